@@ -24,6 +24,7 @@ limitations under the License. */
 #include <sys/stat.h>
 #include <sys/types.h>
 #endif
+#include <algorithm>
 #include <utility>
 #include "gflags/gflags.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
@@ -36,6 +37,12 @@ limitations under the License. */
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
 #include "paddle/fluid/platform/timer.h"
 
+DEFINE_int32(data_feed_readahead_block_num, 4,
+             "The number of blocks a data feed reads ahead of parsing, "
+             "0 means reading the lines directly from the file.");
+DEFINE_int32(data_feed_readahead_block_size, 1 << 20,
+             "The size in bytes of the blocks a data feed reads ahead.");
+
 namespace paddle {
 namespace framework {
 
@@ -155,6 +162,74 @@ void DataFeed::CopyToFeedTensor(void* dst, const void* src, size_t size) {
   }
 }
 
+void DataFeed::InitMultiSlotDesc(
+    const paddle::framework::DataFeedDesc& data_feed_desc) {
+  finish_init_ = false;
+  finish_set_filelist_ = false;
+  finish_start_ = false;
+
+  PADDLE_ENFORCE(data_feed_desc.has_multi_slot_desc(),
+                 "Multi_slot_desc has not been set.");
+  paddle::framework::MultiSlotDesc multi_slot_desc =
+      data_feed_desc.multi_slot_desc();
+  SetBatchSize(data_feed_desc.batch_size());
+  size_t all_slot_num = multi_slot_desc.slots_size();
+  all_slots_.resize(all_slot_num);
+  all_slots_type_.resize(all_slot_num);
+  use_slots_index_.resize(all_slot_num);
+  total_dims_without_inductive_.resize(all_slot_num);
+  inductive_shape_index_.resize(all_slot_num);
+  use_slots_.clear();
+  use_slots_is_dense_.clear();
+  for (size_t i = 0; i < all_slot_num; ++i) {
+    const auto& slot = multi_slot_desc.slots(i);
+    all_slots_[i] = slot.name();
+    all_slots_type_[i] = slot.type();
+    use_slots_index_[i] = slot.is_used() ? use_slots_.size() : -1;
+    total_dims_without_inductive_[i] = 1;
+    inductive_shape_index_[i] = -1;
+    if (slot.is_used()) {
+      use_slots_.push_back(all_slots_[i]);
+      use_slots_is_dense_.push_back(slot.is_dense());
+      std::vector<int> local_shape;
+      if (slot.is_dense()) {
+        for (size_t j = 0; j < slot.shape_size(); ++j) {
+          if (slot.shape(j) > 0) {
+            total_dims_without_inductive_[i] *= slot.shape(j);
+          }
+          if (slot.shape(j) == -1) {
+            inductive_shape_index_[i] = j;
+          }
+        }
+      }
+      for (size_t j = 0; j < slot.shape_size(); ++j) {
+        local_shape.push_back(slot.shape(j));
+      }
+      use_slots_shape_.push_back(local_shape);
+    }
+  }
+  feed_vec_.resize(use_slots_.size());
+  pipe_command_ = data_feed_desc.pipe_command();
+  finish_init_ = true;
+}
+
+void DataFeed::StartReadahead(const std::shared_ptr<FILE>& fp) {
+  // the blocks of the previous file are released first
+  readahead_ = nullptr;
+  if (FLAGS_data_feed_readahead_block_num > 0) {
+    readahead_ = std::make_shared<ReadaheadReader>(
+        fp, FLAGS_data_feed_readahead_block_size,
+        FLAGS_data_feed_readahead_block_num);
+  }
+}
+
+char* DataFeed::GetLineFromPipe(FILE* fp, string::LineFileReader* reader) {
+  if (readahead_ != nullptr) {
+    return readahead_->GetLine();
+  }
+  return reader->getline(fp);
+}
+
 template <typename T>
 void PrivateQueueDataFeed<T>::SetQueueSize(int queue_size) {
   PADDLE_ENFORCE(queue_size > 0, "Illegal queue size: %d.", queue_size);
@@ -181,10 +256,12 @@ void PrivateQueueDataFeed<T>::ReadThread() {
     int err_no = 0;
     fp_ = fs_open_read(filename, &err_no, pipe_command_);
     __fsetlocking(&*fp_, FSETLOCKING_BYCALLER);
+    StartReadahead(fp_);
     T instance;
     while (ParseOneInstanceFromPipe(&instance)) {
       queue_->Put(instance);
     }
+    readahead_ = nullptr;
   }
   queue_->Close();
 #endif
@@ -330,6 +407,7 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
     this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_);
     CHECK(this->fp_ != nullptr);
     __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
+    this->StartReadahead(this->fp_);
     paddle::framework::ChannelWriter<T> writer(input_channel_);
     T instance;
     platform::Timer timeline;
@@ -339,6 +417,7 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
       instance = T();
     }
     writer.Flush();
+    this->readahead_ = nullptr;
     timeline.Pause();
     VLOG(3) << "LoadIntoMemory() read all lines, file=" << filename
             << ", cost time=" << timeline.ElapsedSec()
@@ -350,6 +429,7 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
 
 // explicit instantiation
 template class InMemoryDataFeed<Record>;
+template class InMemoryDataFeed<PackedRecord>;
 
 void MultiSlotDataFeed::Init(
     const paddle::framework::DataFeedDesc& data_feed_desc) {
@@ -412,12 +492,14 @@ void MultiSlotDataFeed::ReadThread() {
     fp_ = fs_open_read(filename, &err_no, pipe_command_);
     CHECK(fp_ != nullptr);
     __fsetlocking(&*fp_, FSETLOCKING_BYCALLER);
+    StartReadahead(fp_);
     std::vector<MultiSlotType> instance;
     int ins_num = 0;
     while (ParseOneInstanceFromPipe(&instance)) {
       ins_num++;
       queue_->Put(instance);
     }
+    readahead_ = nullptr;
     VLOG(3) << "filename: " << filename << " inst num: " << ins_num;
   }
   queue_->Close();
@@ -542,13 +624,13 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
 #ifdef _LINUX
   thread_local string::LineFileReader reader;
 
-  if (!reader.getline(&*(fp_.get()))) {
+  const char* str = GetLineFromPipe(&*(fp_.get()), &reader);
+  if (str == nullptr) {
     return false;
   } else {
     int use_slots_num = use_slots_.size();
     instance->resize(use_slots_num);
 
-    const char* str = reader.get();
     std::string line = std::string(str);
     // VLOG(3) << line;
     char* endptr = const_cast<char*>(str);
@@ -699,63 +781,17 @@ void MultiSlotDataFeed::PutToFeedVec(
 
 void MultiSlotInMemoryDataFeed::Init(
     const paddle::framework::DataFeedDesc& data_feed_desc) {
-  finish_init_ = false;
-  finish_set_filelist_ = false;
-  finish_start_ = false;
-
-  PADDLE_ENFORCE(data_feed_desc.has_multi_slot_desc(),
-                 "Multi_slot_desc has not been set.");
-  paddle::framework::MultiSlotDesc multi_slot_desc =
-      data_feed_desc.multi_slot_desc();
-  SetBatchSize(data_feed_desc.batch_size());
-  size_t all_slot_num = multi_slot_desc.slots_size();
-  all_slots_.resize(all_slot_num);
-  all_slots_type_.resize(all_slot_num);
-  use_slots_index_.resize(all_slot_num);
-  total_dims_without_inductive_.resize(all_slot_num);
-  inductive_shape_index_.resize(all_slot_num);
-  use_slots_.clear();
-  use_slots_is_dense_.clear();
-  for (size_t i = 0; i < all_slot_num; ++i) {
-    const auto& slot = multi_slot_desc.slots(i);
-    all_slots_[i] = slot.name();
-    all_slots_type_[i] = slot.type();
-    use_slots_index_[i] = slot.is_used() ? use_slots_.size() : -1;
-    total_dims_without_inductive_[i] = 1;
-    inductive_shape_index_[i] = -1;
-    if (slot.is_used()) {
-      use_slots_.push_back(all_slots_[i]);
-      use_slots_is_dense_.push_back(slot.is_dense());
-      std::vector<int> local_shape;
-      if (slot.is_dense()) {
-        for (size_t j = 0; j < slot.shape_size(); ++j) {
-          if (slot.shape(j) > 0) {
-            total_dims_without_inductive_[i] *= slot.shape(j);
-          }
-          if (slot.shape(j) == -1) {
-            inductive_shape_index_[i] = j;
-          }
-        }
-      }
-      for (size_t j = 0; j < slot.shape_size(); ++j) {
-        local_shape.push_back(slot.shape(j));
-      }
-      use_slots_shape_.push_back(local_shape);
-    }
-  }
-  feed_vec_.resize(use_slots_.size());
-  pipe_command_ = data_feed_desc.pipe_command();
-  finish_init_ = true;
+  InitMultiSlotDesc(data_feed_desc);
 }
 
 bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
 #ifdef _LINUX
   thread_local string::LineFileReader reader;
 
-  if (!reader.getline(&*(fp_.get()))) {
+  const char* str = GetLineFromPipe(&*(fp_.get()), &reader);
+  if (str == nullptr) {
     return false;
   } else {
-    const char* str = reader.get();
     std::string line = std::string(str);
     // VLOG(3) << line;
     char* endptr = const_cast<char*>(str);
@@ -898,8 +934,26 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
   return false;
 }
 
-void MultiSlotInMemoryDataFeed::PutToFeedVec(
-    const std::vector<Record>& ins_vec) {
+// The accessors of Record and PackedRecord used by PutRecordsToFeedVec.
+static const std::string& InsIdOf(const Record& r) { return r.ins_id_; }
+static std::string InsIdOf(const PackedRecord& r) { return r.InsId(); }
+static const std::string& ContentOf(const Record& r) { return r.content_; }
+static std::string ContentOf(const PackedRecord& r) { return r.Content(); }
+static const std::vector<FeatureItem>& Uint64FeasignsOf(const Record& r) {
+  return r.uint64_feasigns_;
+}
+static PackedRecord::FeatureRange Uint64FeasignsOf(const PackedRecord& r) {
+  return r.Uint64Feasigns();
+}
+static const std::vector<FeatureItem>& FloatFeasignsOf(const Record& r) {
+  return r.float_feasigns_;
+}
+static PackedRecord::FeatureRange FloatFeasignsOf(const PackedRecord& r) {
+  return r.FloatFeasigns();
+}
+
+template <typename R>
+void DataFeed::PutRecordsToFeedVec(const std::vector<R>& ins_vec) {
 #ifdef _LINUX
   std::vector<std::vector<float>> batch_float_feasigns(use_slots_.size(),
                                                        std::vector<float>());
@@ -914,13 +968,13 @@ void MultiSlotInMemoryDataFeed::PutToFeedVec(
   ins_id_vec_.reserve(ins_vec.size());
   for (size_t i = 0; i < ins_vec.size(); ++i) {
     auto& r = ins_vec[i];
-    ins_id_vec_.push_back(r.ins_id_);
-    ins_content_vec_.push_back(r.content_);
-    for (auto& item : r.float_feasigns_) {
+    ins_id_vec_.push_back(InsIdOf(r));
+    ins_content_vec_.push_back(ContentOf(r));
+    for (auto& item : FloatFeasignsOf(r)) {
       batch_float_feasigns[item.slot()].push_back(item.sign().float_feasign_);
       visit[item.slot()] = true;
     }
-    for (auto& item : r.uint64_feasigns_) {
+    for (auto& item : Uint64FeasignsOf(r)) {
       batch_uint64_feasigns[item.slot()].push_back(item.sign().uint64_feasign_);
       visit[item.slot()] = true;
     }
@@ -977,6 +1031,628 @@ void MultiSlotInMemoryDataFeed::PutToFeedVec(
 #endif
 }
 
+void MultiSlotInMemoryDataFeed::PutToFeedVec(
+    const std::vector<Record>& ins_vec) {
+  PutRecordsToFeedVec(ins_vec);
+}
+
+constexpr size_t RecordBlock::kMaxBlockSize;
+
+uint32_t RecordBlock::Append(const Record& record) {
+  feasigns_.insert(feasigns_.end(), record.uint64_feasigns_.begin(),
+                   record.uint64_feasigns_.end());
+  fea_offsets_.push_back(feasigns_.size());
+  feasigns_.insert(feasigns_.end(), record.float_feasigns_.begin(),
+                   record.float_feasigns_.end());
+  fea_offsets_.push_back(feasigns_.size());
+  chars_.insert(chars_.end(), record.ins_id_.begin(), record.ins_id_.end());
+  char_offsets_.push_back(chars_.size());
+  chars_.insert(chars_.end(), record.content_.begin(), record.content_.end());
+  char_offsets_.push_back(chars_.size());
+  return Size() - 1;
+}
+
+void RecordBlock::Seal() {
+  feasigns_.shrink_to_fit();
+  chars_.shrink_to_fit();
+  fea_offsets_.shrink_to_fit();
+  char_offsets_.shrink_to_fit();
+}
+
+size_t RecordBlock::MemorySize() const {
+  return feasigns_.capacity() * sizeof(FeatureItem) + chars_.capacity() +
+         (fea_offsets_.capacity() + char_offsets_.capacity()) *
+             sizeof(uint32_t);
+}
+
+Record PackedRecord::ToRecord() const {
+  Record record;
+  auto uint64_feasigns = Uint64Feasigns();
+  record.uint64_feasigns_.assign(uint64_feasigns.begin(),
+                                 uint64_feasigns.end());
+  auto float_feasigns = FloatFeasigns();
+  record.float_feasigns_.assign(float_feasigns.begin(), float_feasigns.end());
+  record.ins_id_ = InsId();
+  record.content_ = Content();
+  return record;
+}
+
+RecordBlock* RecordArena::NewBlock() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  blocks_.emplace_back(new RecordBlock());
+  return blocks_.back().get();
+}
+
+size_t RecordArena::MemorySize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t size = 0;
+  for (auto& block : blocks_) {
+    size += block->MemorySize();
+  }
+  return size;
+}
+
+void RecordArena::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::unique_ptr<RecordBlock>>().swap(blocks_);
+}
+
+PackedRecord RecordArenaWriter::Append(const Record& record) {
+  if (block_ != nullptr && block_->Full()) {
+    Flush();
+  }
+  if (block_ == nullptr) {
+    block_ = arena_->NewBlock();
+  }
+  return PackedRecord(block_, block_->Append(record));
+}
+
+void RecordArenaWriter::Flush() {
+  if (block_ != nullptr) {
+    block_->Seal();
+    block_ = nullptr;
+  }
+}
+
+void MultiSlotCompactInMemoryDataFeed::Init(
+    const paddle::framework::DataFeedDesc& data_feed_desc) {
+  InitMultiSlotDesc(data_feed_desc);
+  parser_.Init(data_feed_desc);
+}
+
+void MultiSlotCompactInMemoryDataFeed::SetRecordArena(void* arena) {
+  arena_ = static_cast<RecordArena*>(arena);
+}
+
+void MultiSlotCompactInMemoryDataFeed::LoadIntoMemory() {
+  CHECK(arena_ != nullptr) << "the record arena has not been set";
+  writer_.reset(new RecordArenaWriter(arena_));
+  parser_.SetParseInsId(parse_ins_id_);
+  parser_.SetParseContent(parse_content_);
+  InMemoryDataFeed<PackedRecord>::LoadIntoMemory();
+  // seal the last block of this thread
+  writer_.reset();
+  parser_.fp_ = nullptr;
+  parser_.readahead_ = nullptr;
+}
+
+bool MultiSlotCompactInMemoryDataFeed::ParseOneInstanceFromPipe(
+    PackedRecord* instance) {
+  parser_.fp_ = fp_;
+  parser_.readahead_ = readahead_;
+  record_.uint64_feasigns_.clear();
+  record_.float_feasigns_.clear();
+  record_.ins_id_.clear();
+  record_.content_.clear();
+  if (!parser_.ParseOneInstanceFromPipe(&record_)) {
+    return false;
+  }
+  *instance = writer_->Append(record_);
+  return true;
+}
+
+bool MultiSlotCompactInMemoryDataFeed::ParseOneInstance(
+    PackedRecord* instance) {
+  PADDLE_THROW("MultiSlotCompactInMemoryDataFeed only loads data by pipe.");
+  return false;
+}
+
+void MultiSlotCompactInMemoryDataFeed::PutToFeedVec(
+    const std::vector<PackedRecord>& ins_vec) {
+  PutRecordsToFeedVec(ins_vec);
+}
+
+constexpr uint32_t MultiSlotBinaryFormat::kFileMagic;
+constexpr uint32_t MultiSlotBinaryFormat::kBlockMagic;
+constexpr uint32_t MultiSlotBinaryFormat::kIndexMagic;
+constexpr uint64_t MultiSlotBinaryFormat::kMaxPayloadSize;
+
+std::string MultiSlotBinaryFormat::ParseFilename(const std::string& filename,
+                                                 size_t* begin_block,
+                                                 size_t* end_block) {
+  *begin_block = 0;
+  *end_block = static_cast<size_t>(-1);
+  size_t pos = filename.rfind('@');
+  if (pos == std::string::npos) {
+    return filename;
+  }
+  const char* str = filename.c_str() + pos + 1;
+  char* endptr = nullptr;
+  uint64_t begin = strtoull(str, &endptr, 10);
+  if (endptr == str || *endptr != ',') {
+    return filename;
+  }
+  str = endptr + 1;
+  uint64_t end = strtoull(str, &endptr, 10);
+  if (endptr == str || *endptr != '\0') {
+    return filename;
+  }
+  PADDLE_ENFORCE_LE(begin, end, "Illegal block range of file %s", filename);
+  *begin_block = begin;
+  *end_block = end;
+  return filename.substr(0, pos);
+}
+
+// Reads the block offsets from the index at the end of fp. Returns false if
+// fp is not seekable, e.g. a pipe.
+static bool ReadBlockOffsets(FILE* fp, const std::string& filename,
+                             std::vector<uint64_t>* offsets) {
+  uint64_t index_offset = 0;
+  if (fseeko(fp, -static_cast<off_t>(sizeof(index_offset)), SEEK_END) != 0) {
+    return false;
+  }
+  MultiSlotBinaryFormat::BlockHeader header;
+  PADDLE_ENFORCE(fread(&index_offset, sizeof(index_offset), 1, fp) == 1 &&
+                     fseeko(fp, index_offset, SEEK_SET) == 0 &&
+                     fread(&header, sizeof(header), 1, fp) == 1 &&
+                     header.magic_ == MultiSlotBinaryFormat::kIndexMagic,
+                 "Fail to read the block index of file %s", filename);
+  offsets->resize(header.payload_size_);
+  PADDLE_ENFORCE_EQ(
+      fread(offsets->data(), sizeof(uint64_t), offsets->size(), fp),
+      offsets->size(), "Fail to read the block index of file %s", filename);
+  return true;
+}
+
+MultiSlotBinaryWriter::MultiSlotBinaryWriter(
+    const std::string& filename, const std::vector<std::string>& slot_types,
+    size_t block_ins_num)
+    : slot_types_(slot_types),
+      block_ins_num_(block_ins_num),
+      ins_num_(0),
+      block_(slot_types.size()),
+      offset_(0) {
+  PADDLE_ENFORCE_GT(block_ins_num_, 0UL,
+                    "The instance number of a block must be positive.");
+  int err_no = 0;
+  fp_ = fs_open_write(filename, &err_no, "");
+  PADDLE_ENFORCE(fp_ != nullptr, "Fail to open file: %s", filename);
+
+  uint32_t magic = MultiSlotBinaryFormat::kFileMagic;
+  uint32_t slot_num = static_cast<uint32_t>(slot_types_.size());
+  Write(&magic, sizeof(magic));
+  Write(&slot_num, sizeof(slot_num));
+  for (size_t i = 0; i < slot_types_.size(); ++i) {
+    block_[i].Init(slot_types_[i]);
+    block_[i].InitOffset(block_ins_num_);
+    Write(&slot_types_[i][0], 1);
+  }
+  WritePadding();
+}
+
+void MultiSlotBinaryWriter::Write(const void* data, size_t size) {
+  PADDLE_ENFORCE_EQ(fwrite(data, 1, size, &*fp_), size,
+                    "Fail to write the binary file.");
+  offset_ += size;
+}
+
+void MultiSlotBinaryWriter::WritePadding() {
+  static const char padding[8] = {0};
+  Write(padding, MultiSlotBinaryFormat::Align(offset_) - offset_);
+}
+
+void MultiSlotBinaryWriter::AddInstance(
+    const std::vector<MultiSlotType>& instance) {
+  PADDLE_ENFORCE_EQ(instance.size(), block_.size(),
+                    "The slot number of the instance is wrong.");
+  for (size_t i = 0; i < instance.size(); ++i) {
+    block_[i].AddIns(instance[i]);
+  }
+  if (++ins_num_ == block_ins_num_) {
+    FlushBlock();
+  }
+}
+
+void MultiSlotBinaryWriter::FlushBlock() {
+  if (ins_num_ == 0) {
+    return;
+  }
+  MultiSlotBinaryFormat::BlockHeader header;
+  header.magic_ = MultiSlotBinaryFormat::kBlockMagic;
+  header.ins_num_ = static_cast<uint32_t>(ins_num_);
+  header.payload_size_ = 0;
+  for (size_t i = 0; i < block_.size(); ++i) {
+    size_t value_size =
+        slot_types_[i][0] == 'f' ? sizeof(float) : sizeof(uint64_t);
+    header.payload_size_ +=
+        MultiSlotBinaryFormat::Align(ins_num_ * sizeof(uint32_t)) +
+        MultiSlotBinaryFormat::Align(block_[i].GetOffset().back() * value_size);
+  }
+  PADDLE_ENFORCE_LE(header.payload_size_,
+                    MultiSlotBinaryFormat::kMaxPayloadSize,
+                    "The block is too large, please use a smaller "
+                    "block_ins_num.");
+  block_offsets_.push_back(offset_);
+  Write(&header, sizeof(header));
+
+  std::vector<uint32_t> feasign_num(ins_num_);
+  for (size_t i = 0; i < block_.size(); ++i) {
+    const auto& offset = block_[i].GetOffset();
+    for (size_t j = 0; j < ins_num_; ++j) {
+      feasign_num[j] = static_cast<uint32_t>(offset[j + 1] - offset[j]);
+    }
+    Write(feasign_num.data(), ins_num_ * sizeof(uint32_t));
+    WritePadding();
+    if (slot_types_[i][0] == 'f') {  // float
+      Write(block_[i].GetFloatData().data(), offset.back() * sizeof(float));
+    } else if (slot_types_[i][0] == 'u') {  // uint64
+      Write(block_[i].GetUint64Data().data(),
+            offset.back() * sizeof(uint64_t));
+    }
+    WritePadding();
+    block_[i].Init(slot_types_[i]);
+    block_[i].InitOffset(block_ins_num_);
+  }
+  ins_num_ = 0;
+}
+
+void MultiSlotBinaryWriter::Close() {
+  if (fp_ == nullptr) {
+    return;
+  }
+  FlushBlock();
+  uint64_t index_offset = offset_;
+  MultiSlotBinaryFormat::BlockHeader header;
+  header.magic_ = MultiSlotBinaryFormat::kIndexMagic;
+  header.ins_num_ = 0;
+  header.payload_size_ = block_offsets_.size();
+  Write(&header, sizeof(header));
+  Write(block_offsets_.data(), block_offsets_.size() * sizeof(uint64_t));
+  Write(&index_offset, sizeof(index_offset));
+  fp_ = nullptr;
+}
+
+void MultiSlotBinaryReader::Open(const std::string& filename,
+                                 const std::string& pipe_command,
+                                 const std::vector<std::string>& slot_types) {
+  size_t begin_block = 0;
+  filename_ =
+      MultiSlotBinaryFormat::ParseFilename(filename, &begin_block, &end_block_);
+  if (fs_select_internal(filename_) == 0 &&
+      (pipe_command.empty() || pipe_command == "cat")) {
+    // open local files without pipe, so that they are seekable
+    fp_ = localfs_open_read(filename_, "");
+  } else {
+    int err_no = 0;
+    fp_ = fs_open_read(filename_, &err_no, pipe_command);
+  }
+  PADDLE_ENFORCE(fp_ != nullptr, "Fail to open file: %s", filename_);
+#ifdef _LINUX
+  __fsetlocking(&*fp_, FSETLOCKING_BYCALLER);
+#endif
+
+  uint32_t magic = 0;
+  uint32_t slot_num = 0;
+  PADDLE_ENFORCE(Read(&magic, sizeof(magic)) &&
+                     magic == MultiSlotBinaryFormat::kFileMagic &&
+                     Read(&slot_num, sizeof(slot_num)),
+                 "File %s is not in the binary format of multi-slot data.",
+                 filename_);
+  PADDLE_ENFORCE_EQ(slot_num, slot_types.size(),
+                    "The slot number of file %s is wrong.", filename_);
+  size_t header_size = 2 * sizeof(uint32_t) + slot_num;
+  std::vector<char> types(MultiSlotBinaryFormat::Align(header_size) -
+                          2 * sizeof(uint32_t));
+  PADDLE_ENFORCE(Read(types.data(), types.size()),
+                 "Fail to read the header of file %s", filename_);
+  for (size_t i = 0; i < slot_types.size(); ++i) {
+    PADDLE_ENFORCE_EQ(types[i], slot_types[i][0],
+                      "The type of slot %d in file %s is wrong.", i,
+                      filename_);
+  }
+  slot_types_ = slot_types;
+  block_idx_ = 0;
+  ins_num_ = 0;
+  ins_idx_ = 0;
+  if (begin_block > 0) {
+    SeekToBlock(begin_block);
+  }
+}
+
+void MultiSlotBinaryReader::Close() { fp_ = nullptr; }
+
+bool MultiSlotBinaryReader::Read(void* data, size_t size) {
+  return fread(data, 1, size, &*fp_) == size;
+}
+
+void MultiSlotBinaryReader::SeekToBlock(size_t block) {
+  std::vector<uint64_t> offsets;
+  if (ReadBlockOffsets(&*fp_, filename_, &offsets)) {
+    if (block < offsets.size()) {
+      PADDLE_ENFORCE_EQ(fseeko(&*fp_, offsets[block], SEEK_SET), 0,
+                        "Fail to seek file %s", filename_);
+      block_idx_ = block;
+    } else {
+      block_idx_ = end_block_;
+    }
+    return;
+  }
+  // The file is not seekable, skip the blocks before it without decoding.
+  while (block_idx_ < block && ReadBlock(false)) {
+  }
+}
+
+bool MultiSlotBinaryReader::ReadBlock(bool decode) {
+  ins_num_ = 0;
+  ins_idx_ = 0;
+  if (block_idx_ >= end_block_) {
+    return false;
+  }
+  MultiSlotBinaryFormat::BlockHeader header;
+  if (!Read(&header, sizeof(header)) ||
+      header.magic_ == MultiSlotBinaryFormat::kIndexMagic) {
+    return false;
+  }
+  PADDLE_ENFORCE_EQ(header.magic_, MultiSlotBinaryFormat::kBlockMagic,
+                    "Block %d of file %s is broken.", block_idx_, filename_);
+  // The payload is padded to 8 bytes, so it fills the buffer exactly.
+  PADDLE_ENFORCE(
+      header.payload_size_ % sizeof(uint64_t) == 0 &&
+          header.payload_size_ <= MultiSlotBinaryFormat::kMaxPayloadSize,
+      "Block %d of file %s is broken, its payload size is %d.", block_idx_,
+      filename_, header.payload_size_);
+  buffer_.resize(header.payload_size_ / sizeof(uint64_t));
+  PADDLE_ENFORCE(Read(buffer_.data(), header.payload_size_),
+                 "Block %d of file %s is truncated.", block_idx_, filename_);
+  ++block_idx_;
+  if (!decode) {
+    return true;
+  }
+
+  const char* ptr = reinterpret_cast<const char*>(buffer_.data());
+  const char* end = ptr + header.payload_size_;
+  slot_offsets_.resize(slot_types_.size());
+  slot_data_.resize(slot_types_.size());
+  for (size_t i = 0; i < slot_types_.size(); ++i) {
+    const uint32_t* feasign_num = reinterpret_cast<const uint32_t*>(ptr);
+    ptr += MultiSlotBinaryFormat::Align(header.ins_num_ * sizeof(uint32_t));
+    PADDLE_ENFORCE_LE(ptr, end, "Block %d of file %s is broken.",
+                      block_idx_ - 1, filename_);
+    auto& offset = slot_offsets_[i];
+    offset.resize(header.ins_num_ + 1);
+    offset[0] = 0;
+    for (size_t j = 0; j < header.ins_num_; ++j) {
+      offset[j + 1] = offset[j] + feasign_num[j];
+    }
+    size_t value_size =
+        slot_types_[i][0] == 'f' ? sizeof(float) : sizeof(uint64_t);
+    slot_data_[i] = ptr;
+    ptr += MultiSlotBinaryFormat::Align(offset.back() * value_size);
+  }
+  PADDLE_ENFORCE(ptr == end, "Block %d of file %s is broken.", block_idx_ - 1,
+                 filename_);
+  ins_num_ = header.ins_num_;
+  return true;
+}
+
+bool MultiSlotBinaryReader::NextInstance() {
+  if (ins_idx_ + 1 < ins_num_) {
+    ++ins_idx_;
+    return true;
+  }
+  while (ReadBlock()) {
+    if (ins_num_ > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<uint64_t> ReadMultiSlotBinaryIndex(const std::string& filename) {
+  PADDLE_ENFORCE_EQ(fs_select_internal(filename), 0,
+                    "Only the index of local file can be read: %s", filename);
+  auto fp = localfs_open_read(filename, "");
+  PADDLE_ENFORCE(fp != nullptr, "Fail to open file: %s", filename);
+  std::vector<uint64_t> offsets;
+  PADDLE_ENFORCE(ReadBlockOffsets(&*fp, filename, &offsets),
+                 "File %s is not seekable.", filename);
+  return offsets;
+}
+
+std::vector<std::string> SplitMultiSlotBinaryFiles(
+    const std::vector<std::string>& filelist, size_t block_num_per_part) {
+  PADDLE_ENFORCE_GT(block_num_per_part, 0UL,
+                    "The block number of a part must be positive.");
+  std::vector<std::string> parts;
+  for (const auto& filename : filelist) {
+    std::vector<uint64_t> offsets;
+    if (fs_select_internal(filename) != 0 ||
+        !ReadBlockOffsets(&*localfs_open_read(filename, ""), filename,
+                          &offsets)) {
+      parts.push_back(filename);
+      continue;
+    }
+    for (size_t begin = 0; begin < offsets.size();
+         begin += block_num_per_part) {
+      size_t end = std::min(begin + block_num_per_part, offsets.size());
+      parts.push_back(filename + "@" + std::to_string(begin) + "," +
+                      std::to_string(end));
+    }
+  }
+  return parts;
+}
+
+void ConvertMultiSlotTextToBinary(const std::string& src_filename,
+                                  const std::string& dst_filename,
+                                  const std::vector<std::string>& slot_types,
+                                  size_t block_ins_num,
+                                  const std::string& pipe_command) {
+  int err_no = 0;
+  auto fp = fs_open_read(src_filename, &err_no, pipe_command);
+  PADDLE_ENFORCE(fp != nullptr, "Fail to open file: %s", src_filename);
+  MultiSlotBinaryWriter writer(dst_filename, slot_types, block_ins_num);
+  string::LineFileReader reader;
+  std::vector<MultiSlotType> instance(slot_types.size());
+  while (reader.getline(&*fp)) {
+    const char* str = reader.get();
+    char* endptr = const_cast<char*>(str);
+    for (size_t i = 0; i < slot_types.size(); ++i) {
+      int num = strtol(endptr, &endptr, 10);
+      PADDLE_ENFORCE(
+          num,
+          "The number of ids can not be zero, you need padding "
+          "it in data generator; or if there is something wrong with "
+          "the data, please check if the data contains unresolvable "
+          "characters.\nplease check this error line: %s",
+          str);
+      instance[i].Init(slot_types[i], num);
+      if (slot_types[i][0] == 'f') {  // float
+        for (int j = 0; j < num; ++j) {
+          instance[i].AddValue(strtof(endptr, &endptr));
+        }
+      } else if (slot_types[i][0] == 'u') {  // uint64
+        for (int j = 0; j < num; ++j) {
+          instance[i].AddValue((uint64_t)strtoull(endptr, &endptr, 10));
+        }
+      }
+    }
+    writer.AddInstance(instance);
+  }
+  writer.Close();
+}
+
+bool MultiSlotBinaryDataFeed::CheckFile(const char* filename) {
+  CheckInit();  // get info of slots
+  MultiSlotBinaryReader reader;
+  reader.Open(filename, pipe_command_, all_slots_type_);
+  int instance_cout = 0;
+  while (reader.NextInstance()) {
+    ++instance_cout;
+  }
+  reader.Close();
+  VLOG(3) << "instances cout: " << instance_cout;
+  VLOG(3) << "The file format is correct";
+  return true;
+}
+
+void MultiSlotBinaryDataFeed::ReadThread() {
+#ifdef _LINUX
+  std::string filename;
+  while (PickOneFile(&filename)) {
+    reader_.Open(filename, pipe_command_, all_slots_type_);
+    std::vector<MultiSlotType> instance;
+    int ins_num = 0;
+    while (ParseOneInstanceFromPipe(&instance)) {
+      ins_num++;
+      queue_->Put(instance);
+    }
+    reader_.Close();
+    VLOG(3) << "filename: " << filename << " inst num: " << ins_num;
+  }
+  queue_->Close();
+#endif
+}
+
+bool MultiSlotBinaryDataFeed::ParseOneInstanceFromPipe(
+    std::vector<MultiSlotType>* instance) {
+  if (!reader_.NextInstance()) {
+    return false;
+  }
+  instance->resize(use_slots_.size());
+  for (size_t i = 0; i < use_slots_index_.size(); ++i) {
+    int idx = use_slots_index_[i];
+    if (idx == -1) {
+      continue;
+    }
+    auto& slot = (*instance)[idx];
+    slot.Init(all_slots_type_[i]);
+    if (all_slots_type_[i][0] == 'f') {  // float
+      slot.CopyValues(reader_.Feasigns<float>(i), reader_.FeasignNum(i));
+    } else if (all_slots_type_[i][0] == 'u') {  // uint64
+      slot.CopyValues(reader_.Feasigns<uint64_t>(i), reader_.FeasignNum(i));
+    }
+  }
+  return true;
+}
+
+void MultiSlotBinaryInMemoryDataFeed::LoadIntoMemory() {
+#ifdef _LINUX
+  VLOG(3) << "LoadIntoMemory() begin, thread_id=" << thread_id_;
+  PADDLE_ENFORCE(!parse_ins_id_ && !parse_content_,
+                 "The binary format does not contain ins_id and content.");
+  std::string filename;
+  while (PickOneFile(&filename)) {
+    VLOG(3) << "PickOneFile, filename=" << filename
+            << ", thread_id=" << thread_id_;
+    reader_.Open(filename, pipe_command_, all_slots_type_);
+    paddle::framework::ChannelWriter<Record> writer(input_channel_);
+    Record instance;
+    platform::Timer timeline;
+    timeline.Start();
+    while (ParseOneInstanceFromPipe(&instance)) {
+      writer << std::move(instance);
+      instance = Record();
+    }
+    writer.Flush();
+    reader_.Close();
+    timeline.Pause();
+    VLOG(3) << "LoadIntoMemory() read all blocks, file=" << filename
+            << ", cost time=" << timeline.ElapsedSec()
+            << " seconds, thread_id=" << thread_id_;
+  }
+  VLOG(3) << "LoadIntoMemory() end, thread_id=" << thread_id_;
+#endif
+}
+
+bool MultiSlotBinaryInMemoryDataFeed::ParseOneInstanceFromPipe(
+    Record* instance) {
+  if (!reader_.NextInstance()) {
+    return false;
+  }
+  for (size_t i = 0; i < use_slots_index_.size(); ++i) {
+    int idx = use_slots_index_[i];
+    if (idx == -1) {
+      continue;
+    }
+    size_t num = reader_.FeasignNum(i);
+    // the same as the text format, zero feasigns of sparse slots are ignored
+    if (all_slots_type_[i][0] == 'f') {  // float
+      const float* feasigns = reader_.Feasigns<float>(i);
+      for (size_t j = 0; j < num; ++j) {
+        if (fabs(feasigns[j]) < 1e-6 && !use_slots_is_dense_[idx]) {
+          continue;
+        }
+        FeatureKey f;
+        f.float_feasign_ = feasigns[j];
+        instance->float_feasigns_.push_back(FeatureItem(f, idx));
+      }
+    } else if (all_slots_type_[i][0] == 'u') {  // uint64
+      const uint64_t* feasigns = reader_.Feasigns<uint64_t>(i);
+      for (size_t j = 0; j < num; ++j) {
+        if (feasigns[j] == 0 && !use_slots_is_dense_[idx]) {
+          continue;
+        }
+        FeatureKey f;
+        f.uint64_feasign_ = feasigns[j];
+        instance->uint64_feasigns_.push_back(FeatureItem(f, idx));
+      }
+    }
+  }
+  instance->float_feasigns_.shrink_to_fit();
+  instance->uint64_feasigns_.shrink_to_fit();
+  return true;
+}
+
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
 template <typename T>
 void PrivateInstantDataFeed<T>::PutToFeedVec() {
@@ -34,6 +34,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/blocking_queue.h"
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/data_feed.pb.h"
+#include "paddle/fluid/framework/io/readahead_reader.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/variable.h"
@@ -100,6 +101,8 @@ class DataFeed {
   // This function will do nothing at default
   virtual void SetConsumeChannel(void* channel) {}
   // This function will do nothing at default
+  virtual void SetRecordArena(void* arena) {}
+  // This function will do nothing at default
   virtual void SetThreadId(int thread_id) {}
   // This function will do nothing at default
   virtual void SetThreadNum(int thread_num) {}
@@ -138,6 +141,18 @@ class DataFeed {
   // safe).
   virtual bool PickOneFile(std::string* filename);
   virtual void CopyToFeedTensor(void* dst, const void* src, size_t size);
+  // These functions are shared by the DataFeeds of multi-slot type data in
+  // memory. InitMultiSlotDesc sets the slots by the multi_slot_desc, and
+  // PutRecordsToFeedVec puts a batch of Record or PackedRecord to feed_vec.
+  void InitMultiSlotDesc(const DataFeedDesc& data_feed_desc);
+  template <typename R>
+  void PutRecordsToFeedVec(const std::vector<R>& ins_vec);
+  // Starts reading fp ahead on ThreadPoolIO if
+  // FLAGS_data_feed_readahead_block_num > 0, see ReadaheadReader.
+  void StartReadahead(const std::shared_ptr<FILE>& fp);
+  // Returns the next line of fp for ParseOneInstanceFromPipe, which is read
+  // from readahead_ if it is started, or by reader otherwise.
+  char* GetLineFromPipe(FILE* fp, string::LineFileReader* reader);
 
   std::vector<std::string> filelist_;
   size_t* file_idx_;
@@ -175,6 +190,7 @@ class DataFeed {
   std::vector<std::string> ins_id_vec_;
   std::vector<std::string> ins_content_vec_;
   platform::Place place_;
+  std::shared_ptr<ReadaheadReader> readahead_;
 };
 
 // PrivateQueueDataFeed is the base virtual class for ohther DataFeeds.
@@ -526,6 +542,134 @@ paddle::framework::Archive<AR>& operator>>(paddle::framework::Archive<AR>& ar,
   return ar;
 }
 
+// A RecordBlock packs many records into a few contiguous arrays instead of
+// the vectors and strings of every Record. The feasigns of record i are
+// feasigns_[fea_offsets_[2i], fea_offsets_[2i+1]) for uint64 and
+// feasigns_[fea_offsets_[2i+1], fea_offsets_[2i+2]) for float, and its
+// ins_id and content are stored in chars_ the same way.
+class RecordBlock {
+ public:
+  // A block is full once it holds this many feasigns or chars, so that
+  // the offsets fit in uint32_t.
+  static constexpr size_t kMaxBlockSize = 1 << 24;
+
+  RecordBlock() : fea_offsets_{0}, char_offsets_{0} {}
+
+  size_t Size() const { return fea_offsets_.size() / 2; }
+  bool Full() const {
+    return feasigns_.size() >= kMaxBlockSize || chars_.size() >= kMaxBlockSize;
+  }
+  // Appends a record and returns its index in the block.
+  uint32_t Append(const Record& record);
+  // Releases the spare capacity once no more records will be appended.
+  void Seal();
+  size_t MemorySize() const;
+
+  const FeatureItem* Feasigns(size_t offset) const {
+    return feasigns_.data() + offset;
+  }
+  size_t FeaOffset(size_t i) const { return fea_offsets_[i]; }
+  const char* Chars(size_t offset) const { return chars_.data() + offset; }
+  size_t CharOffset(size_t i) const { return char_offsets_[i]; }
+
+ private:
+  std::vector<FeatureItem> feasigns_;
+  std::vector<char> chars_;
+  std::vector<uint32_t> fea_offsets_;
+  std::vector<uint32_t> char_offsets_;
+};
+
+// PackedRecord is a handle of a record stored in a RecordBlock. It is what
+// the channels of MultiSlotCompactDataset hold, so shuffling moves only the
+// handles and the feasigns stay where they were loaded.
+struct PackedRecord {
+  struct FeatureRange {
+    const FeatureItem* begin_;
+    const FeatureItem* end_;
+    const FeatureItem* begin() const { return begin_; }
+    const FeatureItem* end() const { return end_; }
+    size_t size() const { return end_ - begin_; }
+  };
+
+  PackedRecord() : block_(nullptr), index_(0) {}
+  PackedRecord(const RecordBlock* block, uint32_t index)
+      : block_(block), index_(index) {}
+
+  FeatureRange Uint64Feasigns() const { return Range(2 * index_); }
+  FeatureRange FloatFeasigns() const { return Range(2 * index_ + 1); }
+  std::string InsId() const { return String(2 * index_); }
+  std::string Content() const { return String(2 * index_ + 1); }
+  // Copies the record out of its block.
+  Record ToRecord() const;
+
+  const RecordBlock* block_;
+  uint32_t index_;
+
+ private:
+  FeatureRange Range(size_t i) const {
+    return {block_->Feasigns(block_->FeaOffset(i)),
+            block_->Feasigns(block_->FeaOffset(i + 1))};
+  }
+  std::string String(size_t i) const {
+    size_t begin = block_->CharOffset(i);
+    return std::string(block_->Chars(begin), block_->CharOffset(i + 1) - begin);
+  }
+};
+
+// RecordArena owns the blocks of the records of a dataset.
+class RecordArena {
+ public:
+  RecordArena() {}
+  RecordArena(const RecordArena&) = delete;
+  RecordArena& operator=(const RecordArena&) = delete;
+
+  // The returned block is filled by one thread and stays valid until
+  // Clear() is called.
+  RecordBlock* NewBlock();
+  size_t MemorySize();
+  void Clear();
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<RecordBlock>> blocks_;
+};
+
+// Appends records to the blocks of an arena, one block at a time.
+class RecordArenaWriter {
+ public:
+  explicit RecordArenaWriter(RecordArena* arena)
+      : arena_(arena), block_(nullptr) {}
+  ~RecordArenaWriter() { Flush(); }
+
+  PackedRecord Append(const Record& record);
+  // Seals the current block, the next record goes to a new block.
+  void Flush();
+
+ private:
+  RecordArena* arena_;
+  RecordBlock* block_;
+};
+
+// A PackedRecord is serialized in the same format as a Record.
+template <class AR>
+paddle::framework::Archive<AR>& operator<<(paddle::framework::Archive<AR>& ar,
+                                           const PackedRecord& r) {
+  auto write_feasigns = [&ar](const PackedRecord::FeatureRange& range) {
+#ifdef _LINUX
+    ar << (size_t)range.size();
+#else
+    ar << (uint64_t)range.size();
+#endif
+    for (auto& item : range) {
+      ar << item;
+    }
+  };
+  write_feasigns(r.Uint64Feasigns());
+  write_feasigns(r.FloatFeasigns());
+  ar << r.InsId();
+  return ar;
+}
+
 // This DataFeed is used to feed multi-slot type data.
 // The format of multi-slot type data:
 //   [n feasign_0 feasign_1 ... feasign_n]*
@@ -557,6 +701,178 @@ class MultiSlotInMemoryDataFeed : public InMemoryDataFeed<Record> {
   virtual bool ParseOneInstance(Record* instance);
   virtual bool ParseOneInstanceFromPipe(Record* instance);
   virtual void PutToFeedVec(const std::vector<Record>& ins_vec);
+
+  friend class MultiSlotCompactInMemoryDataFeed;
+};
+
+// This DataFeed is the same as MultiSlotInMemoryDataFeed except that the
+// instances are packed into the blocks of the RecordArena of
+// MultiSlotCompactDataset, see RecordBlock.
+class MultiSlotCompactInMemoryDataFeed
+    : public InMemoryDataFeed<PackedRecord> {
+ public:
+  MultiSlotCompactInMemoryDataFeed() : arena_(nullptr) {}
+  virtual ~MultiSlotCompactInMemoryDataFeed() {}
+  virtual void Init(const DataFeedDesc& data_feed_desc);
+  virtual void SetRecordArena(void* arena);
+  virtual void LoadIntoMemory();
+
+ protected:
+  virtual bool ParseOneInstance(PackedRecord* instance);
+  virtual bool ParseOneInstanceFromPipe(PackedRecord* instance);
+  virtual void PutToFeedVec(const std::vector<PackedRecord>& ins_vec);
+
+  // parses the text lines into record_, which is then packed by writer_
+  MultiSlotInMemoryDataFeed parser_;
+  Record record_;
+  RecordArena* arena_;
+  std::unique_ptr<RecordArenaWriter> writer_;
+};
+
+// The binary slot-columnar format of multi-slot type data, which is decoded
+// without any text parsing. A file is made up of:
+//   header: uint32 magic, uint32 slot_num, char type[slot_num]
+//   blocks: uint32 magic, uint32 ins_num, uint64 payload_size, payload
+//   index:  uint32 magic, uint32 0, uint64 block_num,
+//           uint64 block_offset[block_num], uint64 index_offset
+// The payload of a block stores all slots one after another, and each slot
+// is stored as uint32 feasign_num[ins_num] followed by all its feasigns.
+// The header and every array are padded to 8 bytes, and all numbers are in
+// the native byte order.
+//
+// The index at the end of the file is not needed by sequential reads. It
+// records the offsets of blocks so that a file can be read partially: a
+// filename suffixed by "@begin,end" means the blocks [begin, end) of it.
+class MultiSlotBinaryFormat {
+ public:
+  static constexpr uint32_t kFileMagic = 0x4642534d;   // "MSBF"
+  static constexpr uint32_t kBlockMagic = 0x4242534d;  // "MSBB"
+  static constexpr uint32_t kIndexMagic = 0x4942534d;  // "MSBI"
+  // The payload of a block is read into memory at once.
+  static constexpr uint64_t kMaxPayloadSize = 1ULL << 32;
+
+  struct BlockHeader {
+    uint32_t magic_;
+    uint32_t ins_num_;
+    uint64_t payload_size_;  // block_num for the index
+  };
+
+  static size_t Align(size_t size) { return (size + 7) & ~size_t(7); }
+
+  // Splits "path@begin,end" into path and the block range. The range is
+  // [0, -1) if there is no suffix.
+  static std::string ParseFilename(const std::string& filename,
+                                   size_t* begin_block, size_t* end_block);
+};
+
+// Writes the instances of multi-slot type data into a binary file, see
+// MultiSlotBinaryFormat.
+class MultiSlotBinaryWriter {
+ public:
+  MultiSlotBinaryWriter(const std::string& filename,
+                        const std::vector<std::string>& slot_types,
+                        size_t block_ins_num = 1024);
+  ~MultiSlotBinaryWriter() { Close(); }
+
+  // The instance should contain one MultiSlotType of each slot.
+  void AddInstance(const std::vector<MultiSlotType>& instance);
+  // Flushes the last block and writes the index.
+  void Close();
+
+ private:
+  void Write(const void* data, size_t size);
+  void WritePadding();
+  void FlushBlock();
+
+  std::shared_ptr<FILE> fp_;
+  std::vector<std::string> slot_types_;
+  size_t block_ins_num_;
+  size_t ins_num_;
+  std::vector<MultiSlotType> block_;
+  std::vector<uint64_t> block_offsets_;
+  uint64_t offset_;
+};
+
+// Reads the binary files of multi-slot type data block by block, the
+// feasigns of each instance point into the block buffer directly.
+class MultiSlotBinaryReader {
+ public:
+  MultiSlotBinaryReader() {}
+  // The filename may be suffixed by "@begin,end" to read a part of blocks.
+  void Open(const std::string& filename, const std::string& pipe_command,
+            const std::vector<std::string>& slot_types);
+  void Close();
+  // Moves to the next instance, returns false at the end of the blocks.
+  bool NextInstance();
+  size_t FeasignNum(size_t slot) const {
+    return slot_offsets_[slot][ins_idx_ + 1] - slot_offsets_[slot][ins_idx_];
+  }
+  template <typename T>
+  const T* Feasigns(size_t slot) const {
+    return reinterpret_cast<const T*>(slot_data_[slot]) +
+           slot_offsets_[slot][ins_idx_];
+  }
+
+ private:
+  bool ReadBlock(bool decode = true);
+  bool Read(void* data, size_t size);
+  void SeekToBlock(size_t block);
+
+  std::shared_ptr<FILE> fp_;
+  std::string filename_;
+  std::vector<std::string> slot_types_;
+  size_t block_idx_{0};
+  size_t end_block_{0};
+  size_t ins_num_{0};
+  size_t ins_idx_{0};
+  std::vector<uint64_t> buffer_;
+  std::vector<std::vector<uint64_t>> slot_offsets_;
+  std::vector<const char*> slot_data_;
+};
+
+// Returns the block offsets recorded in the index of a local binary file.
+std::vector<uint64_t> ReadMultiSlotBinaryIndex(const std::string& filename);
+
+// Splits every local binary file into parts of at most block_num_per_part
+// blocks, so that the parts of a file can be read by different threads.
+// Remote files are kept as a whole.
+std::vector<std::string> SplitMultiSlotBinaryFiles(
+    const std::vector<std::string>& filelist, size_t block_num_per_part);
+
+// Converts a file of multi-slot type text data into the binary format.
+void ConvertMultiSlotTextToBinary(const std::string& src_filename,
+                                  const std::string& dst_filename,
+                                  const std::vector<std::string>& slot_types,
+                                  size_t block_ins_num = 1024,
+                                  const std::string& pipe_command = "cat");
+
+// This DataFeed is the same as MultiSlotDataFeed except that it reads the
+// binary format, see MultiSlotBinaryFormat.
+class MultiSlotBinaryDataFeed : public MultiSlotDataFeed {
+ public:
+  MultiSlotBinaryDataFeed() {}
+  virtual ~MultiSlotBinaryDataFeed() {}
+  virtual bool CheckFile(const char* filename);
+
+ protected:
+  virtual void ReadThread();
+  virtual bool ParseOneInstanceFromPipe(std::vector<MultiSlotType>* instance);
+
+  MultiSlotBinaryReader reader_;
+};
+
+// This DataFeed is the same as MultiSlotInMemoryDataFeed except that it
+// loads the binary format, see MultiSlotBinaryFormat.
+class MultiSlotBinaryInMemoryDataFeed : public MultiSlotInMemoryDataFeed {
+ public:
+  MultiSlotBinaryInMemoryDataFeed() {}
+  virtual ~MultiSlotBinaryInMemoryDataFeed() {}
+  virtual void LoadIntoMemory();
+
+ protected:
+  virtual bool ParseOneInstanceFromPipe(Record* instance);
+
+  MultiSlotBinaryReader reader_;
 };
 
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
@@ -64,6 +64,9 @@ std::shared_ptr<DataFeed> DataFeedFactory::CreateDataFeed(
 
 REGISTER_DATAFEED_CLASS(MultiSlotDataFeed);
 REGISTER_DATAFEED_CLASS(MultiSlotInMemoryDataFeed);
+REGISTER_DATAFEED_CLASS(MultiSlotCompactInMemoryDataFeed);
+REGISTER_DATAFEED_CLASS(MultiSlotBinaryDataFeed);
+REGISTER_DATAFEED_CLASS(MultiSlotBinaryInMemoryDataFeed);
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
 REGISTER_DATAFEED_CLASS(MultiSlotFileInstantDataFeed);
 #endif
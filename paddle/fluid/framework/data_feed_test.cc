@@ -328,3 +328,62 @@ TEST(DataFeed, MultiSlotUnitTest) {
   // GetElemSetFromFile(&file_elem_set, data_feed_desc, filelist);
   // CheckIsUnorderedSame(reader_elem_set, file_elem_set);
 }
+
+TEST(DataFeed, MultiSlotBinaryUnitTest) {
+  const char* text_file = "TestMultiSlotBinary.txt";
+  const char* binary_file = "TestMultiSlotBinary.bin";
+  std::ofstream w_datafile(text_file);
+  for (int i = 0; i < 100; ++i) {
+    w_datafile << i % 3 + 1;
+    for (int j = 0; j <= i % 3; ++j) {
+      w_datafile << " " << i * 10 + j;
+    }
+    w_datafile << " 2 " << i << ".5 " << -i << "\n";
+  }
+  w_datafile.close();
+
+  std::vector<std::string> slot_types = {"uint64", "float"};
+  paddle::framework::ConvertMultiSlotTextToBinary(text_file, binary_file,
+                                                  slot_types, 8);
+  EXPECT_EQ(paddle::framework::ReadMultiSlotBinaryIndex(binary_file).size(),
+            13UL);
+  const std::vector<std::string> parts =
+      paddle::framework::SplitMultiSlotBinaryFiles({binary_file}, 5);
+  EXPECT_EQ(parts.size(), 3UL);
+
+  // read the parts with and without pipe
+  for (const std::string pipe_command : {"cat", "cat | cat"}) {
+    int i = 0;
+    for (const auto& part : parts) {
+      paddle::framework::MultiSlotBinaryReader reader;
+      reader.Open(part, pipe_command, slot_types);
+      while (reader.NextInstance()) {
+        ASSERT_EQ(reader.FeasignNum(0), static_cast<size_t>(i % 3 + 1));
+        for (int j = 0; j <= i % 3; ++j) {
+          EXPECT_EQ(reader.Feasigns<uint64_t>(0)[j],
+                    static_cast<uint64_t>(i * 10 + j));
+        }
+        ASSERT_EQ(reader.FeasignNum(1), 2UL);
+        EXPECT_EQ(reader.Feasigns<float>(1)[0], i + 0.5f);
+        EXPECT_EQ(reader.Feasigns<float>(1)[1], static_cast<float>(-i));
+        ++i;
+      }
+      reader.Close();
+    }
+    EXPECT_EQ(i, 100);
+  }
+
+  // the payload size of the first block is not padded to 8 bytes, which is
+  // after the 16 bytes file header and the magic and ins_num of the block
+  std::fstream f_datafile(binary_file,
+                          std::ios::in | std::ios::out | std::ios::binary);
+  uint64_t payload_size = 12;
+  f_datafile.seekp(24);
+  f_datafile.write(reinterpret_cast<const char*>(&payload_size),
+                   sizeof(payload_size));
+  f_datafile.close();
+  paddle::framework::MultiSlotBinaryReader reader;
+  reader.Open(binary_file, "cat", slot_types);
+  EXPECT_ANY_THROW(reader.NextInstance());
+  reader.Close();
+}
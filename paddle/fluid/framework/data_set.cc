@@ -14,8 +14,12 @@
 
 #include "paddle/fluid/framework/data_set.h"
 #include <algorithm>
+#include <atomic>
+#include <deque>
+#include <future>  // NOLINT
 #include <random>
 #include <unordered_map>
+#include "gflags/gflags.h"
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/message.h"
 #include "google/protobuf/text_format.h"
@@ -30,9 +34,23 @@
 #define _LINUX
 #endif
 
+DEFINE_int32(dataset_global_shuffle_inflight_mb, 256,
+             "The max size of the data a trainer has sent in GlobalShuffle "
+             "but the other trainers have not received yet.");
+
 namespace paddle {
 namespace framework {
 
+// the hash of ins id decides the trainer a record is sent to in GlobalShuffle
+static uint64_t InsIdHash(const Record& r) {
+  return XXH64(r.ins_id_.data(), r.ins_id_.length(), 0);
+}
+
+static uint64_t InsIdHash(const PackedRecord& r) {
+  std::string ins_id = r.InsId();
+  return XXH64(ins_id.data(), ins_id.length(), 0);
+}
+
 // constructor
 template <typename T>
 DatasetImpl<T>::DatasetImpl() {
@@ -302,76 +320,92 @@ void DatasetImpl<T>::GlobalShuffle(int thread_num) {
     VLOG(3) << "DatasetImpl<T>::GlobalShuffle() end, no data to shuffle";
     return;
   }
+  if (fleet_send_sleep_seconds_ != 0) {
+    LOG(WARNING) << "fleet_send_sleep_seconds is ignored, the data in flight "
+                 << "is bounded by FLAGS_dataset_global_shuffle_inflight_mb";
+  }
 
-  // local shuffle
+  // local shuffle, the blocks to send are then taken from the shuffled data
+  // directly instead of writing it back to input_channel_
   input_channel_->Close();
   std::vector<T> data;
   input_channel_->ReadAll(data);
   std::shuffle(data.begin(), data.end(), fleet_ptr->LocalRandomEngine());
-  input_channel_->Open();
-  input_channel_->Write(std::move(data));
-  data.clear();
-  data.shrink_to_fit();
-
-  input_channel_->Close();
-  input_channel_->SetBlockSize(fleet_send_batch_size_);
-  VLOG(3) << "DatasetImpl<T>::GlobalShuffle() input_channel_ size "
-          << input_channel_->Size();
+  VLOG(3) << "DatasetImpl<T>::GlobalShuffle() data size " << data.size();
 
   auto get_client_id = [this, fleet_ptr](const T& data) -> size_t {
     if (!this->merge_by_insid_) {
       return fleet_ptr->LocalRandomEngine()() % this->trainer_num_;
     } else {
-      return XXH64(data.ins_id_.data(), data.ins_id_.length(), 0) %
-             this->trainer_num_;
+      return InsIdHash(data) % this->trainer_num_;
     }
   };
 
-  auto global_shuffle_func = [this, get_client_id]() {
+  if (thread_num == -1) {
+    thread_num = thread_num_;
+  }
+  thread_num = std::max(thread_num, 1);
+  const size_t block_size =
+      static_cast<size_t>(std::max<int64_t>(fleet_send_batch_size_, 1));
+  const size_t block_num = (data.size() + block_size - 1) / block_size;
+  std::atomic<size_t> next_block(0);
+  const int64_t max_inflight_bytes = std::max<int64_t>(
+      (static_cast<int64_t>(FLAGS_dataset_global_shuffle_inflight_mb) << 20) /
+          thread_num,
+      1);
+
+  // Each thread serializes a block while the messages of its previous blocks
+  // are still being sent and received. It waits for the oldest message only
+  // when the bytes it has in flight would exceed max_inflight_bytes.
+  auto global_shuffle_func = [&]() {
     auto fleet_ptr = FleetWrapper::GetInstance();
-    std::vector<T> data;
-    while (this->input_channel_->Read(data)) {
+    std::deque<std::pair<std::future<int32_t>, int64_t>> inflight;
+    int64_t inflight_bytes = 0;
+    auto wait_oldest = [&inflight, &inflight_bytes]() {
+      inflight.front().first.wait();
+      inflight_bytes -= inflight.front().second;
+      inflight.pop_front();
+    };
+
+    std::vector<int> send_index(this->trainer_num_);
+    for (int i = 0; i < this->trainer_num_; ++i) {
+      send_index[i] = i;
+    }
+    for (size_t block = next_block++; block < block_num;
+         block = next_block++) {
+      size_t begin = block * block_size;
+      size_t end = std::min(begin + block_size, data.size());
       std::vector<paddle::framework::BinaryArchive> ars(this->trainer_num_);
-      for (auto& t : data) {
-        auto client_id = get_client_id(t);
-        ars[client_id] << t;
-      }
-      std::vector<std::future<int32_t>> total_status;
-      std::vector<int> send_index(this->trainer_num_);
-      for (int i = 0; i < this->trainer_num_; ++i) {
-        send_index[i] = i;
+      for (size_t i = begin; i < end; ++i) {
+        ars[get_client_id(data[i])] << data[i];
+        // release the record once it is serialized
+        data[i] = T();
       }
       std::shuffle(send_index.begin(), send_index.end(),
                    fleet_ptr->LocalRandomEngine());
       for (auto index = 0u; index < this->trainer_num_; ++index) {
         int i = send_index[index];
-        if (ars[i].Length() == 0) {
+        int64_t bytes = ars[i].Length();
+        if (bytes == 0) {
           continue;
         }
+        while (!inflight.empty() &&
+               inflight_bytes + bytes > max_inflight_bytes) {
+          wait_oldest();
+        }
         std::string msg(ars[i].Buffer(), ars[i].Length());
-        auto ret = fleet_ptr->SendClientToClientMsg(0, i, msg);
-        total_status.push_back(std::move(ret));
-      }
-      for (auto& t : total_status) {
-        t.wait();
-      }
-      ars.clear();
-      ars.shrink_to_fit();
-      data.clear();
-      data.shrink_to_fit();
-      // currently we find bottleneck is server not able to handle large data
-      // in time, so we can remove this sleep and set fleet_send_batch_size to
-      // 1024, and set server thread to 24.
-      if (fleet_send_sleep_seconds_ != 0) {
-        sleep(this->fleet_send_sleep_seconds_);
+        ars[i].Reset();
+        inflight.emplace_back(fleet_ptr->SendClientToClientMsg(0, i, msg),
+                              bytes);
+        inflight_bytes += bytes;
       }
     }
+    while (!inflight.empty()) {
+      wait_oldest();
+    }
   };
 
   std::vector<std::thread> global_shuffle_threads;
-  if (thread_num == -1) {
-    thread_num = thread_num_;
-  }
   VLOG(3) << "start global shuffle threads, num = " << thread_num;
   for (int i = 0; i < thread_num; ++i) {
     global_shuffle_threads.push_back(std::thread(global_shuffle_func));
@@ -606,17 +640,32 @@ int DatasetImpl<T>::ReceiveFromClient(int msg_type, int client_id,
   if (ar.Cursor() == ar.Finish()) {
     return 0;
   }
+  // not use random because it doesn't perform well here.
+  // to make sure each channel get data equally, we just put data to
+  // channel one by one.
+  // The records are written to the output channels block by block while the
+  // rest of the message is deserialized, so a large message is never held
+  // twice in memory.
+  const size_t block_size =
+      static_cast<size_t>(std::max<int64_t>(fleet_send_batch_size_, 1));
   std::vector<T> data;
+  data.reserve(block_size);
   while (ar.Cursor() < ar.Finish()) {
     data.push_back(ar.Get<T>());
+    if (data.size() >= block_size) {
+      WriteToOutputChannel(&data);
+    }
   }
   CHECK(ar.Cursor() == ar.Finish());
+  if (!data.empty()) {
+    WriteToOutputChannel(&data);
+  }
+#endif
+  return 0;
+}
 
-  auto fleet_ptr = FleetWrapper::GetInstance();
-  // not use random because it doesn't perform well here.
-  // to make sure each channel get data equally, we just put data to
-  // channel one by one.
-  // int64_t index = fleet_ptr->LocalRandomEngine()() % channel_num_;
+template <typename T>
+void DatasetImpl<T>::WriteToOutputChannel(std::vector<T>* data) {
   int64_t index = 0;
   {
     std::unique_lock<std::mutex> lk(global_index_mutex_);
@@ -624,16 +673,22 @@ int DatasetImpl<T>::ReceiveFromClient(int msg_type, int client_id,
   }
   index = index % channel_num_;
   VLOG(3) << "ramdom index=" << index;
-  multi_output_channel_[index]->Write(std::move(data));
+  multi_output_channel_[index]->Write(std::move(*data));
+  data->clear();
+}
 
-  data.clear();
-  data.shrink_to_fit();
-#endif
+// The packed records can only be received into the arena of
+// MultiSlotCompactDataset, see MultiSlotCompactDataset::ReceiveFromClient.
+template <>
+int DatasetImpl<PackedRecord>::ReceiveFromClient(int msg_type, int client_id,
+                                                 const std::string& msg) {
+  PADDLE_THROW("PackedRecord is received by MultiSlotCompactDataset only.");
   return 0;
 }
 
 // explicit instantiation
 template class DatasetImpl<Record>;
+template class DatasetImpl<PackedRecord>;
 
 void MultiSlotDataset::MergeByInsId() {
   VLOG(3) << "MultiSlotDataset::MergeByInsId begin";
@@ -996,5 +1051,100 @@ void MultiSlotDataset::SlotsShuffle(
           << ", cost time=" << timeline.ElapsedSec() << " seconds";
 }
 
+MultiSlotCompactDataset::MultiSlotCompactDataset()
+    : arena_(new RecordArena()),
+      recv_arena_(new RecordArena()),
+      received_num_(0) {}
+
+void MultiSlotCompactDataset::LoadIntoMemory() {
+  DatasetImpl<PackedRecord>::LoadIntoMemory();
+  VLOG(3) << "MultiSlotCompactDataset::LoadIntoMemory() end, memory data bytes="
+          << GetMemoryDataBytes();
+}
+
+void MultiSlotCompactDataset::ReleaseMemory() {
+  DatasetImpl<PackedRecord>::ReleaseMemory();
+  arena_->Clear();
+  recv_arena_->Clear();
+  received_num_ = 0;
+}
+
+void MultiSlotCompactDataset::GlobalShuffle(int thread_num) {
+  // If the loaded records are all in input_channel_, i.e. the output
+  // channels hold only the received ones, all of them are serialized and sent
+  // and the blocks of them can be released after the shuffle.
+  int64_t received_num = received_num_;
+  bool release_arena = GetShuffleDataSize() == received_num;
+  DatasetImpl<PackedRecord>::GlobalShuffle(thread_num);
+  if (release_arena) {
+    arena_->Clear();
+  }
+}
+
+void MultiSlotCompactDataset::CreateReaders() {
+  DatasetImpl<PackedRecord>::CreateReaders();
+  for (auto& reader : readers_) {
+    reader->SetRecordArena(arena_.get());
+  }
+}
+
+void MultiSlotCompactDataset::CreatePreLoadReaders() {
+  DatasetImpl<PackedRecord>::CreatePreLoadReaders();
+  for (auto& reader : preload_readers_) {
+    reader->SetRecordArena(arena_.get());
+  }
+}
+
+void MultiSlotCompactDataset::MergeByInsId() {
+  PADDLE_ENFORCE(!merge_by_insid_,
+                 "MultiSlotCompactDataset does not support MergeByInsId.");
+}
+
+void MultiSlotCompactDataset::SlotsShuffle(
+    const std::set<std::string>& slots_to_replace) {
+  PADDLE_THROW("MultiSlotCompactDataset does not support SlotsShuffle.");
+}
+
+int64_t MultiSlotCompactDataset::GetMemoryDataBytes() {
+  return arena_->MemorySize() + recv_arena_->MemorySize();
+}
+
+int MultiSlotCompactDataset::ReceiveFromClient(int msg_type, int client_id,
+                                               const std::string& msg) {
+#ifdef _LINUX
+  VLOG(3) << "ReceiveFromClient msg_type=" << msg_type
+          << ", client_id=" << client_id << ", msg length=" << msg.length();
+  if (msg.length() == 0) {
+    return 0;
+  }
+  paddle::framework::BinaryArchive ar;
+  ar.SetReadBuffer(const_cast<char*>(msg.c_str()), msg.length(), nullptr);
+  // The records of a message are packed into blocks of their own, which are
+  // released with the other received records in ReleaseMemory.
+  RecordArenaWriter writer(recv_arena_.get());
+  const size_t block_size =
+      static_cast<size_t>(std::max<int64_t>(fleet_send_batch_size_, 1));
+  std::vector<PackedRecord> data;
+  data.reserve(block_size);
+  Record record;
+  int64_t received_num = 0;
+  while (ar.Cursor() < ar.Finish()) {
+    ar >> record;
+    data.push_back(writer.Append(record));
+    ++received_num;
+    if (data.size() >= block_size) {
+      WriteToOutputChannel(&data);
+    }
+  }
+  CHECK(ar.Cursor() == ar.Finish());
+  if (!data.empty()) {
+    WriteToOutputChannel(&data);
+  }
+  // counted after they are written, see GlobalShuffle
+  received_num_ += received_num;
+#endif
+  return 0;
+}
+
 }  // end namespace framework
 }  // end namespace paddle
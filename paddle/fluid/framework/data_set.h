@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <fstream>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -193,6 +194,8 @@ class DatasetImpl : public Dataset {
  protected:
   virtual int ReceiveFromClient(int msg_type, int client_id,
                                 const std::string& msg);
+  // write the received records to one of the output channels
+  void WriteToOutputChannel(std::vector<T>* data);
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> readers_;
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> preload_readers_;
   paddle::framework::Channel<T> input_channel_;
@@ -240,5 +243,33 @@ class MultiSlotDataset : public DatasetImpl<Record> {
   virtual ~MultiSlotDataset() {}
 };
 
+// MultiSlotCompactDataset is the same as MultiSlotDataset except that the
+// records are packed into the blocks of a RecordArena by
+// MultiSlotCompactInMemoryDataFeed, and the channels only hold the handles
+// of them. MergeByInsId and SlotsShuffle are not supported.
+class MultiSlotCompactDataset : public DatasetImpl<PackedRecord> {
+ public:
+  MultiSlotCompactDataset();
+  virtual ~MultiSlotCompactDataset() {}
+  virtual void LoadIntoMemory();
+  virtual void ReleaseMemory();
+  virtual void GlobalShuffle(int thread_num = -1);
+  virtual void CreateReaders();
+  virtual void CreatePreLoadReaders();
+  virtual void MergeByInsId();
+  virtual void SlotsShuffle(const std::set<std::string>& slots_to_replace);
+  // get the bytes of the blocks of all records
+  int64_t GetMemoryDataBytes();
+
+ protected:
+  virtual int ReceiveFromClient(int msg_type, int client_id,
+                                const std::string& msg);
+  // the records loaded by the readers
+  std::unique_ptr<RecordArena> arena_;
+  // the records received from the other trainers in GlobalShuffle
+  std::unique_ptr<RecordArena> recv_arena_;
+  std::atomic<int64_t> received_num_;
+};
+
 }  // end namespace framework
 }  // end namespace paddle
@@ -0,0 +1,186 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/data_set.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
+
+DECLARE_int32(dataset_global_shuffle_inflight_mb);
+
+namespace paddle {
+namespace framework {
+
+// Reads back what GlobalShuffle wrote to the output channels.
+template <typename DatasetT, typename T>
+class TestDataset : public DatasetT {
+ public:
+  std::vector<Record> ReadOutput() {
+    std::vector<Record> result;
+    for (auto& channel : this->multi_output_channel_) {
+      channel->Close();
+      std::vector<T> data;
+      channel->ReadAll(data);
+      for (auto& record : data) {
+        result.push_back(ToRecord(record));
+      }
+    }
+    return result;
+  }
+
+  // Packs the records into the arena of MultiSlotCompactDataset as the
+  // readers do.
+  std::vector<T> Pack(const std::vector<Record>& records);
+
+ private:
+  static Record ToRecord(const Record& record) { return record; }
+  static Record ToRecord(const PackedRecord& record) {
+    return record.ToRecord();
+  }
+};
+
+template <>
+std::vector<Record> TestDataset<MultiSlotDataset, Record>::Pack(
+    const std::vector<Record>& records) {
+  return records;
+}
+
+template <>
+std::vector<PackedRecord>
+TestDataset<MultiSlotCompactDataset, PackedRecord>::Pack(
+    const std::vector<Record>& records) {
+  std::vector<PackedRecord> packed;
+  RecordArenaWriter writer(arena_.get());
+  for (auto& record : records) {
+    packed.push_back(writer.Append(record));
+  }
+  return packed;
+}
+
+template <typename DatasetT, typename T>
+static void RunGlobalShuffle(int trainer_num, int thread_num,
+                             int64_t send_batch_size, int record_num) {
+  // Without pslib every message is received by this process, the stand-in
+  // of the other trainers.
+  TestDataset<DatasetT, T> dataset;
+  dataset.SetTrainerNum(trainer_num);
+  dataset.SetChannelNum(3);
+  dataset.SetFleetSendBatchSize(send_batch_size);
+  dataset.CreateChannel();
+  dataset.RegisterClientToClientMsgHandler();
+
+  auto input = dataset.GetInputChannel();
+  std::vector<Record> records(record_num);
+  for (int i = 0; i < record_num; ++i) {
+    records[i].ins_id_ = "ins_" + std::to_string(i);
+    FeatureKey key;
+    key.uint64_feasign_ = i * 10;
+    records[i].uint64_feasigns_.emplace_back(key, i % 7);
+  }
+  input->Write(dataset.Pack(records));
+  input->Close();
+
+  dataset.GlobalShuffle(thread_num);
+  EXPECT_EQ(dataset.GetShuffleDataSize(), record_num);
+
+  std::set<std::string> ins_ids;
+  for (auto& record : dataset.ReadOutput()) {
+    ASSERT_EQ(record.uint64_feasigns_.size(), 1UL);
+    int i = std::stoi(record.ins_id_.substr(4));
+    EXPECT_EQ(record.uint64_feasigns_[0].sign().uint64_feasign_,
+              static_cast<uint64_t>(i * 10));
+    EXPECT_EQ(record.uint64_feasigns_[0].slot(), i % 7);
+    ins_ids.insert(record.ins_id_);
+  }
+  EXPECT_EQ(ins_ids.size(), static_cast<size_t>(record_num));
+}
+
+static void RunGlobalShuffle(int trainer_num, int thread_num,
+                             int64_t send_batch_size, int record_num) {
+  RunGlobalShuffle<MultiSlotDataset, Record>(trainer_num, thread_num,
+                                             send_batch_size, record_num);
+}
+
+TEST(Dataset, RecordBlock) {
+  RecordArena arena;
+  std::vector<PackedRecord> packed;
+  {
+    RecordArenaWriter writer(&arena);
+    for (int i = 0; i < 100; ++i) {
+      Record record;
+      record.ins_id_ = "ins_" + std::to_string(i);
+      record.content_ = std::string(i % 3, 'c');
+      for (int j = 0; j < i % 5; ++j) {
+        FeatureKey key;
+        key.uint64_feasign_ = i * 100 + j;
+        record.uint64_feasigns_.emplace_back(key, j);
+      }
+      FeatureKey key;
+      key.float_feasign_ = i * 0.5f;
+      record.float_feasigns_.emplace_back(key, 5);
+      packed.push_back(writer.Append(record));
+    }
+  }
+  EXPECT_GT(arena.MemorySize(), 0UL);
+  for (int i = 0; i < 100; ++i) {
+    const PackedRecord& r = packed[i];
+    EXPECT_EQ(r.InsId(), "ins_" + std::to_string(i));
+    EXPECT_EQ(r.Content(), std::string(i % 3, 'c'));
+    ASSERT_EQ(r.Uint64Feasigns().size(), static_cast<size_t>(i % 5));
+    int j = 0;
+    for (auto& item : r.Uint64Feasigns()) {
+      EXPECT_EQ(item.sign().uint64_feasign_,
+                static_cast<uint64_t>(i * 100 + j));
+      EXPECT_EQ(item.slot(), j);
+      ++j;
+    }
+    ASSERT_EQ(r.FloatFeasigns().size(), 1UL);
+    EXPECT_EQ(r.FloatFeasigns().begin()->sign().float_feasign_, i * 0.5f);
+
+    // a packed record is serialized in the same format as a Record
+    BinaryArchive ar;
+    ar << r;
+    Record record = ar.Get<Record>();
+    EXPECT_EQ(record.ins_id_, r.InsId());
+    EXPECT_EQ(record.uint64_feasigns_.size(), r.Uint64Feasigns().size());
+    EXPECT_EQ(record.float_feasigns_.size(), 1UL);
+  }
+  arena.Clear();
+  EXPECT_EQ(arena.MemorySize(), 0UL);
+}
+
+#ifndef PADDLE_WITH_PSLIB
+TEST(Dataset, GlobalShuffle) {
+  RunGlobalShuffle(1, 1, 1024, 100);
+  RunGlobalShuffle(3, 4, 16, 1000);
+}
+
+TEST(Dataset, GlobalShuffleBoundedInflight) {
+  // Every thread waits for each message before sending the next one.
+  int inflight_mb = FLAGS_dataset_global_shuffle_inflight_mb;
+  FLAGS_dataset_global_shuffle_inflight_mb = 0;
+  RunGlobalShuffle(4, 2, 7, 500);
+  FLAGS_dataset_global_shuffle_inflight_mb = inflight_mb;
+}
+
+TEST(Dataset, CompactGlobalShuffle) {
+  RunGlobalShuffle<MultiSlotCompactDataset, PackedRecord>(1, 1, 1024, 100);
+  RunGlobalShuffle<MultiSlotCompactDataset, PackedRecord>(3, 4, 16, 1000);
+}
+#endif
+
+}  // namespace framework
+}  // namespace paddle
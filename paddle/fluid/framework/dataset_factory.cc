@@ -62,5 +62,6 @@ std::unique_ptr<Dataset> DatasetFactory::CreateDataset(
 }
 
 REGISTER_DATASET_CLASS(MultiSlotDataset);
+REGISTER_DATASET_CLASS(MultiSlotCompactDataset);
 }  // namespace framework
 }  // namespace paddle
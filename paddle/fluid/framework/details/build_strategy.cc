@@ -69,11 +69,12 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
     AppendMultiGraphOptPasses();
 
     AppendPassToSetMkldnnAttr("mkldnn_placement_pass");
-    // runtime_context_cache pass should be the last pass to enable the attr of
-    // all original and fused operators. But no operators can be enabled this
-    // attr if putting it after MultiDevPass.
+    // runtime_context_cache and infer_shape_cache pass should be the last
+    // passes to enable the attr of all original and fused operators. But no
+    // operators can be enabled this attr if putting it after MultiDevPass.
     AppendPassWithCheck(strategy_.cache_runtime_context_,
                         "runtime_context_cache_pass");
+    AppendPassWithCheck(strategy_.cache_infer_shape_, "infer_shape_cache_pass");
     AppendPassWithCheck(strategy_.remove_unnecessary_lock_,
                         "modify_op_lock_and_record_event_pass");
     // Note: This pass is used to check whether the multi_device_graph is right.
@@ -174,11 +175,16 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
     // Fuse all the optimization operators.
     // NOTE: fuse_all_xx_ops will count the number of xx operator first,
     // if the number is zero, fuse_all_reduce_ops will do nothing.
-    // Currently, only one type of optimization algorithm can be fused.
+    // Currently, only one type of optimization algorithm can be fused for
+    // dense gradients, the adam, sgd and momentum ops of sparse gradients
+    // are fused by fuse_sparse_xx_op_pass on CPU.
     if (strategy_.fuse_all_optimizer_ops_ == true) {
       AppendPass("fuse_adam_op_pass");
       AppendPass("fuse_sgd_op_pass");
       AppendPass("fuse_momentum_op_pass");
+      AppendPass("fuse_sparse_adam_op_pass");
+      AppendPass("fuse_sparse_sgd_op_pass");
+      AppendPass("fuse_sparse_momentum_op_pass");
     }
   }
 
@@ -368,6 +374,13 @@ ir::Graph *BuildStrategy::Apply(ir::Graph *graph,
                         "GPU, skipped.";
         continue;
       }
+    } else if (pass->Type() == "fuse_sparse_adam_op_pass" ||
+               pass->Type() == "fuse_sparse_sgd_op_pass" ||
+               pass->Type() == "fuse_sparse_momentum_op_pass") {
+      if (use_cuda) {
+        VLOG(1) << pass->Type() << " is only supported on CPU, skipped.";
+        continue;
+      }
     } else if (pass->Type() == "mkldnn_placement_pass") {
       pass->Set("mkldnn_enabled_op_types",
                 new std::unordered_set<std::string>(mkldnn_enabled_op_types_));
@@ -410,8 +423,12 @@ USE_PASS(graph_to_program_pass);
 USE_PASS(fuse_adam_op_pass);
 USE_PASS(fuse_sgd_op_pass);
 USE_PASS(fuse_momentum_op_pass);
+USE_PASS(fuse_sparse_adam_op_pass);
+USE_PASS(fuse_sparse_sgd_op_pass);
+USE_PASS(fuse_sparse_momentum_op_pass);
 USE_PASS(fuse_all_reduce_op_pass);
 USE_PASS(runtime_context_cache_pass);
+USE_PASS(infer_shape_cache_pass);
 #ifdef PADDLE_WITH_MKLDNN
 USE_PASS(mkldnn_placement_pass);
 #endif
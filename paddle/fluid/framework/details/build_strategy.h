@@ -82,13 +82,17 @@ struct BuildStrategy {
   // TODO(dev-paddle): cache_runtime_context may cause some models to hang up
   // while running.
   bool cache_runtime_context_{false};
+  // Skip the runtime InferShape of the operators whose inputs have the same
+  // dims and LoD as the last run.
+  bool cache_infer_shape_{false};
 
   // Operator fusion
   // TODO(dev-paddle): fuse_elewise_add_act_ops may cause some models have
   // cycle.
   bool fuse_elewise_add_act_ops_{false};
   // Fuse_all_optimizer_ops and fuse_all_reduce_ops require that gradients
-  // should not be sparse types
+  // should not be sparse types, except that the adam, sgd and momentum ops
+  // of sparse gradients are fused into fused_sparse_xx ops on CPU.
   boost::optional<bool> fuse_all_optimizer_ops_{boost::none};
   boost::optional<bool> fuse_all_reduce_ops_{boost::none};
   // fuse_relu_depthwise_conv can fuse the `relu ->
@@ -37,6 +37,11 @@ struct ExecutionStrategy {
   // This debug option.
   bool dry_run_{false};
 
+  // Run the operators with a WorkStealingThreadPool instead of the default
+  // thread pool, which has lower scheduling overhead for small operators.
+  // Only works with the kExperimental executor.
+  bool use_work_stealing_thread_pool_{false};
+
   // only use with async_ssa_graph_executor
   // and pyreader with data queue
   size_t num_iteration_per_run_{1};
@@ -30,16 +30,23 @@ namespace details {
 FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
     const ExecutionStrategy &strategy, const std::vector<Scope *> &local_scopes,
     const std::vector<Scope *> &local_exec_scopes,
-    const std::vector<platform::Place> &places, ir::Graph *graph)
+    const std::vector<platform::Place> &places, ir::Graph *graph,
+    std::shared_ptr<WorkStealingThreadPool> work_stealing_pool)
     : strategy_(strategy),
       local_scopes_(local_scopes),
       local_exec_scopes_(local_exec_scopes),
       places_(places),
       graph_(graph),
       fetch_ctxs_(places),
-      pool_(strategy.num_threads_),
+      work_stealing_pool_(std::move(work_stealing_pool)),
       // add one more thread for generate op_deps
       prepare_pool_(1) {
+  if (!strategy_.use_work_stealing_thread_pool_) {
+    pool_.reset(new ::ThreadPool(strategy_.num_threads_));
+  } else if (work_stealing_pool_ == nullptr) {
+    work_stealing_pool_ = std::make_shared<WorkStealingThreadPool>(
+        static_cast<int>(strategy_.num_threads_));
+  }
   for (auto &op : ir::FilterByNodeWrapper<OpHandleBase>(*graph_)) {
     int dep = static_cast<int>(op->NotReadyInputSize());
     op_deps_.emplace(op, dep);
@@ -190,7 +197,7 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
     OpHandleBase *op,
     const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
   ++remaining_;
-  this->pool_.enqueue([=] {
+  auto task = [=] {
     std::deque<OpHandleBase *> op_queue;
     op_queue.push_front(op);
 
@@ -230,7 +237,12 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
     }
     --remaining_;
     complete_q->Push(complete);
-  });
+  };
+  if (work_stealing_pool_) {
+    work_stealing_pool_->Run(std::move(task));
+  } else {
+    pool_->enqueue(std::move(task));
+  }
 }
 
 void FastThreadedSSAGraphExecutor::PrepareAtomicOpDeps() {
@@ -22,6 +22,7 @@
 #include "paddle/fluid/framework/details/exception_holder.h"
 #include "paddle/fluid/framework/details/execution_strategy.h"
 #include "paddle/fluid/framework/details/ssa_graph_executor.h"
+#include "paddle/fluid/framework/threadpool.h"
 
 namespace paddle {
 namespace framework {
@@ -35,7 +36,9 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
                                const std::vector<Scope *> &local_scopes,
                                const std::vector<Scope *> &local_exec_scopes,
                                const std::vector<platform::Place> &places,
-                               ir::Graph *graph);
+                               ir::Graph *graph,
+                               std::shared_ptr<WorkStealingThreadPool>
+                                   work_stealing_pool = nullptr);
   FeedFetchList Run(const std::vector<std::string> &fetch_tensors) override;
   const ir::Graph &Graph() const override;
 
@@ -59,7 +62,11 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
       atomic_op_deps_;
   ExceptionHolder exception_;
 
-  ::ThreadPool pool_;
+  // If strategy_.use_work_stealing_thread_pool_ is set, the ops run in the
+  // work_stealing_pool_, which may be shared with other executors, otherwise
+  // they run in the pool_.
+  std::unique_ptr<::ThreadPool> pool_;
+  std::shared_ptr<WorkStealingThreadPool> work_stealing_pool_;
   ::ThreadPool prepare_pool_;
 
   std::vector<OpHandleBase *> traced_ops_;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/details/parallel_ssa_graph_executor.h"
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include "paddle/fluid/framework/ir/graph_helper.h"
@@ -101,6 +102,11 @@ ParallelSSAGraphExecutor::ParallelSSAGraphExecutor(
     graphs_[i].reset(seq_allreduce_pass->Apply(graphs_[i].release()));
   }
 
+  if (strategy_.use_work_stealing_thread_pool_) {
+    work_stealing_pool_ = std::make_shared<WorkStealingThreadPool>(
+        static_cast<int>(std::max(strategy_.num_threads_, places_.size())));
+  }
+
   // set the correct size of thread pool to each device.
   strategy_.num_threads_ = strategy_.num_threads_ < places_.size()
                                ? 1UL
@@ -110,7 +116,7 @@ ParallelSSAGraphExecutor::ParallelSSAGraphExecutor(
   for (size_t i = 0; i < places.size(); ++i) {
     executors_.emplace_back(new details::FastThreadedSSAGraphExecutor(
         strategy_, local_scopes_, local_exec_scopes, {places_[i]},
-        graphs_.at(i).get()));
+        graphs_.at(i).get(), work_stealing_pool_));
   }
 }
 
@@ -48,6 +48,9 @@ class ParallelSSAGraphExecutor : public SSAGraphExecutor {
   ExecutionStrategy strategy_;
   std::vector<Scope *> local_scopes_;
   std::unique_ptr<::ThreadPool> pool_{nullptr};
+  // Shared by the executors of all devices if
+  // strategy_.use_work_stealing_thread_pool_ is set.
+  std::shared_ptr<WorkStealingThreadPool> work_stealing_pool_;
   std::vector<platform::Place> places_;
   std::vector<std::unique_ptr<ir::Graph>> graphs_;
 
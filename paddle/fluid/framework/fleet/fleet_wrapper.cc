@@ -670,8 +670,10 @@ int FleetWrapper::RegisterClientToClientMsgHandler(int msg_type,
   return pslib_ptr_->_worker_ptr->registe_client2client_msg_handler(msg_type,
                                                                     handler);
 #else
-  VLOG(0) << "FleetWrapper::RegisterClientToClientMsgHandler"
-          << " does nothing when no pslib";
+  VLOG(3) << "FleetWrapper::RegisterClientToClientMsgHandler"
+          << " registers a local handler when no pslib";
+  std::lock_guard<std::mutex> lock(local_msg_handler_mutex_);
+  local_msg_handlers_[msg_type] = handler;
 #endif
   return 0;
 }
@@ -682,10 +684,27 @@ std::future<int32_t> FleetWrapper::SendClientToClientMsg(
   return pslib_ptr_->_worker_ptr->send_client2client_msg(msg_type, to_client_id,
                                                          msg);
 #else
-  VLOG(0) << "FleetWrapper::SendClientToClientMsg"
-          << " does nothing when no pslib";
+  MsgHandlerFunc handler;
+  {
+    std::lock_guard<std::mutex> lock(local_msg_handler_mutex_);
+    auto it = local_msg_handlers_.find(msg_type);
+    if (it != local_msg_handlers_.end()) {
+      handler = it->second;
+    }
+  }
+  if (!handler) {
+    VLOG(0) << "FleetWrapper::SendClientToClientMsg"
+            << " does nothing when no pslib and no local handler";
+    std::promise<int32_t> done;
+    done.set_value(0);
+    return done.get_future();
+  }
+  VLOG(3) << "FleetWrapper::SendClientToClientMsg to client " << to_client_id
+          << " is handled locally when no pslib";
+  return std::async(std::launch::async, [handler, msg_type, msg]() {
+    return handler(msg_type, 0, msg);
+  });
 #endif
-  return std::future<int32_t>();
 }
 
 template <typename T>
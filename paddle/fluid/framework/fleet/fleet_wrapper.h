@@ -21,7 +21,10 @@ limitations under the License. */
 #endif
 #include <atomic>
 #include <ctime>
+#include <functional>
+#include <future>  // NOLINT
 #include <map>
+#include <mutex>  // NOLINT
 #include <random>
 #include <string>
 #include <vector>
@@ -176,6 +179,9 @@ class FleetWrapper {
                         int emb_dim);
 
   // register client to client communication
+  // Without pslib the process is the only client: a message sent to any
+  // client is passed to the handler of the process asynchronously, so the
+  // users such as Dataset::GlobalShuffle can be run and tested locally.
   typedef std::function<int32_t(int, int, const std::string&)> MsgHandlerFunc;
   int RegisterClientToClientMsgHandler(int msg_type, MsgHandlerFunc handler);
   // send client to client message
@@ -204,6 +210,9 @@ class FleetWrapper {
   static std::shared_ptr<FleetWrapper> s_instance_;
 #ifdef PADDLE_WITH_PSLIB
   std::map<uint64_t, std::vector<paddle::ps::Region>> _regions;
+#else
+  std::mutex local_msg_handler_mutex_;
+  std::map<int, MsgHandlerFunc> local_msg_handlers_;
 #endif
 
  protected:
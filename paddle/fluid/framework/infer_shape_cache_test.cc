@@ -0,0 +1,264 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/platform/profiler.h"
+
+DEFINE_int32(infer_shape_cache_benchmark_ops, 500,
+             "The number of operators of the program in the benchmark.");
+DEFINE_int32(infer_shape_cache_benchmark_repeat, 1000,
+             "The times the benchmark runs the program.");
+
+namespace paddle {
+namespace framework {
+
+static int infer_shape_num = 0;
+
+// Out = X + Y, the InferShape checks the inputs as the elementwise ops do.
+class AddTestOp : public OperatorWithKernel {
+ public:
+  using OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(InferShapeContext* ctx) const override {
+    ++infer_shape_num;
+    PADDLE_ENFORCE(ctx->HasInput("X"), "Input(X) should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Y"), "Input(Y) should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"), "Output(Out) should not be null.");
+    auto x_dims = ctx->GetInputDim("X");
+    PADDLE_ENFORCE_EQ(x_dims, ctx->GetInputDim("Y"),
+                      "The dims of X and Y should be the same.");
+    ctx->SetOutputDim("Out", x_dims);
+    ctx->ShareLoD("X", "Out");
+  }
+
+  OpKernelType GetExpectedKernelType(
+      const ExecutionContext& ctx) const override {
+    return OpKernelType(proto::VarType::FP32, ctx.GetPlace());
+  }
+};
+
+// The same as AddTestOp, but the InferShape visits the input variables.
+class VarPtrAddTestOp : public AddTestOp {
+ public:
+  using AddTestOp::AddTestOp;
+
+ protected:
+  void InferShape(InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE_EQ(ctx->GetInputVarPtrs("X").size(), 1UL);
+    AddTestOp::InferShape(ctx);
+  }
+};
+
+class AddTestOpMaker : public OpProtoAndCheckerMaker {
+ public:
+  void Make() {
+    AddInput("X", "The first input of the test op.");
+    AddInput("Y", "The second input of the test op.");
+    AddOutput("Out", "The output of the test op.");
+    AddComment("Out = X + Y.");
+  }
+};
+
+class AddTestKernel : public OpKernel<float> {
+ public:
+  void Compute(const ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<LoDTensor>("X");
+    auto* y = ctx.Input<LoDTensor>("Y");
+    auto* out = ctx.Output<LoDTensor>("Out");
+    const float* x_data = x->data<float>();
+    const float* y_data = y->data<float>();
+    float* out_data = out->mutable_data<float>(ctx.GetPlace());
+    for (int64_t i = 0; i < out->numel(); ++i) {
+      out_data[i] = x_data[i] + y_data[i];
+    }
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(infer_shape_cache_test_add,
+                             paddle::framework::AddTestOp,
+                             paddle::framework::AddTestOpMaker);
+REGISTER_OP_CPU_KERNEL(infer_shape_cache_test_add,
+                       paddle::framework::AddTestKernel);
+REGISTER_OP_WITHOUT_GRADIENT(infer_shape_cache_test_var_ptr_add,
+                             paddle::framework::VarPtrAddTestOp,
+                             paddle::framework::AddTestOpMaker);
+REGISTER_OP_CPU_KERNEL(infer_shape_cache_test_var_ptr_add,
+                       paddle::framework::AddTestKernel);
+
+namespace paddle {
+namespace framework {
+
+// Creates a chain of op_num ops, op i computes "x_{i+1}" = "x_i" + "y".
+static std::vector<std::unique_ptr<OperatorBase>> CreateProgram(
+    const std::string& op_type, int op_num, bool cache_infer_shape,
+    Scope* scope) {
+  std::vector<std::unique_ptr<OperatorBase>> ops;
+  AttributeMap attrs;
+  if (cache_infer_shape) {
+    attrs[kEnableCacheInferShape] = true;
+  }
+  scope->Var("y")->GetMutable<LoDTensor>();
+  scope->Var("x_0")->GetMutable<LoDTensor>();
+  for (int i = 0; i < op_num; ++i) {
+    auto out = "x_" + std::to_string(i + 1);
+    scope->Var(out)->GetMutable<LoDTensor>();
+    ops.emplace_back(OpRegistry::CreateOp(
+        op_type, {{"X", {"x_" + std::to_string(i)}}, {"Y", {"y"}}},
+        {{"Out", {out}}}, attrs));
+  }
+  return ops;
+}
+
+static void FeedInputs(Scope* scope, const DDim& dims, const LoD& lod) {
+  platform::CPUPlace place;
+  for (auto name : {"x_0", "y"}) {
+    auto* tensor = scope->FindVar(name)->GetMutable<LoDTensor>();
+    tensor->Resize(dims);
+    float* data = tensor->mutable_data<float>(place);
+    for (int64_t i = 0; i < tensor->numel(); ++i) {
+      data[i] = 1.0f;
+    }
+  }
+  scope->FindVar("x_0")->GetMutable<LoDTensor>()->set_lod(lod);
+}
+
+static void RunProgram(const std::vector<std::unique_ptr<OperatorBase>>& ops,
+                       const Scope& scope) {
+  platform::CPUPlace place;
+  for (auto& op : ops) {
+    op->Run(scope, place);
+  }
+}
+
+static void ExpectOutput(const Scope& scope, int op_num, const DDim& dims,
+                         const LoD& lod) {
+  auto& out = scope.FindVar("x_" + std::to_string(op_num))->Get<LoDTensor>();
+  ASSERT_EQ(out.dims(), dims);
+  ASSERT_EQ(out.lod(), lod);
+  const float* data = out.data<float>();
+  for (int64_t i = 0; i < out.numel(); ++i) {
+    ASSERT_EQ(data[i], op_num + 1.0f);
+  }
+}
+
+TEST(InferShapeCache, SkipInferShape) {
+  InitDevices(false);
+  const int op_num = 10;
+  Scope scope;
+  auto ops =
+      CreateProgram("infer_shape_cache_test_add", op_num, true, &scope);
+  platform::EnableProfiler(platform::ProfilerState::kCPU);
+  platform::ResetProfiler();
+
+  infer_shape_num = 0;
+  LoD lod{{0, 1, 4}};
+  FeedInputs(&scope, make_ddim({4, 3}), lod);
+  RunProgram(ops, scope);
+  ExpectOutput(scope, op_num, make_ddim({4, 3}), lod);
+  RunProgram(ops, scope);
+  ExpectOutput(scope, op_num, make_ddim({4, 3}), lod);
+  EXPECT_EQ(infer_shape_num, op_num);
+
+  // The cache misses when the dims or LoD of the inputs change.
+  LoD new_lod{{0, 2, 4}};
+  FeedInputs(&scope, make_ddim({4, 3}), new_lod);
+  RunProgram(ops, scope);
+  ExpectOutput(scope, op_num, make_ddim({4, 3}), new_lod);
+  EXPECT_EQ(infer_shape_num, 2 * op_num);
+  FeedInputs(&scope, make_ddim({5, 3}), {{0, 5}});
+  RunProgram(ops, scope);
+  ExpectOutput(scope, op_num, make_ddim({5, 3}), {{0, 5}});
+  EXPECT_EQ(infer_shape_num, 3 * op_num);
+
+  // The outputs are set to the variables of a new scope.
+  Scope other_scope;
+  auto other_ops =
+      CreateProgram("infer_shape_cache_test_add", op_num, false, &other_scope);
+  FeedInputs(&other_scope, make_ddim({5, 3}), {{0, 5}});
+  RunProgram(ops, other_scope);
+  ExpectOutput(other_scope, op_num, make_ddim({5, 3}), {{0, 5}});
+  EXPECT_EQ(infer_shape_num, 3 * op_num);
+
+  uint64_t hits, misses;
+  platform::GetInferShapeCacheStats(&hits, &misses);
+  EXPECT_EQ(hits, 2UL * op_num);
+  EXPECT_EQ(misses, 3UL * op_num);
+  platform::DisableProfiler(platform::EventSortingKey::kDefault,
+                            "/tmp/infer_shape_cache_test_profiler");
+}
+
+TEST(InferShapeCache, NotCacheVarPtrs) {
+  const int op_num = 10;
+  Scope scope;
+  auto ops =
+      CreateProgram("infer_shape_cache_test_var_ptr_add", op_num, true, &scope);
+  platform::EnableProfiler(platform::ProfilerState::kCPU);
+  platform::ResetProfiler();
+
+  infer_shape_num = 0;
+  FeedInputs(&scope, make_ddim({4, 3}), {{0, 4}});
+  for (int i = 0; i < 3; ++i) {
+    RunProgram(ops, scope);
+    ExpectOutput(scope, op_num, make_ddim({4, 3}), {{0, 4}});
+  }
+  EXPECT_EQ(infer_shape_num, 3 * op_num);
+
+  // Only the first run is counted, the cache is disabled after it.
+  uint64_t hits, misses;
+  platform::GetInferShapeCacheStats(&hits, &misses);
+  EXPECT_EQ(hits, 0UL);
+  EXPECT_EQ(misses, static_cast<uint64_t>(op_num));
+  platform::DisableProfiler(platform::EventSortingKey::kDefault,
+                            "/tmp/infer_shape_cache_test_profiler");
+}
+
+// Runs a program of hundreds of small ops as CPU inference does, with and
+// without the InferShape cache.
+TEST(InferShapeCache, Benchmark) {
+  const int op_num = FLAGS_infer_shape_cache_benchmark_ops;
+  const int repeat = FLAGS_infer_shape_cache_benchmark_repeat;
+  for (bool cache_infer_shape : {false, true}) {
+    Scope scope;
+    auto ops = CreateProgram("infer_shape_cache_test_add", op_num,
+                             cache_infer_shape, &scope);
+    FeedInputs(&scope, make_ddim({1, 8}), {{0, 1}});
+    RunProgram(ops, scope);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+      RunProgram(ops, scope);
+    }
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    ExpectOutput(scope, op_num, make_ddim({1, 8}), {{0, 1}});
+    LOG(INFO) << op_num << " ops, cache_infer_shape=" << cache_infer_shape
+              << ": " << ms / repeat << " ms/run";
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,153 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/readahead_reader.h"
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include "glog/logging.h"
+#include "paddle/fluid/framework/threadpool.h"
+
+namespace paddle {
+namespace framework {
+
+ReadaheadReader::ReadaheadReader(std::shared_ptr<FILE> fp, size_t block_size,
+                                 size_t block_num)
+    : fp_(std::move(fp)),
+      block_size_(std::max<size_t>(block_size, 1)),
+      blocks_(std::max<size_t>(block_num, 1)),
+      filled_num_(0),
+      released_num_(0),
+      read_bytes_(0),
+      eof_(false),
+      task_running_(false),
+      stop_(false),
+      has_block_(false),
+      pos_(0) {
+  CHECK(fp_ != nullptr);
+  for (auto& block : blocks_) {
+    block.data_.resize(block_size_);
+    block.size_ = 0;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  StartTask();
+}
+
+ReadaheadReader::~ReadaheadReader() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  stop_ = true;
+  cond_.wait(lock, [this] { return !task_running_; });
+}
+
+// The caller should hold mutex_.
+void ReadaheadReader::StartTask() {
+  if (task_running_ || eof_ || stop_ ||
+      filled_num_ - released_num_ >= blocks_.size()) {
+    return;
+  }
+  task_running_ = true;
+  AsyncIO([this] { ReadTask(); });
+}
+
+void ReadaheadReader::ReadTask() {
+  while (true) {
+    Block* block = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (eof_ || stop_ || filled_num_ - released_num_ >= blocks_.size()) {
+        task_running_ = false;
+        cond_.notify_all();
+        return;
+      }
+      block = &blocks_[filled_num_ % blocks_.size()];
+    }
+    // The block is not visible to the consumer until filled_num_ is
+    // increased, so it is filled without the lock.
+    size_t size = fread(block->data_.data(), 1, block_size_, fp_.get());
+    bool eof = size < block_size_;
+    if (eof && ferror(fp_.get())) {
+      LOG(WARNING) << "ReadaheadReader failed to read the file, errno="
+                   << errno;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    block->size_ = size;
+    read_bytes_ += size;
+    if (size > 0) {
+      ++filled_num_;
+    }
+    eof_ = eof;
+    cond_.notify_all();
+  }
+}
+
+bool ReadaheadReader::NextBlock() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (has_block_) {
+    ++released_num_;
+    has_block_ = false;
+    StartTask();
+  }
+  cond_.wait(lock, [this] { return filled_num_ > released_num_ || eof_; });
+  if (filled_num_ == released_num_) {
+    return false;
+  }
+  has_block_ = true;
+  pos_ = 0;
+  return true;
+}
+
+char* ReadaheadReader::GetLine(size_t* length) {
+  line_.clear();
+  while (has_block_ || NextBlock()) {
+    Block& block = blocks_[released_num_ % blocks_.size()];
+    char* begin = block.data_.data() + pos_;
+    size_t size = block.size_ - pos_;
+    char* end = static_cast<char*>(memchr(begin, '\n', size));
+    if (end == nullptr) {
+      // the line continues in the next block
+      line_.insert(line_.end(), begin, begin + size);
+      if (!NextBlock()) {
+        break;
+      }
+      continue;
+    }
+    pos_ += end - begin + 1;
+    if (line_.empty()) {
+      *end = '\0';
+      if (length != nullptr) {
+        *length = end - begin;
+      }
+      return begin;
+    }
+    line_.insert(line_.end(), begin, end);
+    break;
+  }
+  if (line_.empty() && !has_block_) {
+    return nullptr;
+  }
+  if (length != nullptr) {
+    *length = line_.size();
+  }
+  line_.push_back('\0');
+  return line_.data();
+}
+
+size_t ReadaheadReader::ReadBytes() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return read_bytes_;
+}
+
+}  // namespace framework
+}  // namespace paddle
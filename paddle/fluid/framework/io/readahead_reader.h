@@ -0,0 +1,85 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdio.h>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// ReadaheadReader reads a file opened by fs_open_read ahead of its consumer.
+// The file is read in blocks of block_size into a ring of block_num buffers
+// by the tasks of ThreadPoolIO, so reading the file, including running its
+// pipe command, overlaps with parsing the lines of it.
+//
+// A task reads blocks until the ring is full and then returns, a new task is
+// started when the consumer releases a block. So no thread of ThreadPoolIO
+// waits for the consumer.
+//
+// The lines are returned in place in the buffers. Only a line across two
+// blocks is copied.
+class ReadaheadReader {
+ public:
+  ReadaheadReader(std::shared_ptr<FILE> fp, size_t block_size,
+                  size_t block_num);
+  // Waits for the running task.
+  ~ReadaheadReader();
+
+  // Returns the next line without the '\n', which is terminated by '\0' and
+  // stays valid until the next call. Returns nullptr at the end of the file.
+  char* GetLine(size_t* length = nullptr);
+
+  // The bytes read from the file so far.
+  size_t ReadBytes();
+
+ private:
+  struct Block {
+    std::vector<char> data_;
+    size_t size_;
+  };
+
+  void StartTask();
+  void ReadTask();
+  // Releases the current block and waits for the next one, returns false at
+  // the end of the file.
+  bool NextBlock();
+
+  std::shared_ptr<FILE> fp_;
+  size_t block_size_;
+  std::vector<Block> blocks_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  // The blocks filled by the tasks and released by the consumer so far, the
+  // block i is blocks_[i % blocks_.size()].
+  size_t filled_num_;
+  size_t released_num_;
+  size_t read_bytes_;
+  bool eof_;
+  bool task_running_;
+  bool stop_;
+
+  // The state of the consumer.
+  bool has_block_;
+  size_t pos_;
+  std::vector<char> line_;
+};
+
+}  // namespace framework
+}  // namespace paddle
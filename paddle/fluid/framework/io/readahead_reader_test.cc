@@ -0,0 +1,148 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/readahead_reader.h"
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>  // NOLINT
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/io/fs.h"
+
+DEFINE_int32(readahead_benchmark_file_mb, 64,
+             "The size of the file read by the readahead benchmark.");
+DEFINE_int32(readahead_benchmark_repeat, 3,
+             "The times the readahead benchmark reads the file.");
+
+namespace paddle {
+namespace framework {
+
+static void WriteFile(const std::string& filename, const std::string& data) {
+  FILE* fp = fopen(filename.c_str(), "w");
+  ASSERT_NE(fp, nullptr);
+  ASSERT_EQ(fwrite(data.data(), 1, data.size(), fp), data.size());
+  fclose(fp);
+}
+
+static std::vector<std::string> ReadLines(const std::string& filename,
+                                          const std::string& converter,
+                                          size_t block_size,
+                                          size_t block_num) {
+  int err_no = 0;
+  ReadaheadReader reader(fs_open_read(filename, &err_no, converter),
+                         block_size, block_num);
+  std::vector<std::string> lines;
+  size_t length = 0;
+  while (char* line = reader.GetLine(&length)) {
+    EXPECT_EQ(strlen(line), length);
+    lines.emplace_back(line, length);
+  }
+  return lines;
+}
+
+TEST(ReadaheadReader, GetLine) {
+  const std::string filename = "readahead_reader_test.txt";
+  std::vector<std::string> expected = {
+      "1 2 3", "", "a line longer than a block", "x", "", "last"};
+  std::string data;
+  for (auto& line : expected) {
+    data += line + "\n";
+  }
+
+  for (size_t block_size : {1, 3, 7, 1024}) {
+    for (size_t block_num : {1, 2, 8}) {
+      WriteFile(filename, data);
+      EXPECT_EQ(ReadLines(filename, "", block_size, block_num), expected);
+      // the last line may have no '\n'
+      WriteFile(filename, data.substr(0, data.size() - 1));
+      EXPECT_EQ(ReadLines(filename, "", block_size, block_num), expected);
+      // through a pipe command
+      EXPECT_EQ(ReadLines(filename, "cat", block_size, block_num), expected);
+    }
+  }
+
+  WriteFile(filename, "");
+  EXPECT_TRUE(ReadLines(filename, "", 4, 2).empty());
+  remove(filename.c_str());
+}
+
+// Reads a local file by string::LineFileReader and by ReadaheadReader, and
+// parses the numbers of every line as the data feeds do.
+TEST(ReadaheadReader, Benchmark) {
+  const std::string filename = "readahead_reader_benchmark.txt";
+  const size_t file_size =
+      static_cast<size_t>(FLAGS_readahead_benchmark_file_mb) << 20;
+  {
+    std::string data;
+    data.reserve(file_size + 256);
+    unsigned int seed = 0;
+    while (data.size() < file_size) {
+      for (int i = 0; i < 20; ++i) {
+        data += std::to_string(rand_r(&seed)) + " ";
+      }
+      data += "\n";
+    }
+    WriteFile(filename, data);
+  }
+
+  auto parse = [](const char* str, uint64_t* sum) {
+    char* endptr = const_cast<char*>(str);
+    while (*endptr != '\0') {
+      *sum += strtoull(endptr, &endptr, 10);
+      while (*endptr == ' ') {
+        ++endptr;
+      }
+    }
+  };
+
+  for (int repeat = 0; repeat < FLAGS_readahead_benchmark_repeat; ++repeat) {
+    int err_no = 0;
+    uint64_t sum1 = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+      auto fp = fs_open_read(filename, &err_no, "");
+      string::LineFileReader reader;
+      while (char* line = reader.getline(&*fp)) {
+        parse(line, &sum1);
+      }
+    }
+    double t1 = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+
+    uint64_t sum2 = 0;
+    start = std::chrono::steady_clock::now();
+    {
+      ReadaheadReader reader(fs_open_read(filename, &err_no, ""), 1 << 20, 4);
+      while (char* line = reader.GetLine()) {
+        parse(line, &sum2);
+      }
+      EXPECT_GE(reader.ReadBytes(), file_size);
+    }
+    double t2 = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+
+    EXPECT_EQ(sum1, sum2);
+    double mb = static_cast<double>(file_size) / (1 << 20);
+    LOG(INFO) << "read and parse " << mb << " MB, LineFileReader "
+              << mb / t1 << " MB/s, ReadaheadReader " << mb / t2 << " MB/s";
+  }
+  remove(filename.c_str());
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -45,6 +45,22 @@ class FuseOptimizerOpPass : public ir::Pass {
       const std::vector<ir::Node *> &opt_ops, ir::Graph *graph,
       ir::Node *opt_node) const;
 
+  void GetSpecifiedOpsAndVars(
+      const std::vector<std::string> &aux_vars_name,
+      const std::vector<ir::Node *> &opt_nodes,
+      std::unordered_map<std::string, std::vector<std::string>> *aux_args_name)
+      const;
+
+  std::unordered_map<std::string, std::vector<Node *>> GetVarInfo(
+      const Graph &result) const;
+
+  proto::VarType::Type GetTypeOfVar(
+      const std::unordered_map<std::string, std::vector<Node *>> &var_nodes,
+      const std::string &name) const;
+
+  bool HasVarDepsBetweenOps(const std::vector<Node *> &topo_nodes,
+                            const std::vector<Node *> &opt_nodes) const;
+
  private:
   virtual const std::string GetOpType() const = 0;
 
@@ -55,12 +71,6 @@ class FuseOptimizerOpPass : public ir::Pass {
       const std::unordered_map<std::string, std::string> &fused_vars_name,
       const std::vector<ir::Node *> &adam_ops, ir::Graph *graph) const = 0;
 
-  void GetSpecifiedOpsAndVars(
-      const std::vector<std::string> &aux_vars_name,
-      const std::vector<ir::Node *> &opt_nodes,
-      std::unordered_map<std::string, std::vector<std::string>> *aux_args_name)
-      const;
-
   void AppendAllocContinuousSpace(const std::vector<std::string> &in_args,
                                   const std::vector<std::string> &out_args,
                                   const std::string &fused_out_arg,
@@ -79,22 +89,12 @@ class FuseOptimizerOpPass : public ir::Pass {
       const std::unordered_map<std::string, std::string> &fused_vars_name,
       ir::Graph *result) const;
 
-  std::unordered_map<std::string, std::vector<Node *>> GetVarInfo(
-      const Graph &result) const;
-
-  proto::VarType::Type GetTypeOfVar(
-      const std::unordered_map<std::string, std::vector<Node *>> &var_nodes,
-      const std::string &name) const;
-
   void GradientsFilter(const std::vector<size_t> &new_grad_idx,
                        std::vector<Node *> *opt_nodes,
                        std::unordered_map<std::string, std::vector<std::string>>
                            *aux_var_set) const;
 
   bool IsLoDTensorType(const proto::VarType::Type &type) const;
-
-  bool HasVarDepsBetweenOps(const std::vector<Node *> &topo_nodes,
-                            const std::vector<Node *> &opt_nodes) const;
 };
 
 }  // namespace ir
@@ -0,0 +1,76 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass/fuse_sparse_optimizer_op_pass.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// Fuses the adam ops of the parameters with SelectedRows gradients into
+// fused_sparse_adam ops.
+class FuseSparseAdamOpPass : public FuseSparseOptimizerOpPass {
+ private:
+  const std::string GetOpType() const { return "adam"; }
+
+  const std::vector<std::string> GetAuxiliaryVarNames() const {
+    return {"Moment1", "Moment2", "Beta1Pow", "Beta2Pow"};
+  }
+
+  const std::vector<std::string> GetGroupAttrNames() const {
+    return {"beta1", "beta2", "epsilon", "lazy_mode"};
+  }
+
+  ir::Node *FuseOptimizerOps(
+      const std::unordered_map<std::string, std::vector<std::string>>
+          &aux_var_set,
+      const std::unordered_map<std::string, std::string> &fused_vars_name,
+      const std::vector<ir::Node *> &adam_ops, ir::Graph *graph) const {
+    PADDLE_ENFORCE_GT(adam_ops.size(), static_cast<size_t>(0));
+    auto *op = adam_ops[0]->Op();
+
+    VLOG(6) << "Insert fused_sparse_adam to graph.";
+    OpDesc adam_desc(op->Block());
+    adam_desc.SetType("fused_sparse_adam");
+    adam_desc.SetInput(kParam, aux_var_set.at(kParam));
+    adam_desc.SetInput(kGrad, aux_var_set.at(kGrad));
+    adam_desc.SetInput("Moment1", aux_var_set.at("Moment1"));
+    adam_desc.SetInput("Moment2", aux_var_set.at("Moment2"));
+    adam_desc.SetInput(kLearningRate, aux_var_set.at(kLearningRate));
+    adam_desc.SetInput("Beta1Pow", aux_var_set.at("Beta1Pow"));
+    adam_desc.SetInput("Beta2Pow", aux_var_set.at("Beta2Pow"));
+
+    adam_desc.SetOutput("ParamOut", GetOutputsOfOps(adam_ops, "ParamOut"));
+    adam_desc.SetOutput("Moment1Out", GetOutputsOfOps(adam_ops, "Moment1Out"));
+    adam_desc.SetOutput("Moment2Out", GetOutputsOfOps(adam_ops, "Moment2Out"));
+    adam_desc.SetAttr("beta1", op->GetAttr("beta1"));
+    adam_desc.SetAttr("beta2", op->GetAttr("beta2"));
+    adam_desc.SetAttr("epsilon", op->GetAttr("epsilon"));
+    adam_desc.SetAttr("lazy_mode", op->GetAttr("lazy_mode"));
+    adam_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                      op->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName()));
+    return graph->CreateOpNode(&adam_desc);
+  }
+};
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_sparse_adam_op_pass,
+              paddle::framework::ir::FuseSparseAdamOpPass);
@@ -0,0 +1,73 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass/fuse_sparse_optimizer_op_pass.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// Fuses the momentum ops of the parameters with SelectedRows gradients into
+// fused_sparse_momentum ops.
+class FuseSparseMomentumOpPass : public FuseSparseOptimizerOpPass {
+ private:
+  const std::string GetOpType() const { return "momentum"; }
+
+  const std::vector<std::string> GetAuxiliaryVarNames() const {
+    return {"Velocity"};
+  }
+
+  const std::vector<std::string> GetGroupAttrNames() const {
+    return {"mu", "use_nesterov"};
+  }
+
+  ir::Node *FuseOptimizerOps(
+      const std::unordered_map<std::string, std::vector<std::string>>
+          &aux_var_set,
+      const std::unordered_map<std::string, std::string> &fused_vars_name,
+      const std::vector<ir::Node *> &momentum_ops, ir::Graph *graph) const {
+    PADDLE_ENFORCE_GT(momentum_ops.size(), static_cast<size_t>(0));
+    auto *op = momentum_ops[0]->Op();
+
+    VLOG(6) << "Insert fused_sparse_momentum to graph.";
+    OpDesc momentum_desc(op->Block());
+    momentum_desc.SetType("fused_sparse_momentum");
+    momentum_desc.SetInput(kParam, aux_var_set.at(kParam));
+    momentum_desc.SetInput(kGrad, aux_var_set.at(kGrad));
+    momentum_desc.SetInput("Velocity", aux_var_set.at("Velocity"));
+    momentum_desc.SetInput(kLearningRate, aux_var_set.at(kLearningRate));
+
+    momentum_desc.SetOutput("ParamOut",
+                            GetOutputsOfOps(momentum_ops, "ParamOut"));
+    momentum_desc.SetOutput("VelocityOut",
+                            GetOutputsOfOps(momentum_ops, "VelocityOut"));
+    momentum_desc.SetAttr("mu", op->GetAttr("mu"));
+    momentum_desc.SetAttr("use_nesterov", op->GetAttr("use_nesterov"));
+    momentum_desc.SetAttr(
+        OpProtoAndCheckerMaker::OpRoleAttrName(),
+        op->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName()));
+    return graph->CreateOpNode(&momentum_desc);
+  }
+};
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_sparse_momentum_op_pass,
+              paddle::framework::ir::FuseSparseMomentumOpPass);
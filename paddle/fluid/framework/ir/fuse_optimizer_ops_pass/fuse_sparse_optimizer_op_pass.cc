@@ -0,0 +1,113 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass/fuse_sparse_optimizer_op_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void FuseSparseOptimizerOpPass::ApplyImpl(ir::Graph *graph) const {
+  std::vector<ir::Node *> topo_nodes = ir::TopologySortOperations(*graph);
+  auto vars_info = GetVarInfo(*graph);
+  const std::string fuse_op_type = GetOpType();
+
+  std::vector<std::string> attr_names = GetGroupAttrNames();
+  attr_names.emplace_back(OpProtoAndCheckerMaker::OpRoleAttrName());
+  std::vector<std::vector<ir::Node *>> groups;
+  size_t sparse_ops_num = 0;
+  for (auto &node : topo_nodes) {
+    if (node->Op()->Type() != fuse_op_type) continue;
+    auto param_name = node->Op()->Input(kParam);
+    auto grad_name = node->Op()->Input(kGrad);
+    PADDLE_ENFORCE_EQ(param_name.size(), static_cast<size_t>(1));
+    PADDLE_ENFORCE_EQ(grad_name.size(), static_cast<size_t>(1));
+    // The parameters which are SelectedRows, e.g. in distributed training,
+    // are not fused.
+    if (GetTypeOfVar(vars_info, grad_name[0]) !=
+            proto::VarType::SELECTED_ROWS ||
+        GetTypeOfVar(vars_info, param_name[0]) != proto::VarType::LOD_TENSOR) {
+      continue;
+    }
+    auto *op = node->Op();
+    auto iter = std::find_if(
+        groups.begin(), groups.end(),
+        [&](const std::vector<ir::Node *> &group) {
+          auto *group_op = group.front()->Op();
+          return std::all_of(attr_names.begin(), attr_names.end(),
+                             [&](const std::string &name) {
+                               return op->GetAttr(name) ==
+                                      group_op->GetAttr(name);
+                             });
+        });
+    if (iter == groups.end()) {
+      groups.emplace_back();
+      iter = groups.end() - 1;
+    }
+    iter->emplace_back(node);
+    ++sparse_ops_num;
+  }
+  VLOG(6) << "Find " << sparse_ops_num << " " << fuse_op_type
+          << " operators for sparse gradients in " << groups.size()
+          << " groups.";
+
+  for (auto &opt_nodes : groups) {
+    if (opt_nodes.size() < 2) continue;
+    if (HasVarDepsBetweenOps(topo_nodes, opt_nodes)) {
+      VLOG(6) << "There are interdependent variables among these "
+                 "optimization operators, which can not be handled well "
+                 "at present.";
+      continue;
+    }
+    LOG(WARNING) << "Find " << opt_nodes.size() << " " << fuse_op_type
+                 << " operators for sparse gradients. To make the speed "
+                    "faster, those optimization are fused during training.";
+
+    std::vector<std::string> aux_var_names = GetAuxiliaryVarNames();
+    aux_var_names.emplace_back(kParam);
+    aux_var_names.emplace_back(kGrad);
+    aux_var_names.emplace_back(kLearningRate);
+    std::unordered_map<std::string, std::vector<std::string>> aux_var_set;
+    GetSpecifiedOpsAndVars(aux_var_names, opt_nodes, &aux_var_set);
+
+    auto *fused_opt_node = FuseOptimizerOps(aux_var_set, {}, opt_nodes, graph);
+    InsertInputAndOutputForFusedOpNode(opt_nodes, graph, fused_opt_node);
+    for (auto &opt_op : opt_nodes) {
+      graph->RemoveNode(opt_op);
+    }
+    // The topology order is changed by the fused op.
+    topo_nodes = ir::TopologySortOperations(*graph);
+  }
+}
+
+std::vector<std::string> FuseSparseOptimizerOpPass::GetOutputsOfOps(
+    const std::vector<ir::Node *> &opt_ops, const std::string &arg_name) const {
+  std::vector<std::string> outputs;
+  for (auto &opt_op : opt_ops) {
+    auto arg_names = opt_op->Op()->Output(arg_name);
+    PADDLE_ENFORCE_EQ(arg_names.size(), static_cast<size_t>(1));
+    outputs.emplace_back(arg_names[0]);
+  }
+  return outputs;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,59 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass/fuse_optimizer_op_pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// Fuses the optimization ops of the parameters with SelectedRows gradients,
+// e.g. the embedding tables, into one fused_sparse_xx op per group. Unlike
+// FuseOptimizerOpPass, the parameters and their auxiliary vars are not
+// coalesced, because only some rows of them are updated. The ops are grouped
+// by the attributes of GetGroupAttrNames and the op role, and every group
+// with more than one op is fused.
+class FuseSparseOptimizerOpPass : public FuseOptimizerOpPass {
+ protected:
+  void ApplyImpl(ir::Graph *graph) const override;
+
+  // Gets the outputs named arg_name of opt_ops in order.
+  std::vector<std::string> GetOutputsOfOps(
+      const std::vector<ir::Node *> &opt_ops,
+      const std::string &arg_name) const;
+
+ private:
+  virtual const std::string GetOpType() const = 0;
+
+  virtual const std::vector<std::string> GetAuxiliaryVarNames() const = 0;
+
+  // The attributes which should be the same for the fused ops.
+  virtual const std::vector<std::string> GetGroupAttrNames() const = 0;
+
+  // Creates the fused_sparse_xx op of opt_ops, the inputs of every arg in
+  // vars_set are in the order of opt_ops, and fused_vars_name is empty.
+  virtual ir::Node *FuseOptimizerOps(
+      const std::unordered_map<std::string, std::vector<std::string>> &vars_set,
+      const std::unordered_map<std::string, std::string> &fused_vars_name,
+      const std::vector<ir::Node *> &opt_ops, ir::Graph *graph) const = 0;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,62 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass/fuse_sparse_optimizer_op_pass.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// Fuses the sgd ops of the parameters with SelectedRows gradients into
+// fused_sparse_sgd ops.
+class FuseSparseSGDOpPass : public FuseSparseOptimizerOpPass {
+ private:
+  const std::string GetOpType() const { return "sgd"; }
+
+  const std::vector<std::string> GetAuxiliaryVarNames() const { return {}; }
+
+  const std::vector<std::string> GetGroupAttrNames() const { return {}; }
+
+  ir::Node *FuseOptimizerOps(
+      const std::unordered_map<std::string, std::vector<std::string>>
+          &aux_var_set,
+      const std::unordered_map<std::string, std::string> &fused_vars_name,
+      const std::vector<ir::Node *> &sgd_ops, ir::Graph *graph) const {
+    PADDLE_ENFORCE_GT(sgd_ops.size(), static_cast<size_t>(0));
+    auto *op = sgd_ops[0]->Op();
+
+    VLOG(6) << "Insert fused_sparse_sgd to graph.";
+    OpDesc sgd_desc(op->Block());
+    sgd_desc.SetType("fused_sparse_sgd");
+    sgd_desc.SetInput(kParam, aux_var_set.at(kParam));
+    sgd_desc.SetInput(kGrad, aux_var_set.at(kGrad));
+    sgd_desc.SetInput(kLearningRate, aux_var_set.at(kLearningRate));
+
+    sgd_desc.SetOutput("ParamOut", GetOutputsOfOps(sgd_ops, "ParamOut"));
+    sgd_desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                     op->GetAttr(OpProtoAndCheckerMaker::OpRoleAttrName()));
+    return graph->CreateOpNode(&sgd_desc);
+  }
+};
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_sparse_sgd_op_pass,
+              paddle::framework::ir::FuseSparseSGDOpPass);
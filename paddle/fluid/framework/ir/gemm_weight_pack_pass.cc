@@ -0,0 +1,98 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/gemm_weight_pack_pass.h"
+#include <string>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static bool PackTensor(const LoDTensor& tensor) {
+  if (!tensor.IsInitialized()) {
+    return false;
+  }
+  if (tensor.type() == proto::VarType::FP32) {
+    return operators::math::PackWeight<float>(tensor);
+  } else if (tensor.type() == proto::VarType::FP64) {
+    return operators::math::PackWeight<double>(tensor);
+  }
+  return false;
+}
+
+void GemmWeightPackPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(graph);
+  FusePassBase::Init("gemm_weight_pack", graph);
+  auto* scope = param_scope();
+
+  int count = 0;
+  for (Node* node : graph->Nodes()) {
+    if (!node->IsOp() || node->Op() == nullptr) {
+      continue;
+    }
+    auto* op = node->Op();
+    std::string weight_slot;
+    if (op->Type() == "fc") {
+      weight_slot = "W";
+    } else if (op->Type() == "mul") {
+      // The weight is flattened to a matrix of the same data only if
+      // y_num_col_dims is 1.
+      if (op->HasAttr("y_num_col_dims") &&
+          boost::get<int>(op->GetAttr("y_num_col_dims")) != 1) {
+        continue;
+      }
+      weight_slot = "Y";
+    } else {
+      continue;
+    }
+    if (op->HasAttr("use_mkldnn") &&
+        boost::get<bool>(op->GetAttr("use_mkldnn"))) {
+      continue;
+    }
+    if (op->Input(weight_slot).size() != 1) {
+      continue;
+    }
+
+    const std::string& weight_name = op->Input(weight_slot)[0];
+    Node* weight = nullptr;
+    for (auto* input : node->inputs) {
+      if (input->IsVar() && input->Name() == weight_name) {
+        weight = input;
+        break;
+      }
+    }
+    if (weight == nullptr || weight->Var() == nullptr ||
+        !weight->Var()->Persistable()) {
+      continue;
+    }
+    auto* var = scope->FindVar(weight_name);
+    if (var == nullptr || !var->IsType<LoDTensor>() ||
+        !PackTensor(var->Get<LoDTensor>())) {
+      continue;
+    }
+
+    op->SetAttr("use_packed_weight", true);
+    ++count;
+  }
+  AddStatis(count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(gemm_weight_pack_pass,
+              paddle::framework::ir::GemmWeightPackPass);
@@ -0,0 +1,78 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/gemm_weight_pack_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void InitWeight(Scope* scope, const std::string& name,
+                       const std::vector<int64_t>& dims) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->mutable_data<float>(make_ddim(dims), platform::CPUPlace());
+}
+
+TEST(GemmWeightPackPass, basic) {
+  // inputs                     operator            output
+  // --------------------------------------------------------
+  // (a, weights_0, bias_0)     fc               -> fc_out
+  // (fc_out, weights_1)        mul              -> mul_out_0
+  // (mul_out_0, b)             mul              -> mul_out_1
+  Layers layers;
+  auto* a = layers.data("a");
+  auto* weights_0 = layers.data("weights_0", {4, 8}, true);
+  auto* bias_0 = layers.data("bias_0", {8}, true);
+  auto* fc_out = layers.fc(a, weights_0, bias_0);
+  auto* weights_1 = layers.data("weights_1", {8, 16}, true);
+  auto* mul_out_0 = layers.mul(fc_out, weights_1);
+  auto* b = layers.data("b");
+  layers.mul(mul_out_0, b);
+
+  Scope scope;
+  InitWeight(&scope, "weights_0", {4, 8});
+  InitWeight(&scope, "bias_0", {8});
+  InitWeight(&scope, "weights_1", {8, 16});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass = PassRegistry::Instance().Get("gemm_weight_pack_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+#ifdef PADDLE_WITH_MKLML
+  const bool packable = true;
+#else
+  const bool packable = false;
+#endif
+  int num_packed = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->HasAttr("use_packed_weight")) {
+      auto* op = node->Op();
+      ASSERT_TRUE(boost::get<bool>(op->GetAttr("use_packed_weight")));
+      // The Y of the second mul is not a parameter.
+      ASSERT_NE(op->Input(op->Type() == "fc" ? "W" : "Y")[0], "b");
+      ++num_packed;
+    }
+  }
+  EXPECT_EQ(num_packed, packable ? 2 : 0);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(gemm_weight_pack_pass);
@@ -0,0 +1,462 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/multihead_attention_fuse_pass.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+namespace patterns {
+
+struct MultiHeadAttention : public PatternBase {
+  MultiHeadAttention(PDPattern *pattern, const std::string &name_scope)
+      : PatternBase(pattern, name_scope, "multihead_attention") {}
+
+  PDNode *operator()(PDNode *x);
+
+  // declare operator node's name
+  PATTERN_DECL_NODE(fc_q);
+  PATTERN_DECL_NODE(fc_k);
+  PATTERN_DECL_NODE(fc_v);
+  PATTERN_DECL_NODE(reshape_q);
+  PATTERN_DECL_NODE(reshape_k);
+  PATTERN_DECL_NODE(reshape_v);
+  PATTERN_DECL_NODE(transpose_q);
+  PATTERN_DECL_NODE(transpose_k);
+  PATTERN_DECL_NODE(transpose_v);
+  PATTERN_DECL_NODE(scale);
+  PATTERN_DECL_NODE(matmul_qk);
+  PATTERN_DECL_NODE(eltadd_qk);
+  PATTERN_DECL_NODE(softmax);
+  PATTERN_DECL_NODE(matmul_qkv);
+  PATTERN_DECL_NODE(transpose_qkv);
+  PATTERN_DECL_NODE(reshape_qkv);
+  PATTERN_DECL_NODE(fc_out);
+  // declare variable node's name
+  PATTERN_DECL_NODE(fc_q_w);
+  PATTERN_DECL_NODE(fc_q_bias);
+  PATTERN_DECL_NODE(fc_q_out);
+  PATTERN_DECL_NODE(reshape_q_out);
+  PATTERN_DECL_NODE(transpose_q_out);
+  PATTERN_DECL_NODE(fc_k_w);
+  PATTERN_DECL_NODE(fc_k_bias);
+  PATTERN_DECL_NODE(fc_k_out);
+  PATTERN_DECL_NODE(reshape_k_out);
+  PATTERN_DECL_NODE(transpose_k_out);
+  PATTERN_DECL_NODE(fc_v_w);
+  PATTERN_DECL_NODE(fc_v_bias);
+  PATTERN_DECL_NODE(fc_v_out);
+  PATTERN_DECL_NODE(reshape_v_out);
+  PATTERN_DECL_NODE(transpose_v_out);
+  PATTERN_DECL_NODE(scale_out);
+  PATTERN_DECL_NODE(matmul_qk_out);  // (scale_out,transpose_k_out) -> qk
+  PATTERN_DECL_NODE(bias_qk);
+  PATTERN_DECL_NODE(eltadd_qk_out);
+  PATTERN_DECL_NODE(softmax_out);
+  PATTERN_DECL_NODE(matmul_qkv_out);  // (softmax_out,transpose_v_out) -> qkv
+  PATTERN_DECL_NODE(transpose_qkv_out);
+  PATTERN_DECL_NODE(reshape_qkv_out);
+  PATTERN_DECL_NODE(fc_out_w);
+  PATTERN_DECL_NODE(fc_out_bias);
+  PATTERN_DECL_NODE(fc_out_out);
+
+ private:
+  // x -> fc -> reshape2 -> transpose2, which splits the projection of x into
+  // heads. Returns the output of transpose2.
+  PDNode *SplitHeads(PDNode *x, const std::string &fc_repr,
+                     const std::string &fc_w_repr,
+                     const std::string &fc_bias_repr,
+                     const std::string &fc_out_repr,
+                     const std::string &reshape_repr,
+                     const std::string &reshape_out_repr,
+                     const std::string &transpose_repr,
+                     const std::string &transpose_out_repr);
+};
+
+PDNode *MultiHeadAttention::SplitHeads(
+    PDNode *x, const std::string &fc_repr, const std::string &fc_w_repr,
+    const std::string &fc_bias_repr, const std::string &fc_out_repr,
+    const std::string &reshape_repr, const std::string &reshape_out_repr,
+    const std::string &transpose_repr, const std::string &transpose_out_repr) {
+  auto *fc = pattern->NewNode(fc_repr)->assert_is_op("fc");
+  auto *fc_w_var = pattern->NewNode(fc_w_repr)
+                       ->AsInput()
+                       ->assert_is_persistable_var()
+                       ->assert_is_op_input("fc", "W");
+  auto *fc_bias_var = pattern->NewNode(fc_bias_repr)
+                          ->AsInput()
+                          ->assert_is_persistable_var()
+                          ->assert_is_op_input("fc", "Bias");
+  auto *fc_out_var = pattern->NewNode(fc_out_repr)
+                         ->AsIntermediate()
+                         ->assert_is_op_output("fc")
+                         ->assert_is_op_input("reshape2", "X");
+  fc->LinksFrom({x, fc_w_var, fc_bias_var}).LinksTo({fc_out_var});
+
+  auto *reshape = pattern->NewNode(reshape_repr)->assert_is_op("reshape2");
+  auto *reshape_out_var = pattern->NewNode(reshape_out_repr)
+                              ->AsIntermediate()
+                              ->assert_is_op_output("reshape2", "Out")
+                              ->assert_is_op_input("transpose2", "X");
+  reshape->LinksFrom({fc_out_var}).LinksTo({reshape_out_var});
+
+  auto *transpose =
+      pattern->NewNode(transpose_repr)->assert_is_op("transpose2");
+  auto *transpose_out_var = pattern->NewNode(transpose_out_repr)
+                                ->AsIntermediate()
+                                ->assert_is_op_output("transpose2", "Out");
+  transpose->LinksFrom({reshape_out_var}).LinksTo({transpose_out_var});
+  return transpose_out_var;
+}
+
+PDNode *MultiHeadAttention::operator()(PDNode *x) {
+  x->assert_is_op_input("fc", "Input");
+
+  // Create nodes for q, scaled by scale op.
+  auto *transpose_q_out_var = SplitHeads(
+      x, fc_q_repr(), fc_q_w_repr(), fc_q_bias_repr(), fc_q_out_repr(),
+      reshape_q_repr(), reshape_q_out_repr(), transpose_q_repr(),
+      transpose_q_out_repr());
+  transpose_q_out_var->assert_is_op_input("scale", "X");
+  auto *scale = pattern->NewNode(scale_repr())->assert_is_op("scale");
+  auto *scale_out_var = pattern->NewNode(scale_out_repr())
+                            ->AsIntermediate()
+                            ->assert_is_op_output("scale")
+                            ->assert_is_op_input("matmul", "X");
+  scale->LinksFrom({transpose_q_out_var}).LinksTo({scale_out_var});
+
+  // Create nodes for k and q * k^T.
+  auto *transpose_k_out_var = SplitHeads(
+      x, fc_k_repr(), fc_k_w_repr(), fc_k_bias_repr(), fc_k_out_repr(),
+      reshape_k_repr(), reshape_k_out_repr(), transpose_k_repr(),
+      transpose_k_out_repr());
+  transpose_k_out_var->assert_is_op_input("matmul", "Y");
+  auto *matmul_qk = pattern->NewNode(matmul_qk_repr())->assert_is_op("matmul");
+  auto *matmul_qk_out_var = pattern->NewNode(matmul_qk_out_repr())
+                                ->AsIntermediate()
+                                ->assert_is_op_output("matmul")
+                                ->assert_is_op_input("elementwise_add", "X");
+  matmul_qk->LinksFrom({scale_out_var, transpose_k_out_var})
+      .LinksTo({matmul_qk_out_var});
+
+  // Create nodes for the attention bias and softmax.
+  auto *eltadd_qk =
+      pattern->NewNode(eltadd_qk_repr())->assert_is_op("elementwise_add");
+  auto *bias_qk_var = pattern->NewNode(bias_qk_repr())
+                          ->AsInput()
+                          ->assert_is_op_input("elementwise_add", "Y");
+  auto *eltadd_qk_out_var = pattern->NewNode(eltadd_qk_out_repr())
+                                ->AsIntermediate()
+                                ->assert_is_op_output("elementwise_add")
+                                ->assert_is_op_input("softmax");
+  eltadd_qk->LinksFrom({matmul_qk_out_var, bias_qk_var})
+      .LinksTo({eltadd_qk_out_var});
+
+  auto *softmax = pattern->NewNode(softmax_repr())->assert_is_op("softmax");
+  auto *softmax_out_var = pattern->NewNode(softmax_out_repr())
+                              ->AsIntermediate()
+                              ->assert_is_op_output("softmax")
+                              ->assert_is_op_input("matmul", "X");
+  softmax->LinksFrom({eltadd_qk_out_var}).LinksTo({softmax_out_var});
+
+  // Create nodes for v and the weighted sum of v.
+  auto *transpose_v_out_var = SplitHeads(
+      x, fc_v_repr(), fc_v_w_repr(), fc_v_bias_repr(), fc_v_out_repr(),
+      reshape_v_repr(), reshape_v_out_repr(), transpose_v_repr(),
+      transpose_v_out_repr());
+  transpose_v_out_var->assert_is_op_input("matmul", "Y");
+  auto *matmul_qkv =
+      pattern->NewNode(matmul_qkv_repr())->assert_is_op("matmul");
+  auto *matmul_qkv_out_var = pattern->NewNode(matmul_qkv_out_repr())
+                                 ->AsIntermediate()
+                                 ->assert_is_op_output("matmul")
+                                 ->assert_is_op_input("transpose2", "X");
+  matmul_qkv->LinksFrom({softmax_out_var, transpose_v_out_var})
+      .LinksTo({matmul_qkv_out_var});
+
+  // Create nodes to combine the heads and the output projection.
+  auto *transpose_qkv =
+      pattern->NewNode(transpose_qkv_repr())->assert_is_op("transpose2");
+  auto *transpose_qkv_out_var = pattern->NewNode(transpose_qkv_out_repr())
+                                    ->AsIntermediate()
+                                    ->assert_is_op_output("transpose2", "Out")
+                                    ->assert_is_op_input("reshape2", "X");
+  transpose_qkv->LinksFrom({matmul_qkv_out_var})
+      .LinksTo({transpose_qkv_out_var});
+
+  auto *reshape_qkv =
+      pattern->NewNode(reshape_qkv_repr())->assert_is_op("reshape2");
+  auto *reshape_qkv_out_var = pattern->NewNode(reshape_qkv_out_repr())
+                                  ->AsIntermediate()
+                                  ->assert_is_op_output("reshape2", "Out")
+                                  ->assert_is_op_input("fc", "Input");
+  reshape_qkv->LinksFrom({transpose_qkv_out_var})
+      .LinksTo({reshape_qkv_out_var});
+
+  auto *fc_out = pattern->NewNode(fc_out_repr())->assert_is_op("fc");
+  auto *fc_out_w_var = pattern->NewNode(fc_out_w_repr())
+                           ->AsInput()
+                           ->assert_is_persistable_var()
+                           ->assert_is_op_input("fc", "W");
+  auto *fc_out_bias_var = pattern->NewNode(fc_out_bias_repr())
+                              ->AsInput()
+                              ->assert_is_persistable_var()
+                              ->assert_is_op_input("fc", "Bias");
+  auto *fc_out_out_var = pattern->NewNode(fc_out_out_repr())
+                             ->AsOutput()
+                             ->assert_is_op_output("fc");
+  fc_out->LinksFrom({reshape_qkv_out_var, fc_out_w_var, fc_out_bias_var})
+      .LinksTo({fc_out_out_var});
+  return fc_out_out_var;
+}
+
+}  // namespace patterns
+
+template <typename T>
+static T GetAttrOr(const Node *op, const std::string &name, T default_value) {
+  return op->Op()->HasAttr(name) ? boost::get<T>(op->Op()->GetAttr(name))
+                                 : default_value;
+}
+
+static bool HasInputVars(const Node *op, const std::string &name) {
+  auto &inputs = op->Op()->Inputs();
+  auto it = inputs.find(name);
+  return it != inputs.end() && !it->second.empty();
+}
+
+// Whether the projection is an fc without activation on the 3-D input.
+static bool IsProjection(const Node *fc) {
+  return GetAttrOr<int>(fc, "in_num_col_dims", 1) == 2 &&
+         GetAttrOr<std::string>(fc, "activation_type", "").empty();
+}
+
+// Whether the transpose2 swaps the head and sequence dimensions.
+static bool IsHeadTranspose(const Node *transpose) {
+  return GetAttrOr<std::vector<int>>(transpose, "axis", {}) ==
+         std::vector<int>({0, 2, 1, 3});
+}
+
+void MultiHeadAttentionFusePass::ApplyImpl(ir::Graph *graph) const {
+  PADDLE_ENFORCE_NOT_NULL(graph);
+  FusePassBase::Init("multihead_attention_fuse", graph);
+  int found_subgraph_count = 0;
+
+  GraphPatternDetector gpd;
+  auto *x = gpd.mutable_pattern()
+                ->NewNode("multihead_attention_fuse/x")
+                ->AsInput()
+                ->assert_is_op_input("fc", "Input");
+  patterns::MultiHeadAttention fused_pattern(gpd.mutable_pattern(),
+                                             "multihead_attention_fuse");
+  fused_pattern(x);
+
+  auto handler = [&](const GraphPatternDetector::subgraph_t &subgraph,
+                     Graph *graph) {
+    if (subgraph.count(x) <= 0) {
+      LOG(WARNING) << "The subgraph is empty.";
+      return;
+    }
+
+    VLOG(4) << "handle MultiHeadAttention fuse";
+    GET_IR_NODE_FROM_SUBGRAPH(fc_q, fc_q, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_k, fc_k, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_v, fc_v, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_q, reshape_q, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_k, reshape_k, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_v, reshape_v, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_q, transpose_q, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_k, transpose_k, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_v, transpose_v, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(scale, scale, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_qk, matmul_qk, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(eltadd_qk, eltadd_qk, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(softmax, softmax, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_qkv, matmul_qkv, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_qkv, transpose_qkv, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_qkv, reshape_qkv, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_out, fc_out, fused_pattern);
+
+    GET_IR_NODE_FROM_SUBGRAPH(fc_q_w, fc_q_w, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_q_bias, fc_q_bias, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_q_out, fc_q_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_q_out, reshape_q_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_q_out, transpose_q_out,
+                              fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_k_w, fc_k_w, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_k_bias, fc_k_bias, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_k_out, fc_k_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_k_out, reshape_k_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_k_out, transpose_k_out,
+                              fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_v_w, fc_v_w, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_v_bias, fc_v_bias, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_v_out, fc_v_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_v_out, reshape_v_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_v_out, transpose_v_out,
+                              fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(scale_out, scale_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_qk_out, matmul_qk_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(bias_qk, bias_qk, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(eltadd_qk_out, eltadd_qk_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(softmax_out, softmax_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_qkv_out, matmul_qkv_out, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_qkv_out, transpose_qkv_out,
+                              fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_qkv_out, reshape_qkv_out,
+                              fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_out_w, fc_out_w, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_out_bias, fc_out_bias, fused_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_out_out, fc_out_out, fused_pattern);
+
+    // The fused op only supports X of [batch, seq_len, hidden].
+    auto *x_node = subgraph.at(x);
+    if (x_node->Var() == nullptr || x_node->Var()->GetShape().size() != 3U) {
+      return;
+    }
+    for (auto *fc : {fc_q, fc_k, fc_v, fc_out}) {
+      if (!IsProjection(fc)) {
+        return;
+      }
+    }
+
+    // q, k and v are split into the same heads of shape [0, 0, head, size],
+    // and their weights are of the same shape.
+    auto w_shape = fc_q_w->Var()->GetShape();
+    if (w_shape.size() != 2U || fc_k_w->Var()->GetShape() != w_shape ||
+        fc_v_w->Var()->GetShape() != w_shape) {
+      return;
+    }
+    auto head_shape =
+        GetAttrOr<std::vector<int>>(reshape_q, "shape", std::vector<int>());
+    if (head_shape.size() != 4U || head_shape[0] != 0 || head_shape[1] != 0 ||
+        head_shape[2] <= 0 || head_shape[3] <= 0 ||
+        head_shape[2] * head_shape[3] != w_shape[1]) {
+      return;
+    }
+    for (auto *reshape : {reshape_q, reshape_k, reshape_v, reshape_qkv}) {
+      if (HasInputVars(reshape, "Shape") ||
+          HasInputVars(reshape, "ShapeTensor")) {
+        return;
+      }
+    }
+    if (GetAttrOr<std::vector<int>>(reshape_k, "shape", {}) != head_shape ||
+        GetAttrOr<std::vector<int>>(reshape_v, "shape", {}) != head_shape ||
+        GetAttrOr<std::vector<int>>(reshape_qkv, "shape", {}).size() != 3U) {
+      return;
+    }
+    for (auto *transpose :
+         {transpose_q, transpose_k, transpose_v, transpose_qkv}) {
+      if (!IsHeadTranspose(transpose)) {
+        return;
+      }
+    }
+
+    // softmax((scale * q) * k^T * alpha + bias_qk) * v
+    if (GetAttrOr<float>(scale, "bias", 0.f) != 0.f ||
+        GetAttrOr<bool>(matmul_qk, "transpose_X", false) ||
+        !GetAttrOr<bool>(matmul_qk, "transpose_Y", false) ||
+        GetAttrOr<bool>(matmul_qkv, "transpose_X", false) ||
+        GetAttrOr<bool>(matmul_qkv, "transpose_Y", false) ||
+        GetAttrOr<float>(matmul_qkv, "alpha", 1.f) != 1.f) {
+      return;
+    }
+    for (auto *matmul : {matmul_qk, matmul_qkv}) {
+      if (GetAttrOr<int>(matmul, "head_number", 1) != 1) {
+        return;
+      }
+    }
+    int add_axis = GetAttrOr<int>(eltadd_qk, "axis", -1);
+    int softmax_axis = GetAttrOr<int>(softmax, "axis", -1);
+    if (bias_qk->Var()->GetShape().size() != 4U ||
+        (add_axis != -1 && add_axis != 0) ||
+        (softmax_axis != -1 && softmax_axis != 3)) {
+      return;
+    }
+    float alpha = GetAttrOr<float>(scale, "scale", 1.f) *
+                  GetAttrOr<float>(matmul_qk, "alpha", 1.f);
+
+    std::unordered_set<const Node *> del_node_set = {
+        fc_q,          fc_k,            fc_v,            reshape_q,
+        reshape_k,     reshape_v,       transpose_q,     transpose_k,
+        transpose_v,   scale,           matmul_qk,       eltadd_qk,
+        softmax,       matmul_qkv,      transpose_qkv,   reshape_qkv,
+        fc_out,        fc_q_out,        reshape_q_out,   transpose_q_out,
+        fc_k_out,      reshape_k_out,   transpose_k_out, fc_v_out,
+        reshape_v_out, transpose_v_out, scale_out,       matmul_qk_out,
+        eltadd_qk_out, softmax_out,     matmul_qkv_out,  transpose_qkv_out,
+        reshape_qkv_out};
+    // The XShape outputs of reshape2 and transpose2 are used by nobody in
+    // inference.
+    for (auto *op : {reshape_q, reshape_k, reshape_v, reshape_qkv, transpose_q,
+                     transpose_k, transpose_v, transpose_qkv}) {
+      for (auto *out : op->outputs) {
+        if (!del_node_set.count(out)) {
+          if (!out->outputs.empty()) {
+            return;
+          }
+          del_node_set.insert(out);
+        }
+      }
+    }
+
+    // Create a FusedMultiHeadAttention op node
+    OpDesc new_desc;
+    new_desc.SetType("fused_multihead_attention");
+
+    // inputs
+    new_desc.SetInput("X", {subgraph.at(x)->Name()});
+    new_desc.SetInput("WQ", {fc_q_w->Name()});
+    new_desc.SetInput("BiasQ", {fc_q_bias->Name()});
+    new_desc.SetInput("WK", {fc_k_w->Name()});
+    new_desc.SetInput("BiasK", {fc_k_bias->Name()});
+    new_desc.SetInput("WV", {fc_v_w->Name()});
+    new_desc.SetInput("BiasV", {fc_v_bias->Name()});
+    new_desc.SetInput("BiasQK", {bias_qk->Name()});
+    new_desc.SetInput("WOut", {fc_out_w->Name()});
+    new_desc.SetInput("BiasOut", {fc_out_bias->Name()});
+
+    // outputs
+    new_desc.SetOutput("Out", {fc_out_out->Name()});
+
+    // attrs
+    new_desc.SetAttr("head_number", head_shape[2]);
+    new_desc.SetAttr("alpha", alpha);
+
+    auto fused_node = graph->CreateOpNode(&new_desc);  // OpDesc will be copied.
+
+    GraphSafeRemoveNodes(graph, del_node_set);
+
+    for (auto *input : {subgraph.at(x), fc_q_w, fc_q_bias, fc_k_w, fc_k_bias,
+                        fc_v_w, fc_v_bias, bias_qk, fc_out_w, fc_out_bias}) {
+      IR_NODE_LINK_TO(input, fused_node);
+    }
+    IR_NODE_LINK_TO(fused_node, fc_out_out);
+
+    found_subgraph_count++;
+  };
+
+  gpd(graph, handler);
+  AddStatis(found_subgraph_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(multihead_attention_fuse_pass,
+              paddle::framework::ir::MultiHeadAttentionFusePass);
@@ -0,0 +1,133 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/multihead_attention_fuse_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// Builds the self-attention of one transformer layer on x of shape
+// [1, 128, 768] with 12 heads, and returns its output.
+static VarDesc* MultiHeadAttention(Layers* layers, VarDesc* x,
+                                   float scale = 0.125f) {
+  // inputs                               operator            output
+  // --------------------------------------------------------------------
+  // (x, weights_q, bias_q)               fc               -> fc_q
+  // (fc_q)                               reshape2         -> reshape_q
+  // (reshape_q)                          transpose2       -> transpose_q
+  // (transpose_q)                        scale            -> scale_q
+  // ... k and v without scale
+  // (scale_q, transpose_k)               matmul           -> qk
+  // (qk, bias_qk)                        elementwise_add  -> qk_bias
+  // (qk_bias)                            softmax          -> qk_softmax
+  // (qk_softmax, transpose_v)            matmul           -> qkv
+  // (qkv)                                transpose2       -> transpose_qkv
+  // (transpose_qkv)                      reshape2         -> reshape_qkv
+  // (reshape_qkv, weights_out, bias_out) fc               -> out
+  std::vector<VarDesc*> heads;
+  for (std::string name : {"q", "k", "v"}) {
+    auto* weights = layers->data("weights_" + name, {768, 768}, true);
+    auto* bias = layers->data("bias_" + name, {768}, true);
+    auto* fc_out = layers->fc(x, weights, bias, 2);
+    auto* reshape_out = layers->reshape2(fc_out, {0, 0, 12, 64});
+    heads.push_back(layers->transpose2(reshape_out, {0, 2, 1, 3}));
+  }
+  auto* scale_q = layers->scale(heads[0], scale);
+  auto* qk = layers->matmul(scale_q, heads[1], false, true);
+  auto* bias_qk = layers->data("bias_qk", {1, 12, 128, 128});
+  auto* qk_bias = layers->elementwise_add(qk, bias_qk);
+  auto* qk_softmax = layers->softmax(qk_bias);
+  auto* qkv = layers->matmul(qk_softmax, heads[2]);
+  auto* transpose_qkv = layers->transpose2(qkv, {0, 2, 1, 3});
+  auto* reshape_qkv = layers->reshape2(transpose_qkv, {0, 0, 768});
+  auto* weights_out = layers->data("weights_out", {768, 768}, true);
+  auto* bias_out = layers->data("bias_out", {768}, true);
+  return layers->fc(reshape_qkv, weights_out, bias_out, 2);
+}
+
+TEST(MultiHeadAttentionFusePass, basic) {
+  Layers layers;
+  auto* x = layers.data("x", {1, 128, 768});
+  auto* out = MultiHeadAttention(&layers, x);
+  // The residual connection uses x too.
+  layers.elementwise_add(out, x);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass = PassRegistry::Instance().Get("multihead_attention_fuse_pass");
+  int num_nodes_before = graph->Nodes().size();
+  VLOG(3) << DebugString(graph);
+
+  graph.reset(pass->Apply(graph.release()));
+  int num_nodes_after = graph->Nodes().size();
+  int num_fused_nodes_after = GetNumOpNodes(graph, "fused_multihead_attention");
+  VLOG(3) << DebugString(graph);
+
+  // 17 ops, 16 intermediate outputs and 8 XShape outputs are replaced by the
+  // fused op.
+  PADDLE_ENFORCE_EQ(num_nodes_before, num_nodes_after + 40);
+  PADDLE_ENFORCE_EQ(num_fused_nodes_after, 1);
+  PADDLE_ENFORCE_EQ(GetNumOpNodes(graph, "elementwise_add"), 1);
+
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "fused_multihead_attention") {
+      auto* op = node->Op();
+      EXPECT_EQ(boost::get<int>(op->GetAttr("head_number")), 12);
+      EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("alpha")), 0.125f);
+      EXPECT_EQ(op->Input("WK"), std::vector<std::string>({"weights_k"}));
+      EXPECT_EQ(op->Input("BiasQK"), std::vector<std::string>({"bias_qk"}));
+      EXPECT_EQ(op->Output("Out"), std::vector<std::string>({out->Name()}));
+    }
+  }
+}
+
+TEST(MultiHeadAttentionFusePass, bias_of_scale) {
+  // The scale with bias is not a scaled dot-product attention.
+  Layers layers;
+  auto* x = layers.data("x", {1, 128, 768});
+  MultiHeadAttention(&layers, x);
+  for (auto* op : layers.main_program().Block(0).AllOps()) {
+    if (op->Type() == "scale") {
+      op->SetAttr("bias", 1.0f);
+    }
+  }
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass = PassRegistry::Instance().Get("multihead_attention_fuse_pass");
+  graph.reset(pass->Apply(graph.release()));
+  PADDLE_ENFORCE_EQ(GetNumOpNodes(graph, "fused_multihead_attention"), 0);
+  PADDLE_ENFORCE_EQ(GetNumOpNodes(graph, "softmax"), 1);
+}
+
+TEST(MultiHeadAttentionFusePass, input_not_3d) {
+  // The fused op only supports X of [batch, seq_len, hidden].
+  Layers layers;
+  auto* x = layers.data("x", {128, 768});
+  MultiHeadAttention(&layers, x);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass = PassRegistry::Instance().Get("multihead_attention_fuse_pass");
+  graph.reset(pass->Apply(graph.release()));
+  PADDLE_ENFORCE_EQ(GetNumOpNodes(graph, "fused_multihead_attention"), 0);
+  PADDLE_ENFORCE_EQ(GetNumOpNodes(graph, "softmax"), 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(multihead_attention_fuse_pass);
@@ -106,6 +106,58 @@ struct Layers {
     return binary_op("elementwise_add", x, y, out);
   }
 
+  VarDesc* reshape2(VarDesc* x, std::vector<int> shape) {
+    VarDesc* out = lod_tensor(unique_name());
+    VarDesc* xshape = lod_tensor(unique_name());
+    OpDesc* op = program_.MutableBlock(0)->AppendOp();
+    op->SetType("reshape2");
+    op->SetInput("X", {x->Name()});
+    op->SetOutput("Out", {out->Name()});
+    op->SetOutput("XShape", {xshape->Name()});
+    op->SetAttr("shape", shape);
+    op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                static_cast<int>(OpRole::kForward));
+    return out;
+  }
+
+  VarDesc* transpose2(VarDesc* x, std::vector<int> axis) {
+    VarDesc* out = lod_tensor(unique_name());
+    VarDesc* xshape = lod_tensor(unique_name());
+    OpDesc* op = program_.MutableBlock(0)->AppendOp();
+    op->SetType("transpose2");
+    op->SetInput("X", {x->Name()});
+    op->SetOutput("Out", {out->Name()});
+    op->SetOutput("XShape", {xshape->Name()});
+    op->SetAttr("axis", axis);
+    op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                static_cast<int>(OpRole::kForward));
+    return out;
+  }
+
+  VarDesc* scale(VarDesc* x, float scale, float bias = 0.0f) {
+    VarDesc* out = unary_op("scale", x);
+    OpDesc* op = program_.MutableBlock(0)->AllOps().back();
+    op->SetAttr("scale", scale);
+    op->SetAttr("bias", bias);
+    op->SetAttr("bias_after_scale", true);
+    return out;
+  }
+
+  VarDesc* softmax(VarDesc* x, int axis = -1) {
+    VarDesc* out = unary_op("softmax", x);
+    program_.MutableBlock(0)->AllOps().back()->SetAttr("axis", axis);
+    return out;
+  }
+
+  VarDesc* matmul(VarDesc* x, VarDesc* y, bool transpose_x = false,
+                  bool transpose_y = false, float alpha = 1.0f) {
+    AttributeMap attrs;
+    attrs["transpose_X"] = transpose_x;
+    attrs["transpose_Y"] = transpose_y;
+    attrs["alpha"] = alpha;
+    return binary_op("matmul", x, y, nullptr, &attrs);
+  }
+
   VarDesc* dropout(VarDesc* x, float dropout_prob,
                    std::string dropout_implementation) {
     VarDesc* out = lod_tensor(unique_name());
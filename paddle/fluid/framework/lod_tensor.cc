@@ -217,7 +217,8 @@ void AppendLoD(LoD *lod, const LoD &lod_length) {
 }
 
 void SerializeToStream(std::ostream &os, const LoDTensor &tensor,
-                       const platform::DeviceContext &dev_ctx) {
+                       const platform::DeviceContext &dev_ctx,
+                       bool align_payload) {
   {  // the 1st field, uint32_t version for LoDTensor
     os.write(reinterpret_cast<const char *>(&kCurTensorVersion),
              sizeof(kCurTensorVersion));
@@ -240,7 +241,7 @@ void SerializeToStream(std::ostream &os, const LoDTensor &tensor,
     }
   }
   // the 3st field, Tensor
-  TensorToStream(os, static_cast<Tensor>(tensor), dev_ctx);
+  TensorToStream(os, static_cast<Tensor>(tensor), dev_ctx, align_payload);
 }
 
 void DeserializeFromStream(std::istream &is, LoDTensor *tensor,
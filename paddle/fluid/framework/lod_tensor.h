@@ -204,9 +204,12 @@ void AppendLoD(LoD* lod, const LoD& lod_length);
  * Serialize/Desiralize LoDTensor to std::ostream
  * You can pass ofstream or ostringstream to serilize to file
  * or to a in memory string. GPU tensor will be copied to CPU.
+ * If align_payload is true, the tensor data is aligned in the stream so that
+ * it can be loaded from a mapped file without copy, see MappedFile.
  */
 void SerializeToStream(std::ostream& os, const LoDTensor& tensor,
-                       const platform::DeviceContext& dev_ctx);
+                       const platform::DeviceContext& dev_ctx,
+                       bool align_payload = false);
 void DeserializeFromStream(std::istream& is, LoDTensor* tensor,
                            const platform::DeviceContext& dev_ctx);
 
@@ -0,0 +1,171 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/mapped_file.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/version.h"
+
+namespace paddle {
+namespace framework {
+
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef _WIN32
+  PADDLE_THROW("Mapping file %s is not supported on Windows", filename);
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  PADDLE_ENFORCE(fd != -1, "Cannot open file %s: %s", filename,
+                 strerror(errno));
+  struct stat sb;
+  if (fstat(fd, &sb) != 0) {
+    close(fd);
+    PADDLE_THROW("Cannot stat file %s: %s", filename, strerror(errno));
+  }
+  size_ = static_cast<size_t>(sb.st_size);
+  if (size_ > 0) {
+    // The mapping is writable but private, the writes are copied on write and
+    // never reach the file.
+    void* data =
+        mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      PADDLE_THROW("Cannot mmap file %s: %s", filename, strerror(errno));
+    }
+    data_ = static_cast<char*>(data);
+  }
+  // The mapping is still valid after the file descriptor is closed.
+  close(fd);
+  VLOG(3) << "Map file " << filename << " of " << size_ << " bytes";
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+#endif
+}
+
+MappedAllocation::MappedAllocation(std::shared_ptr<MappedFile> file,
+                                   size_t offset, size_t size)
+    : Allocation(file->data() + offset, size, platform::CPUPlace()),
+      file_(std::move(file)) {}
+
+namespace {
+
+class MappedFileReader {
+ public:
+  MappedFileReader(const MappedFile& file, size_t offset)
+      : file_(file), offset_(offset) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    std::memcpy(&value, Skip(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  const char* Skip(size_t size) {
+    PADDLE_ENFORCE_LE(size, file_.size() - offset_,
+                      "Unexpected end of the tensor file, please check "
+                      "whether the model file is complete or damaged.");
+    const char* ptr = file_.data() + offset_;
+    offset_ += size;
+    return ptr;
+  }
+
+  size_t offset() const { return offset_; }
+
+ private:
+  const MappedFile& file_;
+  size_t offset_;
+};
+
+void TensorFromMappedFile(const std::shared_ptr<MappedFile>& file,
+                          MappedFileReader* reader, Tensor* tensor) {
+  uint32_t version = reader->Read<uint32_t>();
+  PADDLE_ENFORCE(version == 0U || version == 1U,
+                 "Only version 0 and 1 are supported");
+  proto::VarType::TensorDesc desc;
+  {
+    int32_t size = reader->Read<int32_t>();
+    PADDLE_ENFORCE_GE(size, 0, "Cannot parse tensor desc");
+    PADDLE_ENFORCE(desc.ParseFromArray(reader->Skip(size), size),
+                   "Cannot parse tensor desc");
+  }
+  if (version == 1U) {
+    reader->Skip(reader->Read<uint32_t>());
+  }
+
+  std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+  auto ddim = make_ddim(dims);
+  size_t size = product(ddim) * SizeOfType(desc.data_type());
+  const char* payload = reader->Skip(size);
+
+  if (size > 0 &&
+      reinterpret_cast<uintptr_t>(payload) % kTensorPayloadAlignment == 0) {
+    Tensor mapped(desc.data_type());
+    mapped.Resize(ddim);
+    mapped.ResetHolder(std::make_shared<MappedAllocation>(
+        file, static_cast<size_t>(payload - file->data()), size));
+    tensor->ShareDataWith(mapped);
+  } else {
+    tensor->Resize(ddim);
+    void* buf = tensor->mutable_data(platform::CPUPlace(), desc.data_type());
+    std::memcpy(buf, payload, size);
+  }
+}
+
+}  // namespace
+
+void DeserializeFromMappedFile(const std::shared_ptr<MappedFile>& file,
+                               size_t* offset, LoDTensor* tensor) {
+  MappedFileReader reader(*file, *offset);
+  {
+    // the 1st field, unit32_t version for LoDTensor
+    uint32_t version = reader.Read<uint32_t>();
+    PADDLE_ENFORCE(IsTensorVersionSupported(version),
+                   "tensor version %u is not supported.", version);
+    PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  }
+  {
+    // the 2st field, LoD information
+    uint64_t lod_level = reader.Read<uint64_t>();
+    auto& lod = *tensor->mutable_lod();
+    lod.resize(lod_level);
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size = reader.Read<uint64_t>();
+      const char* data = reader.Skip(size);
+      std::vector<size_t> tmp(size / sizeof(size_t));
+      std::memcpy(tmp.data(), data, size);
+      lod[i] = tmp;
+    }
+  }
+  // the 3st filed, Tensor
+  TensorFromMappedFile(file, &reader, tensor);
+  *offset = reader.offset();
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,74 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief A file mapped into memory with MAP_PRIVATE.
+ *
+ * The pages of the file are shared through the page cache by all processes
+ * mapping it, until some process writes a page, which is then copied for the
+ * writing process only. So tensors pointing to the mapping behave the same
+ * as normally allocated tensors.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  char* data_{nullptr};
+  size_t size_{0};
+
+  DISABLE_COPY_AND_ASSIGN(MappedFile);
+};
+
+/*
+ * @brief A CPU allocation of [ptr, ptr + size) inside a MappedFile, which
+ * keeps the file mapped.
+ */
+class MappedAllocation : public memory::Allocation {
+ public:
+  MappedAllocation(std::shared_ptr<MappedFile> file, size_t offset,
+                   size_t size);
+
+ private:
+  std::shared_ptr<MappedFile> file_;
+};
+
+/*
+ * @brief Deserialize a LoDTensor written by SerializeToStream from the mapped
+ * file, starting at *offset, and advance *offset to the end of the tensor.
+ *
+ * The tensor points to the mapping directly if its payload is aligned to
+ * kTensorPayloadAlignment, which is guaranteed when the tensor is serialized
+ * with align_payload. Otherwise, the payload is copied.
+ */
+void DeserializeFromMappedFile(const std::shared_ptr<MappedFile>& file,
+                               size_t* offset, LoDTensor* tensor);
+
+}  // namespace framework
+}  // namespace paddle
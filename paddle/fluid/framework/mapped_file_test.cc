@@ -0,0 +1,113 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/mapped_file.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+static void SaveTensors(const std::string& filename, bool align_payload,
+                        std::vector<LoDTensor>* tensors) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext dev_ctx(place);
+  std::ofstream fout(filename, std::ios::binary);
+  for (int i = 0; i < 3; ++i) {
+    LoDTensor tensor;
+    tensor.Resize({i + 1, 3});
+    tensor.set_lod({{0, static_cast<size_t>(i + 1)}});
+    float* data = tensor.mutable_data<float>(place);
+    for (int64_t j = 0; j < tensor.numel(); ++j) {
+      data[j] = static_cast<float>(i * 100 + j);
+    }
+    SerializeToStream(fout, tensor, dev_ctx, align_payload);
+    tensors->emplace_back(tensor);
+  }
+}
+
+static void CheckTensors(const std::string& filename, bool expect_mapped,
+                         const std::vector<LoDTensor>& expects) {
+  auto file = std::make_shared<MappedFile>(filename);
+  size_t offset = 0;
+  for (auto& expect : expects) {
+    LoDTensor tensor;
+    DeserializeFromMappedFile(file, &offset, &tensor);
+    ASSERT_EQ(tensor.dims(), expect.dims());
+    ASSERT_EQ(tensor.lod(), expect.lod());
+    ASSERT_EQ(tensor.type(), proto::VarType::FP32);
+    const float* data = tensor.data<float>();
+    bool mapped = reinterpret_cast<const char*>(data) >= file->data() &&
+                  reinterpret_cast<const char*>(data) <
+                      file->data() + file->size();
+    if (expect_mapped) {
+      ASSERT_TRUE(mapped);
+    }
+    for (int64_t i = 0; i < tensor.numel(); ++i) {
+      ASSERT_EQ(data[i], expect.data<float>()[i]);
+    }
+  }
+  ASSERT_EQ(offset, file->size());
+}
+
+TEST(MappedFile, AlignedPayload) {
+  std::vector<LoDTensor> tensors;
+  SaveTensors("mapped_file_aligned", true, &tensors);
+  CheckTensors("mapped_file_aligned", true, tensors);
+
+  // The aligned tensors can also be loaded from the stream
+  platform::CPUPlace place;
+  platform::CPUDeviceContext dev_ctx(place);
+  std::ifstream fin("mapped_file_aligned", std::ios::binary);
+  for (auto& expect : tensors) {
+    LoDTensor tensor;
+    DeserializeFromStream(fin, &tensor, dev_ctx);
+    ASSERT_EQ(tensor.dims(), expect.dims());
+    for (int64_t i = 0; i < tensor.numel(); ++i) {
+      ASSERT_EQ(tensor.data<float>()[i], expect.data<float>()[i]);
+    }
+  }
+}
+
+TEST(MappedFile, UnalignedPayload) {
+  std::vector<LoDTensor> tensors;
+  SaveTensors("mapped_file_unaligned", false, &tensors);
+  CheckTensors("mapped_file_unaligned", false, tensors);
+}
+
+TEST(MappedFile, CopyOnWrite) {
+  std::vector<LoDTensor> tensors;
+  SaveTensors("mapped_file_cow", true, &tensors);
+
+  {
+    auto file = std::make_shared<MappedFile>("mapped_file_cow");
+    size_t offset = 0;
+    LoDTensor tensor;
+    DeserializeFromMappedFile(file, &offset, &tensor);
+    file.reset();
+    // The tensor keeps the file mapped, and the writes are private.
+    float* data = tensor.mutable_data<float>(platform::CPUPlace());
+    for (int64_t i = 0; i < tensor.numel(); ++i) {
+      data[i] = -1;
+    }
+  }
+
+  CheckTensors("mapped_file_cow", true, tensors);
+}
+
+}  // namespace framework
+}  // namespace paddle
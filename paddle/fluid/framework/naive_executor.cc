@@ -12,7 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "paddle/fluid/framework/feed_fetch_method.h"
@@ -22,6 +29,7 @@
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/string/pretty_log.h"
 
 namespace paddle {
@@ -36,6 +44,24 @@ void NaiveExecutor::Prepare(Scope *scope, const ProgramDesc &program_desc,
 
   VLOG(3) << "NaiveExecutor init with scope " << scope;
   CreateOps(program_desc, block_id, with_feed_fetch_ops);
+  if (pool_) {
+    BuildOpDependencies();
+  }
+}
+
+void NaiveExecutor::EnableInterOpParallel(int inter_op_num_threads,
+                                          int intra_op_num_threads) {
+  PADDLE_ENFORCE(platform::is_cpu_place(place_),
+                 "The inter-op parallel mode only supports CPUPlace.");
+  if (inter_op_num_threads <= 1) {
+    pool_.reset();
+    return;
+  }
+  pool_.reset(new WorkStealingThreadPool(inter_op_num_threads));
+  intra_op_num_threads_ = intra_op_num_threads;
+  if (!ops_.empty()) {
+    BuildOpDependencies();
+  }
 }
 
 void NaiveExecutor::Run() {
@@ -49,11 +75,176 @@ void NaiveExecutor::Run() {
                              "setting the cmake flag ON_INFER=ON if you are "
                              "running Paddle Inference";
 #endif  // PADDLE_ON_INFERENCE
+  if (pool_) {
+    RunInterOpParallel();
+    return;
+  }
   for (auto &op : ops_) {
-    VLOG(4) << std::this_thread::get_id() << " run "
-            << op->DebugStringEx(scope_) << " on scope " << scope_;
-    op->SetIsCalledByExecutor(false);
-    op->Run(*scope_, place_);
+    RunOp(op.get());
+  }
+}
+
+void NaiveExecutor::RunOp(OperatorBase *op) {
+  VLOG(4) << std::this_thread::get_id() << " run "
+          << op->DebugStringEx(scope_) << " on scope " << scope_;
+  op->SetIsCalledByExecutor(false);
+  op->Run(*scope_, place_);
+}
+
+// The operators with sub-blocks may access any variable in the scope.
+static bool HasSubBlock(const OperatorBase &op) {
+  for (auto &attr : op.Attrs()) {
+    if (attr.second.type() == typeid(BlockDesc *) ||
+        attr.second.type() == typeid(std::vector<BlockDesc *>)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// An op depends on the last op writing any of its inputs or outputs, and the
+// ops reading its outputs after the last writing. So each variable is
+// accessed in the same order as the sequential mode. The ops with sub-blocks
+// are barriers, which depend on all the ops before them, and all the ops
+// after them depend on them.
+void NaiveExecutor::BuildOpDependencies() {
+  const size_t kNone = static_cast<size_t>(-1);
+  std::vector<std::set<size_t>> preceding_ops(ops_.size());
+  std::unordered_map<std::string, size_t> last_writer;
+  std::unordered_map<std::string, std::vector<size_t>> readers;
+  std::vector<size_t> ops_since_barrier;
+  size_t last_barrier = kNone;
+
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    auto &deps = preceding_ops[i];
+    if (HasSubBlock(*ops_[i])) {
+      deps.insert(ops_since_barrier.begin(), ops_since_barrier.end());
+      if (last_barrier != kNone) {
+        deps.insert(last_barrier);
+      }
+      last_writer.clear();
+      readers.clear();
+      ops_since_barrier.clear();
+      last_barrier = i;
+      continue;
+    }
+    if (last_barrier != kNone) {
+      deps.insert(last_barrier);
+    }
+    for (auto &pair : ops_[i]->Inputs()) {
+      for (auto &name : pair.second) {
+        auto it = last_writer.find(name);
+        if (it != last_writer.end()) {
+          deps.insert(it->second);
+        }
+      }
+    }
+    for (auto &pair : ops_[i]->Outputs()) {
+      for (auto &name : pair.second) {
+        auto it = last_writer.find(name);
+        if (it != last_writer.end()) {
+          deps.insert(it->second);
+        }
+        auto &var_readers = readers[name];
+        deps.insert(var_readers.begin(), var_readers.end());
+      }
+    }
+    deps.erase(i);
+
+    for (auto &pair : ops_[i]->Inputs()) {
+      for (auto &name : pair.second) {
+        readers[name].push_back(i);
+      }
+    }
+    for (auto &pair : ops_[i]->Outputs()) {
+      for (auto &name : pair.second) {
+        last_writer[name] = i;
+        readers[name].clear();
+      }
+    }
+    ops_since_barrier.push_back(i);
+  }
+
+  op_deps_.assign(ops_.size(), 0);
+  op_successors_.assign(ops_.size(), std::vector<size_t>());
+  root_ops_.clear();
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    op_deps_[i] = preceding_ops[i].size();
+    for (size_t dep : preceding_ops[i]) {
+      op_successors_[dep].push_back(i);
+    }
+    if (op_deps_[i] == 0) {
+      root_ops_.push_back(i);
+    }
+  }
+  VLOG(3) << "NaiveExecutor builds the dependencies of " << ops_.size()
+          << " ops, " << root_ops_.size() << " of them are ready at first";
+}
+
+void NaiveExecutor::RunInterOpParallel() {
+  std::unique_ptr<std::atomic<size_t>[]> deps(
+      new std::atomic<size_t>[ops_.size()]);
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    deps[i] = op_deps_[i];
+  }
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t running_tasks = 0;
+  std::atomic<bool> failed{false};
+  std::exception_ptr exception;
+
+  // Each task runs an op, and then runs one of its ready successors in the
+  // same thread and schedules the others to the pool.
+  std::function<void(size_t)> schedule;
+  schedule = [&](size_t op_idx) {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      ++running_tasks;
+    }
+    pool_->Run([&, op_idx] {
+      static thread_local int intra_op_num_threads = 0;
+      if (intra_op_num_threads != intra_op_num_threads_) {
+        intra_op_num_threads = intra_op_num_threads_;
+        platform::SetNumThreads(intra_op_num_threads);
+      }
+      size_t cur = op_idx;
+      while (!failed) {
+        try {
+          RunOp(ops_[cur].get());
+        } catch (...) {
+          std::lock_guard<std::mutex> guard(mutex);
+          if (!failed) {
+            exception = std::current_exception();
+            failed = true;
+          }
+          break;
+        }
+        size_t next = ops_.size();
+        for (size_t succ : op_successors_[cur]) {
+          if (--deps[succ] != 0) continue;
+          if (next == ops_.size()) {
+            next = succ;
+          } else {
+            schedule(succ);
+          }
+        }
+        if (next == ops_.size()) break;
+        cur = next;
+      }
+      std::lock_guard<std::mutex> guard(mutex);
+      if (--running_tasks == 0) {
+        cv.notify_all();
+      }
+    });
+  };
+
+  for (size_t op_idx : root_ops_) {
+    schedule(op_idx);
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&] { return running_tasks == 0; });
+  if (exception) {
+    std::rethrow_exception(exception);
   }
 }
 
@@ -125,6 +316,9 @@ void NaiveExecutor::CleanFeedFetchOps() {
     }
   }
   ops_.swap(ops);
+  if (pool_) {
+    BuildOpDependencies();
+  }
 }
 
 }  // namespace framework
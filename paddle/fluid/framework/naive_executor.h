@@ -14,19 +14,25 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
 namespace framework {
 
 /*
- * Simple, intuitive and effective. Only single thread is supported, and
- * currently designed for inference.
+ * Simple, intuitive and effective. Currently designed for inference.
+ *
+ * The operators run sequentially in the calling thread by default. If the
+ * inter-op parallel mode is enabled, the independent operators run
+ * concurrently on a thread pool, and the results are the same as the
+ * sequential mode.
  */
 class NaiveExecutor {
  public:
@@ -44,6 +50,13 @@ class NaiveExecutor {
   void CreateVariables(const ProgramDesc& desc, int block_id, bool persistable,
                        Scope* scope);
 
+  // Run the operators on inter_op_num_threads threads, each of which sets
+  // the number of threads of the CPU math library to intra_op_num_threads.
+  // The dependencies of operators are built in Prepare, so it should be
+  // called before Prepare. Only the operators on CPU are supported.
+  void EnableInterOpParallel(int inter_op_num_threads,
+                             int intra_op_num_threads);
+
   // Run all the operators.
   void Run();
 
@@ -58,11 +71,26 @@ class NaiveExecutor {
   void CreateOps(const ProgramDesc& desc, int block_id,
                  bool with_feed_fetch_ops);
 
+  // Build the dependencies of ops_ for the inter-op parallel mode.
+  void BuildOpDependencies();
+
+  void RunOp(OperatorBase* op);
+  void RunInterOpParallel();
+
  private:
   const platform::Place place_;
   // Catch the required resource to avoid recreate.
   std::vector<std::unique_ptr<OperatorBase>> ops_;
   Scope* scope_;
+
+  // Used by the inter-op parallel mode.
+  std::unique_ptr<WorkStealingThreadPool> pool_;
+  int intra_op_num_threads_{1};
+  // The number of the operators each op depends on.
+  std::vector<size_t> op_deps_;
+  // The operators depend on each op.
+  std::vector<std::vector<size_t>> op_successors_;
+  std::vector<size_t> root_ops_;
 };
 
 }  // namespace framework
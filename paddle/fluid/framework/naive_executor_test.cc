@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/naive_executor.h"
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <string>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/program_desc.h"
 
@@ -64,6 +65,54 @@ TEST(NaiveExecutor, Basic) {
   }
 }
 
+TEST(NaiveExecutor, InterOpParallel) {
+  // Two branches: d = (a + b) + (a + a), then c is overwritten by d + b.
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto name : {"a", "b", "c", "d", "e"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto add_op = [&](const std::string& x, const std::string& y,
+                    const std::string& out) {
+    auto* op = main_block->AppendOp();
+    op->SetType("elementwise_add");
+    op->SetInput("X", {x});
+    op->SetInput("Y", {y});
+    op->SetOutput("Out", {out});
+  };
+  add_op("a", "b", "c");
+  add_op("a", "a", "e");
+  add_op("c", "e", "d");
+  add_op("d", "b", "c");
+
+  auto place = platform::CPUPlace();
+  float a_arr[] = {0, 1, 2, 3};
+  float b_arr[] = {0.0, .1, .2, .3};
+  for (int inter_op_num_threads : {1, 4}) {
+    Scope scope;
+    NaiveExecutor exe(place);
+    exe.EnableInterOpParallel(inter_op_num_threads, 1);
+    exe.Prepare(&scope, program, 0, false);
+    exe.CreateVariables(program, 0, false, &scope);
+    auto* a_tensor = exe.FindTensor("a");
+    auto* b_tensor = exe.FindTensor("b");
+    a_tensor->Resize({1, 4});
+    b_tensor->Resize({1, 4});
+    std::copy_n(a_arr, 4, a_tensor->mutable_data<float>(place));
+    std::copy_n(b_arr, 4, b_tensor->mutable_data<float>(place));
+
+    for (int iter = 0; iter < 10; ++iter) {
+      exe.Run();
+      auto* c_data = exe.FindTensor("c")->data<float>();
+      auto* d_data = exe.FindTensor("d")->data<float>();
+      for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(d_data[i], (a_arr[i] + b_arr[i]) + (a_arr[i] + a_arr[i]));
+        EXPECT_EQ(c_data[i], d_data[i] + b_arr[i]);
+      }
+    }
+  }
+}
+
 }  // namespace framework
 }  // namespace paddle
 
@@ -176,7 +176,7 @@ void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
     // issue
     // in concurrency scenerio. Here use an `if` to fix this issue.
     // Please not remove the `if`, ask @Superjomn if there are any concern.
-    if (platform::IsProfileEnabled()) {
+    if (platform::IsEventRecordEnabled()) {
       platform::RecordEvent record_event(Type());
       RunImpl(scope, place);
     } else {
@@ -532,6 +532,9 @@ class RuntimeInferShapeContext : public InferShapeContext {
                            const RuntimeContext& ctx)
       : op_(op), ctx_(ctx) {}
 
+  // Records the outputs set by InferShape into cache.
+  void SetInferShapeCache(InferShapeCache* cache) { cache_ = cache; }
+
   bool HasInput(const std::string& name) const override {
     // has only one input
     const auto& ins = ctx_.inputs;
@@ -623,10 +626,15 @@ class RuntimeInferShapeContext : public InferShapeContext {
       out_sele_rows->mutable_value()->Resize(in_sele_rows.value().dims());
       out_sele_rows->set_rows(in_sele_rows.rows());
       out_sele_rows->set_height(in_sele_rows.height());
+      // The rows are not a part of the signature.
+      if (cache_ != nullptr) cache_->cacheable = false;
     } else if (in_var->IsType<framework::LoDTensor>()) {
       auto& in_lod_tensor = in_var->Get<framework::LoDTensor>();
       auto* out_lod_tensor = out_var->GetMutable<framework::LoDTensor>();
       out_lod_tensor->Resize(in_lod_tensor.dims());
+      if (cache_ != nullptr) {
+        cache_->RecordDims(out, j, *out_var, in_lod_tensor.dims());
+      }
     } else {
       PADDLE_THROW(
           "Currently, the input type of ShareDim only can be LoDTensor "
@@ -651,6 +659,7 @@ class RuntimeInferShapeContext : public InferShapeContext {
     auto& in_tensor = in_var->Get<LoDTensor>();
     auto* out_tensor = out_var->GetMutable<LoDTensor>();
     out_tensor->set_lod(in_tensor.lod());
+    bool share_layout = true;
 
 // TODO(dzhwinter) : reuse ShareLoD in most operators.
 // Need to call ShareLayout explicitly in sequence related ops.
@@ -668,9 +677,15 @@ class RuntimeInferShapeContext : public InferShapeContext {
     //    This is to avoid kMKLDNN is populated wrongly into a non-MKLDNN
     //    OPKernel. In all MKLDNN OPkernel, set_layout(kMKLDNN) should be called
     //    in Compute()
-    if (in_tensor.layout() != DataLayout::kMKLDNN)
+    share_layout = in_tensor.layout() != DataLayout::kMKLDNN;
 #endif
+    if (share_layout) {
       out_tensor->set_layout(in_tensor.layout());
+    }
+    if (cache_ != nullptr) {
+      cache_->RecordLoD(out, j, in_tensor.lod(), share_layout,
+                        in_tensor.layout());
+    }
   }
 
   void DecreaseLoDLevel(const std::string& in, const std::string& out,
@@ -683,6 +698,8 @@ class RuntimeInferShapeContext : public InferShapeContext {
   // TODO(paddle-dev): Can this be template?
   std::vector<InferShapeVarPtr> GetInputVarPtrs(
       const std::string& name) override {
+    // The variables may be visited in any way by InferShape.
+    if (cache_ != nullptr) cache_->cacheable = false;
     const std::vector<Variable*>& vars = InputVars(name);
     std::vector<InferShapeVarPtr> res;
     res.reserve(vars.size());
@@ -692,6 +709,7 @@ class RuntimeInferShapeContext : public InferShapeContext {
 
   std::vector<InferShapeVarPtr> GetOutputVarPtrs(
       const std::string& name) override {
+    if (cache_ != nullptr) cache_->cacheable = false;
     const std::vector<Variable*>& vars = OutputVars(name);
     std::vector<InferShapeVarPtr> res;
     res.reserve(vars.size());
@@ -728,12 +746,18 @@ class RuntimeInferShapeContext : public InferShapeContext {
                       "Output(%s) should hold one element, but now it holds %d",
                       name, vars.size());
     SetDim(vars[0], dim);
+    if (cache_ != nullptr) cache_->RecordDims(name, 0, *vars[0], dim);
   }
 
   void SetOutputsDim(const std::string& name,
                      const std::vector<DDim>& dims) override {
     auto& vars = OutputVars(name);
     SetDims(vars, dims);
+    if (cache_ != nullptr) {
+      for (size_t i = 0; i < vars.size(); ++i) {
+        if (vars[i] != nullptr) cache_->RecordDims(name, i, *vars[i], dims[i]);
+      }
+    }
   }
 
  protected:
@@ -823,8 +847,141 @@ class RuntimeInferShapeContext : public InferShapeContext {
 
   const OperatorBase& op_;
   const RuntimeContext& ctx_;
+  InferShapeCache* cache_{nullptr};
 };
 
+InferShapeCache::Output* InferShapeCache::GetOutput(const std::string& name,
+                                                    size_t index) {
+  for (auto& output : outputs) {
+    if (output.index == index && output.name == name) return &output;
+  }
+  outputs.emplace_back();
+  outputs.back().name = name;
+  outputs.back().index = index;
+  return &outputs.back();
+}
+
+void InferShapeCache::RecordDims(const std::string& name, size_t index,
+                                 const Variable& var, const DDim& dims) {
+  auto* output = GetOutput(name, index);
+  output->is_selected_rows = var.IsType<SelectedRows>();
+  output->has_dims = true;
+  output->dims = dims;
+}
+
+void InferShapeCache::RecordLoD(const std::string& name, size_t index,
+                                const LoD& lod, bool has_layout,
+                                DataLayout layout) {
+  auto* output = GetOutput(name, index);
+  output->has_lod = true;
+  output->lod = lod;
+  if (has_layout) {
+    output->has_layout = true;
+    output->layout = layout;
+  }
+}
+
+bool InferShapeCache::Replay(const VariableValueMap& outputs) const {
+  for (auto& output : this->outputs) {
+    auto it = outputs.find(output.name);
+    if (it == outputs.end() || it->second.size() <= output.index) {
+      return false;
+    }
+    Variable* var = it->second[output.index];
+    if (var == nullptr) return false;
+    if (output.is_selected_rows) {
+      if (!var->IsType<SelectedRows>()) return false;
+      if (output.has_dims) {
+        var->GetMutable<SelectedRows>()->set_height(output.dims[0]);
+      }
+      continue;
+    }
+    if (!var->IsType<LoDTensor>()) return false;
+    auto* tensor = var->GetMutable<LoDTensor>();
+    if (output.has_dims) tensor->Resize(output.dims);
+    if (output.has_lod) tensor->set_lod(output.lod);
+    if (output.has_layout) tensor->set_layout(output.layout);
+  }
+  return true;
+}
+
+static void AppendDims(const DDim& dims, std::vector<int64_t>* signature) {
+  signature->push_back(dims.size());
+  for (int i = 0; i < dims.size(); ++i) {
+    signature->push_back(dims[i]);
+  }
+}
+
+// Get the signature of the inputs which decides the result of InferShape,
+// returns false if any input is of the type that can not be cached.
+static bool GetInferShapeSignature(const VariableValueMap& inputs,
+                                   std::vector<int64_t>* signature) {
+  signature->clear();
+  for (auto& pair : inputs) {
+    signature->push_back(pair.second.size());
+    for (auto* var : pair.second) {
+      if (var == nullptr || !var->IsInitialized()) {
+        signature->push_back(-1);
+      } else if (var->IsType<LoDTensor>()) {
+        auto& tensor = var->Get<LoDTensor>();
+        signature->push_back(static_cast<int64_t>(proto::VarType::LOD_TENSOR));
+        signature->push_back(static_cast<int64_t>(tensor.layout()));
+        AppendDims(tensor.dims(), signature);
+        auto& lod = tensor.lod();
+        signature->push_back(lod.size());
+        for (auto& level : lod) {
+          signature->push_back(level.size());
+          signature->insert(signature->end(), level.begin(), level.end());
+        }
+      } else if (var->IsType<SelectedRows>()) {
+        auto& selected_rows = var->Get<SelectedRows>();
+        signature->push_back(
+            static_cast<int64_t>(proto::VarType::SELECTED_ROWS));
+        signature->push_back(selected_rows.height());
+        AppendDims(selected_rows.value().dims(), signature);
+      } else {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void OperatorWithKernel::CachedInferShape(const Scope& scope,
+                                          const RuntimeContext& ctx) const {
+  RuntimeInferShapeContext infer_shape_ctx(*this, scope, ctx);
+  std::lock_guard<std::mutex> lock(infer_shape_cache_mutex_);
+  if (infer_shape_cache_ == nullptr) {
+    infer_shape_cache_.reset(new InferShapeCache());
+  }
+  auto* cache = infer_shape_cache_.get();
+  if (cache->cacheable &&
+      !GetInferShapeSignature(ctx.inputs, &cache->new_signature)) {
+    VLOG(3) << "InferShape of " << type_ << " is not cached for its inputs.";
+    cache->cacheable = false;
+  }
+  if (!cache->cacheable) {
+    this->InferShape(&infer_shape_ctx);
+    return;
+  }
+  if (cache->valid && cache->new_signature == cache->signature &&
+      cache->Replay(ctx.outputs)) {
+    platform::RecordInferShapeCacheAccess(true);
+    return;
+  }
+  platform::RecordInferShapeCacheAccess(false);
+  cache->valid = false;
+  cache->outputs.clear();
+  infer_shape_ctx.SetInferShapeCache(cache);
+  this->InferShape(&infer_shape_ctx);
+  if (cache->cacheable) {
+    cache->signature.swap(cache->new_signature);
+    cache->valid = true;
+  } else {
+    VLOG(3) << "InferShape of " << type_ << " is not cached.";
+  }
+}
+
 static void CheckTensorNANOrInf(const std::string& op_type,
                                 const std::string& name,
                                 const framework::Tensor& tensor) {
@@ -867,6 +1024,8 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   if (!all_kernels_must_compute_runtime_shape_ &&
       HasAttr(kAllKernelsMustComputeRuntimeShape))
     all_kernels_must_compute_runtime_shape_ = true;
+  if (!enable_cache_infer_shape_ && HasAttr(kEnableCacheInferShape))
+    enable_cache_infer_shape_ = true;
   if (!enable_cache_runtime_context_) {
     RuntimeContext ctx(Inputs(), Outputs(), scope);
     RunImpl(scope, place, &ctx);
@@ -909,8 +1068,13 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   }
 
   if (!all_kernels_must_compute_runtime_shape_) {
-    RuntimeInferShapeContext infer_shape_ctx(*this, exec_scope, *runtime_ctx);
-    this->InferShape(&infer_shape_ctx);
+    if (enable_cache_infer_shape_) {
+      CachedInferShape(exec_scope, *runtime_ctx);
+    } else {
+      RuntimeInferShapeContext infer_shape_ctx(*this, exec_scope,
+                                               *runtime_ctx);
+      this->InferShape(&infer_shape_ctx);
+    }
   }
   // TODO(panyx0718): ExecutionContext should only depend on RuntimeContext
   // not Scope. Imperative mode only pass inputs and get outputs.
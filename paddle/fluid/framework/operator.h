@@ -81,6 +81,14 @@ constexpr char kEnableCacheRuntimeContext[] = "@ENABLE_CACHE_RUNTIME_CONTEXT@";
 constexpr char kAllKernelsMustComputeRuntimeShape[] =
     "@ALL_KERNELS_MUST_COMPUTE_RUNTIME_SHAPE@";
 
+/// If an Op has attribute kEnableCacheInferShape, the dims, LoD and layout
+/// set by its runtime InferShape are cached with the signature of its inputs,
+/// i.e. their types, dims, LoD and layouts. When the inputs of the next run
+/// have the same signature, the cached outputs are set without calling
+/// InferShape. The Ops whose InferShape visits the variables directly are
+/// never cached.
+constexpr char kEnableCacheInferShape[] = "@ENABLE_CACHE_INFER_SHAPE@";
+
 // define some kernel priority
 /* Define multiple kernel type fallback order*/
 extern std::vector<std::tuple<platform::Place, LibraryType>> kKernelPriority;
@@ -428,6 +436,40 @@ class OpKernel : public OpKernelBase {
   using ELEMENT_TYPE = T;
 };
 
+/// The outputs set by the last runtime InferShape of an operator and the
+/// signature of the inputs it ran on, see kEnableCacheInferShape.
+struct InferShapeCache {
+  struct Output {
+    std::string name;
+    size_t index;
+    bool is_selected_rows{false};
+    bool has_dims{false};
+    DDim dims;
+    bool has_lod{false};
+    LoD lod;
+    bool has_layout{false};
+    DataLayout layout{DataLayout::kAnyLayout};
+  };
+
+  void RecordDims(const std::string& name, size_t index, const Variable& var,
+                  const DDim& dims);
+  void RecordLoD(const std::string& name, size_t index, const LoD& lod,
+                 bool has_layout, DataLayout layout);
+  // Sets the recorded outputs to the variables in outputs, returns false if
+  // any of them is missing or not of the recorded type.
+  bool Replay(const VariableValueMap& outputs) const;
+
+  bool cacheable{true};
+  bool valid{false};
+  std::vector<int64_t> signature;
+  // The signature of the inputs of the current run.
+  std::vector<int64_t> new_signature;
+  std::vector<Output> outputs;
+
+ private:
+  Output* GetOutput(const std::string& name, size_t index);
+};
+
 class OperatorWithKernel : public OperatorBase {
  public:
   using OpKernelFunc = std::function<void(const ExecutionContext&)>;
@@ -495,6 +537,8 @@ class OperatorWithKernel : public OperatorBase {
   void ChooseKernel(const RuntimeContext& ctx, const Scope& scope,
                     const platform::Place& place) const;
 
+  void CachedInferShape(const Scope& scope, const RuntimeContext& ctx) const;
+
  protected:
   mutable OpKernelConfigsMap kernel_configs_map_;
   mutable std::unique_ptr<OpKernelType> kernel_type_;
@@ -505,6 +549,9 @@ class OperatorWithKernel : public OperatorBase {
   mutable bool all_kernels_must_compute_runtime_shape_ = false;
   mutable std::mutex cache_update_mutex_;
   mutable bool enable_cache_transfer_scope_ = false;
+  mutable bool enable_cache_infer_shape_ = false;
+  mutable std::unique_ptr<InferShapeCache> infer_shape_cache_;
+  mutable std::mutex infer_shape_cache_mutex_;
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
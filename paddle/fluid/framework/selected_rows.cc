@@ -17,6 +17,9 @@ limitations under the License. */
 namespace paddle {
 namespace framework {
 
+constexpr int64_t SelectedRows::kMinGrownChunkRows;
+constexpr int SelectedRows::kMaxGrownChunks;
+
 struct ReAllocateVisitor {
   ReAllocateVisitor(const framework::DDim& dims, framework::Tensor* tensor)
       : dims_(dims), tensor_(tensor) {}
@@ -38,31 +41,6 @@ struct ReAllocateVisitor {
   framework::Tensor* tensor_;
 };
 
-struct TensorCopyVisitor {
-  TensorCopyVisitor(framework::Tensor* dst, int64_t dst_offset,
-                    const framework::Tensor src, int64_t src_offset,
-                    int64_t size)
-      : dst_(dst),
-        dst_offset_(dst_offset),
-        src_(src),
-        src_offset_(src_offset),
-        size_(size) {}
-
-  template <typename T>
-  void apply() const {
-    // TODO(Yancey1989): support other place
-    platform::CPUPlace cpu;
-    memory::Copy(cpu, dst_->mutable_data<T>(cpu) + dst_offset_, cpu,
-                 src_.data<T>() + src_offset_, size_ * sizeof(T));
-  }
-
-  framework::Tensor* dst_;
-  int64_t dst_offset_;
-  framework::Tensor src_;
-  int64_t src_offset_;
-  int64_t size_;
-};
-
 struct TensorFillVisitor {
   TensorFillVisitor(framework::Tensor* dst, int64_t dst_offset, int64_t size,
                     float value)
@@ -83,6 +61,85 @@ struct TensorFillVisitor {
   int64_t size_;
 };
 
+struct TensorGatherVisitor {
+  TensorGatherVisitor(framework::Tensor* dst, const SelectedRows& src,
+                      const std::vector<int64_t>& indexes, int64_t width)
+      : dst_(dst), src_(src), indexes_(indexes), width_(width) {}
+
+  template <typename T>
+  void apply() const {
+    // TODO(Yancey1989): support other place
+    platform::CPUPlace cpu;
+    auto* dst_data = dst_->mutable_data<T>(cpu);
+    for (size_t i = 0; i < indexes_.size(); ++i) {
+      auto* dst_row = dst_data + i * width_;
+      if (indexes_[i] < 0) {
+        VLOG(5) << "the " << i << "th id is not in the table, return 0";
+        std::fill(dst_row, dst_row + width_, static_cast<T>(0));
+      } else {
+        const auto* src_row = src_.RowData<T>(indexes_[i]);
+        std::copy(src_row, src_row + width_, dst_row);
+      }
+    }
+  }
+
+  framework::Tensor* dst_;
+  const SelectedRows& src_;
+  const std::vector<int64_t>& indexes_;
+  int64_t width_;
+};
+
+struct CompleteValueVisitor {
+  CompleteValueVisitor(const SelectedRows& src, framework::Tensor* dst)
+      : src_(src), dst_(dst) {}
+
+  template <typename T>
+  void apply() const {
+    platform::CPUPlace cpu;
+    int64_t row_num = dst_->dims()[0];
+    int64_t width = dst_->numel() / row_num;
+    auto* dst_data = dst_->mutable_data<T>(cpu);
+    // The rows in value are continuous.
+    int64_t capacity = src_.value().dims()[0];
+    if (capacity > 0) {
+      const auto* src_data = src_.value().data<T>();
+      std::copy(src_data, src_data + capacity * width, dst_data);
+    }
+    for (int64_t i = capacity; i < row_num; ++i) {
+      const auto* src_row = src_.RowData<T>(i);
+      std::copy(src_row, src_row + width, dst_data + i * width);
+    }
+  }
+
+  const SelectedRows& src_;
+  framework::Tensor* dst_;
+};
+
+// The chunks of base rows are of base, base, 2 * base, 4 * base, ... rows,
+// so the chunk k > 0 holds the rows [base << (k - 1), base << k).
+static inline int GrownChunkIdx(int64_t i, int64_t base, int64_t* row) {
+  if (i < base) {
+    *row = i;
+    return 0;
+  }
+  int k = 0;
+  for (int64_t q = i / base; q > 1; q >>= 1) {
+    ++k;
+  }
+  *row = i - (base << k);
+  return k + 1;
+}
+
+static inline int64_t GrownChunkRows(int k, int64_t base) {
+  return k == 0 ? base : base << (k - 1);
+}
+
+// The value chunks start with at least the capacity of value, so that a
+// large table grows in large chunks.
+static inline int64_t GrownValueChunkBase(const Tensor& value) {
+  return std::max(value.dims()[0], SelectedRows::kMinGrownChunkRows);
+}
+
 void SerializeToStream(std::ostream& os, const SelectedRows& selected_rows,
                        const platform::DeviceContext& dev_ctx) {
   {  // the 1st field, uint32_t version
@@ -104,7 +161,13 @@ void SerializeToStream(std::ostream& os, const SelectedRows& selected_rows,
     os.write(reinterpret_cast<const char*>(&height), sizeof(height));
   }
   // the 4st field, Tensor data
-  TensorToStream(os, selected_rows.value(), dev_ctx);
+  if (selected_rows.HasGrownValue()) {
+    framework::Tensor value;
+    selected_rows.GetCompleteValue(&value);
+    TensorToStream(os, value, dev_ctx);
+  } else {
+    TensorToStream(os, selected_rows.value(), dev_ctx);
+  }
 }
 
 void DeserializeFromStream(std::istream& is, SelectedRows* selected_rows,
@@ -135,70 +198,215 @@ void DeserializeFromStream(std::istream& is, SelectedRows* selected_rows,
   TensorFromStream(is, selected_rows->mutable_value(), dev_ctx);
 }
 
+SelectedRows::GrownRows::GrownRows(size_t size) {
+  for (int k = 0; k < kMaxGrownChunks; ++k) {
+    key_chunks_[k].store(nullptr, std::memory_order_relaxed);
+    value_chunks_[k].store(nullptr, std::memory_order_relaxed);
+  }
+  Reset(size);
+}
+
+SelectedRows::GrownRows::~GrownRows() { Reset(0); }
+
+void SelectedRows::GrownRows::Reset(size_t size) {
+  for (int k = 0; k < kMaxGrownChunks; ++k) {
+    delete[] key_chunks_[k].exchange(nullptr, std::memory_order_relaxed);
+    delete value_chunks_[k].exchange(nullptr, std::memory_order_relaxed);
+  }
+  next_index_.store(static_cast<int64_t>(size), std::memory_order_relaxed);
+  synced_.store(static_cast<int64_t>(size), std::memory_order_release);
+}
+
+const Tensor* SelectedRows::ValueChunk(int64_t index, int64_t* row) const {
+  int64_t capacity = value_->dims()[0];
+  if (index < capacity) {
+    *row = index;
+    return value_.get();
+  }
+  int k = GrownChunkIdx(index - capacity, GrownValueChunkBase(*value_), row);
+  PADDLE_ENFORCE_LT(k, kMaxGrownChunks, "row %d is not in the table", index);
+  const Tensor* chunk = grown_->value_chunks_[k].load(std::memory_order_acquire);
+  PADDLE_ENFORCE_NOT_NULL(chunk, "row %d is not in the table", index);
+  return chunk;
+}
+
+void SelectedRows::AddGrownRow(int64_t key, int64_t index) {
+  int64_t key_row;
+  int key_k = GrownChunkIdx(index, kMinGrownChunkRows, &key_row);
+  PADDLE_ENFORCE_LT(key_k, kMaxGrownChunks,
+                    "selected rows is full, then length exceed %d", index);
+  int64_t capacity = value_->dims()[0];
+  int64_t value_base = GrownValueChunkBase(*value_);
+  int64_t value_row = 0;
+  int value_k = index < capacity
+                    ? -1
+                    : GrownChunkIdx(index - capacity, value_base, &value_row);
+  PADDLE_ENFORCE_LT(value_k, kMaxGrownChunks,
+                    "selected rows is full, then length exceed %d", index);
+
+  GrownKey* keys = grown_->key_chunks_[key_k].load(std::memory_order_acquire);
+  bool has_value_chunk =
+      value_k < 0 ||
+      grown_->value_chunks_[value_k].load(std::memory_order_acquire) !=
+          nullptr;
+  if (keys == nullptr || !has_value_chunk) {
+    // Only the allocation of the chunks is serialized, the other threads
+    // adding the rows in the existing chunks go on.
+    AutoWRLock guard(rwlock_.get());
+    keys = grown_->key_chunks_[key_k].load(std::memory_order_relaxed);
+    if (keys == nullptr) {
+      keys = new GrownKey[GrownChunkRows(key_k, kMinGrownChunkRows)]();
+      grown_->key_chunks_[key_k].store(keys, std::memory_order_release);
+    }
+    if (value_k >= 0 &&
+        grown_->value_chunks_[value_k].load(std::memory_order_relaxed) ==
+            nullptr) {
+      PADDLE_ENFORCE(value_->IsInitialized(),
+                     "The value of auto grown SelectedRows should be "
+                     "initialized.");
+      auto dims = value_->dims();
+      dims[0] = GrownChunkRows(value_k, value_base);
+      VLOG(3) << "grow the value of SelectedRows by " << dims[0] << " rows";
+      std::unique_ptr<Tensor> chunk(new Tensor(value_->type()));
+      chunk->Resize(dims);
+      framework::VisitDataType(
+          value_->type(), TensorFillVisitor(chunk.get(), 0, chunk->numel(), 0));
+      grown_->value_chunks_[value_k].store(chunk.release(),
+                                           std::memory_order_release);
+    }
+  }
+  keys[key_row].key_ = key;
+  keys[key_row].ready_.store(true, std::memory_order_release);
+}
+
+void SelectedRows::AppendGrownRows() const {
+  AutoWRLock guard(rwlock_.get());
+  int64_t synced = grown_->synced_.load(std::memory_order_relaxed);
+  PADDLE_ENFORCE_EQ(static_cast<int64_t>(rows_.size()), synced,
+                    "The rows of auto grown SelectedRows are changed without "
+                    "SyncIndex");
+  int64_t next_index = grown_->next_index_.load(std::memory_order_acquire);
+  // Only the rows whose keys are written are appended, the others are
+  // appended by the next call.
+  for (; synced < next_index; ++synced) {
+    int64_t row;
+    int k = GrownChunkIdx(synced, kMinGrownChunkRows, &row);
+    GrownKey* keys = grown_->key_chunks_[k].load(std::memory_order_acquire);
+    if (keys == nullptr || !keys[row].ready_.load(std::memory_order_acquire)) {
+      break;
+    }
+    rows_.push_back(keys[row].key_);
+  }
+  grown_->synced_.store(synced, std::memory_order_release);
+}
+
+bool SelectedRows::HasGrownValue() const {
+  for (int k = 0; k < kMaxGrownChunks; ++k) {
+    if (grown_->value_chunks_[k].load(std::memory_order_acquire) != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SelectedRows::GetCompleteValue(framework::Tensor* value) const {
+  auto dims = value_->dims();
+  dims[0] = std::max(dims[0], static_cast<int64_t>(rows().size()));
+  value->Resize(dims);
+  framework::VisitDataType(value_->type(), CompleteValueVisitor(*this, value));
+}
+
 bool SelectedRows::HasKey(int64_t key) const {
+  SyncGrownRows();
   return std::find(rows_.begin(), rows_.end(), key) == rows_.end() ? false
                                                                    : true;
 }
 
+void SelectedRows::BatchIndex(const int64_t* keys, int64_t n,
+                              int64_t* indexes) const {
+  SyncGrownRows();
+  if (id_to_index_->Size() == rows_.size()) {
+    id_to_index_->BatchFind(keys, n, indexes);
+    // id_to_index_ is not updated by set_rows or mutable_rows, so check the
+    // found indexes against rows.
+    bool in_sync = true;
+    for (int64_t i = 0; i < n && in_sync; ++i) {
+      in_sync = indexes[i] < 0 ||
+                (static_cast<size_t>(indexes[i]) < rows_.size() &&
+                 rows_[indexes[i]] == keys[i]);
+    }
+    if (in_sync) {
+      return;
+    }
+  }
+  // rows can be duplicate, keep the first index of the key as Index does.
+  std::unordered_map<int64_t, int64_t> index_map(rows_.size());
+  for (size_t i = 0; i < rows_.size(); ++i) {
+    index_map.emplace(rows_[i], static_cast<int64_t>(i));
+  }
+  for (int64_t i = 0; i < n; ++i) {
+    auto it = index_map.find(keys[i]);
+    indexes[i] = it == index_map.end() ? -1 : it->second;
+  }
+}
+
 int64_t SelectedRows::AutoGrownIndex(int64_t key, bool auto_grown,
                                      bool is_test) {
+  int64_t index;
+  BatchAutoGrownIndex(&key, 1, &index, auto_grown, is_test);
+  return index;
+}
+
+void SelectedRows::BatchAutoGrownIndex(const int64_t* keys, int64_t n,
+                                       int64_t* indexes, bool auto_grown,
+                                       bool is_test) {
+  id_to_index_->BatchFind(keys, n, indexes);
   if (is_test) {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
-      return -1;
-    } else {
-      return iter->second;
-    }
+    return;
   }
 
-  rwlock_->RDLock();
-  auto iter = id_to_index_.find(key);
-  if (iter == id_to_index_.end()) {
-    rwlock_->UNLock();
-    if (!auto_grown) {
-      PADDLE_THROW("key %d not found", key);
+  std::vector<int64_t> missing;
+  std::vector<int64_t> missing_keys;
+  for (int64_t i = 0; i < n; ++i) {
+    if (indexes[i] < 0) {
+      missing.push_back(i);
+      missing_keys.push_back(keys[i]);
     }
-    rwlock_->WRLock();
-    auto map_size = id_to_index_.size();
-    auto vector_size = rows_.size();
-    if (map_size != vector_size) {
-      rwlock_->UNLock();
-      PADDLE_THROW(
-          "id_to_index_ size %d should have the same size with rows_ %d",
-          map_size, vector_size);
-    }
-    auto write_iter = id_to_index_.find(key);
-    if (write_iter == id_to_index_.end()) {
-      int row_num = rows_.size();
-      if (row_num == value_->dims()[0]) {
-        rwlock_->UNLock();
-        PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
-      }
-      // key logic to put a key into id_to_index_
-      rows_.push_back(key);
-      auto index = static_cast<int64_t>(rows_.size() - 1);
-      id_to_index_[key] = index;
-      rwlock_->UNLock();
-      return index;
-    } else {
-      auto index = write_iter->second;
-      rwlock_->UNLock();
-      return index;
-    }
-  } else {
-    auto index = iter->second;
-    rwlock_->UNLock();
-    return index;
+  }
+  if (missing.empty()) {
+    return;
+  }
+  if (!auto_grown) {
+    PADDLE_THROW("key %d not found", missing_keys[0]);
+  }
+
+  // key logic to put the keys into id_to_index_, the keys may be added by
+  // other threads after BatchFind, and the new rows take the indexes from
+  // next_index_ with the locks of their shards held.
+  std::vector<int64_t> missing_indexes(missing.size());
+  id_to_index_->BatchFindOrInsert(
+      missing_keys.data(), missing_keys.size(), &grown_->next_index_,
+      missing_indexes.data(),
+      [this](int64_t key, int64_t index) { AddGrownRow(key, index); });
+  for (size_t i = 0; i < missing.size(); ++i) {
+    indexes[missing[i]] = missing_indexes[i];
   }
 }
 
 void SelectedRows::SyncIndex() {
-  rwlock_->WRLock();
-  id_to_index_.clear();
+  SyncGrownRows();
+  if (HasGrownValue()) {
+    // Move the grown chunks into value, since they are freed by Reset.
+    framework::Tensor value;
+    GetCompleteValue(&value);
+    value_->ShareDataWith(value);
+  }
+  id_to_index_->Clear();
   for (size_t i = 0; i < rows_.size(); ++i) {
-    id_to_index_[rows_[i]] = i;
+    id_to_index_->Set(rows_[i], i);
   }
-  rwlock_->UNLock();
+  AutoWRLock guard(rwlock_.get());
+  grown_->Reset(rows_.size());
 }
 
 void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
@@ -208,25 +416,18 @@ void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
   if (ids.numel() == 0) {
     VLOG(3) << "keys is empty, please check data!";
   } else {
-    int64_t value_width = value_->numel() / value_->dims()[0];
+    int64_t value_width =
+        framework::product(framework::slice_ddim(value_->dims(), 1,
+                                                 value_->dims().size()));
     PADDLE_ENFORCE_EQ(value_width, value->numel() / value->dims()[0],
                       "output tensor should have the same shape with table "
                       "except the dims[0].");
-    for (int i = 0; i < ids.numel(); ++i) {
-      auto id = ids.data<int64_t>()[i];
-      int64_t index = AutoGrownIndex(id, auto_grown, is_test);
-      if (index < 0) {
-        VLOG(5) << "id " << id << " not in the table, return 0";
-        framework::VisitDataType(
-            value_->type(),
-            TensorFillVisitor(value, i * value_width, value_width, 0.0));
-      } else {
-        framework::VisitDataType(
-            value_->type(),
-            TensorCopyVisitor(value, i * value_width, *value_.get(),
-                              index * value_width, value_width));
-      }
-    }
+    std::vector<int64_t> indexes(ids.numel());
+    BatchAutoGrownIndex(ids.data<int64_t>(), ids.numel(), indexes.data(),
+                        auto_grown, is_test);
+    framework::VisitDataType(
+        value_->type(),
+        TensorGatherVisitor(value, *this, indexes, value_width));
   }
 }
 
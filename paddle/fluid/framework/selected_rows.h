@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
@@ -23,6 +24,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/rw_lock.h"
+#include "paddle/fluid/framework/sharded_id_index.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/memory/memcpy.h"
 
@@ -50,12 +52,16 @@ class SelectedRows {
       : rows_(rows), height_(height) {
     value_.reset(new Tensor());
     rwlock_.reset(new RWLock);
+    id_to_index_.reset(new ShardedIdIndex);
+    grown_.reset(new GrownRows(rows_.size()));
   }
 
   SelectedRows() {
     height_ = 0;
     value_.reset(new Tensor());
     rwlock_.reset(new RWLock);
+    id_to_index_.reset(new ShardedIdIndex);
+    grown_.reset(new GrownRows(0));
   }
 
   platform::Place place() const { return value_->place(); }
@@ -68,11 +74,53 @@ class SelectedRows {
 
   void set_height(int64_t height) { height_ = height; }
 
-  const Vector<int64_t>& rows() const { return rows_; }
+  const Vector<int64_t>& rows() const {
+    SyncGrownRows();
+    return rows_;
+  }
+
+  Vector<int64_t>* mutable_rows() {
+    SyncGrownRows();
+    return &rows_;
+  }
+
+  void set_rows(const Vector<int64_t>& rows) {
+    rows_ = rows;
+    grown_->Reset(rows_.size());
+  }
 
-  Vector<int64_t>* mutable_rows() { return &rows_; }
+  /*
+   * @brief Get the data of the row at index of the value. The rows of an
+   * auto grown table beyond value().dims()[0] are kept in the grown chunks
+   * instead of value(), so the rows should be accessed by RowData or
+   * MutableRowData rather than the data of value() after growing.
+   */
+  template <typename T>
+  const T* RowData(int64_t index) const {
+    int64_t row;
+    const Tensor* chunk = ValueChunk(index, &row);
+    return chunk->data<T>() + row * (chunk->numel() / chunk->dims()[0]);
+  }
 
-  void set_rows(const Vector<int64_t>& rows) { rows_ = rows; }
+  template <typename T>
+  T* MutableRowData(int64_t index) {
+    int64_t row;
+    const Tensor* chunk = ValueChunk(index, &row);
+    return const_cast<T*>(chunk->data<T>()) +
+           row * (chunk->numel() / chunk->dims()[0]);
+  }
+
+  /*
+   * @brief Whether some rows of the value are kept in the grown chunks.
+   */
+  bool HasGrownValue() const;
+
+  /*
+   * @brief Copy all the rows of the value, including the ones in the grown
+   * chunks, into value, whose dims[0] is the larger one of
+   * value().dims()[0] and rows().size().
+   */
+  void GetCompleteValue(framework::Tensor* value) const;
 
   /*
    * @brief Get the index of key in rows
@@ -80,6 +128,7 @@ class SelectedRows {
    * @return -1 if the key does not exists.
    */
   int64_t Index(int64_t key) const {
+    SyncGrownRows();
     auto it = std::find(rows_.begin(), rows_.end(), key);
     if (it == rows_.end()) {
       PADDLE_THROW("id %s not in table", key);
@@ -87,6 +136,17 @@ class SelectedRows {
     return static_cast<int64_t>(std::distance(rows_.begin(), it));
   }
 
+  /*
+   * @brief The batch version of Index, get the indexes of n keys in rows.
+   * The keys are looked up in id_to_index_ when it is in sync with rows,
+   * and a key missing in it is missing in rows too. Otherwise they are
+   * looked up in a hash map built from rows once for the whole batch, so it
+   * costs O(rows + n) instead of O(rows * n).
+   *
+   * The index of a missing key is -1.
+   */
+  void BatchIndex(const int64_t* keys, int64_t n, int64_t* indexes) const;
+
   /*
    * @brief whether has the specified key in the table.
    *
@@ -119,19 +179,37 @@ class SelectedRows {
    */
   int64_t AutoGrownIndex(int64_t key, bool auto_grown, bool is_test = false);
 
+  /*
+   * @brief The batch version of AutoGrownIndex, get the indexes of n keys.
+   * The keys are looked up and the missing keys are added with one lock per
+   * shard of id_to_index_. The rows of the keys beyond value().dims()[0] are
+   * kept in the grown chunks, which are zero initialized and never moved,
+   * so the optimizers can write the rows without lock.
+   *
+   * The index of a missing key is -1 if is_test is true.
+   */
+  void BatchAutoGrownIndex(const int64_t* keys, int64_t n, int64_t* indexes,
+                           bool auto_grown, bool is_test = false);
+
   /*
    * @brief Get the index of the key from id_to_index_ map.
    */
-  inline int64_t GetIndexFromId(int64_t key) {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
-      return -1;
-    } else {
-      return iter->second;
-    }
+  inline int64_t GetIndexFromId(int64_t key) const {
+    return id_to_index_->Find(key);
   }
 
+  /*
+   * @brief Rebuild id_to_index_ from rows, and move the grown chunks into
+   * value. It should be called after the rows of an auto grown table are
+   * changed by set_rows or mutable_rows.
+   */
   void SyncIndex();
+
+  // The grown chunks of the value and the keys start with
+  // kMinGrownChunkRows rows, and double in turn.
+  static constexpr int64_t kMinGrownChunkRows = 1024;
+  static constexpr int kMaxGrownChunks = 48;
+
   /*
    * @brief Get complete Dims before
    */
@@ -142,15 +220,61 @@ class SelectedRows {
   }
 
  private:
+  struct GrownKey {
+    int64_t key_;
+    // Set after key_ is written.
+    std::atomic<bool> ready_;
+  };
+
+  // The rows added by AutoGrownIndex. The key of every added row is kept in
+  // the key chunks until it is appended to rows_ by SyncGrownRows, and the
+  // rows beyond the capacity of value_ are kept in the value chunks. The
+  // chunks are allocated with rwlock_ held, and are never moved until Reset.
+  struct GrownRows {
+    explicit GrownRows(size_t size);
+    ~GrownRows();
+
+    // Frees the chunks, and restarts the indexes of the added rows from size.
+    void Reset(size_t size);
+
+    // The index of the next added row.
+    std::atomic<int64_t> next_index_;
+    // The number of rows in rows_.
+    std::atomic<int64_t> synced_;
+    std::atomic<GrownKey*> key_chunks_[kMaxGrownChunks];
+    std::atomic<Tensor*> value_chunks_[kMaxGrownChunks];
+  };
+
+  // Returns the tensor holding the row at index of the value, and the row in
+  // it.
+  const Tensor* ValueChunk(int64_t index, int64_t* row) const;
+
+  // Records the key of the row added at index, and allocates the chunks of
+  // the row if they do not exist. It is called with the lock of the shard of
+  // the key held.
+  void AddGrownRow(int64_t key, int64_t index);
+
+  // Appends the keys of the added rows to rows_.
+  inline void SyncGrownRows() const {
+    if (grown_->synced_.load(std::memory_order_acquire) <
+        grown_->next_index_.load(std::memory_order_acquire)) {
+      AppendGrownRows();
+    }
+  }
+  void AppendGrownRows() const;
+
   // Notice: rows can be duplicate. We can have {0, 4, 7, 0, 5, 7, 9} here.
   // SelectedRows are simply concated when adding together. Until a
   // SelectedRows add a Tensor, will the duplicate rows be handled.
-  Vector<int64_t> rows_;
-  std::unordered_map<int64_t, int64_t>
-      id_to_index_;  // should not be used when rows_ has duplicate member
+  // The keys added by AutoGrownIndex are appended lazily by SyncGrownRows.
+  mutable Vector<int64_t> rows_;
+  // should not be used when rows_ has duplicate member
+  std::unique_ptr<ShardedIdIndex> id_to_index_{nullptr};
   std::unique_ptr<Tensor> value_{nullptr};
   int64_t height_;  // height indicates the underline tensor's height
+  // Held when allocating the grown chunks or appending the grown rows.
   std::unique_ptr<RWLock> rwlock_{nullptr};
+  std::unique_ptr<GrownRows> grown_{nullptr};
 };
 
 /*
@@ -69,6 +69,23 @@ TEST_F(SelectedRowsTester, SerializeAndDeseralize) {
   }
 }
 
+TEST_F(SelectedRowsTester, BatchIndex) {
+  std::vector<int64_t> keys{7, 0, 5, 4};
+  std::vector<int64_t> indexes(keys.size());
+  // id_to_index_ is empty, the indexes are found in rows
+  selected_rows_->BatchIndex(keys.data(), keys.size(), indexes.data());
+  ASSERT_EQ(indexes, std::vector<int64_t>({2, 0, -1, 1}));
+
+  selected_rows_->SyncIndex();
+  selected_rows_->BatchIndex(keys.data(), keys.size(), indexes.data());
+  ASSERT_EQ(indexes, std::vector<int64_t>({2, 0, -1, 1}));
+
+  // id_to_index_ is stale after set_rows
+  selected_rows_->set_rows({5, 7, 0});
+  selected_rows_->BatchIndex(keys.data(), keys.size(), indexes.data());
+  ASSERT_EQ(indexes, std::vector<int64_t>({1, 2, 0, -1}));
+}
+
 TEST(SelectedRows, SparseTable) {
   platform::CPUPlace cpu;
   SelectedRows table;
@@ -124,6 +141,120 @@ TEST(SelectedRows, SparseTable) {
   }
 }
 
+TEST(SelectedRows, AutoGrownValue) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+
+  int64_t table_size = 4;
+  int64_t embedding_width = 8;
+  auto* data = table.mutable_value()->mutable_data<float>(
+      framework::make_ddim({table_size, embedding_width}), cpu);
+  for (int64_t i = 0; i < table_size * embedding_width; ++i) {
+    data[i] = 1.0f;
+  }
+
+  // the keys take the indexes in their order, and grow out of the value
+  int64_t key_num = 3000;
+  framework::Tensor ids;
+  auto* ids_data =
+      ids.mutable_data<int64_t>(framework::make_ddim({key_num}), cpu);
+  for (int64_t i = 0; i < key_num; ++i) {
+    ids_data[i] = i * 100;
+  }
+  framework::Tensor get_value;
+  auto* value_data = get_value.mutable_data<float>(
+      framework::make_ddim({key_num, embedding_width}), cpu);
+  table.Get(ids, &get_value, true);
+
+  // the value is not reallocated, the new rows are zero initialized
+  ASSERT_EQ(table.value().data<float>(), data);
+  ASSERT_EQ(table.value().dims()[0], table_size);
+  ASSERT_TRUE(table.HasGrownValue());
+  ASSERT_EQ(table.rows().size(), static_cast<size_t>(key_num));
+  for (int64_t i = 0; i < key_num; ++i) {
+    ASSERT_EQ(table.GetIndexFromId(i * 100), i);
+    ASSERT_EQ(table.rows()[i], i * 100);
+    float expected = i < table_size ? 1.0f : 0.0f;
+    for (int64_t j = 0; j < embedding_width; ++j) {
+      ASSERT_EQ(value_data[i * embedding_width + j], expected);
+    }
+  }
+
+  // the grown rows are written and read by their data
+  for (int64_t i = 0; i < key_num; ++i) {
+    auto* row = table.MutableRowData<float>(i);
+    for (int64_t j = 0; j < embedding_width; ++j) {
+      row[j] = static_cast<float>(i);
+    }
+  }
+  table.Get(ids, &get_value);
+  for (int64_t i = 0; i < key_num * embedding_width; ++i) {
+    ASSERT_EQ(value_data[i], static_cast<float>(i / embedding_width));
+  }
+
+  // the grown rows are serialized with the value
+  SelectedRows dst_table;
+  platform::CPUDeviceContext cpu_ctx(cpu);
+  std::ostringstream oss;
+  SerializeToStream(oss, table, cpu_ctx);
+  std::istringstream iss(oss.str());
+  DeserializeFromStream(iss, &dst_table, cpu_ctx);
+  dst_table.SyncIndex();
+  ASSERT_EQ(dst_table.rows(), table.rows());
+  ASSERT_EQ(dst_table.value().dims()[0], key_num);
+  ASSERT_FALSE(dst_table.HasGrownValue());
+
+  // SyncIndex moves the grown rows into the value
+  table.SyncIndex();
+  ASSERT_FALSE(table.HasGrownValue());
+  ASSERT_EQ(table.value().dims()[0], key_num);
+  for (int64_t i = 0; i < key_num; ++i) {
+    ASSERT_EQ(table.GetIndexFromId(i * 100), i);
+    ASSERT_EQ(dst_table.GetIndexFromId(i * 100), i);
+    ASSERT_EQ(*table.RowData<float>(i), static_cast<float>(i));
+    ASSERT_EQ(*dst_table.RowData<float>(i), static_cast<float>(i));
+  }
+  ASSERT_EQ(table.AutoGrownIndex(-1, true), key_num);
+  ASSERT_EQ(table.rows().size(), static_cast<size_t>(key_num + 1));
+}
+
+TEST(SelectedRows, MultiThreadAutoGrownValue) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+
+  int64_t table_size = 16;
+  int64_t embedding_width = 4;
+  table.mutable_value()->mutable_data<float>(
+      framework::make_ddim({table_size, embedding_width}), cpu);
+
+  // the threads add the keys and write their rows at the same time
+  int64_t key_num = 100000;
+  auto grow = [&](int64_t offset) {
+    for (int64_t i = 0; i < key_num; ++i) {
+      int64_t key = (i + offset) % key_num;
+      int64_t index = table.AutoGrownIndex(key, true);
+      table.MutableRowData<float>(index)[offset % embedding_width] =
+          static_cast<float>(key);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < 4; ++i) {
+    threads.emplace_back(grow, i * 997);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(table.rows().size(), static_cast<size_t>(key_num));
+  for (int64_t i = 0; i < key_num; ++i) {
+    int64_t key = table.rows()[i];
+    ASSERT_EQ(table.GetIndexFromId(key), i);
+    for (int64_t j = 0; j < embedding_width; ++j) {
+      ASSERT_EQ(table.RowData<float>(i)[j], static_cast<float>(key));
+    }
+  }
+}
+
 void f1(SelectedRows* table, int table_size) {
   for (int i = 1000000; i > 0; --i) {
     auto id = i % table_size;
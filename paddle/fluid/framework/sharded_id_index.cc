@@ -0,0 +1,201 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/sharded_id_index.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+// The ids of sparse tables are often continuous or hashed already, so mix the
+// bits to spread them over the shards and slots.
+static inline uint64_t HashId(int64_t id) {
+  uint64_t x = static_cast<uint64_t>(id);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+static constexpr size_t kInitShardCapacity = 16;
+
+ShardedIdIndex::Shard::Shard(size_t shift)
+    : slots_(kInitShardCapacity, Slot{0, -1}), size_(0), shift_(shift) {}
+
+int64_t ShardedIdIndex::Shard::Find(int64_t id, uint64_t hash) const {
+  size_t mask = slots_.size() - 1;
+  for (size_t i = (hash >> shift_) & mask;; i = (i + 1) & mask) {
+    const Slot& slot = slots_[i];
+    if (slot.index_ < 0) return -1;
+    if (slot.id_ == id) return slot.index_;
+  }
+}
+
+ShardedIdIndex::Slot* ShardedIdIndex::Shard::FindSlot(int64_t id,
+                                                      uint64_t hash) {
+  // Keep the load factor no more than 0.5, so that there is always an empty
+  // slot to stop the probing.
+  if ((size_ + 1) * 2 > slots_.size()) {
+    Rehash(slots_.size() * 2);
+  }
+  size_t mask = slots_.size() - 1;
+  for (size_t i = (hash >> shift_) & mask;; i = (i + 1) & mask) {
+    Slot* slot = &slots_[i];
+    if (slot->index_ < 0 || slot->id_ == id) return slot;
+  }
+}
+
+void ShardedIdIndex::Shard::Rehash(size_t capacity) {
+  std::vector<Slot> old_slots(capacity, Slot{0, -1});
+  old_slots.swap(slots_);
+  size_t mask = capacity - 1;
+  for (auto& old_slot : old_slots) {
+    if (old_slot.index_ < 0) continue;
+    size_t i = (HashId(old_slot.id_) >> shift_) & mask;
+    while (slots_[i].index_ >= 0) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = old_slot;
+  }
+}
+
+ShardedIdIndex::ShardedIdIndex(size_t shard_num) {
+  PADDLE_ENFORCE(shard_num > 0 && (shard_num & (shard_num - 1)) == 0,
+                 "shard_num must be 2^N, but got %d", shard_num);
+  size_t shard_bits = 0;
+  while ((static_cast<size_t>(1) << shard_bits) < shard_num) ++shard_bits;
+  shards_.reserve(shard_num);
+  for (size_t i = 0; i < shard_num; ++i) {
+    shards_.emplace_back(new Shard(shard_bits));
+  }
+}
+
+int64_t ShardedIdIndex::Find(int64_t id) const {
+  uint64_t hash = HashId(id);
+  auto& shard = *shards_[ShardIdx(hash)];
+  AutoRDLock guard(&shard.lock_);
+  return shard.Find(id, hash);
+}
+
+void ShardedIdIndex::BatchFind(const int64_t* ids, size_t n,
+                               int64_t* indexes) const {
+  if (n == 1) {
+    indexes[0] = Find(ids[0]);
+    return;
+  }
+
+  // Counting sort the positions of ids by shard, so that every shard is
+  // locked only once.
+  size_t shard_num = shards_.size();
+  std::vector<uint64_t> hashes(n);
+  std::vector<size_t> offsets(shard_num + 1, 0);
+  for (size_t i = 0; i < n; ++i) {
+    hashes[i] = HashId(ids[i]);
+    ++offsets[ShardIdx(hashes[i]) + 1];
+  }
+  for (size_t i = 0; i < shard_num; ++i) {
+    offsets[i + 1] += offsets[i];
+  }
+  std::vector<size_t> positions(n);
+  {
+    std::vector<size_t> cursors(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+      positions[cursors[ShardIdx(hashes[i])]++] = i;
+    }
+  }
+
+  for (size_t s = 0; s < shard_num; ++s) {
+    if (offsets[s] == offsets[s + 1]) continue;
+    auto& shard = *shards_[s];
+    AutoRDLock guard(&shard.lock_);
+    for (size_t j = offsets[s]; j < offsets[s + 1]; ++j) {
+      size_t i = positions[j];
+      indexes[i] = shard.Find(ids[i], hashes[i]);
+    }
+  }
+}
+
+void ShardedIdIndex::BatchFindOrInsert(
+    const int64_t* ids, size_t n, std::atomic<int64_t>* next_index,
+    int64_t* indexes,
+    const std::function<void(int64_t, int64_t)>& on_insert) {
+  // The ids are inserted one by one with the lock of their shard, instead of
+  // grouped by shard like BatchFind, so that the ids inserted by one call
+  // take the indexes in their order.
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t hash = HashId(ids[i]);
+    auto& shard = *shards_[ShardIdx(hash)];
+    AutoWRLock guard(&shard.lock_);
+    Slot* slot = shard.FindSlot(ids[i], hash);
+    if (slot->index_ < 0) {
+      // The index is taken only when the id is really inserted, so that the
+      // indexes stay continuous.
+      int64_t index = next_index->fetch_add(1, std::memory_order_relaxed);
+      on_insert(ids[i], index);
+      slot->id_ = ids[i];
+      slot->index_ = index;
+      ++shard.size_;
+      size_.fetch_add(1, std::memory_order_relaxed);
+    }
+    indexes[i] = slot->index_;
+  }
+}
+
+std::pair<int64_t, bool> ShardedIdIndex::Insert(int64_t id, int64_t index) {
+  PADDLE_ENFORCE_GE(index, 0, "index of id %d should not be negative", id);
+  uint64_t hash = HashId(id);
+  auto& shard = *shards_[ShardIdx(hash)];
+  AutoWRLock guard(&shard.lock_);
+  Slot* slot = shard.FindSlot(id, hash);
+  if (slot->index_ >= 0) {
+    return std::make_pair(slot->index_, false);
+  }
+  slot->id_ = id;
+  slot->index_ = index;
+  ++shard.size_;
+  size_.fetch_add(1, std::memory_order_relaxed);
+  return std::make_pair(index, true);
+}
+
+void ShardedIdIndex::Set(int64_t id, int64_t index) {
+  PADDLE_ENFORCE_GE(index, 0, "index of id %d should not be negative", id);
+  uint64_t hash = HashId(id);
+  auto& shard = *shards_[ShardIdx(hash)];
+  AutoWRLock guard(&shard.lock_);
+  Slot* slot = shard.FindSlot(id, hash);
+  if (slot->index_ < 0) {
+    slot->id_ = id;
+    ++shard.size_;
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+  slot->index_ = index;
+}
+
+void ShardedIdIndex::Clear() {
+  for (auto& shard : shards_) {
+    AutoWRLock guard(&shard->lock_);
+    std::vector<Slot>(kInitShardCapacity, Slot{0, -1}).swap(shard->slots_);
+    size_.fetch_sub(shard->size_, std::memory_order_relaxed);
+    shard->size_ = 0;
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
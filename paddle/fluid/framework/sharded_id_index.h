@@ -0,0 +1,119 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/framework/rw_lock.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief A concurrent hash index from int64 ids to int64 row indexes, which
+ * is used by SelectedRows as the id_to_index_ of sparse tables.
+ *
+ * The ids are split into shards by hash, and each shard is an open-addressing
+ * hash table with linear probing guarded by its own RWLock, so that threads
+ * looking up or inserting ids of different shards never contend. The batch
+ * interfaces group the ids by shard and lock each shard only once.
+ *
+ * The indexes should be non-negative, -1 means the id does not exist.
+ */
+class ShardedIdIndex {
+ public:
+  explicit ShardedIdIndex(size_t shard_num = 64);
+
+  /*
+   * @brief Get the index of the id.
+   *
+   * @return -1 if the id does not exist.
+   */
+  int64_t Find(int64_t id) const;
+
+  /*
+   * @brief Get the indexes of n ids, the index of the missing id is -1.
+   */
+  void BatchFind(const int64_t* ids, size_t n, int64_t* indexes) const;
+
+  /*
+   * @brief Insert the id with the index if the id does not exist.
+   *
+   * @return the index of the id, and whether it is inserted.
+   */
+  std::pair<int64_t, bool> Insert(int64_t id, int64_t index);
+
+  /*
+   * @brief Get the indexes of n ids, and insert the missing ids with the
+   * indexes taken from next_index in the order of ids. Every id is inserted
+   * with the lock of its shard only, so the ids of different shards are
+   * inserted in parallel.
+   *
+   * on_insert(id, index) is called for every inserted id with the lock of
+   * its shard held, so it is done before any other thread finds the id.
+   */
+  void BatchFindOrInsert(
+      const int64_t* ids, size_t n, std::atomic<int64_t>* next_index,
+      int64_t* indexes,
+      const std::function<void(int64_t, int64_t)>& on_insert);
+
+  /*
+   * @brief Insert the id or overwrite the index of the id.
+   */
+  void Set(int64_t id, int64_t index);
+
+  void Clear();
+
+  size_t Size() const { return size_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Slot {
+    int64_t id_;
+    int64_t index_;  // -1 if the slot is empty
+  };
+
+  struct Shard {
+    explicit Shard(size_t shift);
+
+    // Should be called with the lock held.
+    int64_t Find(int64_t id, uint64_t hash) const;
+    // Should be called with the write lock held. Returns the slot of the id,
+    // which is an empty slot if the id does not exist.
+    Slot* FindSlot(int64_t id, uint64_t hash);
+    void Rehash(size_t capacity);
+
+    std::vector<Slot> slots_;
+    size_t size_;
+    // The bits of hash used to choose the shard, which should be skipped when
+    // choosing the slot.
+    size_t shift_;
+    mutable RWLock lock_;
+  };
+
+  inline size_t ShardIdx(uint64_t hash) const {
+    return static_cast<size_t>(hash) & (shards_.size() - 1);
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<size_t> size_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
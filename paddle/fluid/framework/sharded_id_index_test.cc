@@ -0,0 +1,120 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/sharded_id_index.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+TEST(ShardedIdIndex, insert_and_find) {
+  ShardedIdIndex index(4);
+  ASSERT_EQ(index.Find(10), -1);
+  ASSERT_EQ(index.Insert(10, 0), std::make_pair(int64_t(0), true));
+  ASSERT_EQ(index.Insert(10, 1), std::make_pair(int64_t(0), false));
+  ASSERT_EQ(index.Insert(-3, 1), std::make_pair(int64_t(1), true));
+  ASSERT_EQ(index.Find(10), 0);
+  ASSERT_EQ(index.Find(-3), 1);
+  ASSERT_EQ(index.Size(), 2UL);
+
+  index.Set(10, 5);
+  ASSERT_EQ(index.Find(10), 5);
+  ASSERT_EQ(index.Size(), 2UL);
+
+  // trigger the rehash of shards
+  for (int64_t i = 0; i < 10000; ++i) {
+    index.Set(i * 7 + 100, i);
+  }
+  std::vector<int64_t> ids, indexes(10002);
+  for (int64_t i = 0; i < 10000; ++i) {
+    ids.push_back(i * 7 + 100);
+  }
+  ids.push_back(-3);
+  ids.push_back(99);
+  index.BatchFind(ids.data(), ids.size(), indexes.data());
+  for (int64_t i = 0; i < 10000; ++i) {
+    ASSERT_EQ(indexes[i], i);
+  }
+  ASSERT_EQ(indexes[10000], 1);
+  ASSERT_EQ(indexes[10001], -1);
+
+  index.Clear();
+  ASSERT_EQ(index.Size(), 0UL);
+  ASSERT_EQ(index.Find(10), -1);
+}
+
+TEST(ShardedIdIndex, multi_thread_insert) {
+  ShardedIdIndex index;
+  const int64_t id_num = 100000;
+  auto insert = [&](int64_t offset) {
+    for (int64_t i = 0; i < id_num; ++i) {
+      int64_t id = (i + offset) % id_num;
+      auto res = index.Insert(id, id);
+      ASSERT_EQ(res.first, id);
+      ASSERT_EQ(index.Find(id), id);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < 8; ++i) {
+    threads.emplace_back(insert, i * 997);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(index.Size(), static_cast<size_t>(id_num));
+}
+
+TEST(ShardedIdIndex, multi_thread_batch_find_or_insert) {
+  ShardedIdIndex index;
+  std::atomic<int64_t> next_index(0);
+  const int64_t id_num = 100000;
+  const int64_t batch_size = 64;
+  std::vector<int64_t> inserted_ids(id_num, -1);
+  auto insert = [&](int64_t offset) {
+    std::vector<int64_t> ids(batch_size), indexes(batch_size);
+    for (int64_t i = 0; i < id_num; i += batch_size) {
+      for (int64_t j = 0; j < batch_size; ++j) {
+        ids[j] = (i + j + offset) % id_num;
+      }
+      index.BatchFindOrInsert(ids.data(), ids.size(), &next_index,
+                              indexes.data(), [&](int64_t id, int64_t idx) {
+                                // the index is taken by only one id
+                                ASSERT_EQ(inserted_ids[idx], -1);
+                                inserted_ids[idx] = id;
+                              });
+      for (int64_t j = 0; j < batch_size; ++j) {
+        ASSERT_EQ(inserted_ids[indexes[j]], ids[j]);
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < 8; ++i) {
+    threads.emplace_back(insert, i * 997);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  // the indexes are continuous
+  ASSERT_EQ(next_index.load(), id_num);
+  ASSERT_EQ(index.Size(), static_cast<size_t>(id_num));
+  for (int64_t i = 0; i < id_num; ++i) {
+    ASSERT_EQ(index.Find(inserted_ids[i]), i);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -381,9 +381,10 @@ void TensorIsfinite(const framework::Tensor& tensor, framework::Tensor* out) {
 }
 
 void TensorToStream(std::ostream& os, const Tensor& tensor,
-                    const platform::DeviceContext& dev_ctx) {
+                    const platform::DeviceContext& dev_ctx,
+                    bool align_payload) {
   {  // the 1st field, uint32_t version
-    constexpr uint32_t version = 0;
+    const uint32_t version = align_payload ? 1 : 0;
     os.write(reinterpret_cast<const char*>(&version), sizeof(version));
   }
   {  // the 2nd field, tensor description
@@ -400,6 +401,19 @@ void TensorToStream(std::ostream& os, const Tensor& tensor,
     auto out = desc.SerializeAsString();
     os.write(out.data(), size);
   }
+  if (align_payload) {  // version 1 only, uint32_t padding size and padding
+    auto pos = os.tellp();
+    PADDLE_ENFORCE(pos != std::streampos(-1),
+                   "The stream should support tellp to align the payload");
+    uint32_t padding = static_cast<uint32_t>(
+        (kTensorPayloadAlignment -
+         (static_cast<uint64_t>(pos) + sizeof(padding)) %
+             kTensorPayloadAlignment) %
+        kTensorPayloadAlignment);
+    os.write(reinterpret_cast<const char*>(&padding), sizeof(padding));
+    const char zeros[kTensorPayloadAlignment] = {0};
+    os.write(zeros, padding);
+  }
   {  // the 3rd field, tensor data
     uint64_t size = tensor.numel() * framework::SizeOfType(tensor.type());
 
@@ -454,7 +468,8 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
                       const platform::DeviceContext& dev_ctx) {
   uint32_t version;
   is.read(reinterpret_cast<char*>(&version), sizeof(version));
-  PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  PADDLE_ENFORCE(version == 0U || version == 1U,
+                 "Only version 0 and 1 are supported");
   proto::VarType::TensorDesc desc;
   {  // int32_t size
      // proto buffer
@@ -465,6 +480,11 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
     PADDLE_ENFORCE(desc.ParseFromArray(buf.get(), size),
                    "Cannot parse tensor desc");
   }
+  if (version == 1U) {  // skip the padding of the aligned payload
+    uint32_t padding;
+    is.read(reinterpret_cast<char*>(&padding), sizeof(padding));
+    is.ignore(padding);
+  }
   {  // read tensor
     std::vector<int64_t> dims;
     dims.reserve(static_cast<size_t>(desc.dims().size()));
@@ -67,8 +67,16 @@ void TensorContainsNAN(const framework::Tensor& tensor, framework::Tensor* out);
 void TensorContainsInf(const framework::Tensor& tensor, framework::Tensor* out);
 void TensorIsfinite(const framework::Tensor& tensor, framework::Tensor* out);
 
+// The alignment of the tensor payload in the stream when align_payload is
+// true, so that the payload can be used in place after the file is mapped.
+constexpr size_t kTensorPayloadAlignment = 64;
+
+// If align_payload is true, the tensor is written in version 1, in which the
+// payload is padded to kTensorPayloadAlignment from the beginning of the
+// stream.
 void TensorToStream(std::ostream& os, const Tensor& tensor,
-                    const platform::DeviceContext& dev_ctx);
+                    const platform::DeviceContext& dev_ctx,
+                    bool align_payload = false);
 void TensorFromStream(std::istream& is, Tensor* tensor,
                       const platform::DeviceContext& dev_ctx);
 
@@ -95,6 +95,101 @@ void ThreadPool::TaskLoop() {
   }
 }
 
+// The index of the current thread in the WorkStealingThreadPool it belongs
+// to, so that the tasks submitted by a worker go to its own deque.
+static thread_local const WorkStealingThreadPool* current_pool = nullptr;
+static thread_local size_t current_worker_idx = 0;
+
+WorkStealingThreadPool::WorkStealingThreadPool(int num_threads) {
+  PADDLE_ENFORCE_GT(num_threads, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(
+        new std::thread(&WorkStealingThreadPool::TaskLoop, this, i));
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(sleep_mutex_);
+    running_ = false;
+  }
+  scheduled_.notify_all();
+  for (auto& t : threads_) {
+    t->join();
+  }
+}
+
+void WorkStealingThreadPool::Run(Task task) {
+  size_t idx = current_pool == this
+                   ? current_worker_idx
+                   : next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                         workers_.size();
+  // Count the task before pushing it, so that pending_tasks_ never underflows
+  // when a worker takes the task immediately.
+  pending_tasks_.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> guard(workers_[idx]->mutex_);
+    workers_[idx]->tasks_.push_back(std::move(task));
+  }
+  if (sleeping_threads_.load() > 0) {
+    // Notify under the lock, otherwise a thread which has checked
+    // pending_tasks_ but not started waiting yet would miss it.
+    std::lock_guard<std::mutex> guard(sleep_mutex_);
+    scheduled_.notify_one();
+  }
+}
+
+bool WorkStealingThreadPool::PopTask(size_t idx, Task* task) {
+  auto& worker = *workers_[idx];
+  std::lock_guard<std::mutex> guard(worker.mutex_);
+  if (worker.tasks_.empty()) {
+    return false;
+  }
+  *task = std::move(worker.tasks_.back());
+  worker.tasks_.pop_back();
+  return true;
+}
+
+bool WorkStealingThreadPool::StealTask(size_t idx, Task* task) {
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    auto& victim = *workers_[(idx + i) % workers_.size()];
+    std::lock_guard<std::mutex> guard(victim.mutex_);
+    if (!victim.tasks_.empty()) {
+      *task = std::move(victim.tasks_.front());
+      victim.tasks_.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::TaskLoop(size_t idx) {
+  current_pool = this;
+  current_worker_idx = idx;
+  Task task;
+  while (true) {
+    if (PopTask(idx, &task) || StealTask(idx, &task)) {
+      pending_tasks_.fetch_sub(1);
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleeping_threads_.fetch_add(1);
+    scheduled_.wait(lock, [this] {
+      return pending_tasks_.load() > 0 || !running_;
+    });
+    sleeping_threads_.fetch_sub(1);
+    if (!running_ && pending_tasks_.load() == 0) {
+      return;
+    }
+  }
+}
+
 std::unique_ptr<ThreadPool> ThreadPoolIO::io_threadpool_(nullptr);
 std::once_flag ThreadPoolIO::io_init_flag_;
 
@@ -14,10 +14,13 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>  // NOLINT
+#include <deque>
 #include <functional>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <thread>  // NOLINT
 #include <vector>
@@ -127,6 +130,56 @@ class ThreadPoolIO : ThreadPool {
   static std::once_flag io_init_flag_;
 };
 
+// WorkStealingThreadPool runs fire-and-forget tasks on a fixed number of
+// threads. Unlike ThreadPool, it neither allocates a future for each task
+// nor shares one task queue among all threads.
+//
+// Each worker owns a deque of tasks. The tasks submitted by a worker are
+// pushed to the back of its own deque and popped from the back (LIFO) by
+// itself, which keeps the data of dependent tasks hot in its cache. The tasks
+// submitted by other threads are distributed to the workers round-robin. An
+// idle worker steals tasks from the front of the other deques before going
+// to sleep.
+//
+// The tasks should handle their exceptions themselves, an exception escaping
+// from a task is fatal.
+class WorkStealingThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingThreadPool(int num_threads);
+
+  // Waits for all the submitted tasks and stops the threads.
+  ~WorkStealingThreadPool();
+
+  void Run(Task task);
+
+  size_t Size() const { return workers_.size(); }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(WorkStealingThreadPool);
+
+  struct Worker {
+    std::mutex mutex_;
+    std::deque<Task> tasks_;
+  };
+
+  void TaskLoop(size_t idx);
+  bool PopTask(size_t idx, Task* task);
+  bool StealTask(size_t idx, Task* task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::unique_ptr<std::thread>> threads_;
+  std::atomic<size_t> next_worker_{0};
+
+  // The number of tasks in all the deques.
+  std::atomic<size_t> pending_tasks_{0};
+  std::atomic<size_t> sleeping_threads_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable scheduled_;
+  bool running_{true};
+};
+
 // Run a function asynchronously.
 // NOTE: The function must return void. If the function need to return a value,
 // you can use lambda to capture a value pointer.
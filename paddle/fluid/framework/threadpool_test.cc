@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include <gtest/gtest.h>
 #include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
 
 #include "paddle/fluid/framework/threadpool.h"
 
@@ -59,3 +61,76 @@ TEST(ThreadPool, ConcurrentRun) {
   }
   EXPECT_EQ(sum, ((n + 1) * n) / 2);
 }
+
+TEST(WorkStealingThreadPool, Run) {
+  std::atomic<int> sum(0);
+  {
+    framework::WorkStealingThreadPool pool(4);
+    for (int i = 1; i <= 100; ++i) {
+      pool.Run([&sum, i] { sum.fetch_add(i); });
+    }
+  }
+  // the destructor waits for all tasks
+  EXPECT_EQ(sum, 5050);
+}
+
+TEST(WorkStealingThreadPool, NestedRun) {
+  // Each task submits two child tasks until the depth reaches 10.
+  std::atomic<int> count(0);
+  {
+    framework::WorkStealingThreadPool pool(4);
+    std::function<void(int)> spawn = [&](int depth) {
+      count.fetch_add(1);
+      if (depth < 10) {
+        pool.Run([&spawn, depth] { spawn(depth + 1); });
+        pool.Run([&spawn, depth] { spawn(depth + 1); });
+      }
+    };
+    pool.Run([&spawn] { spawn(0); });
+    while (count < (1 << 11) - 1) {
+      std::this_thread::yield();
+    }
+  }
+  EXPECT_EQ(count, (1 << 11) - 1);
+}
+
+// Measure the scheduling overhead with empty tasks, each of which submits
+// the next one like the ops in a chain.
+template <typename RunFunc>
+static double BenchmarkEmptyTasks(RunFunc run, int task_num) {
+  std::mutex mu;
+  std::condition_variable cv;
+  bool done = false;
+  std::atomic<int> remaining(task_num);
+  std::function<void()> task = [&] {
+    if (remaining.fetch_sub(1) > 1) {
+      run(task);
+    } else {
+      std::lock_guard<std::mutex> guard(mu);
+      done = true;
+      cv.notify_one();
+    }
+  };
+  auto start = std::chrono::steady_clock::now();
+  run(task);
+  std::unique_lock<std::mutex> lock(mu);
+  cv.wait(lock, [&] { return done; });
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         task_num;
+}
+
+TEST(WorkStealingThreadPool, SchedulingBenchmark) {
+  const int task_num = 100000;
+  for (int thread_num : {1, 4, 8}) {
+    framework::ThreadPool pool(thread_num);
+    framework::WorkStealingThreadPool ws_pool(thread_num);
+    double pool_us = BenchmarkEmptyTasks(
+        [&pool](const std::function<void()>& fn) { pool.Run(fn); }, task_num);
+    double ws_pool_us = BenchmarkEmptyTasks(
+        [&ws_pool](const std::function<void()>& fn) { ws_pool.Run(fn); },
+        task_num);
+    LOG(INFO) << "threads " << thread_num << ", us per empty task: ThreadPool "
+              << pool_us << ", WorkStealingThreadPool " << ws_pool_us;
+  }
+}
@@ -48,7 +48,9 @@ void IrGraphBuildPass::RunImpl(Argument *argument) {
     auto program = LoadModel(
         argument->model_program_path(), argument->model_params_path(),
         argument->scope_ptr(), place,
-        argument->model_from_memory_valid() && argument->model_from_memory());
+        argument->model_from_memory_valid() && argument->model_from_memory(),
+        argument->model_params_use_mmap_valid() &&
+            argument->model_params_use_mmap());
     argument->SetMainProgram(program.release());
   } else {
     PADDLE_THROW(
@@ -72,10 +74,10 @@ std::unique_ptr<framework::ProgramDesc> IrGraphBuildPass::LoadModel(
 std::unique_ptr<framework::ProgramDesc> IrGraphBuildPass::LoadModel(
     const std::string &program_path, const std::string &params_path,
     framework::Scope *scope, const platform::Place &place,
-    bool model_from_memory) {
+    bool model_from_memory, bool use_mmap) {
   framework::Executor exe(place);
   if (!model_from_memory) {
-    return Load(&exe, scope, program_path, params_path);
+    return Load(&exe, scope, program_path, params_path, use_mmap);
   } else {
     return LoadFromMemory(&exe, scope, program_path, params_path);
   }
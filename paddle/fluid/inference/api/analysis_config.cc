@@ -89,6 +89,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(model_dir_);
   CP_MEMBER(model_from_memory_);  // the memory model reuses prog_file_ and
                                   // params_file_ fields.
+  CP_MEMBER(params_use_mmap_);
 
   CP_MEMBER(opt_cache_dir_);
   prog_file_ = std::move(other.prog_file_);
@@ -103,6 +104,8 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(enable_memory_optim_);
   CP_MEMBER(static_memory_optim_);
   CP_MEMBER(static_memory_optim_force_update_);
+  CP_MEMBER(use_memory_arena_);
+  CP_MEMBER(use_optim_program_cache_);
   // TensorRT related.
   CP_MEMBER(use_tensorrt_);
   CP_MEMBER(tensorrt_workspace_size_);
@@ -132,6 +135,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
 
   // profile related.
   CP_MEMBER(with_profile_);
+  CP_MEMBER(with_latency_monitor_);
 
   // Ir related.
   CP_MEMBER(enable_ir_optim_);
@@ -140,6 +144,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(specify_input_name_);
 
   CP_MEMBER(cpu_math_library_num_threads_);
+  CP_MEMBER(inter_op_num_threads_);
 
   CP_MEMBER(serialized_info_cache_);
 
@@ -373,6 +378,8 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << enable_memory_optim_;
   ss << static_memory_optim_;
   ss << static_memory_optim_force_update_;
+  ss << use_memory_arena_;
+  ss << use_optim_program_cache_;
 
   ss << use_ngraph_;
 
@@ -383,8 +390,10 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << use_mkldnn_quantizer_;
   ss << model_from_memory_;
+  ss << params_use_mmap_;
 
   ss << with_profile_;
+  ss << with_latency_monitor_;
 
   ss << enable_ir_optim_;
   ss << use_feed_fetch_ops_;
@@ -392,6 +401,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << specify_input_name_;
   ss << cpu_math_library_num_threads_;
+  ss << inter_op_num_threads_;
   ss << use_anakin_;
   ss << anakin_min_subgraph_size_;
   return ss.str();
@@ -404,6 +414,12 @@ void AnalysisConfig::SetCpuMathLibraryNumThreads(
   Update();
 }
 
+void AnalysisConfig::SetInterOpNumThreads(int inter_op_num_threads) {
+  inter_op_num_threads_ = inter_op_num_threads;
+
+  Update();
+}
+
 float AnalysisConfig::fraction_of_gpu_memory_for_pool() const {
 #ifdef PADDLE_WITH_CUDA
   // Get the GPU memory details and calculate the fraction of memory for the
@@ -433,6 +449,18 @@ bool AnalysisConfig::enable_memory_optim() const {
   return enable_memory_optim_;
 }
 
+void AnalysisConfig::EnableMemoryArena(bool x) {
+  use_memory_arena_ = x;
+
+  Update();
+}
+
+void AnalysisConfig::EnableOptimProgramCache(bool x) {
+  use_optim_program_cache_ = x;
+
+  Update();
+}
+
 void AnalysisConfig::SetModelBuffer(const char *prog_buffer,
                                     size_t prog_buffer_size,
                                     const char *param_buffer,
@@ -466,6 +494,16 @@ void AnalysisConfig::EnableProfile() {
   Update();
 }
 
+void AnalysisConfig::SwitchParamsUseMmap(bool x) {
+  params_use_mmap_ = x;
+  Update();
+}
+
+void AnalysisConfig::EnableLatencyMonitor() {
+  with_latency_monitor_ = true;
+  Update();
+}
+
 void AnalysisConfig::EnableAnakinEngine(
     int max_batch_size, std::map<std::string, std::vector<int>> max_input_shape,
     int min_subgraph_size, AnalysisConfig::Precision precision_mode,
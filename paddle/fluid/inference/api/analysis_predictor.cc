@@ -14,10 +14,16 @@
 
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
+#include <xxhash.h>
 #include <algorithm>
+#include <cstdio>
 #include <fstream>
+#include <iomanip>
 #include <memory>
+#include <random>
+#include <sstream>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/feed_fetch_method.h"
@@ -36,6 +42,7 @@
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/gpu_info.h"
+#include "paddle/fluid/platform/latency_monitor.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -71,6 +78,27 @@ bool IsPersistable(const framework::VarDesc *var) {
   }
   return false;
 }
+
+// The size is hashed before the data to separate the strings.
+void HashString(XXH64_state_t *state, const std::string &str) {
+  uint64_t size = str.size();
+  XXH64_update(state, &size, sizeof(size));
+  XXH64_update(state, str.data(), str.size());
+}
+
+bool HashFile(XXH64_state_t *state, const std::string &path) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  if (!fin.is_open()) return false;
+  std::vector<char> buffer(1 << 20);
+  uint64_t size = 0;
+  while (fin) {
+    fin.read(buffer.data(), buffer.size());
+    XXH64_update(state, buffer.data(), fin.gcount());
+    size += fin.gcount();
+  }
+  XXH64_update(state, &size, sizeof(size));
+  return true;
+}
 }  // namespace
 
 bool AnalysisPredictor::Init(
@@ -86,6 +114,9 @@ bool AnalysisPredictor::Init(
     LOG(INFO) << "Profiler is deactivated, and no profiling report will be "
                  "generated.";
   }
+  if (config_.with_latency_monitor_) {
+    platform::LatencyMonitor::Instance().Enable();
+  }
 
   // no matter with or without MKLDNN
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
@@ -135,6 +166,10 @@ bool AnalysisPredictor::PrepareProgram(
     const std::shared_ptr<framework::ProgramDesc> &program) {
   if (!program) {
     if (!LoadProgramDesc()) return false;
+    if (LoadOptimProgramCache()) {
+      executor_->CreateVariables(*inference_program_, 0, false, sub_scope_);
+      return true;
+    }
     // If not cloned, the parameters should be loaded.
     // If config_.ir_optim() is True, parameters is loaded in
     // OptimizeInferenceProgram(), but other persistable variables
@@ -148,6 +183,7 @@ bool AnalysisPredictor::PrepareProgram(
     // the analysis pass(op fuse, graph analysis, trt subgraph, mkldnn etc) will
     // not be executed.
     OptimizeInferenceProgram();
+    SaveOptimProgramCache();
   } else {
     // If the program is passed from external, no need to optimize it, this
     // logic is used in the clone scenario.
@@ -169,6 +205,15 @@ bool AnalysisPredictor::CreateExecutor() {
   return true;
 }
 bool AnalysisPredictor::PrepareExecutor() {
+  if (config_.inter_op_num_threads() > 1) {
+    if (config_.use_gpu() || config_.mkldnn_enabled()) {
+      LOG(WARNING) << "The inter-op parallel mode only works on CPU without "
+                      "MKLDNN, the operators will run sequentially.";
+    } else {
+      executor_->EnableInterOpParallel(config_.inter_op_num_threads(),
+                                       config_.cpu_math_library_num_threads());
+    }
+  }
   executor_->Prepare(sub_scope_, *inference_program_, 0,
                      config_.use_feed_fetch_ops_);
 
@@ -394,6 +439,7 @@ void AnalysisPredictor::PrepareArgument() {
   argument_.SetStaticMemoryOptimForceUpdate(
       config_.static_memory_optim_force_update_);
   argument_.SetModelFromMemory(config_.model_from_memory_);
+  argument_.SetModelParamsUseMmap(config_.params_use_mmap_);
   // Analyze inference_program
   argument_.SetUseAnakin(config_.anakin_engine_enabled());
   argument_.SetPredictorID(predictor_id_);
@@ -631,7 +677,13 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 
 bool AnalysisPredictor::ZeroCopyRun() {
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  if (memory_arena_) {
+    memory_arena_->Bind();
+  }
   executor_->Run();
+  if (config_.memory_arena_enabled()) {
+    UpdateMemoryArena();
+  }
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
   tensor_array_batch_cleaner_.ResetTensorArray();
@@ -731,6 +783,7 @@ bool AnalysisPredictor::LoadParameters() {
     op->SetType("load_combine");
     op->SetOutput("Out", params);
     op->SetAttr("file_path", {config_.params_file()});
+    op->SetAttr("use_mmap", {config_.params_use_mmap_});
     op->CheckAttrs();
   }
 
@@ -743,6 +796,206 @@ bool AnalysisPredictor::LoadParameters() {
   return true;
 }
 
+std::string AnalysisPredictor::GetOptimProgramCacheKey() {
+  XXH64_state_t *state = XXH64_createState();
+  XXH64_reset(state, 0);
+  HashString(state, get_version());
+  // The buffers of the model from memory are in the serialized config.
+  HashString(state, config_.SerializeInfoCache());
+  for (auto &pass : config_.pass_builder()->AllPasses()) {
+    HashString(state, pass);
+  }
+  HashString(state, ";");
+  for (auto &pass : config_.pass_builder()->AnalysisPasses()) {
+    HashString(state, pass);
+  }
+  // The static memory optimization uses the batch shapes collected before.
+  auto memory_cache_path = inference::analysis::GetMemoryCachePath(
+      config_.model_dir(), config_.prog_file());
+  if (config_.static_memory_optim_ &&
+      inference::IsFileExists(memory_cache_path)) {
+    HashFile(state, memory_cache_path);
+  }
+
+  bool readable = true;
+  if (!config_.model_from_memory()) {
+    if (!config_.params_file().empty()) {
+      readable = HashFile(state, config_.prog_file()) &&
+                 HashFile(state, config_.params_file());
+    } else {
+      readable = HashFile(state, config_.model_dir() + "/__model__");
+      std::vector<std::string> params;
+      for (auto *var : inference_program_->Block(0).AllVars()) {
+        if (IsPersistable(var)) params.push_back(var->Name());
+      }
+      std::sort(params.begin(), params.end());
+      for (auto &param : params) {
+        HashString(state, param);
+        readable =
+            readable && HashFile(state, config_.model_dir() + "/" + param);
+      }
+    }
+  }
+  uint64_t hash = XXH64_digest(state);
+  XXH64_freeState(state);
+  if (!readable) return "";
+
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return ss.str();
+}
+
+bool AnalysisPredictor::LoadOptimProgramCache() {
+  if (!config_.optim_program_cache_enabled()) return false;
+  if (!config_.ir_optim() || config_.tensorrt_engine_enabled() ||
+      config_.anakin_engine_enabled() || config_.mkldnn_quantizer_enabled()) {
+    LOG(WARNING) << "The optimized program cache only works with ir_optim, "
+                    "and without TensorRT, Anakin or the MKL-DNN quantizer.";
+    return false;
+  }
+
+  std::string cache_dir = config_.opt_cache_dir_;
+  if (cache_dir.empty()) {
+    if (config_.model_from_memory()) {
+      LOG(WARNING) << "The model is loaded from memory, you should set the "
+                      "cache directory using config.SetOptimCacheDir() to "
+                      "cache the optimized program.";
+      return false;
+    }
+    std::string model_root =
+        config_.model_dir().empty()
+            ? inference::analysis::GetDirRoot(config_.prog_file())
+            : config_.model_dir();
+    cache_dir = model_root + "/_opt_cache/";
+  }
+  if (!inference::analysis::PathExists(cache_dir) &&
+      MKDIR(cache_dir.c_str()) == -1) {
+    LOG(WARNING) << "Can not create the optimize cache directory "
+                 << cache_dir << ", the optimized program is not cached.";
+    return false;
+  }
+  std::string key = GetOptimProgramCacheKey();
+  if (key.empty()) {
+    LOG(WARNING) << "Can not read the model files to hash them, the optimized "
+                    "program is not cached.";
+    return false;
+  }
+  optim_program_cache_path_ = cache_dir + "/" + key;
+  std::string model_path = optim_program_cache_path_ + ".model";
+  std::string params_path = optim_program_cache_path_ + ".params";
+  // The params are saved before the model, see SaveOptimProgramCache().
+  if (!inference::IsFileExists(model_path)) {
+    LOG(INFO) << "The optimized program is not cached in " << cache_dir;
+    return false;
+  }
+
+  auto origin_program = inference_program_;
+  try {
+    inference_program_.reset(new framework::ProgramDesc(
+        inference::analysis::LoadProgramDesc(model_path)));
+    executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
+
+    framework::ProgramDesc load_program;
+    auto *load_block = load_program.MutableBlock(0);
+    std::vector<std::string> params;
+    for (auto *var : inference_program_->Block(0).AllVars()) {
+      if (IsPersistable(var)) {
+        auto *new_var = load_block->Var(var->Name());
+        new_var->SetType(var->GetType());
+        new_var->SetPersistable(true);
+        params.push_back(var->Name());
+      }
+    }
+    std::sort(params.begin(), params.end());
+    auto *op = load_block->AppendOp();
+    op->SetType("load_combine");
+    op->SetOutput("Out", params);
+    op->SetAttr("file_path", {params_path});
+    op->SetAttr("use_mmap", {config_.params_use_mmap_});
+    op->CheckAttrs();
+
+    framework::NaiveExecutor e(place_);
+    e.Prepare(scope_.get(), load_program, 0, false);
+    e.Run();
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Failed to load the optimized program cached in "
+                 << model_path << ": " << e.what();
+    inference_program_ = origin_program;
+    return false;
+  }
+
+  // The same as the end of OptimizeInferenceProgram().
+  config_.PartiallyRelease();
+  // The cache is not saved again.
+  optim_program_cache_path_.clear();
+  LOG(INFO) << "Load the optimized program from " << model_path;
+  return true;
+}
+
+void AnalysisPredictor::SaveOptimProgramCache() {
+  if (optim_program_cache_path_.empty()) return;
+  std::vector<std::string> params;
+  for (auto *var : inference_program_->Block(0).AllVars()) {
+    if (!IsPersistable(var)) continue;
+    auto *scope_var = scope_->FindVar(var->Name());
+    if (scope_var == nullptr || !scope_var->IsType<framework::LoDTensor>() ||
+        !scope_var->Get<framework::LoDTensor>().IsInitialized()) {
+      LOG(WARNING) << "The optimized program is not cached, the persistable "
+                      "variable "
+                   << var->Name() << " is not an initialized LoDTensor.";
+      return;
+    }
+    params.push_back(var->Name());
+  }
+  std::sort(params.begin(), params.end());
+
+  // The files are written to temporary paths and renamed, the params before
+  // the model, so a predictor never loads a partially written cache, even if
+  // several processes save the same cache at the same time.
+  std::string tmp_suffix = ".tmp" + std::to_string(std::random_device()());
+  std::string model_path = optim_program_cache_path_ + ".model";
+  std::string params_path = optim_program_cache_path_ + ".params";
+  try {
+    framework::ProgramDesc save_program;
+    auto *save_block = save_program.MutableBlock(0);
+    for (auto &param : params) {
+      auto *new_var = save_block->Var(param);
+      new_var->SetType(framework::proto::VarType::LOD_TENSOR);
+      new_var->SetPersistable(true);
+    }
+    auto *op = save_block->AppendOp();
+    op->SetType("save_combine");
+    op->SetInput("X", params);
+    op->SetAttr("file_path", params_path + tmp_suffix);
+    op->SetAttr("align_payload", config_.params_use_mmap_);
+    op->CheckAttrs();
+    framework::Executor exe(platform::CPUPlace{});
+    exe.Run(save_program, scope(), 0, true, true);
+
+    std::ofstream fout(model_path + tmp_suffix,
+                       std::ios::out | std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fout.is_open()), "Cannot open file %s",
+                   model_path + tmp_suffix);
+    fout << GetSerializedProgram();
+    fout.close();
+    PADDLE_ENFORCE(static_cast<bool>(fout), "Failed to write file %s",
+                   model_path + tmp_suffix);
+
+    PADDLE_ENFORCE_EQ(
+        std::rename((params_path + tmp_suffix).c_str(), params_path.c_str()),
+        0, "Failed to rename the cached params to %s", params_path);
+    PADDLE_ENFORCE_EQ(
+        std::rename((model_path + tmp_suffix).c_str(), model_path.c_str()),
+        0, "Failed to rename the cached model to %s", model_path);
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Failed to cache the optimized program: " << e.what();
+    std::remove((params_path + tmp_suffix).c_str());
+    std::remove((model_path + tmp_suffix).c_str());
+    return;
+  }
+  LOG(INFO) << "Save the optimized program to " << model_path;
+}
+
 #if PADDLE_WITH_TENSORRT
 bool AnalysisPredictor::SaveTrtCalibToDisk() {
   PADDLE_ENFORCE(config_.tensorrt_engine_enabled(),
@@ -875,6 +1128,42 @@ void AnalysisPredictor::SerializeBatchVarShapes(const std::string &path) {
   }
 }
 
+void AnalysisPredictor::UpdateMemoryArena() {
+  if (memory_arena_plan_count_ >= max_memory_arena_plan_count_) return;
+  if (!memory_arena_) {
+    std::unordered_set<std::string> skip_vars({"feed", "fetch"});
+    for (auto &item : idx2feeds_) skip_vars.insert(item.second);
+    for (auto &item : idx2fetches_) skip_vars.insert(item.second);
+    memory_arena_.reset(
+        new details::StaticMemoryArena(*inference_program_, skip_vars, place_));
+    if (!platform::is_cpu_place(place_) || !memory_arena_->IsValid()) {
+      LOG(WARNING) << "The memory arena only supports the programs of one "
+                      "block on CPU, it is disabled.";
+      memory_arena_.reset();
+      memory_arena_plan_count_ = max_memory_arena_plan_count_;
+      return;
+    }
+  } else if (!memory_arena_->NeedReplan()) {
+    return;
+  }
+
+  auto batch_var_shapes = batch_var_shapes_;
+  auto path = inference::analysis::GetMemoryCachePath(config_.model_dir(),
+                                                      config_.prog_file());
+  if (inference::IsFileExists(path)) {
+    auto cached_shapes = inference::analysis::DeseralizeBatchVarShapes(path);
+    batch_var_shapes.insert(batch_var_shapes.end(), cached_shapes.begin(),
+                            cached_shapes.end());
+  }
+  framework::Scope *scope = sub_scope_ ? sub_scope_ : scope_.get();
+  memory_arena_->Plan(scope, batch_var_shapes);
+  if (++memory_arena_plan_count_ == max_memory_arena_plan_count_) {
+    LOG(WARNING) << "The memory arena has been planned "
+                 << memory_arena_plan_count_
+                 << " times, the tensors out of it will not be planned again.";
+  }
+}
+
 bool AnalysisPredictor::need_collect_var_shapes_for_memory_optim() {
   if (need_collect_var_shapes_ >= 0) return need_collect_var_shapes_;
   bool need = false;
@@ -898,8 +1187,33 @@ std::string AnalysisPredictor::GetSerializedProgram() const {
   return inference_program_->Proto()->SerializeAsString();
 }
 
+std::vector<PaddleOpLatency> AnalysisPredictor::GetOpLatencySnapshot(
+    bool reset) {
+  std::vector<PaddleOpLatency> res;
+  if (!config_.with_latency_monitor_) {
+    LOG(WARNING) << "The latency monitor is not enabled, please call "
+                    "AnalysisConfig::EnableLatencyMonitor first.";
+    return res;
+  }
+  auto stats = platform::LatencyMonitor::Instance().Snapshot(reset);
+  res.reserve(stats.size());
+  for (auto &item : stats) {
+    PaddleOpLatency latency;
+    latency.name = item.name_;
+    latency.calls = item.calls_;
+    latency.total_ms = item.total_ms_;
+    latency.min_ms = item.min_ms_;
+    latency.max_ms = item.max_ms_;
+    latency.p50_ms = item.p50_ms_;
+    latency.p99_ms = item.p99_ms_;
+    res.emplace_back(std::move(latency));
+  }
+  return res;
+}
+
 // Add SaveOptimModel
-void AnalysisPredictor::SaveOptimModel(const std::string &dir) {
+void AnalysisPredictor::SaveOptimModel(const std::string &dir,
+                                       bool align_params) {
   // save model
   std::string model_name = dir + "/model";
   std::ofstream outfile;
@@ -930,6 +1244,7 @@ void AnalysisPredictor::SaveOptimModel(const std::string &dir) {
   op->SetType("save_combine");
   op->SetInput("X", save_var_list);
   op->SetAttr("file_path", dir + "/params");
+  op->SetAttr("align_payload", align_params);
   op->CheckAttrs();
 
   platform::CPUPlace place;
@@ -22,6 +22,7 @@
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/api_impl.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
+#include "paddle/fluid/inference/api/details/static_memory_arena.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/string/printf.h"
@@ -84,17 +85,24 @@ class AnalysisPredictor : public PaddlePredictor {
 
   std::string GetSerializedProgram() const override;
 
+  std::vector<PaddleOpLatency> GetOpLatencySnapshot(
+      bool reset = true) override;
+
   bool MkldnnQuantize();
 
   // save program to  model
-  // save parameters to params
-  void SaveOptimModel(const std::string &dir);
+  // save parameters to params, whose data are aligned for mmap if
+  // align_params is true
+  void SaveOptimModel(const std::string &dir, bool align_params = false);
 
  protected:
   // For memory optimization.
   bool need_collect_var_shapes_for_memory_optim();
   void CollectVarShapes();
   void SerializeBatchVarShapes(const std::string &path);
+  // Plans the memory arena after the first run, and plans it again if some
+  // tensors were out of it in the last run.
+  void UpdateMemoryArena();
 
   bool PrepareProgram(const std::shared_ptr<framework::ProgramDesc> &program);
   bool PrepareScope(const std::shared_ptr<framework::Scope> &parent_scope);
@@ -104,6 +112,16 @@ class AnalysisPredictor : public PaddlePredictor {
   bool LoadProgramDesc();
   bool LoadParameters();
 
+  // The cache of the optimized program on disk, see
+  // AnalysisConfig::EnableOptimProgramCache. LoadOptimProgramCache() loads the
+  // optimized program and its parameters, and returns false if they are not
+  // cached, then SaveOptimProgramCache() saves them after the analysis.
+  bool LoadOptimProgramCache();
+  void SaveOptimProgramCache();
+  // The hash of the model files, the config and the passes, empty if the model
+  // files can not be read.
+  std::string GetOptimProgramCacheKey();
+
   bool SetFeed(const std::vector<PaddleTensor> &input_datas,
                framework::Scope *scope);
   bool GetFetch(std::vector<PaddleTensor> *output_data,
@@ -176,6 +194,14 @@ class AnalysisPredictor : public PaddlePredictor {
   const size_t max_shape_collect_count_{1000};
   int need_collect_var_shapes_{-1};  // -1 for default, 0 for false, 1 for true.
   std::vector<std::map<std::string, std::vector<int>>> batch_var_shapes_;
+  std::unique_ptr<details::StaticMemoryArena> memory_arena_;
+  // The arena is not planned any more after so many times, the tensors out
+  // of it just allocate by themselves.
+  const int max_memory_arena_plan_count_{8};
+  int memory_arena_plan_count_{0};
+  // The path prefix of the cached program and parameters of this predictor,
+  // empty if the cache is not used.
+  std::string optim_program_cache_path_;
   int predictor_id_;
 
  private:
@@ -15,7 +15,9 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <string>
 #include <thread>  // NOLINT
+#include <vector>
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/inference/api/helper.h"
@@ -193,6 +195,45 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+TEST(AnalysisPredictor, optim_program_cache) {
+  // 2. Dummy Input Data
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  // The first predictor runs the analysis and saves the optimized program,
+  // the second one loads it.
+  std::vector<std::string> programs;
+  std::vector<std::vector<PaddleTensor>> outputs(2);
+  for (int i = 0; i < 2; i++) {
+    AnalysisConfig config;
+    config.SetModel(FLAGS_dirname);
+    config.SetOptimCacheDir("/tmp/analysis_predictor_optim_program_cache");
+    config.EnableOptimProgramCache();
+    auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+    programs.push_back(predictor->GetSerializedProgram());
+    ASSERT_TRUE(predictor->Run(inputs, &outputs[i]));
+  }
+  ASSERT_FALSE(programs[0].empty());
+  EXPECT_EQ(programs[0], programs[1]);
+  inference::CompareResult(outputs[0], outputs[1]);
+
+  // The cache is not used with another config.
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SetOptimCacheDir("/tmp/analysis_predictor_optim_program_cache");
+  config.EnableOptimProgramCache();
+  config.pass_builder()->DeletePass("fc_fuse_pass");
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  EXPECT_NE(predictor->GetSerializedProgram(), programs[0]);
+  std::vector<PaddleTensor> output;
+  ASSERT_TRUE(predictor->Run(inputs, &output));
+  inference::CompareResult(outputs[0], output);
+}
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
@@ -0,0 +1,530 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/paddle_batching_predictor.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/latency_monitor.h"
+
+namespace paddle {
+
+namespace {
+
+using LoD = std::vector<std::vector<size_t>>;
+
+struct BatchRequest {
+  const std::vector<PaddleTensor> *inputs;
+  std::vector<PaddleTensor> *outputs;
+  // The names of the inputs, resolved by the order of the model inputs if
+  // they are omitted.
+  std::vector<std::string> names;
+  size_t num_samples{0};
+  uint64_t enqueue_ns{0};
+  std::promise<bool> done;
+};
+
+size_t NumSamples(const PaddleTensor &tensor) {
+  if (!tensor.lod.empty()) {
+    return tensor.lod[0].size() - 1;
+  }
+  return static_cast<size_t>(tensor.shape[0]);
+}
+
+size_t RowBytes(const std::vector<int> &shape, PaddleDType dtype) {
+  size_t bytes = PaddleDtypeSize(dtype);
+  for (size_t i = 1; i < shape.size(); ++i) {
+    bytes *= shape[i];
+  }
+  return bytes;
+}
+
+// Whether the two requests can be concatenated into one batch.
+bool IsCompatible(const BatchRequest &a, const BatchRequest &b) {
+  if (a.names != b.names) {
+    return false;
+  }
+  for (size_t i = 0; i < a.names.size(); ++i) {
+    const auto &x = (*a.inputs)[i];
+    const auto &y = (*b.inputs)[i];
+    if (x.dtype != y.dtype || x.lod.size() != y.lod.size() ||
+        x.shape.size() != y.shape.size() ||
+        !std::equal(x.shape.begin() + 1, x.shape.end(), y.shape.begin() + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void *MutableCPUData(ZeroCopyTensor *tensor, PaddleDType dtype) {
+  switch (dtype) {
+    case PaddleDType::FLOAT32:
+      return tensor->mutable_data<float>(PaddlePlace::kCPU);
+    case PaddleDType::INT64:
+      return tensor->mutable_data<int64_t>(PaddlePlace::kCPU);
+    case PaddleDType::INT32:
+      return tensor->mutable_data<int32_t>(PaddlePlace::kCPU);
+    case PaddleDType::UINT8:
+      return tensor->mutable_data<uint8_t>(PaddlePlace::kCPU);
+  }
+  PADDLE_THROW("Unsupported data type %d", static_cast<int>(dtype));
+}
+
+void CopyFromCPU(ZeroCopyTensor *tensor, PaddleDType dtype, const void *data) {
+  switch (dtype) {
+    case PaddleDType::FLOAT32:
+      return tensor->copy_from_cpu(static_cast<const float *>(data));
+    case PaddleDType::INT64:
+      return tensor->copy_from_cpu(static_cast<const int64_t *>(data));
+    case PaddleDType::INT32:
+      return tensor->copy_from_cpu(static_cast<const int32_t *>(data));
+    case PaddleDType::UINT8:
+      return tensor->copy_from_cpu(static_cast<const uint8_t *>(data));
+  }
+  PADDLE_THROW("Unsupported data type %d", static_cast<int>(dtype));
+}
+
+const void *Data(const ZeroCopyTensor &tensor, PaddleDType dtype,
+                 PaddlePlace *place) {
+  int size = 0;
+  switch (dtype) {
+    case PaddleDType::FLOAT32:
+      return tensor.data<float>(place, &size);
+    case PaddleDType::INT64:
+      return tensor.data<int64_t>(place, &size);
+    case PaddleDType::INT32:
+      return tensor.data<int32_t>(place, &size);
+    case PaddleDType::UINT8:
+      return tensor.data<uint8_t>(place, &size);
+  }
+  PADDLE_THROW("Unsupported data type %d", static_cast<int>(dtype));
+}
+
+void CopyToCPU(ZeroCopyTensor *tensor, PaddleDType dtype, void *data) {
+  switch (dtype) {
+    case PaddleDType::FLOAT32:
+      return tensor->copy_to_cpu(static_cast<float *>(data));
+    case PaddleDType::INT64:
+      return tensor->copy_to_cpu(static_cast<int64_t *>(data));
+    case PaddleDType::INT32:
+      return tensor->copy_to_cpu(static_cast<int32_t *>(data));
+    case PaddleDType::UINT8:
+      return tensor->copy_to_cpu(static_cast<uint8_t *>(data));
+  }
+  PADDLE_THROW("Unsupported data type %d", static_cast<int>(dtype));
+}
+
+}  // namespace
+
+class BatchingPredictor::Impl {
+ public:
+  Impl(const AnalysisConfig &config, const BatchingConfig &batching_config);
+  ~Impl();
+
+  bool Run(const std::vector<PaddleTensor> &inputs,
+           std::vector<PaddleTensor> *outputs);
+
+  PaddleBatchingStats GetStats(bool reset);
+
+ private:
+  bool PrepareRequest(BatchRequest *request) const;
+  // Wait for the next batch, returns false when stopped and all the requests
+  // are done.
+  bool NextBatch(std::vector<BatchRequest *> *batch);
+  void WorkerLoop(PaddlePredictor *predictor);
+  void FeedBatch(PaddlePredictor *predictor,
+                 const std::vector<BatchRequest *> &batch);
+  void FetchBatch(PaddlePredictor *predictor,
+                  const std::vector<BatchRequest *> &batch);
+
+  BatchingConfig batching_config_;
+  bool use_gpu_;
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors_;
+  std::vector<std::string> input_names_;
+  std::vector<std::string> output_names_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<BatchRequest *> queue_;
+  bool stopped_{false};
+  std::vector<std::thread> workers_;
+
+  std::mutex stats_mutex_;
+  uint64_t failed_requests_{0};
+  uint64_t batches_{0};
+  uint64_t batched_samples_{0};
+  uint64_t batched_requests_{0};
+  uint64_t queue_ns_{0};
+  platform::LatencyHistogram latency_;
+};
+
+BatchingPredictor::Impl::Impl(const AnalysisConfig &config,
+                              const BatchingConfig &batching_config)
+    : batching_config_(batching_config), use_gpu_(config.use_gpu()) {
+  PADDLE_ENFORCE_GT(batching_config_.max_batch_size, 0);
+  PADDLE_ENFORCE_GE(batching_config_.max_wait_us, 0);
+  PADDLE_ENFORCE_GT(batching_config_.num_workers, 0);
+
+  AnalysisConfig zero_copy_config(config);
+  zero_copy_config.SwitchUseFeedFetchOps(false);
+  predictors_.emplace_back(
+      CreatePaddlePredictor<AnalysisConfig>(zero_copy_config));
+  PADDLE_ENFORCE_NOT_NULL(predictors_[0], "Failed to create the predictor");
+  for (int i = 1; i < batching_config_.num_workers; ++i) {
+    predictors_.emplace_back(predictors_[0]->Clone());
+  }
+  input_names_ = predictors_[0]->GetInputNames();
+  output_names_ = predictors_[0]->GetOutputNames();
+
+  for (auto &predictor : predictors_) {
+    workers_.emplace_back(&Impl::WorkerLoop, this, predictor.get());
+  }
+}
+
+BatchingPredictor::Impl::~Impl() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+bool BatchingPredictor::Impl::PrepareRequest(BatchRequest *request) const {
+  const auto &inputs = *request->inputs;
+  if (inputs.empty() || inputs.size() > input_names_.size()) {
+    LOG(ERROR) << "The request should have 1 to " << input_names_.size()
+               << " inputs, but got " << inputs.size();
+    return false;
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const auto &input = inputs[i];
+    request->names.push_back(input.name.empty() ? input_names_[i]
+                                                : input.name);
+    if (input.shape.empty() || input.shape[0] < 0) {
+      LOG(ERROR) << "The shape of input " << request->names.back()
+                 << " should have the batch dimension";
+      return false;
+    }
+    size_t rows = input.shape[0];
+    if (input.data.length() < rows * RowBytes(input.shape, input.dtype)) {
+      LOG(ERROR) << "The data of input " << request->names.back()
+                 << " is smaller than its shape";
+      return false;
+    }
+    for (auto &level : input.lod) {
+      if (level.empty() || level.front() != 0) {
+        LOG(ERROR) << "The LoD of input " << request->names.back()
+                   << " should start with 0";
+        return false;
+      }
+    }
+    if (!input.lod.empty() && input.lod.back().back() != rows) {
+      LOG(ERROR) << "The LoD of input " << request->names.back()
+                 << " does not match its shape";
+      return false;
+    }
+  }
+  request->num_samples = NumSamples(inputs[0]);
+  if (request->num_samples == 0) {
+    LOG(ERROR) << "The request should have at least one sample";
+    return false;
+  }
+  return true;
+}
+
+bool BatchingPredictor::Impl::Run(const std::vector<PaddleTensor> &inputs,
+                                  std::vector<PaddleTensor> *outputs) {
+  BatchRequest request;
+  request.inputs = &inputs;
+  request.outputs = outputs;
+  bool success = PrepareRequest(&request);
+  request.enqueue_ns = platform::MonotonicNsec();
+  if (success) {
+    auto done = request.done.get_future();
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (stopped_) {
+        LOG(ERROR) << "The BatchingPredictor is stopped";
+        return false;
+      }
+      queue_.push_back(&request);
+    }
+    cv_.notify_one();
+    success = done.get();
+  }
+
+  uint64_t latency_ns = platform::MonotonicNsec() - request.enqueue_ns;
+  std::lock_guard<std::mutex> guard(stats_mutex_);
+  latency_.Add(latency_ns);
+  if (!success) {
+    ++failed_requests_;
+  }
+  return success;
+}
+
+bool BatchingPredictor::Impl::NextBatch(std::vector<BatchRequest *> *batch) {
+  const size_t max_batch_size = batching_config_.max_batch_size;
+  const uint64_t max_wait_ns = batching_config_.max_wait_us * 1000ULL;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    if (queue_.empty()) {
+      if (stopped_) {
+        return false;
+      }
+      cv_.wait(lock);
+      continue;
+    }
+    // The batch is the longest prefix of the queue that is compatible with
+    // the first request and fits in max_batch_size.
+    size_t num_requests = 1;
+    size_t num_samples = queue_.front()->num_samples;
+    for (; num_requests < queue_.size(); ++num_requests) {
+      auto *request = queue_[num_requests];
+      if (!IsCompatible(*queue_.front(), *request) ||
+          num_samples + request->num_samples > max_batch_size) {
+        break;
+      }
+      num_samples += request->num_samples;
+    }
+    bool full = num_samples >= max_batch_size || num_requests < queue_.size();
+    uint64_t deadline_ns = queue_.front()->enqueue_ns + max_wait_ns;
+    uint64_t now_ns = platform::MonotonicNsec();
+    if (full || stopped_ || now_ns >= deadline_ns) {
+      batch->assign(queue_.begin(), queue_.begin() + num_requests);
+      queue_.erase(queue_.begin(), queue_.begin() + num_requests);
+      if (!queue_.empty()) {
+        cv_.notify_one();
+      }
+      return true;
+    }
+    cv_.wait_for(lock, std::chrono::nanoseconds(deadline_ns - now_ns));
+  }
+}
+
+void BatchingPredictor::Impl::WorkerLoop(PaddlePredictor *predictor) {
+  std::vector<BatchRequest *> batch;
+  while (NextBatch(&batch)) {
+    uint64_t start_ns = platform::MonotonicNsec();
+    bool success = false;
+    try {
+      FeedBatch(predictor, batch);
+      success = predictor->ZeroCopyRun();
+      if (success) {
+        FetchBatch(predictor, batch);
+      } else {
+        LOG(ERROR) << "ZeroCopyRun of the batch failed";
+      }
+    } catch (const std::exception &e) {
+      LOG(ERROR) << "Failed to run the batch of " << batch.size()
+                 << " requests: " << e.what();
+      success = false;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(stats_mutex_);
+      ++batches_;
+      batched_requests_ += batch.size();
+      for (auto *request : batch) {
+        batched_samples_ += request->num_samples;
+        queue_ns_ += start_ns - request->enqueue_ns;
+      }
+    }
+    for (auto *request : batch) {
+      request->done.set_value(success);
+    }
+  }
+}
+
+void BatchingPredictor::Impl::FeedBatch(
+    PaddlePredictor *predictor, const std::vector<BatchRequest *> &batch) {
+  const auto &first = *batch.front();
+  std::vector<char> staging;
+  for (size_t i = 0; i < first.names.size(); ++i) {
+    const auto &head = (*first.inputs)[i];
+    size_t row_bytes = RowBytes(head.shape, head.dtype);
+    std::vector<int> shape(head.shape);
+    shape[0] = 0;
+    // Concatenate the LoD, the offsets of each request are shifted by the
+    // end of the previous requests in the same level.
+    LoD lod(head.lod.size(), std::vector<size_t>(1, 0));
+    for (auto *request : batch) {
+      const auto &input = (*request->inputs)[i];
+      shape[0] += input.shape[0];
+      for (size_t level = 0; level < lod.size(); ++level) {
+        size_t base = lod[level].back();
+        for (size_t j = 1; j < input.lod[level].size(); ++j) {
+          lod[level].push_back(base + input.lod[level][j]);
+        }
+      }
+    }
+
+    auto tensor = predictor->GetInputTensor(first.names[i]);
+    tensor->Reshape(shape);
+    tensor->SetLoD(lod);
+    char *dst = nullptr;
+    if (use_gpu_) {
+      staging.resize(shape[0] * row_bytes);
+      dst = staging.data();
+    } else {
+      dst = static_cast<char *>(MutableCPUData(tensor.get(), head.dtype));
+    }
+    for (auto *request : batch) {
+      const auto &input = (*request->inputs)[i];
+      size_t bytes = input.shape[0] * row_bytes;
+      std::memcpy(dst, input.data.data(), bytes);
+      dst += bytes;
+    }
+    if (use_gpu_) {
+      CopyFromCPU(tensor.get(), head.dtype, staging.data());
+    }
+  }
+}
+
+void BatchingPredictor::Impl::FetchBatch(
+    PaddlePredictor *predictor, const std::vector<BatchRequest *> &batch) {
+  size_t total_samples = 0;
+  for (auto *request : batch) {
+    request->outputs->resize(output_names_.size());
+    total_samples += request->num_samples;
+  }
+
+  std::vector<char> staging;
+  for (size_t i = 0; i < output_names_.size(); ++i) {
+    auto tensor = predictor->GetOutputTensor(output_names_[i]);
+    auto shape = tensor->shape();
+    auto lod = tensor->lod();
+    auto dtype = tensor->type();
+    size_t row_bytes = RowBytes(shape, dtype);
+    PADDLE_ENFORCE(!shape.empty(), "The output %s should not be a scalar",
+                   output_names_[i]);
+
+    const char *src = nullptr;
+    PaddlePlace place;
+    src = static_cast<const char *>(Data(*tensor, dtype, &place));
+    if (place != PaddlePlace::kCPU) {
+      staging.resize(shape[0] * row_bytes);
+      CopyToCPU(tensor.get(), dtype, staging.data());
+      src = staging.data();
+    }
+
+    size_t rows_per_sample = 0;
+    if (lod.empty()) {
+      PADDLE_ENFORCE_EQ(shape[0] % total_samples, 0,
+                        "The rows of output %s can not be split into %d "
+                        "samples",
+                        output_names_[i], total_samples);
+      rows_per_sample = shape[0] / total_samples;
+    } else {
+      PADDLE_ENFORCE_EQ(lod[0].size() - 1, total_samples,
+                        "The sequences of output %s should match the %d "
+                        "samples",
+                        output_names_[i], total_samples);
+    }
+
+    size_t sample_begin = 0;
+    for (auto *request : batch) {
+      auto &output = (*request->outputs)[i];
+      size_t sample_end = sample_begin + request->num_samples;
+      size_t row_begin = sample_begin * rows_per_sample;
+      size_t row_end = sample_end * rows_per_sample;
+      output.lod.clear();
+      if (!lod.empty()) {
+        // Follow the sequences of the request down to the rows, and rebase
+        // the offsets of each level to 0.
+        row_begin = sample_begin;
+        row_end = sample_end;
+        for (auto &level : lod) {
+          output.lod.emplace_back(level.begin() + row_begin,
+                                  level.begin() + row_end + 1);
+          for (auto &offset : output.lod.back()) {
+            offset -= level[row_begin];
+          }
+          row_begin = level[row_begin];
+          row_end = level[row_end];
+        }
+      }
+      output.name = output_names_[i];
+      output.dtype = dtype;
+      output.shape = shape;
+      output.shape[0] = static_cast<int>(row_end - row_begin);
+      output.data.Resize((row_end - row_begin) * row_bytes);
+      std::memcpy(output.data.data(), src + row_begin * row_bytes,
+                  (row_end - row_begin) * row_bytes);
+      sample_begin = sample_end;
+    }
+  }
+}
+
+PaddleBatchingStats BatchingPredictor::Impl::GetStats(bool reset) {
+  std::lock_guard<std::mutex> guard(stats_mutex_);
+  PaddleBatchingStats stats;
+  stats.requests = latency_.count();
+  stats.failed_requests = failed_requests_;
+  stats.batches = batches_;
+  if (batches_ > 0) {
+    stats.avg_batch_size = static_cast<double>(batched_samples_) / batches_;
+    stats.avg_batch_fill =
+        stats.avg_batch_size / batching_config_.max_batch_size;
+    stats.avg_requests_per_batch =
+        static_cast<double>(batched_requests_) / batches_;
+  }
+  if (batched_requests_ > 0) {
+    stats.avg_queue_ms = queue_ns_ / 1e6 / batched_requests_;
+  }
+  if (latency_.count() > 0) {
+    stats.avg_latency_ms = latency_.total_ns() / 1e6 / latency_.count();
+    stats.p50_latency_ms = latency_.Percentile(0.5) / 1e6;
+    stats.p99_latency_ms = latency_.Percentile(0.99) / 1e6;
+    stats.max_latency_ms = latency_.max_ns() / 1e6;
+  }
+  if (reset) {
+    failed_requests_ = 0;
+    batches_ = 0;
+    batched_samples_ = 0;
+    batched_requests_ = 0;
+    queue_ns_ = 0;
+    latency_ = platform::LatencyHistogram();
+  }
+  return stats;
+}
+
+BatchingPredictor::BatchingPredictor(const AnalysisConfig &config,
+                                     const BatchingConfig &batching_config)
+    : impl_(new Impl(config, batching_config)) {}
+
+BatchingPredictor::~BatchingPredictor() {}
+
+bool BatchingPredictor::Run(const std::vector<PaddleTensor> &inputs,
+                            std::vector<PaddleTensor> *outputs) {
+  return impl_->Run(inputs, outputs);
+}
+
+PaddleBatchingStats BatchingPredictor::GetStats(bool reset) {
+  return impl_->GetStats(reset);
+}
+
+}  // namespace paddle
@@ -0,0 +1,114 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+DEFINE_string(dirname, "", "dirname to tests.");
+
+namespace paddle {
+
+// The word2vec model has four int64 inputs of shape [N, 1].
+static std::vector<PaddleTensor> MakeInputs(std::vector<int64_t> *data) {
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({static_cast<int>(data->size()), 1});
+  tensor.data.Reset(data->data(), data->size() * sizeof(int64_t));
+  tensor.dtype = PaddleDType::INT64;
+  return std::vector<PaddleTensor>(4, tensor);
+}
+
+static void ExpectTensorNear(const PaddleTensor &a, const PaddleTensor &b) {
+  ASSERT_EQ(a.shape, b.shape);
+  ASSERT_EQ(a.lod, b.lod);
+  ASSERT_EQ(a.dtype, PaddleDType::FLOAT32);
+  auto *a_data = static_cast<float *>(a.data.data());
+  auto *b_data = static_cast<float *>(b.data.data());
+  for (size_t i = 0; i < a.data.length() / sizeof(float); ++i) {
+    EXPECT_NEAR(a_data[i], b_data[i], 1e-5 * std::fabs(b_data[i]) + 1e-6);
+  }
+}
+
+TEST(BatchingPredictor, MultiThreadRun) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+
+  const int num_threads = 8;
+  std::vector<std::vector<int64_t>> data(num_threads);
+  std::vector<std::vector<PaddleTensor>> expects(num_threads);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  for (int i = 0; i < num_threads; ++i) {
+    // The requests have different numbers of samples.
+    for (int j = 0; j <= i % 3; ++j) {
+      data[i].push_back(i + j);
+    }
+    ASSERT_TRUE(predictor->Run(MakeInputs(&data[i]), &expects[i]));
+  }
+
+  BatchingConfig batching_config;
+  batching_config.max_batch_size = 8;
+  batching_config.max_wait_us = 10000;
+  batching_config.num_workers = 2;
+  BatchingPredictor batching_predictor(config, batching_config);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i] {
+      std::vector<PaddleTensor> outputs;
+      ASSERT_TRUE(batching_predictor.Run(MakeInputs(&data[i]), &outputs));
+      ASSERT_EQ(outputs.size(), expects[i].size());
+      for (size_t j = 0; j < outputs.size(); ++j) {
+        ExpectTensorNear(outputs[j], expects[i][j]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto stats = batching_predictor.GetStats(true);
+  EXPECT_EQ(stats.requests, static_cast<uint64_t>(num_threads));
+  EXPECT_EQ(stats.failed_requests, 0UL);
+  EXPECT_GT(stats.batches, 0UL);
+  EXPECT_LE(stats.avg_batch_size, batching_config.max_batch_size);
+  EXPECT_GE(stats.max_latency_ms, stats.p50_latency_ms);
+  LOG(INFO) << "batches: " << stats.batches
+            << ", avg batch size: " << stats.avg_batch_size
+            << ", p99 latency: " << stats.p99_latency_ms << " ms";
+
+  stats = batching_predictor.GetStats();
+  EXPECT_EQ(stats.requests, 0UL);
+}
+
+TEST(BatchingPredictor, InvalidRequest) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  BatchingPredictor batching_predictor(config, BatchingConfig());
+
+  std::vector<int64_t> data{1, 2};
+  auto inputs = MakeInputs(&data);
+  // The LoD does not match the shape.
+  inputs[0].lod = {{0, 3}};
+  std::vector<PaddleTensor> outputs;
+  ASSERT_FALSE(batching_predictor.Run(inputs, &outputs));
+  EXPECT_EQ(batching_predictor.GetStats().failed_requests, 1UL);
+}
+
+}  // namespace paddle
@@ -0,0 +1,252 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/static_memory_arena.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/string/pretty_log.h"
+
+namespace paddle {
+namespace details {
+
+static size_t AlignUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+size_t PlanArenaOffsets(const std::vector<ArenaBlock> &blocks,
+                        size_t alignment, std::vector<size_t> *offsets) {
+  std::vector<size_t> order(blocks.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (blocks[a].size != blocks[b].size) {
+      return blocks[a].size > blocks[b].size;
+    }
+    return blocks[a].begin < blocks[b].begin;
+  });
+
+  offsets->assign(blocks.size(), 0);
+  std::vector<size_t> placed;
+  size_t arena_size = 0;
+  for (auto i : order) {
+    auto &block = blocks[i];
+    size_t size = AlignUp(block.size, alignment);
+    // The ranges in the arena of the placed blocks used at the same time.
+    std::vector<std::pair<size_t, size_t>> used;
+    for (auto j : placed) {
+      if (blocks[j].begin <= block.end && block.begin <= blocks[j].end) {
+        used.emplace_back((*offsets)[j],
+                          (*offsets)[j] + AlignUp(blocks[j].size, alignment));
+      }
+    }
+    std::sort(used.begin(), used.end());
+
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t prev_end = 0;
+    for (auto &range : used) {
+      if (range.first >= prev_end + size &&
+          range.first - prev_end < best_gap) {
+        best_gap = range.first - prev_end;
+        best_offset = prev_end;
+      }
+      prev_end = std::max(prev_end, range.second);
+    }
+    if (best_offset == std::numeric_limits<size_t>::max()) {
+      best_offset = prev_end;
+    }
+    (*offsets)[i] = best_offset;
+    arena_size = std::max(arena_size, best_offset + size);
+    placed.push_back(i);
+  }
+  return arena_size;
+}
+
+StaticMemoryArena::StaticMemoryArena(
+    const framework::ProgramDesc &program,
+    const std::unordered_set<std::string> &skip_vars,
+    const platform::Place &place)
+    : place_(place) {
+  if (program.Size() > 1) {
+    valid_ = false;
+    return;
+  }
+  auto &block = program.Block(0);
+  auto ops = block.AllOps();
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto names = ops[i]->InputArgumentNames();
+    auto out_names = ops[i]->OutputArgumentNames();
+    names.insert(names.end(), out_names.begin(), out_names.end());
+    for (auto &name : names) {
+      if (skip_vars.count(name) || name == framework::kEmptyVarName) continue;
+      auto *var = block.FindVar(name);
+      if (var == nullptr || var->Persistable() ||
+          var->GetType() != framework::proto::VarType::LOD_TENSOR) {
+        continue;
+      }
+      auto it = lifetimes_.find(name);
+      if (it == lifetimes_.end()) {
+        lifetimes_.emplace(name, std::make_pair(static_cast<int>(i),
+                                                static_cast<int>(i)));
+        var_names_.push_back(name);
+      } else {
+        it->second.second = i;
+      }
+    }
+  }
+}
+
+void StaticMemoryArena::Plan(framework::Scope *scope,
+                             const BatchVarShapes &batch_var_shapes) {
+  PADDLE_ENFORCE(valid_, "The memory arena is not valid for the program.");
+  for (auto &batch : batch_var_shapes) {
+    for (auto &item : batch) {
+      if (!lifetimes_.count(item.first)) continue;
+      int64_t numel = std::accumulate(item.second.begin(), item.second.end(),
+                                      int64_t(1), std::multiplies<int64_t>());
+      auto &max_numel = batch_numels_[item.first];
+      max_numel = std::max(max_numel, numel);
+    }
+  }
+
+  // Group the tensors by their memory.
+  std::unordered_map<memory::Allocation *, size_t> block_ids;
+  std::vector<Block> blocks;
+  for (auto &name : var_names_) {
+    auto *var = scope->FindVar(name);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    auto &holder = tensor->Holder();
+    if (holder == nullptr || !(holder->place() == place_)) continue;
+    auto &lifetime = lifetimes_.at(name);
+    auto it = block_ids.find(holder.get());
+    if (it == block_ids.end()) {
+      it = block_ids.emplace(holder.get(), blocks.size()).first;
+      blocks.emplace_back();
+      blocks.back().size = 0;
+      blocks.back().begin = lifetime.first;
+      blocks.back().end = lifetime.second;
+      blocks.back().allocation = holder;
+    }
+    auto &block = blocks[it->second];
+    block.tensors.push_back(tensor);
+    block.names.push_back(name);
+    block.begin = std::min(block.begin, lifetime.first);
+    block.end = std::max(block.end, lifetime.second);
+  }
+
+  std::unordered_set<memory::Allocation *> old_allocations;
+  for (auto &block : blocks_) {
+    old_allocations.insert(block.allocation.get());
+  }
+  std::vector<Block> planned;
+  for (auto &block : blocks) {
+    // The memory is held by the tensors, blocks and the previous arena.
+    auto ref_count = static_cast<int64_t>(
+        block.tensors.size() + 1 +
+        old_allocations.count(block.allocation.get()));
+    if (block.allocation.use_count() > ref_count) {
+      VLOG(3) << "Skip " << block.names.front()
+              << " in the memory arena, whose memory is shared with others.";
+      continue;
+    }
+    size_t size = block.allocation->size();
+    size_t type_size =
+        framework::SizeOfType(block.tensors.front()->type());
+    for (auto &name : block.names) {
+      size = std::max(size, planned_sizes_[name]);
+      auto it = batch_numels_.find(name);
+      if (it != batch_numels_.end()) {
+        size = std::max(size, it->second * type_size);
+      }
+    }
+    for (auto &name : block.names) {
+      planned_sizes_[name] = size;
+    }
+    block.size = size;
+    block.allocation.reset();
+    planned.push_back(std::move(block));
+  }
+
+  // The tensors using the previous arena are cleared before it is freed. It
+  // is kept if the tensors out of the arena still use it.
+  bool arena_in_use = false;
+  for (auto &block : blocks_) {
+    for (auto *tensor : block.tensors) {
+      if (tensor->Holder() == block.allocation) tensor->clear();
+    }
+    arena_in_use = arena_in_use || block.allocation.use_count() > 1;
+  }
+  blocks_.clear();
+  if (arena_in_use) {
+    retired_arenas_.push_back(std::move(arena_));
+  }
+  arena_.reset();
+
+  std::vector<ArenaBlock> arena_blocks;
+  total_size_ = 0;
+  for (auto &block : planned) {
+    arena_blocks.push_back({block.size, block.begin, block.end});
+    total_size_ += block.size;
+  }
+  std::vector<size_t> offsets;
+  arena_size_ = PlanArenaOffsets(arena_blocks, kAlignment, &offsets);
+  if (arena_size_ > 0) {
+    arena_ = memory::Alloc(place_, arena_size_);
+    auto *base = static_cast<uint8_t *>(arena_->ptr());
+    for (size_t i = 0; i < planned.size(); ++i) {
+      planned[i].allocation = std::make_shared<memory::Allocation>(
+          base + offsets[i], planned[i].size, place_);
+    }
+  }
+  blocks_ = std::move(planned);
+
+  string::PrettyLogInfo(
+      "--- Planned a memory arena of %.2f MB for %d tensors of %.2f MB",
+      arena_size_ / 1024. / 1024., tensor_num(), total_size_ / 1024. / 1024.);
+}
+
+void StaticMemoryArena::Bind() const {
+  for (auto &block : blocks_) {
+    // Reset the holder without checking the size as ResetHolder does.
+    block.tensors.front()->clear();
+    block.tensors.front()->ResetHolder(block.allocation);
+    for (size_t i = 1; i < block.tensors.size(); ++i) {
+      block.tensors[i]->clear();
+    }
+  }
+}
+
+bool StaticMemoryArena::NeedReplan() const {
+  for (auto &block : blocks_) {
+    for (auto *tensor : block.tensors) {
+      auto &holder = tensor->Holder();
+      if (holder != nullptr && holder != block.allocation) return true;
+    }
+  }
+  return false;
+}
+
+size_t StaticMemoryArena::tensor_num() const {
+  size_t num = 0;
+  for (auto &block : blocks_) {
+    num += block.tensors.size();
+  }
+  return num;
+}
+
+}  // namespace details
+}  // namespace paddle
@@ -0,0 +1,123 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace details {
+
+// A memory block used by the tensors in the op range [begin, end].
+struct ArenaBlock {
+  size_t size;
+  int begin;
+  int end;
+};
+
+// Assigns every block an offset in one arena, the blocks whose op ranges
+// overlap never overlap in the arena. The blocks are placed from the largest
+// one, each in the smallest gap between the placed blocks it overlaps with
+// (best-fit), or after all of them. The offsets are aligned to alignment.
+// Returns the size of the arena.
+size_t PlanArenaOffsets(const std::vector<ArenaBlock> &blocks,
+                        size_t alignment, std::vector<size_t> *offsets);
+
+// Places the temporary tensors of an inference program in one pre-allocated
+// arena, so that running the program allocates no memory for them.
+//
+// The arena is planned by the tensors after a run: the tensors sharing one
+// memory block (e.g. the output of reshape2 and its input) are planned as one
+// block whose op range covers all of them, and the size of a block is the
+// max of its memory in the run and the sizes of its tensors in the batch
+// shapes collected for memory optimization. The tensors sharing memory with
+// the others out of the arena, e.g. the parameters and the feed and fetch
+// targets, are skipped.
+//
+// Before each run Bind() lets the tensors use their blocks, the tensors whose
+// data are larger than the planned blocks fall back to allocating by
+// themselves, and NeedReplan() tells the arena should be planned again.
+class StaticMemoryArena {
+ public:
+  using BatchVarShapes = std::vector<std::map<std::string, std::vector<int>>>;
+
+  // The lifetime of the variables are the op ranges in block 0 of program,
+  // in which the ops are run in order. The variables in skip_vars are never
+  // placed in the arena.
+  StaticMemoryArena(const framework::ProgramDesc &program,
+                    const std::unordered_set<std::string> &skip_vars,
+                    const platform::Place &place);
+
+  // Whether the arena can be used by program, false if the program has
+  // control flow ops whose sub-blocks use the variables out of block 0.
+  bool IsValid() const { return valid_; }
+
+  // Plans the arena by the tensors in scope after a run, and allocates it.
+  // The tensors using the previous arena are cleared.
+  void Plan(framework::Scope *scope, const BatchVarShapes &batch_var_shapes);
+
+  // Lets the tensors use their blocks in the arena, no memory is allocated.
+  void Bind() const;
+
+  // Whether any tensor was out of its block in the last run.
+  bool NeedReplan() const;
+
+  size_t arena_size() const { return arena_size_; }
+  // The sum of the sizes of the planned blocks.
+  size_t total_size() const { return total_size_; }
+  size_t tensor_num() const;
+
+ private:
+  struct Block {
+    // tensors[0] owns the block, the others share it with tensors[0].
+    std::vector<framework::LoDTensor *> tensors;
+    std::vector<std::string> names;
+    size_t size;
+    int begin;
+    int end;
+    std::shared_ptr<memory::Allocation> allocation;
+  };
+
+  static constexpr size_t kAlignment = 64;
+
+  platform::Place place_;
+  bool valid_{true};
+  // The var names in the order of their first use.
+  std::vector<std::string> var_names_;
+  std::unordered_map<std::string, std::pair<int, int>> lifetimes_;
+  // The max numel of the variables in the batch shapes.
+  std::unordered_map<std::string, int64_t> batch_numels_;
+  // The planned size of every variable, which never decreases.
+  std::unordered_map<std::string, size_t> planned_sizes_;
+
+  std::vector<Block> blocks_;
+  memory::AllocationPtr arena_;
+  std::vector<memory::AllocationPtr> retired_arenas_;
+  size_t arena_size_{0};
+  size_t total_size_{0};
+};
+
+}  // namespace details
+}  // namespace paddle
@@ -0,0 +1,172 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/static_memory_arena.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace details {
+
+TEST(PlanArenaOffsets, best_fit) {
+  // a and c are not used at the same time, b is used with both of them.
+  std::vector<ArenaBlock> blocks{{100, 0, 1}, {300, 1, 3}, {64, 2, 3}};
+  std::vector<size_t> offsets;
+  size_t arena_size = PlanArenaOffsets(blocks, 64, &offsets);
+  EXPECT_EQ(offsets[1], 0UL);
+  EXPECT_EQ(offsets[0], 320UL);
+  EXPECT_EQ(offsets[2], 320UL);
+  EXPECT_EQ(arena_size, 448UL);
+}
+
+// x -> fc -> a -> relu -> b -> reshape -> c -> relu -> d -> relu -> e -> fc ->
+// out, every op but reshape adds 1 to its input, reshape shares the memory of
+// its input.
+static framework::ProgramDesc CreateProgram() {
+  framework::ProgramDesc program;
+  auto *block = program.MutableBlock(0);
+  for (auto name : {"x", "a", "b", "c", "d", "e", "out"}) {
+    block->Var(name)->SetType(framework::proto::VarType::LOD_TENSOR);
+  }
+  std::vector<std::string> types{"fc", "relu", "reshape", "relu", "relu", "fc"};
+  std::vector<std::string> names{"x", "a", "b", "c", "d", "e", "out"};
+  for (size_t i = 0; i < types.size(); ++i) {
+    auto *op = block->AppendOp();
+    op->SetType(types[i]);
+    op->SetInput("X", {names[i]});
+    op->SetOutput("Out", {names[i + 1]});
+  }
+  return program;
+}
+
+static void RunProgram(const framework::ProgramDesc &program,
+                       framework::Scope *scope, int batch_size) {
+  platform::CPUPlace place;
+  auto *x = scope->Var("x")->GetMutable<framework::LoDTensor>();
+  x->Resize({batch_size, 16});
+  float *x_data = x->mutable_data<float>(place);
+  for (int64_t i = 0; i < x->numel(); ++i) {
+    x_data[i] = i;
+  }
+  for (auto *op : program.Block(0).AllOps()) {
+    auto &in = scope->Var(op->Input("X")[0])->Get<framework::LoDTensor>();
+    auto *out =
+        scope->Var(op->Output("Out")[0])->GetMutable<framework::LoDTensor>();
+    if (op->Type() == "reshape") {
+      out->ShareDataWith(in);
+      out->Resize({in.numel()});
+      continue;
+    }
+    out->Resize(in.dims());
+    const float *in_data = in.data<float>();
+    float *out_data = out->mutable_data<float>(place);
+    for (int64_t i = 0; i < out->numel(); ++i) {
+      out_data[i] = in_data[i] + 1;
+    }
+  }
+}
+
+static void ExpectOutput(const framework::Scope &scope, int batch_size) {
+  auto &out = scope.FindVar("out")->Get<framework::LoDTensor>();
+  ASSERT_EQ(out.numel(), batch_size * 16);
+  const float *data = out.data<float>();
+  for (int64_t i = 0; i < out.numel(); ++i) {
+    ASSERT_EQ(data[i], i + 5);
+  }
+}
+
+static std::vector<const void *> TensorPtrs(const framework::Scope &scope) {
+  std::vector<const void *> ptrs;
+  for (auto name : {"a", "b", "c", "d", "e"}) {
+    ptrs.push_back(scope.FindVar(name)->Get<framework::LoDTensor>().data<void>());
+  }
+  return ptrs;
+}
+
+TEST(StaticMemoryArena, plan_and_replan) {
+  auto program = CreateProgram();
+  framework::Scope scope;
+  StaticMemoryArena arena(program, {"x", "out"}, platform::CPUPlace());
+  ASSERT_TRUE(arena.IsValid());
+
+  RunProgram(program, &scope, 4);
+  arena.Plan(&scope, {});
+  // b and c share one block, a and d, b and e use the same memory.
+  EXPECT_EQ(arena.tensor_num(), 5UL);
+  EXPECT_EQ(arena.total_size(), 4UL * 4 * 16 * sizeof(float));
+  EXPECT_EQ(arena.arena_size(), 2UL * 4 * 16 * sizeof(float));
+
+  std::vector<const void *> ptrs;
+  for (int i = 0; i < 3; ++i) {
+    arena.Bind();
+    RunProgram(program, &scope, i == 2 ? 2 : 4);
+    ExpectOutput(scope, i == 2 ? 2 : 4);
+    EXPECT_FALSE(arena.NeedReplan());
+    if (i == 0) ptrs = TensorPtrs(scope);
+    EXPECT_EQ(TensorPtrs(scope), ptrs);
+  }
+  EXPECT_EQ(ptrs[0], ptrs[3]);
+  EXPECT_EQ(ptrs[1], ptrs[2]);
+  EXPECT_EQ(ptrs[1], ptrs[4]);
+
+  // A larger batch falls back to allocating, then the arena is planned again.
+  arena.Bind();
+  RunProgram(program, &scope, 8);
+  ExpectOutput(scope, 8);
+  EXPECT_TRUE(arena.NeedReplan());
+  arena.Plan(&scope, {});
+  EXPECT_EQ(arena.arena_size(), 2UL * 8 * 16 * sizeof(float));
+  for (int batch_size : {8, 4}) {
+    arena.Bind();
+    RunProgram(program, &scope, batch_size);
+    ExpectOutput(scope, batch_size);
+    EXPECT_FALSE(arena.NeedReplan());
+  }
+}
+
+TEST(StaticMemoryArena, batch_var_shapes) {
+  auto program = CreateProgram();
+  framework::Scope scope;
+  StaticMemoryArena arena(program, {"x", "out"}, platform::CPUPlace());
+  RunProgram(program, &scope, 4);
+  arena.Plan(&scope, {{{"a", {16, 16}}, {"d", {8, 16}}}});
+  EXPECT_EQ(arena.total_size(), (16UL + 4 + 8 + 4) * 16 * sizeof(float));
+  for (int batch_size : {16, 4}) {
+    arena.Bind();
+    RunProgram(program, &scope, batch_size);
+    ExpectOutput(scope, batch_size);
+  }
+}
+
+TEST(StaticMemoryArena, skip_shared_memory) {
+  auto program = CreateProgram();
+  // out shares the memory of e.
+  program.MutableBlock(0)->AllOps().back()->SetType("reshape");
+  framework::Scope scope;
+  StaticMemoryArena arena(program, {"x", "out"}, platform::CPUPlace());
+  RunProgram(program, &scope, 4);
+  arena.Plan(&scope, {});
+  EXPECT_EQ(arena.tensor_num(), 4UL);
+  auto *e_holder =
+      scope.FindVar("e")->Get<framework::LoDTensor>().Holder().get();
+  arena.Bind();
+  RunProgram(program, &scope, 4);
+  EXPECT_FALSE(arena.NeedReplan());
+  EXPECT_EQ(scope.FindVar("e")->Get<framework::LoDTensor>().Holder().get(),
+            e_holder);
+}
+
+}  // namespace details
+}  // namespace paddle
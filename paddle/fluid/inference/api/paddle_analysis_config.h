@@ -209,6 +209,16 @@ struct AnalysisConfig {
     return cpu_math_library_num_threads_;
   }
 
+  /** Set and get the number of threads to run the independent operators
+   * concurrently, each of which uses cpu_math_library_num_threads threads
+   * in the CPU math library. 1 means running the operators sequentially.
+   * Only works on CPU without MKLDNN.
+   */
+  void SetInterOpNumThreads(int inter_op_num_threads);
+  /** An int state telling how many threads are used to run operators.
+   */
+  int inter_op_num_threads() const { return inter_op_num_threads_; }
+
   /** Transform the AnalysisConfig to NativeConfig.
    */
   NativeConfig ToNativeConfig() const;
@@ -241,6 +251,20 @@ struct AnalysisConfig {
    */
   bool model_from_memory() const { return model_from_memory_; }
 
+  /** \brief Load the combined parameters file by mapping it into memory.
+   *
+   * The CPU parameters point to the mapping directly when their data are
+   * aligned in the file, which can be saved by `SaveOptimModel` of the
+   * predictor with `align_params` or the `align_payload` attribute of
+   * save_combine. The
+   * processes loading the same file share the memory through the page
+   * cache, and the parameters modified later are copied on write.
+   */
+  void SwitchParamsUseMmap(bool x = true);
+  /** A boolean state telling whether the parameters file is mapped.
+   */
+  bool params_use_mmap() const { return params_use_mmap_; }
+
   /** Turn on memory optimize
    * NOTE still in development, will release latter.
    */
@@ -249,6 +273,35 @@ struct AnalysisConfig {
   /** Tell whether the memory optimization is activated. */
   bool enable_memory_optim() const;
 
+  /** \brief Place the temporary tensors in one pre-allocated memory arena.
+   *
+   * The arena is planned by the tensors after the first `ZeroCopyRun` and the
+   * batch shapes collected for the static memory optimization, then the
+   * tensors are allocated in the arena instead of the memory pool. When a
+   * batch is larger than the planned one, the tensors out of the arena are
+   * allocated by themselves, and the arena is planned again.
+   */
+  void EnableMemoryArena(bool x = true);
+  /** A boolean state telling whether the memory arena is activated.
+   */
+  bool memory_arena_enabled() const { return use_memory_arena_; }
+
+  /** \brief Cache the optimized program on disk.
+   *
+   * The program optimized by the analysis and its parameters are saved in the
+   * optimize cache directory (set by `SetOptimCacheDir`, or `_opt_cache` in the
+   * model directory by default), keyed by the hash of the model files, this
+   * config and the passes. The predictors created later with the same key load
+   * them instead of running the analysis. It does not work with TensorRT,
+   * Anakin and the MKL-DNN quantizer.
+   */
+  void EnableOptimProgramCache(bool x = true);
+  /** A boolean state telling whether the optimized program cache is activated.
+   */
+  bool optim_program_cache_enabled() const {
+    return use_optim_program_cache_;
+  }
+
   /** \brief Turn on profiling report.
    *
    * If not turned on, no profiling report will be generateed.
@@ -258,6 +311,17 @@ struct AnalysisConfig {
    */
   bool profile_enabled() const { return with_profile_; }
 
+  /** \brief Turn on the always-on latency monitor.
+   *
+   * The monitor collects the latency histograms of the operators with little
+   * overhead, which can be exported by `GetOpLatencySnapshot` of the
+   * predictor at any time.
+   */
+  void EnableLatencyMonitor();
+  /** A boolean state telling whether the latency monitor is activated.
+   */
+  bool latency_monitor_enabled() const { return with_latency_monitor_; }
+
   void SetInValid() const { is_valid_ = false; }
   bool is_valid() const { return is_valid_; }
 
@@ -311,12 +375,15 @@ struct AnalysisConfig {
   bool enable_memory_optim_{false};
   bool static_memory_optim_{false};
   bool static_memory_optim_force_update_{false};
+  bool use_memory_arena_{false};
+  bool use_optim_program_cache_{false};
 
   bool use_ngraph_{false};
   bool use_mkldnn_{false};
   std::unordered_set<std::string> mkldnn_enabled_op_types_;
 
   bool model_from_memory_{false};
+  bool params_use_mmap_{false};
 
   bool enable_ir_optim_{true};
   bool use_feed_fetch_ops_{true};
@@ -325,8 +392,10 @@ struct AnalysisConfig {
   bool specify_input_name_{false};
 
   int cpu_math_library_num_threads_{1};
+  int inter_op_num_threads_{1};
 
   bool with_profile_{false};
+  bool with_latency_monitor_{false};
 
   // A runtime cache, shouldn't be transferred to others.
   std::string serialized_info_cache_;
@@ -23,6 +23,7 @@
  */
 
 #include <cassert>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -199,6 +200,19 @@ class ZeroCopyTensor {
   int device_;
 };
 
+/** Latency statistics of an operator type, collected by the always-on
+ * latency monitor. All the times are in milliseconds.
+ */
+struct PaddleOpLatency {
+  std::string name;  // operator type.
+  uint64_t calls{0};
+  double total_ms{0};
+  double min_ms{0};
+  double max_ms{0};
+  double p50_ms{0};
+  double p99_ms{0};
+};
+
 /** A simple Inference API for Paddle.
  */
 class PaddlePredictor {
@@ -268,6 +282,20 @@ class PaddlePredictor {
    */
   virtual bool ZeroCopyRun() { return false; }
 
+  /** \brief Get the latency statistics of the operators since the last
+   * snapshot.
+   *
+   * NOTE Only works in AnalysisPredictor with the latency monitor enabled by
+   * `AnalysisConfig.EnableLatencyMonitor()`. The statistics are collected
+   * from all the predictors in the process, and are reset after each
+   * snapshot if `reset` is true. For GPU operators, the latency is the time
+   * spent on the host.
+   */
+  virtual std::vector<PaddleOpLatency> GetOpLatencySnapshot(
+      bool reset = true) {
+    return {};
+  }
+
   /** Clone a predictor that share the model weights, the Cloned predictor
    * should be thread-safe.
    */
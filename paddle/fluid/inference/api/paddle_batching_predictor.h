@@ -0,0 +1,122 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*! \file */
+
+// Here we include some header files with relative paths, for that in deploy,
+// the abstract path of this header file will be changed.
+#include "paddle_analysis_config.h"  // NOLINT
+#include "paddle_api.h"              // NOLINT
+
+namespace paddle {
+
+/** Configs of the request batching of `BatchingPredictor`.
+ */
+struct BatchingConfig {
+  /** The maximum number of samples in a batch. A sample is a row of the first
+   * input, or a sequence if the first input has LoD.
+   */
+  int max_batch_size{32};
+  /** The maximum time in microseconds a request waits for other requests to
+   * fill the batch.
+   */
+  int max_wait_us{1000};
+  /** The number of predictors running batches concurrently, they share the
+   * model weights.
+   */
+  int num_workers{1};
+};
+
+/** Request and batch statistics of `BatchingPredictor`. The latency of a
+ * request is from `Run` is called to it returns, in milliseconds.
+ */
+struct PaddleBatchingStats {
+  uint64_t requests{0};
+  uint64_t failed_requests{0};
+  uint64_t batches{0};
+  double avg_batch_size{0};  // samples per batch.
+  double avg_batch_fill{0};  // avg_batch_size / max_batch_size.
+  double avg_requests_per_batch{0};
+  double avg_queue_ms{0};  // time waited before the batch runs.
+  double avg_latency_ms{0};
+  double p50_latency_ms{0};
+  double p99_latency_ms{0};
+  double max_latency_ms{0};
+};
+
+/** \brief A front end of `AnalysisPredictor` which batches the requests.
+ *
+ * `Run` can be called from many threads, each with a single request. The
+ * requests are coalesced into a batch of at most `max_batch_size` samples,
+ * or of the requests that arrive in `max_wait_us` after the first one. Each
+ * batch runs with one `ZeroCopyRun`, and the outputs are split back to the
+ * requests.
+ *
+ * The inputs of the requests are concatenated along the first dimension, so
+ * the requests in a batch should have the same input names, data types and
+ * the dimensions except the first one. The LoD of the inputs are
+ * concatenated too. An output is split by the top level of its LoD if it has
+ * one, otherwise by the first dimension, so every sample should produce the
+ * same number of top level sequences or rows of the output.
+ *
+ * Usage:
+ *
+ * \code{cpp}
+ * AnalysisConfig config;
+ * config.SetModel(model_dir);
+ * BatchingConfig batching_config;
+ * batching_config.max_batch_size = 64;
+ * BatchingPredictor predictor(config, batching_config);
+ * // in each serving thread
+ * std::vector<PaddleTensor> outputs;
+ * predictor.Run(inputs, &outputs);
+ * \endcode
+ */
+class BatchingPredictor {
+ public:
+  /** Create the predictors from the config, the feed and fetch ops are
+   * disabled to run with `ZeroCopyRun`.
+   */
+  BatchingPredictor(const AnalysisConfig& config,
+                    const BatchingConfig& batching_config);
+  BatchingPredictor(const BatchingPredictor&) = delete;
+  BatchingPredictor& operator=(const BatchingPredictor&) = delete;
+  /** Wait for the queued requests to finish and stop the workers.
+   */
+  ~BatchingPredictor();
+
+  /** Run a request in the next batch and wait for its outputs. The names of
+   * the inputs can be omitted if they are in the order of the model inputs.
+   *
+   * Returns false if the request or its batch fails.
+   */
+  bool Run(const std::vector<PaddleTensor>& inputs,
+           std::vector<PaddleTensor>* outputs);
+
+  /** Get the statistics since the last reset.
+   */
+  PaddleBatchingStats GetStats(bool reset = false);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace paddle
@@ -119,8 +119,9 @@ GpuPassStrategy::GpuPassStrategy() : PassStrategy({}) {
         "conv_elementwise_add_fuse_pass",       //
 #endif                                          //
         "transpose_flatten_concat_fuse_pass",
-        // following pass should be located in the last, since it will
+        // following passes should be located in the last, since they will
         // work on all fused ops.
+        "infer_shape_cache_pass",  //
         "runtime_context_cache_pass"
   });
 
@@ -153,21 +154,25 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
                   "attention_lstm_fuse_pass",       //
                   "seqconv_eltadd_relu_fuse_pass",  //
                   // "seqpool_concat_fuse_pass",    //
-                  "seqpool_cvm_concat_fuse_pass",  //
+                  "seqpool_cvm_concat_fuse_pass",        //
                   // "embedding_fc_lstm_fuse_pass", //
-                  "fc_lstm_fuse_pass",             //
-                  "mul_lstm_fuse_pass",            //
-                  "fc_gru_fuse_pass",              //
-                  "mul_gru_fuse_pass",             //
-                  "seq_concat_fc_fuse_pass",       //
-                  "fc_fuse_pass",                  //
-                  "repeated_fc_relu_fuse_pass",    //
-                  "squared_mat_sub_fuse_pass",     //
-                  "conv_bn_fuse_pass",             //
-                  "conv_eltwiseadd_bn_fuse_pass",  //
-                  "is_test_pass",                  //
-                  // following pass should be located in the last, since
-                  // it will work on all fused ops.
+                  "fc_lstm_fuse_pass",                   //
+                  "mul_lstm_fuse_pass",                  //
+                  "fc_gru_fuse_pass",                    //
+                  "mul_gru_fuse_pass",                   //
+                  "seq_concat_fc_fuse_pass",             //
+                  "fc_fuse_pass",                        //
+                  "multihead_attention_fuse_pass",       //
+                  "fc_elementwise_layernorm_fuse_pass",  //
+                  "repeated_fc_relu_fuse_pass",          //
+                  "squared_mat_sub_fuse_pass",           //
+                  "conv_bn_fuse_pass",                   //
+                  "conv_eltwiseadd_bn_fuse_pass",        //
+                  "is_test_pass",                        //
+                  "gemm_weight_pack_pass",               //
+                  // following passes should be located in the last, since
+                  // they will work on all fused ops.
+                  "infer_shape_cache_pass",  //
                   "runtime_context_cache_pass"});
 
   use_gpu_ = false;
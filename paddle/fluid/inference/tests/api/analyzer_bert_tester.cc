@@ -168,6 +168,21 @@ void profile(bool use_mkldnn = false, bool use_ngraph = false) {
 }
 
 TEST(Analyzer_bert, profile) { profile(); }
+
+// Profile the graph without the fusions of the multi-head attention and
+// fc + elementwise_add + layer_norm, as the baseline of the fused one.
+TEST(Analyzer_bert, profile_unfused) {
+  AnalysisConfig config;
+  SetConfig(&config);
+  config.pass_builder()->DeletePass("multihead_attention_fuse_pass");
+  config.pass_builder()->DeletePass("fc_elementwise_layernorm_fuse_pass");
+
+  std::vector<std::vector<PaddleTensor>> outputs;
+  std::vector<std::vector<PaddleTensor>> inputs;
+  LoadInputData(&inputs);
+  TestPrediction(reinterpret_cast<const PaddlePredictor::Config *>(&config),
+                 inputs, &outputs, FLAGS_num_threads);
+}
 #ifdef PADDLE_WITH_MKLDNN
 TEST(Analyzer_bert, profile_mkldnn) { profile(true, false); }
 #endif
@@ -26,6 +26,7 @@
 #include "paddle/fluid/memory/allocation/locked_allocator.h"
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
+#include "paddle/fluid/memory/allocation/thread_local_cached_allocator.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/place.h"
@@ -41,6 +42,9 @@ DEFINE_int64(
     "The retry time (milliseconds) when allocator fails "
     "to allocate memory. No retry if this value is not greater than 0");
 
+DECLARE_uint64(cpu_thread_cache_max_size);
+DECLARE_uint64(cpu_thread_cache_capacity_in_mb);
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -74,6 +78,18 @@ class AllocatorFacadePrivate {
         break;
       }
 
+      case AllocatorStrategy::kThreadLocal: {
+        InitThreadLocalCachedCPUAllocator();
+#ifdef PADDLE_WITH_CUDA
+        for (int dev_id = 0; dev_id < platform::GetCUDADeviceCount();
+             ++dev_id) {
+          InitAutoGrowthCUDAAllocator(platform::CUDAPlace(dev_id));
+        }
+        InitNaiveBestFitCUDAPinnedAllocator();
+#endif
+        break;
+      }
+
       default: {
         PADDLE_THROW("Unsupported allocator strategy: %d",
                      static_cast<int>(strategy));
@@ -103,6 +119,21 @@ class AllocatorFacadePrivate {
         std::make_shared<NaiveBestFitAllocator>(platform::CPUPlace());
   }
 
+  // Small allocations are served by per-thread free lists without locking,
+  // and the cache misses fall into a shared auto-growth chunk pool, which
+  // reuses the chunks instead of calling posix_memalign for each allocation.
+  void InitThreadLocalCachedCPUAllocator() {
+    // Align the blocks split from the chunks to the cache line size.
+    size_t alignment = 64;
+    auto cpu_allocator = std::make_shared<CPUAllocator>();
+    auto chunk_pool = std::make_shared<AutoGrowthBestFitAllocator>(
+        cpu_allocator, alignment, platform::CpuMaxChunkSize());
+    allocators_[platform::CPUPlace()] =
+        std::make_shared<ThreadLocalCachedAllocator>(
+            chunk_pool, FLAGS_cpu_thread_cache_max_size,
+            FLAGS_cpu_thread_cache_capacity_in_mb << 20);
+  }
+
 #ifdef PADDLE_WITH_CUDA
   void InitNaiveBestFitCUDAPinnedAllocator() {
     allocators_[platform::CUDAPinnedPlace()] =
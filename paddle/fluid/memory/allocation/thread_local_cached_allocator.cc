@@ -0,0 +1,227 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_local_cached_allocator.h"
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+static constexpr size_t kMinClassShift = 8;
+static constexpr size_t kClassNumPerPowerOfTwo = 4;
+
+constexpr size_t ThreadLocalCachedAllocator::kMinClassSize;
+
+size_t ThreadLocalCachedAllocator::SizeClassIndex(size_t size) {
+  if (size <= kMinClassSize) return 0;
+  size_t shift = kMinClassShift;
+  while ((static_cast<size_t>(1) << (shift + 1)) < size) ++shift;
+  // size is in (2^shift, 2^(shift+1)], which is split into 4 classes
+  size_t step = static_cast<size_t>(1) << (shift - 2);
+  size_t sub = (size - (static_cast<size_t>(1) << shift) + step - 1) / step;
+  return 1 + (shift - kMinClassShift) * kClassNumPerPowerOfTwo + (sub - 1);
+}
+
+size_t ThreadLocalCachedAllocator::SizeClassSize(size_t idx) {
+  if (idx == 0) return kMinClassSize;
+  size_t shift = kMinClassShift + (idx - 1) / kClassNumPerPowerOfTwo;
+  size_t sub = (idx - 1) % kClassNumPerPowerOfTwo + 1;
+  return (static_cast<size_t>(1) << shift) +
+         sub * (static_cast<size_t>(1) << (shift - 2));
+}
+
+// The allocation of a cached size class. Its size is exactly the size of the
+// class so that FreeImpl can find the free list without any extra field.
+class CachedAllocation : public Allocation {
+ public:
+  CachedAllocation(AllocationPtr underlying_allocation, size_t class_size)
+      : Allocation(underlying_allocation->ptr(), class_size,
+                   underlying_allocation->place()),
+        underlying_allocation_(std::move(underlying_allocation)) {}
+
+ private:
+  AllocationPtr underlying_allocation_;
+};
+
+// NOTE: ThreadCache is only accessed by its owner thread, except that the
+// destructor of ThreadLocalCachedAllocator releases all caches. Using an
+// allocator while destroying it is not allowed anyway.
+struct ThreadLocalCachedAllocator::ThreadCache {
+  explicit ThreadCache(size_t class_num) : free_lists_(class_num) {}
+
+  ~ThreadCache() {
+    for (auto &free_list : free_lists_) {
+      for (auto *allocation : free_list) {
+        delete allocation;
+      }
+    }
+  }
+
+  std::vector<std::vector<Allocation *>> free_lists_;
+  size_t cached_bytes_{0};
+};
+
+struct ThreadLocalCachedAllocator::CacheRegistry {
+  std::mutex mtx_;
+  bool alive_{true};
+  std::list<std::unique_ptr<ThreadCache>> caches_;
+};
+
+// Used to bypass the thread caches when some allocation is freed during the
+// destruction of thread local variables.
+static thread_local bool thread_cache_holder_destroyed = false;
+
+// Holds the caches of the current thread for all alive allocators, and
+// returns the cached allocations to the allocators when the thread exits.
+struct ThreadCacheHolder {
+  struct Entry {
+    const void *key_;
+    std::weak_ptr<ThreadLocalCachedAllocator::CacheRegistry> registry_;
+    ThreadLocalCachedAllocator::ThreadCache *cache_;
+  };
+
+  ~ThreadCacheHolder() {
+    thread_cache_holder_destroyed = true;
+    for (auto &entry : entries_) {
+      Release(entry);
+    }
+  }
+
+  static void Release(const Entry &entry) {
+    auto registry = entry.registry_.lock();
+    if (!registry) return;
+    std::lock_guard<std::mutex> guard(registry->mtx_);
+    if (!registry->alive_) return;
+    auto &caches = registry->caches_;
+    for (auto it = caches.begin(); it != caches.end(); ++it) {
+      if (it->get() == entry.cache_) {
+        caches.erase(it);
+        break;
+      }
+    }
+  }
+
+  std::vector<Entry> entries_;
+};
+
+ThreadLocalCachedAllocator::ThreadLocalCachedAllocator(
+    std::shared_ptr<Allocator> underlying_allocator, size_t max_cached_size,
+    size_t cache_capacity)
+    : underlying_allocator_(std::move(underlying_allocator)),
+      cache_capacity_(cache_capacity),
+      registry_(std::make_shared<CacheRegistry>()) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      "UnderlyingAllocator of ThreadLocalCachedAllocator must not be null");
+  PADDLE_ENFORCE(underlying_allocator_->IsAllocThreadSafe(),
+                 "UnderlyingAllocator of ThreadLocalCachedAllocator must be "
+                 "thread-safe");
+  // Round max_cached_size up to a class boundary, so that any allocation
+  // whose size is larger than max_cached_size_ is not cached.
+  size_t max_class_idx =
+      SizeClassIndex(std::max(max_cached_size, kMinClassSize));
+  max_cached_size_ = SizeClassSize(max_class_idx);
+  class_num_ = max_class_idx + 1;
+  VLOG(10) << "ThreadLocalCachedAllocator: max_cached_size "
+           << max_cached_size_ << ", class_num " << class_num_
+           << ", cache_capacity " << cache_capacity_;
+}
+
+ThreadLocalCachedAllocator::~ThreadLocalCachedAllocator() {
+  std::lock_guard<std::mutex> guard(registry_->mtx_);
+  registry_->alive_ = false;
+  registry_->caches_.clear();
+}
+
+ThreadLocalCachedAllocator::ThreadCache *
+ThreadLocalCachedAllocator::GetThreadCache() {
+  static thread_local ThreadCacheHolder holder;
+  const void *key = registry_.get();
+  auto &entries = holder.entries_;
+  for (auto &entry : entries) {
+    if (entry.key_ == key && !entry.registry_.expired()) {
+      return entry.cache_;
+    }
+  }
+
+  // Slow path: remove the entries of destroyed allocators, and create a new
+  // cache for this thread.
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [](const ThreadCacheHolder::Entry &entry) {
+                                 return entry.registry_.expired();
+                               }),
+                entries.end());
+
+  auto *cache = new ThreadCache(class_num_);
+  {
+    std::lock_guard<std::mutex> guard(registry_->mtx_);
+    registry_->caches_.emplace_back(cache);
+  }
+  entries.push_back(ThreadCacheHolder::Entry{key, registry_, cache});
+  return cache;
+}
+
+Allocation *ThreadLocalCachedAllocator::AllocateImpl(size_t size) {
+  if (size > max_cached_size_) {
+    return underlying_allocator_->Allocate(size).release();
+  }
+
+  size_t idx = SizeClassIndex(size);
+  if (!thread_cache_holder_destroyed) {
+    auto *cache = GetThreadCache();
+    auto &free_list = cache->free_lists_[idx];
+    if (!free_list.empty()) {
+      auto *allocation = free_list.back();
+      free_list.pop_back();
+      cache->cached_bytes_ -= allocation->size();
+      return allocation;
+    }
+  }
+
+  size_t class_size = SizeClassSize(idx);
+  return new CachedAllocation(underlying_allocator_->Allocate(class_size),
+                              class_size);
+}
+
+void ThreadLocalCachedAllocator::FreeImpl(Allocation *allocation) {
+  size_t size = allocation->size();
+  if (size > max_cached_size_) {
+    underlying_allocator_->Free(allocation);
+    return;
+  }
+
+  if (!thread_cache_holder_destroyed) {
+    auto *cache = GetThreadCache();
+    if (cache->cached_bytes_ + size <= cache_capacity_) {
+      cache->free_lists_[SizeClassIndex(size)].push_back(allocation);
+      cache->cached_bytes_ += size;
+      return;
+    }
+  }
+
+  // The cache is full, return the memory to the underlying allocator
+  delete allocation;
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,84 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * ThreadLocalCachedAllocator keeps per-thread free lists of recently freed
+ * small allocations in front of a shared, thread-safe underlying allocator
+ * (usually an AutoGrowthBestFitAllocator).
+ *
+ * Requests are rounded up to a size class. Each power of two between
+ * kMinClassSize and max_cached_size is split into 4 classes, so the internal
+ * fragmentation is at most 25%. Requests larger than max_cached_size go to
+ * the underlying allocator directly.
+ *
+ * Allocate/Free of a cached size class touch only the calling thread's free
+ * list and do not take any lock. The cached bytes of each thread are bounded
+ * by cache_capacity. Freed allocations are cached in the freeing thread, and
+ * all caches of a thread are returned to the underlying allocator when the
+ * thread exits.
+ */
+class ThreadLocalCachedAllocator : public Allocator {
+ public:
+  ThreadLocalCachedAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                             size_t max_cached_size, size_t cache_capacity);
+
+  ~ThreadLocalCachedAllocator();
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  static constexpr size_t kMinClassSize = 256;
+
+  // Returns the size class index of size, size must be in
+  // [1, max_cached_size].
+  static size_t SizeClassIndex(size_t size);
+
+  // Returns the byte size of the size class idx.
+  static size_t SizeClassSize(size_t idx);
+
+ protected:
+  Allocation *AllocateImpl(size_t size) override;
+  void FreeImpl(Allocation *allocation) override;
+
+ private:
+  struct ThreadCache;
+  struct CacheRegistry;
+
+  ThreadCache *GetThreadCache();
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  size_t max_cached_size_;
+  size_t cache_capacity_;
+  size_t class_num_;
+
+  std::shared_ptr<CacheRegistry> registry_;
+
+  friend struct ThreadCacheHolder;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
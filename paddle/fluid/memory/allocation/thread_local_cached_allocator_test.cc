@@ -0,0 +1,144 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_local_cached_allocator.h"
+#include <gtest/gtest.h>
+#include <chrono>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+static std::shared_ptr<Allocator> GetChunkPool() {
+  return std::make_shared<AutoGrowthBestFitAllocator>(
+      std::make_shared<CPUAllocator>(), 64, 64 << 20);
+}
+
+TEST(thread_local_cached_allocator, size_class) {
+  using A = ThreadLocalCachedAllocator;
+  ASSERT_EQ(A::SizeClassIndex(1), 0UL);
+  ASSERT_EQ(A::SizeClassIndex(A::kMinClassSize), 0UL);
+  ASSERT_EQ(A::SizeClassSize(0), A::kMinClassSize);
+
+  size_t prev_size = 0;
+  for (size_t idx = 0; idx < 64; ++idx) {
+    size_t class_size = A::SizeClassSize(idx);
+    ASSERT_GT(class_size, prev_size);
+    // The internal fragmentation is at most 25%
+    ASSERT_LE(class_size, prev_size + prev_size / 4 + A::kMinClassSize);
+    ASSERT_EQ(A::SizeClassIndex(class_size), idx);
+    ASSERT_EQ(A::SizeClassIndex(prev_size + 1), idx);
+    prev_size = class_size;
+  }
+}
+
+TEST(thread_local_cached_allocator, reuse) {
+  ThreadLocalCachedAllocator allocator(GetChunkPool(), 1 << 20, 1 << 20);
+
+  void *ptr = nullptr;
+  {
+    auto allocation = allocator.Allocate(1000);
+    ASSERT_NE(allocation->ptr(), nullptr);
+    ASSERT_GE(allocation->size(), 1000UL);
+    ptr = allocation->ptr();
+  }
+
+  // The freed allocation of the same size class should be reused
+  {
+    auto allocation = allocator.Allocate(1010);
+    ASSERT_EQ(allocation->ptr(), ptr);
+  }
+
+  // Large allocations are not cached
+  {
+    auto allocation = allocator.Allocate(4 << 20);
+    ASSERT_NE(allocation->ptr(), nullptr);
+    ASSERT_GE(allocation->size(), static_cast<size_t>(4 << 20));
+  }
+}
+
+TEST(thread_local_cached_allocator, cross_thread_free) {
+  auto allocator = std::make_shared<ThreadLocalCachedAllocator>(
+      GetChunkPool(), 1 << 16, 1 << 20);
+
+  std::vector<AllocationPtr> allocations;
+  for (size_t i = 1; i <= 100; ++i) {
+    allocations.emplace_back(allocator->Allocate(i * 1000));
+  }
+
+  std::thread th([&] {
+    allocations.clear();
+    for (size_t i = 1; i <= 100; ++i) {
+      auto allocation = allocator->Allocate(i * 1000);
+      ASSERT_GE(allocation->size(), i * 1000);
+    }
+  });
+  th.join();
+  allocator.reset();
+}
+
+template <typename AllocatorT>
+static double BenchmarkAllocate(const std::shared_ptr<AllocatorT> &allocator,
+                                size_t thread_num, size_t iter_num) {
+  auto alloc_func = [&](unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> dist(1, 64 << 10);
+    std::vector<AllocationPtr> allocations(16);
+    for (size_t i = 0; i < iter_num; ++i) {
+      allocations[i % allocations.size()] = allocator->Allocate(dist(gen));
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> ths;
+  for (size_t i = 0; i < thread_num; ++i) {
+    ths.emplace_back(alloc_func, static_cast<unsigned int>(i));
+  }
+  for (auto &th : ths) {
+    th.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         (thread_num * iter_num);
+}
+
+TEST(thread_local_cached_allocator, multithread_benchmark) {
+  const size_t iter_num = 20000;
+  for (size_t thread_num : {1, 4, 16, 32}) {
+    auto naive =
+        std::make_shared<NaiveBestFitAllocator>(platform::CPUPlace());
+    auto auto_growth = GetChunkPool();
+    auto thread_local_cached = std::make_shared<ThreadLocalCachedAllocator>(
+        GetChunkPool(), 1 << 20, 64 << 20);
+
+    LOG(INFO) << "threads " << thread_num << ", us per allocation: "
+              << "naive_best_fit "
+              << BenchmarkAllocate(naive, thread_num, iter_num)
+              << ", auto_growth "
+              << BenchmarkAllocate(auto_growth, thread_num, iter_num)
+              << ", thread_local "
+              << BenchmarkAllocate(thread_local_cached, thread_num, iter_num);
+  }
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -14,11 +14,14 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/benchmark/op_tester.h"
 #include <fstream>
+#include <numeric>
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/init.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/platform/timer.h"
@@ -42,6 +45,21 @@ void OpTester::Init(const OpTesterConfig &config) {
   // Initialize the OpDesc
   if (op_desc_info.Has(config_.op_type)) {
     type_ = config_.op_type;
+    proto_type_ = type_;
+    // The gradient ops have no proto, their inputs, outputs and attributes
+    // are deduced from the proto of the forward op.
+    const std::string grad_suffix = "_grad";
+    if (!op_desc_info.Get(type_).HasOpProtoAndChecker() &&
+        type_.size() > grad_suffix.size() &&
+        type_.compare(type_.size() - grad_suffix.size(), grad_suffix.size(),
+                      grad_suffix) == 0) {
+      proto_type_ = type_.substr(0, type_.size() - grad_suffix.size());
+      is_grad_op_ = true;
+      PADDLE_ENFORCE(op_desc_info.Has(proto_type_) &&
+                         op_desc_info.Get(proto_type_).HasOpProtoAndChecker(),
+                     "The forward op %s of %s is not registered.", proto_type_,
+                     type_);
+    }
 
     CreateOpDesc();
     CreateInputVarDesc();
@@ -57,6 +75,7 @@ void OpTester::Init(const OpTesterConfig &config) {
   }
 
   framework::InitDevices(false);
+  platform::SetNumThreads(config_.num_threads);
   scope_.reset(new paddle::framework::Scope());
 
   op_ = framework::OpRegistry::CreateOp(op_desc_);
@@ -99,8 +118,9 @@ void OpTester::Run() {
     timer.Pause();
   }
   config_.runtime = timer.ElapsedMS() / config_.repeat;
-  LOG(INFO) << "=== Run " << config_.repeat
-            << " times, latency: " << config_.runtime << " ms ===";
+  LOG(INFO) << "=== Run " << config_.repeat << " times with "
+            << config_.num_threads
+            << " threads, latency: " << config_.runtime << " ms ===";
 }
 
 void OpTester::RunImpl() {
@@ -112,18 +132,46 @@ void OpTester::RunImpl() {
 std::vector<std::string> OpTester::GetOpProtoInputNames() {
   std::vector<std::string> input_names;
   const framework::proto::OpProto &proto =
-      framework::OpInfoMap::Instance().Get(type_).Proto();
+      framework::OpInfoMap::Instance().Get(proto_type_).Proto();
   for (int i = 0; i != proto.inputs_size(); ++i) {
     const auto &input = proto.inputs(i);
     input_names.push_back(input.name());
   }
+  if (is_grad_op_) {
+    // The gradient op may take any of the inputs and outputs of the forward
+    // op, and the gradients of the outputs.
+    for (int i = 0; i != proto.outputs_size(); ++i) {
+      const auto &output = proto.outputs(i);
+      input_names.push_back(output.name());
+      input_names.push_back(framework::GradVarName(output.name()));
+    }
+  }
   return input_names;
 }
 
+bool OpTester::IsDispensableInput(const std::string &name) {
+  const framework::proto::OpProto &proto =
+      framework::OpInfoMap::Instance().Get(proto_type_).Proto();
+  for (int i = 0; i != proto.inputs_size(); ++i) {
+    const auto &input = proto.inputs(i);
+    if (input.name() == name) {
+      return input.dispensable();
+    }
+  }
+  return false;
+}
+
 std::vector<std::string> OpTester::GetOpProtoOutputNames() {
   std::vector<std::string> output_names;
   const framework::proto::OpProto &proto =
-      framework::OpInfoMap::Instance().Get(type_).Proto();
+      framework::OpInfoMap::Instance().Get(proto_type_).Proto();
+  if (is_grad_op_) {
+    for (int i = 0; i != proto.inputs_size(); ++i) {
+      const auto &input = proto.inputs(i);
+      output_names.push_back(framework::GradVarName(input.name()));
+    }
+    return output_names;
+  }
   for (int i = 0; i != proto.outputs_size(); ++i) {
     const auto &output = proto.outputs(i);
     output_names.push_back(output.name());
@@ -135,7 +183,7 @@ std::unordered_map<std::string, framework::proto::AttrType>
 OpTester::GetOpProtoAttrNames() {
   std::unordered_map<std::string, framework::proto::AttrType> attr_types;
   const framework::proto::OpProto &proto =
-      framework::OpInfoMap::Instance().Get(type_).Proto();
+      framework::OpInfoMap::Instance().Get(proto_type_).Proto();
   const std::vector<std::string> skipped_attrs = {
       framework::OpProtoAndCheckerMaker::OpRoleAttrName(),
       framework::OpProtoAndCheckerMaker::OpRoleVarAttrName(),
@@ -169,6 +217,9 @@ void OpTester::CreateInputVarDesc() {
   std::vector<std::string> input_names = GetOpProtoInputNames();
   for (auto &name : input_names) {
     const OpInputConfig *input = config_.GetInput(name);
+    if (input == nullptr && (is_grad_op_ || IsDispensableInput(name))) {
+      continue;
+    }
     if (input == nullptr) {
       LOG(FATAL) << "The input " << name << " of op " << config_.op_type
                  << " is not correctlly provided.";
@@ -177,7 +228,11 @@ void OpTester::CreateInputVarDesc() {
     std::string var_name = config_.op_type + "." + name;
     framework::VarDesc *var = Var(var_name);
     // Need to support more type
-    var->SetType(framework::proto::VarType::LOD_TENSOR);
+    if (input->var_type == "selected_rows") {
+      var->SetType(framework::proto::VarType::SELECTED_ROWS);
+    } else {
+      var->SetType(framework::proto::VarType::LOD_TENSOR);
+    }
     var->SetPersistable(false);
     var->SetDataType(TransToVarType(input->dtype));
     var->SetShape(input->dims);
@@ -214,8 +269,10 @@ void OpTester::CreateOpDesc() {
     const std::string &value_str = item.second;
     const framework::proto::AttrType &type = attr_types[name];
     switch (type) {
-      case framework::proto::AttrType::BOOLEAN:
-        break;
+      case framework::proto::AttrType::BOOLEAN: {
+        bool value = value_str == "true" || value_str == "1";
+        op_desc_.SetAttr(name, value);
+      } break;
       case framework::proto::AttrType::INT: {
         int value = StringTo<int>(value_str);
         op_desc_.SetAttr(name, {value});
@@ -227,8 +284,11 @@ void OpTester::CreateOpDesc() {
       case framework::proto::AttrType::STRING: {
         op_desc_.SetAttr(name, {value_str});
       } break;
+      case framework::proto::AttrType::INTS: {
+        std::vector<int> value = StringToVector<int>(value_str);
+        op_desc_.SetAttr(name, value);
+      } break;
       case framework::proto::AttrType::BOOLEANS:
-      case framework::proto::AttrType::INTS:
       case framework::proto::AttrType::FLOATS:
       case framework::proto::AttrType::STRINGS:
         LOG(FATAL) << "Not supported yet.";
@@ -255,7 +315,7 @@ framework::VarDesc *OpTester::Var(const std::string &name) {
 }
 
 template <typename T>
-void OpTester::SetupTensor(framework::LoDTensor *tensor,
+void OpTester::SetupTensor(framework::Tensor *tensor,
                            const std::vector<int64_t> &shape, T lower, T upper,
                            const std::string &initializer,
                            const std::string &filename) {
@@ -264,6 +324,7 @@ void OpTester::SetupTensor(framework::LoDTensor *tensor,
   std::uniform_real_distribution<double> uniform_dist(0, 1);
 
   T *ptr = tensor->mutable_data<T>(framework::make_ddim(shape), place_);
+  int64_t numel = tensor->numel();
 
   framework::LoDTensor cpu_tensor;
   T *cpu_ptr = nullptr;
@@ -276,20 +337,20 @@ void OpTester::SetupTensor(framework::LoDTensor *tensor,
   }
 
   if (initializer == "random") {
-    for (int i = 0; i < cpu_tensor.numel(); ++i) {
+    for (int64_t i = 0; i < numel; ++i) {
       cpu_ptr[i] = static_cast<T>(uniform_dist(rng) * (upper - lower) + lower);
     }
   } else if (initializer == "natural") {
-    for (int i = 0; i < cpu_tensor.numel(); ++i) {
+    for (int64_t i = 0; i < numel; ++i) {
       cpu_ptr[i] = static_cast<T>(lower + i);
     }
   } else if (initializer == "zeros") {
-    for (int i = 0; i < cpu_tensor.numel(); ++i) {
+    for (int64_t i = 0; i < numel; ++i) {
       cpu_ptr[i] = static_cast<T>(0);
     }
   } else if (initializer == "file") {
     std::ifstream is(filename);
-    for (size_t i = 0; i < cpu_tensor.numel(); ++i) {
+    for (int64_t i = 0; i < numel; ++i) {
       T value;
       is >> value;
       cpu_ptr[i] = static_cast<T>(value);
@@ -331,7 +392,21 @@ void OpTester::CreateVariables(framework::Scope *scope) {
     std::vector<int64_t> shape = var_desc->GetShape();
 
     auto *var = scope->Var(var_name);
-    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    framework::Tensor *tensor = nullptr;
+    framework::LoDTensor *lod_tensor = nullptr;
+    if (var_desc->GetType() == framework::proto::VarType::SELECTED_ROWS) {
+      // The selected rows contain all the rows of the value, in order.
+      auto *selected_rows = var->GetMutable<framework::SelectedRows>();
+      std::vector<int64_t> rows(shape[0]);
+      std::iota(rows.begin(), rows.end(), 0);
+      selected_rows->set_rows(rows);
+      selected_rows->set_height(shape[0]);
+      selected_rows->SyncIndex();
+      tensor = selected_rows->mutable_value();
+    } else {
+      lod_tensor = var->GetMutable<framework::LoDTensor>();
+      tensor = lod_tensor;
+    }
     const auto &data_type = var_desc->GetDataType();
     if (data_type == framework::proto::VarType::INT32) {
       SetupTensor<int>(tensor, shape, 0, 1, item.second.initializer,
@@ -351,13 +426,15 @@ void OpTester::CreateVariables(framework::Scope *scope) {
       PADDLE_THROW("Unsupported dtype %d.", data_type);
     }
 
-    VLOG(3) << "Set lod for tensor " << var_name;
-    std::vector<std::vector<size_t>> &lod_vec = item.second.lod;
-    framework::LoD lod;
-    for (size_t i = 0; i < lod_vec.size(); ++i) {
-      lod.push_back(lod_vec[i]);
+    if (lod_tensor != nullptr) {
+      VLOG(3) << "Set lod for tensor " << var_name;
+      std::vector<std::vector<size_t>> &lod_vec = item.second.lod;
+      framework::LoD lod;
+      for (size_t i = 0; i < lod_vec.size(); ++i) {
+        lod.push_back(lod_vec[i]);
+      }
+      lod_tensor->set_lod(lod);
     }
-    tensor->set_lod(lod);
   }
 }
 
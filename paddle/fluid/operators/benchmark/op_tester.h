@@ -40,6 +40,7 @@ class OpTester {
 
  private:
   std::vector<std::string> GetOpProtoInputNames();
+  bool IsDispensableInput(const std::string &name);
   std::vector<std::string> GetOpProtoOutputNames();
   std::unordered_map<std::string, framework::proto::AttrType>
   GetOpProtoAttrNames();
@@ -53,7 +54,7 @@ class OpTester {
   void CreateVariables(framework::Scope *scope);
 
   template <typename T>
-  void SetupTensor(framework::LoDTensor *input,
+  void SetupTensor(framework::Tensor *input,
                    const std::vector<int64_t> &shape, T lower, T upper,
                    const std::string &initializer, const std::string &filename);
 
@@ -62,6 +63,8 @@ class OpTester {
  private:
   OpTesterConfig config_;
   std::string type_;
+  std::string proto_type_;  // the forward op of a gradient op.
+  bool is_grad_op_{false};
   framework::OpDesc op_desc_;
   std::unordered_map<std::string, std::unique_ptr<framework::VarDesc>> vars_;
   std::unordered_map<std::string, OpInputConfig> inputs_;
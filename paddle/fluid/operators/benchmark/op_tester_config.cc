@@ -48,6 +48,8 @@ OpInputConfig::OpInputConfig(std::istream& is) {
       if (sep == "name" || sep == "name:") {
         is >> name;
         EraseEndSep(&name);
+      } else if (sep == "var_type" || sep == "var_type:") {
+        ParseVarType(is);
       } else if (sep == "dtype" || sep == "dtype:") {
         ParseDType(is);
       } else if (sep == "initializer" || sep == "initializer:") {
@@ -64,6 +66,21 @@ OpInputConfig::OpInputConfig(std::istream& is) {
   }
 }
 
+void OpInputConfig::ParseVarType(std::istream& is) {
+  std::string var_type_str;
+  is >> var_type_str;
+  EraseEndSep(&var_type_str);
+
+  const std::vector<std::string> supported_var_types = {"lod_tensor",
+                                                        "selected_rows"};
+  if (!Has(supported_var_types, var_type_str)) {
+    PADDLE_THROW("Unsupported var_type %s", var_type_str.c_str());
+  }
+
+  var_type = var_type_str;
+  VLOG(4) << "var_type of input " << name << " is: " << var_type;
+}
+
 void OpInputConfig::ParseDType(std::istream& is) {
   std::string dtype_str;
   is >> dtype_str;
@@ -171,6 +188,8 @@ bool OpTesterConfig::Init(std::istream& is) {
         is >> device_id;
       } else if (sep == "repeat" || sep == "repeat:") {
         is >> repeat;
+      } else if (sep == "num_threads" || sep == "num_threads:") {
+        is >> num_threads;
       } else if (sep == "profile" || sep == "profile:") {
         is >> profile;
       } else if (sep == "print_debug_string" || sep == "print_debug_string:") {
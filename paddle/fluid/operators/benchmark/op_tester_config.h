@@ -28,12 +28,14 @@ struct OpInputConfig {
   OpInputConfig() {}
   explicit OpInputConfig(std::istream& is);
 
+  void ParseVarType(std::istream& is);
   void ParseDType(std::istream& is);
   void ParseInitializer(std::istream& is);
   void ParseDims(std::istream& is);
   void ParseLoD(std::istream& is);
 
   std::string name;
+  std::string var_type{"lod_tensor"};  // lod_tensor, selected_rows
   std::string dtype{"fp32"};  // int32/int, int64/long, fp32/float, fp64/double
   std::string initializer{"random"};  // random, natural, zeros, file
   std::string filename{""};
@@ -56,6 +58,7 @@ struct OpTesterConfig {
   std::unordered_map<std::string, std::string> attrs;
   int device_id{-1};  // CPU: -1
   int repeat{1};
+  int num_threads{1};  // set by platform::SetNumThreads
   int profile{0};
   int print_debug_string{0};
   double runtime{0.0};
@@ -78,6 +81,18 @@ T StringTo(const std::string& str) {
   return value;
 }
 
+// Parse a list of values separated by commas, e.g. "3,3".
+template <typename T>
+std::vector<T> StringToVector(const std::string& str) {
+  std::vector<T> values;
+  std::istringstream is(str);
+  std::string token;
+  while (std::getline(is, token, ',')) {
+    values.push_back(StringTo<T>(token));
+  }
+  return values;
+}
+
 }  // namespace benchmark
 }  // namespace operators
 }  // namespace paddle
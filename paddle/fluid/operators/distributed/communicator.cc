@@ -34,18 +34,31 @@ DEFINE_bool(communicator_independent_recv_thread, true,
 DEFINE_int32(communicator_min_send_grad_num_before_recv, 20,
              "max grad num to send before recv parameters");
 DEFINE_int32(communicator_thread_pool_size, 5, "thread num to do send or recv");
-DEFINE_int32(communicator_send_wait_times, 5,
-             "times that send thread will wait if merge num does not reach "
-             "max_merge_var_num");
+DEFINE_int32(communicator_send_wait_ms, 10,
+             "max time in ms that a gradient waits in the queue before being "
+             "merged and sent, if merge num does not reach max_merge_var_num");
 DEFINE_bool(communicator_fake_rpc, false,
             "fake mode does not really send any thing");
 DEFINE_bool(communicator_merge_sparse_grad, true,
             "merge sparse gradient before sending");
+DEFINE_string(communicator_grad_compress_type, "none",
+              "compress the merged dense gradient before sending, "
+              "none, topk, int8 or int16");
+DEFINE_double(communicator_grad_compress_topk_ratio, 0.01,
+              "ratio of the elements of a gradient sent by topk compression");
+DEFINE_int32(communicator_grad_compress_min_numel, 1024,
+             "gradients with fewer elements are sent without compression");
 
 namespace paddle {
 namespace operators {
 namespace distributed {
 
+// A gradient is merged and sent as soon as its queue has so many gradients.
+static size_t MergeNumToSend() {
+  return static_cast<size_t>(std::min(FLAGS_communicator_max_merge_var_num,
+                                      FLAGS_communicator_send_queue_size));
+}
+
 inline double GetCurrentUS() {
   struct timeval time;
   gettimeofday(&time, NULL);
@@ -69,13 +82,18 @@ Communicator::Communicator(const RpcCtxMap &send_varname_to_ctx,
           << FLAGS_communicator_min_send_grad_num_before_recv;
   VLOG(0) << "communicator_thread_pool_size: "
           << FLAGS_communicator_thread_pool_size;
-  VLOG(0) << "communicator_send_wait_times: "
-          << FLAGS_communicator_send_wait_times;
+  VLOG(0) << "communicator_send_wait_ms: " << FLAGS_communicator_send_wait_ms;
   VLOG(0) << "communicator_max_merge_var_num: "
           << FLAGS_communicator_max_merge_var_num;
   VLOG(0) << "communicator_fake_rpc: " << FLAGS_communicator_fake_rpc;
   VLOG(0) << "communicator_merge_sparse_grad: "
           << FLAGS_communicator_merge_sparse_grad;
+  VLOG(0) << "communicator_grad_compress_type: "
+          << FLAGS_communicator_grad_compress_type;
+  VLOG(0) << "communicator_grad_compress_topk_ratio: "
+          << FLAGS_communicator_grad_compress_topk_ratio;
+  VLOG(0) << "communicator_grad_compress_min_numel: "
+          << FLAGS_communicator_grad_compress_min_numel;
 
   if (send_varname_to_ctx.size() == 0) {
     VLOG(0) << "nothing need to be send, will not start send_thread";
@@ -85,9 +103,17 @@ Communicator::Communicator(const RpcCtxMap &send_varname_to_ctx,
       send_varname_to_queue_[iter.first] =
           std::make_shared<BlockingQueue<std::shared_ptr<Variable>>>(
               FLAGS_communicator_send_queue_size);
+      send_var_states_[iter.first];
     }
     send_threadpool_.reset(
         new ::ThreadPool(FLAGS_communicator_thread_pool_size));
+    auto compress_type =
+        StringToGradCompressType(FLAGS_communicator_grad_compress_type);
+    if (compress_type != GradCompressType::kNone) {
+      grad_compressor_.reset(new GradientCompressor(
+          compress_type, FLAGS_communicator_grad_compress_topk_ratio,
+          FLAGS_communicator_grad_compress_min_numel));
+    }
   }
 
   if (recv_varname_to_ctx.size() == 0) {
@@ -104,6 +130,7 @@ Communicator::~Communicator() {
     fwrite(msg.c_str(), msg.length(), 1, stdout);
   }
   running_ = false;
+  WakeUpThreads();
   if (send_thread_) send_thread_->join();
   if (recv_thread_) recv_thread_->join();
   if (FLAGS_v >= 3) {
@@ -114,84 +141,153 @@ Communicator::~Communicator() {
 
 void Communicator::SendThread() {
   VLOG(3) << "SendThread start!";
+  const auto max_wait =
+      std::chrono::milliseconds(FLAGS_communicator_send_wait_ms);
+  const size_t merge_num_to_send = MergeNumToSend();
+  std::unique_lock<std::mutex> lock(send_mutex_);
   while (running_) {
-    std::vector<std::future<void>> task_futures;
-    task_futures.reserve(send_varname_to_ctx_.size());
-    VLOG(3) << "run send graph";
-    auto before_run_send_graph = GetCurrentUS();
-    for (auto &iter : send_varname_to_queue_) {
-      auto &var_name = iter.first;
-      auto &var_queue = iter.second;
-      if (var_queue->Size() > 0) {
-        auto send_task = [this, &var_name, &var_queue] {
-          VLOG(3) << var_name << " merge and send";
-          std::vector<std::shared_ptr<Variable>> vars;
-          size_t merged_var_num = 0;
-          size_t wait_times = 0;
-          while (merged_var_num < FLAGS_communicator_max_merge_var_num) {
-            if (var_queue->Size() == 0) {
-              VLOG(3) << "wait_times -> " << wait_times;
-              if (wait_times >= FLAGS_communicator_send_wait_times) {
-                break;
-              }
-              std::this_thread::sleep_for(std::chrono::milliseconds(10));
-              wait_times++;
-              continue;
-            } else {
-              wait_times = 0;
-
-              vars.push_back(var_queue->Pop());
-              // only count the send number of the first var
-              if (var_name == send_varname_to_queue_.begin()->first) {
-                grad_num_.fetch_add(1, std::memory_order_relaxed);
-              }
-              merged_var_num++;
-            }
-          }
-          auto before_merge = GetCurrentUS();
-          MergeVars(var_name, vars, send_scope_.get());
-          auto after_merge = GetCurrentUS();
-          VLOG(3) << "merge " << merged_var_num << " " << var_name
-                  << " use time " << after_merge - before_merge;
-          auto send_functor = distributed::ParameterSend<float>();
-          auto &ctx = send_varname_to_ctx_.at(var_name);
-          if (!FLAGS_communicator_fake_rpc) {
-            send_functor(ctx, *send_scope_, true);
-          }
-          auto after_send = GetCurrentUS();
-          VLOG(3) << "send " << var_name << " use time "
-                  << after_send - after_merge;
-        };
-        task_futures.emplace_back(
-            send_threadpool_->enqueue(std::move(send_task)));
+    auto now = Clock::now();
+    bool has_pending = false;
+    auto next_deadline = Clock::time_point::max();
+    std::vector<std::string> ready_vars;
+    for (auto &iter : send_var_states_) {
+      auto &state = iter.second;
+      if (state.in_flight || !state.pending) {
+        continue;
+      }
+      if (send_varname_to_queue_.at(iter.first)->Size() == 0) {
+        state.pending = false;
+        continue;
+      }
+      auto deadline = state.pending_since + max_wait;
+      if (send_varname_to_queue_.at(iter.first)->Size() >= merge_num_to_send ||
+          deadline <= now) {
+        state.in_flight = true;
+        ready_vars.push_back(iter.first);
       } else {
-        VLOG(4) << var_name << " queue empty";
+        has_pending = true;
+        next_deadline = std::min(next_deadline, deadline);
       }
     }
-    for (auto &task_f : task_futures) {
-      task_f.wait();
-    }
-    auto after_run_send_graph = GetCurrentUS();
 
-    VLOG(3) << "run send graph use time "
-            << after_run_send_graph - before_run_send_graph;
-    RecvNonIndependent();
+    if (!ready_vars.empty()) {
+      in_flight_num_ += ready_vars.size();
+      for (auto &var_name : ready_vars) {
+        VLOG(4) << var_name << " is ready to merge and send";
+        send_threadpool_->enqueue([this, var_name] { MergeAndSend(var_name); });
+      }
+    } else if (!FLAGS_communicator_independent_recv_thread &&
+               in_flight_num_ == 0 && grad_num_.load() > 0) {
+      // recv in the send thread when nothing is being sent
+      lock.unlock();
+      RecvAll();
+      grad_num_.store(0);
+      lock.lock();
+    } else if (has_pending) {
+      send_cv_.wait_until(lock, next_deadline);
+    } else {
+      send_cv_.wait(lock);
+    }
   }
+  send_cv_.wait(lock, [this] { return in_flight_num_ == 0; });
   VLOG(0) << "communicator stopped, send thread exit";
 }
 
-void Communicator::RecvNonIndependent() {
-  if (FLAGS_communicator_independent_recv_thread) {
-    return;
+void Communicator::MergeAndSend(const std::string &var_name) {
+  auto &var_queue = send_varname_to_queue_.at(var_name);
+  auto &state = send_var_states_.at(var_name);
+  auto start = Clock::now();
+  size_t queue_size = 0;
+  std::vector<std::shared_ptr<Variable>> vars;
+  uint64_t wait_us = 0;
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    queue_size = var_queue->Size();
+    vars = var_queue->PopUpTo(FLAGS_communicator_max_merge_var_num);
+    wait_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  start - state.pending_since)
+                  .count();
+    // the rest gradients in the queue are counted from now
+    state.pending = var_queue->Size() > 0;
+    state.pending_since = start;
   }
 
-  auto grad_num = grad_num_.load();
-  if (grad_num > 0) {
-    RecvAll();
-    grad_num_.store(0);
-  } else {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  if (!vars.empty()) {
+    try {
+      MergeVars(var_name, vars, send_scope_.get());
+      auto after_merge = Clock::now();
+      VLOG(3) << "merge " << vars.size() << " " << var_name << " use time "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     after_merge - start)
+                     .count();
+      auto send_functor = distributed::ParameterSend<float>();
+      auto &ctx = send_varname_to_ctx_.at(var_name);
+      if (!FLAGS_communicator_fake_rpc) {
+        send_functor(ctx, *send_scope_, true, grad_compressor_.get());
+      }
+    } catch (const std::exception &e) {
+      LOG(ERROR) << "merge and send " << var_name << " failed: " << e.what();
+    }
+    // only count the send number of the first var
+    if (var_name == send_varname_to_queue_.begin()->first) {
+      auto grad_num = grad_num_.fetch_add(vars.size()) + vars.size();
+      if (grad_num > FLAGS_communicator_min_send_grad_num_before_recv) {
+        { std::lock_guard<std::mutex> lock(recv_mutex_); }
+        recv_cv_.notify_one();
+      }
+    }
   }
+
+  auto send_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                     Clock::now() - start)
+                     .count();
+  VLOG(3) << "send " << var_name << " queue size " << queue_size << " merge "
+          << vars.size() << " wait time " << wait_us << " use time "
+          << send_us;
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    auto &stat = state.stat;
+    stat.max_queue_size = std::max(stat.max_queue_size, queue_size);
+    stat.send_num += 1;
+    stat.merged_grad_num += vars.size();
+    stat.total_wait_us += wait_us;
+    stat.max_wait_us = std::max(stat.max_wait_us, wait_us);
+    stat.total_send_us += send_us;
+    stat.max_send_us = std::max<uint64_t>(stat.max_send_us, send_us);
+    state.in_flight = false;
+    --in_flight_num_;
+  }
+  send_cv_.notify_all();
+
+  if (grad_compressor_) {
+    auto stat = grad_compressor_->TakeStat();
+    if (stat.num_vars > 0) {
+      VLOG(1) << "compress " << stat.num_vars << " grads from "
+              << stat.raw_bytes << " to " << stat.compressed_bytes
+              << " bytes, ratio "
+              << static_cast<double>(stat.raw_bytes) / stat.compressed_bytes
+              << ", use time " << stat.time_us;
+    }
+  }
+}
+
+std::unordered_map<std::string, SendVarStat> Communicator::GetSendStats() {
+  std::unordered_map<std::string, SendVarStat> stats;
+  std::lock_guard<std::mutex> lock(send_mutex_);
+  for (auto &iter : send_var_states_) {
+    auto &stat = stats[iter.first];
+    stat = iter.second.stat;
+    stat.queue_size = send_varname_to_queue_.at(iter.first)->Size();
+  }
+  return stats;
+}
+
+void Communicator::WakeUpThreads() {
+  // lock to not notify between the check of running_ and the wait
+  { std::lock_guard<std::mutex> lock(send_mutex_); }
+  send_cv_.notify_all();
+  { std::lock_guard<std::mutex> lock(recv_mutex_); }
+  recv_cv_.notify_all();
 }
 
 void Communicator::RecvAll() {
@@ -221,14 +317,20 @@ void Communicator::RecvAll() {
 void Communicator::RecvThread() {
   VLOG(3) << "RecvThread start!";
   while (running_) {
-    auto grad_num = grad_num_.load();
-    if (grad_num > FLAGS_communicator_min_send_grad_num_before_recv) {
-      VLOG(1) << "current grad num " << grad_num;
-      RecvAll();
-      grad_num_.store(0);
-    } else {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    {
+      std::unique_lock<std::mutex> lock(recv_mutex_);
+      recv_cv_.wait(lock, [this] {
+        return !running_ ||
+               grad_num_.load() >
+                   FLAGS_communicator_min_send_grad_num_before_recv;
+      });
+    }
+    if (!running_) {
+      break;
     }
+    VLOG(1) << "current grad num " << grad_num_.load();
+    RecvAll();
+    grad_num_.store(0);
   }
   VLOG(0) << "communicator stopped, recv thread exit";
 }
@@ -252,6 +354,22 @@ void Communicator::Send(const std::string &var_name,
     auto &queue = send_varname_to_queue_.at(var_name);
     VLOG(3) << "send " << var_name << " queue size " << queue->Size();
     queue->Push(tmp_grad_var);
+
+    bool notify = false;
+    {
+      std::lock_guard<std::mutex> lock(send_mutex_);
+      auto &state = send_var_states_.at(var_name);
+      if (!state.pending) {
+        state.pending = true;
+        state.pending_since = Clock::now();
+        notify = true;
+      } else {
+        notify = queue->Size() >= MergeNumToSend();
+      }
+    }
+    if (notify) {
+      send_cv_.notify_one();
+    }
   }
 }
 
@@ -324,6 +442,7 @@ void Communicator::Start() {
 void Communicator::Stop() {
   VLOG(0) << "Communicator stop";
   running_ = false;
+  WakeUpThreads();
   if (!communicator_) {
     VLOG(0) << "Communicator is not inited, do nothing";
   } else {
@@ -15,6 +15,8 @@ limitations under the License. */
 #pragma once
 
 #include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
 #include <deque>
 #include <memory>
 #include <string>
@@ -26,6 +28,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/operators/distributed/gradient_compress.h"
 #include "paddle/fluid/operators/distributed/rpc_common.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
@@ -78,6 +81,20 @@ class BlockingQueue {
     return rc;
   }
 
+  // Pop at most max_num elements without blocking.
+  std::vector<T> PopUpTo(size_t max_num) {
+    std::vector<T> elems;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (!queue_.empty() && elems.size() < max_num) {
+        elems.emplace_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+    }
+    cv_.notify_all();
+    return elems;
+  }
+
   size_t Cap() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return capacity_;
@@ -159,6 +176,22 @@ inline void MergeVars(const std::string& var_name,
 
 using RpcCtxMap = std::unordered_map<std::string, RpcContext>;
 
+// The counters of sending a gradient, to tune the staleness of the async
+// training by FLAGS_communicator_max_merge_var_num and
+// FLAGS_communicator_send_wait_ms.
+struct SendVarStat {
+  size_t queue_size = 0;         // the gradients waiting in the queue now
+  size_t max_queue_size = 0;     // the most gradients waiting at a merge
+  uint64_t send_num = 0;         // the merged gradients sent
+  uint64_t merged_grad_num = 0;  // the gradients merged into them
+  // the time from a gradient getting into the empty queue to the merge
+  uint64_t total_wait_us = 0;
+  uint64_t max_wait_us = 0;
+  // the time of merging and sending
+  uint64_t total_send_us = 0;
+  uint64_t max_send_us = 0;
+};
+
 class Communicator {
  public:
   Communicator(const RpcCtxMap& send_varname_to_ctx,
@@ -174,14 +207,28 @@ class Communicator {
   // send grad
   void Send(const std::string& var_name, const framework::Scope& scope);
 
+  std::unordered_map<std::string, SendVarStat> GetSendStats();
+
  private:
+  using Clock = std::chrono::steady_clock;
+
+  struct SendVarState {
+    // the queue got gradients since pending_since
+    bool pending = false;
+    Clock::time_point pending_since;
+    // a task is merging and sending the gradient
+    bool in_flight = false;
+    SendVarStat stat;
+  };
+
   // recv all parameter
   void RecvAll();
-  void RecvNonIndependent();
   void SendThread();
   void RecvThread();
+  void MergeAndSend(const std::string& var_name);
+  void WakeUpThreads();
 
-  bool running_ = false;
+  std::atomic<bool> running_{false};
   std::unordered_map<std::string,
                      std::shared_ptr<BlockingQueue<std::shared_ptr<Variable>>>>
       send_varname_to_queue_;
@@ -195,6 +242,20 @@ class Communicator {
   std::unique_ptr<::ThreadPool> recv_threadpool_{nullptr};
   std::atomic_uint grad_num_{0};  // the num of gradient sent since last recv
 
+  // The send thread waits for the gradients in send_var_states_ to be
+  // ready, i.e., having FLAGS_communicator_max_merge_var_num gradients or
+  // having waited FLAGS_communicator_send_wait_ms, and starts a task to
+  // merge and send each of them in send_threadpool_.
+  std::mutex send_mutex_;
+  std::condition_variable send_cv_;
+  std::unordered_map<std::string, SendVarState> send_var_states_;
+  size_t in_flight_num_ = 0;
+  // The recv thread waits for grad_num_ to be large enough.
+  std::mutex recv_mutex_;
+  std::condition_variable recv_cv_;
+  // compress the merged dense gradients, nullptr if not compressed
+  std::unique_ptr<GradientCompressor> grad_compressor_;
+
   // the following code is for initialize the commnunicator
  public:
   static void Init(const RpcCtxMap& send_varname_to_ctx,
@@ -15,11 +15,17 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <memory>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "paddle/fluid/operators/distributed/communicator.h"
 
+DECLARE_bool(communicator_fake_rpc);
+DECLARE_int32(communicator_max_merge_var_num);
+DECLARE_int32(communicator_send_wait_ms);
+
 namespace paddle {
 namespace operators {
 namespace distributed {
@@ -106,6 +112,55 @@ TEST(communicator, merge_selected_rows) {
   }
 }
 
+TEST(communicator, send_by_merge_num_and_wait_time) {
+  FLAGS_communicator_fake_rpc = true;
+  FLAGS_communicator_max_merge_var_num = 4;
+  FLAGS_communicator_send_wait_ms = 50;
+
+  const std::string grad_name = "x@GRAD";
+  RpcCtxMap send_ctx;
+  send_ctx[grad_name] =
+      RpcContext(grad_name, {grad_name}, {"127.0.0.1:0"}, {}, 0);
+  framework::Scope scope;
+  scope.Var(grad_name)->GetMutable<LoDTensor>()->mutable_data<float>(
+      framework::make_ddim({2, 3}), platform::CPUPlace());
+  Communicator::Init(send_ctx, RpcCtxMap(), &scope);
+  auto *communicator = Communicator::GetInstance();
+  communicator->Start();
+
+  auto wait_for_merged_num = [&](uint64_t num) {
+    for (int i = 0; i < 1000; ++i) {
+      if (communicator->GetSendStats()[grad_name].merged_grad_num >= num) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return communicator->GetSendStats()[grad_name];
+  };
+
+  // The full merges are sent without waiting.
+  for (int i = 0; i < 8; ++i) {
+    communicator->Send(grad_name, scope);
+  }
+  auto stat = wait_for_merged_num(8);
+  EXPECT_EQ(stat.merged_grad_num, 8UL);
+  EXPECT_GE(stat.send_num, 2UL);
+  EXPECT_LE(stat.max_queue_size, 8UL);
+
+  // A partial merge is sent after the wait time.
+  auto start = std::chrono::steady_clock::now();
+  communicator->Send(grad_name, scope);
+  stat = wait_for_merged_num(9);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(stat.merged_grad_num, 9UL);
+  EXPECT_EQ(stat.queue_size, 0UL);
+  EXPECT_GE(elapsed, std::chrono::milliseconds(45));
+  EXPECT_GE(stat.max_wait_us, 45000UL);
+
+  communicator->Stop();
+  EXPECT_FALSE(communicator->IsRunning());
+}
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
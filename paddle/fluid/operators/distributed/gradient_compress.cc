@@ -0,0 +1,310 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/gradient_compress.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+namespace {
+
+constexpr uint32_t kCompressedGradMagic = 0x5a434750;
+
+// The layout of a compressed gradient is the header followed by the payload:
+//   kTopK:  uint32 indices[num_values], float values[num_values]
+//   kInt8:  int8 values[numel], the value is values[i] * scale
+//   kInt16: int16 values[numel], the value is values[i] * scale
+struct CompressedGradHeader {
+  uint32_t magic;
+  int32_t type;
+  int32_t rank;
+  float scale;
+  int64_t numel;
+  int64_t num_values;
+  int64_t dims[framework::DDim::kMaxRank];
+};
+
+int64_t PayloadBytes(GradCompressType type, int64_t num_values) {
+  switch (type) {
+    case GradCompressType::kTopK:
+      return num_values * (sizeof(uint32_t) + sizeof(float));
+    case GradCompressType::kInt8:
+      return num_values * sizeof(int8_t);
+    case GradCompressType::kInt16:
+      return num_values * sizeof(int16_t);
+    default:
+      PADDLE_THROW("Unknown gradient compress type %d",
+                   static_cast<int>(type));
+  }
+}
+
+uint8_t* AllocCompressed(const CompressedGradHeader& header,
+                         framework::LoDTensor* out) {
+  int64_t size = sizeof(header) +
+                 PayloadBytes(static_cast<GradCompressType>(header.type),
+                              header.num_values);
+  out->set_lod(framework::LoD());
+  auto* data = out->mutable_data<uint8_t>(framework::make_ddim({size}),
+                                          platform::CPUPlace());
+  memcpy(data, &header, sizeof(header));
+  return data + sizeof(header);
+}
+
+void CompressTopK(double ratio, float* grad, CompressedGradHeader* header,
+                  framework::LoDTensor* out) {
+  int64_t numel = header->numel;
+  PADDLE_ENFORCE_LE(numel,
+                    static_cast<int64_t>(std::numeric_limits<uint32_t>::max()),
+                    "The gradient is too large to compress by top-k.");
+  int64_t k = static_cast<int64_t>(std::ceil(ratio * numel));
+  k = std::min(std::max<int64_t>(k, 1), numel);
+
+  std::vector<uint32_t> indices(numel);
+  std::iota(indices.begin(), indices.end(), 0);
+  std::nth_element(indices.begin(), indices.begin() + (k - 1), indices.end(),
+                   [grad](uint32_t a, uint32_t b) {
+                     return std::fabs(grad[a]) > std::fabs(grad[b]);
+                   });
+  indices.resize(k);
+  std::sort(indices.begin(), indices.end());
+
+  header->num_values = k;
+  auto* out_indices =
+      reinterpret_cast<uint32_t*>(AllocCompressed(*header, out));
+  auto* out_values = reinterpret_cast<float*>(out_indices + k);
+  for (int64_t i = 0; i < k; ++i) {
+    out_indices[i] = indices[i];
+    out_values[i] = grad[indices[i]];
+    grad[indices[i]] = 0;
+  }
+}
+
+template <typename QT>
+void Quantize(float* grad, CompressedGradHeader* header,
+              framework::LoDTensor* out) {
+  int64_t numel = header->numel;
+  float max_abs = 0;
+  for (int64_t i = 0; i < numel; ++i) {
+    max_abs = std::max(max_abs, std::fabs(grad[i]));
+  }
+  const float kQuantMax = std::numeric_limits<QT>::max();
+  header->scale = max_abs / kQuantMax;
+  header->num_values = numel;
+  auto* values = reinterpret_cast<QT*>(AllocCompressed(*header, out));
+  if (header->scale == 0) {
+    memset(values, 0, numel * sizeof(QT));
+    return;
+  }
+  float inv_scale = 1.0f / header->scale;
+  for (int64_t i = 0; i < numel; ++i) {
+    float q = std::round(grad[i] * inv_scale);
+    q = std::min(std::max(q, -kQuantMax), kQuantMax);
+    values[i] = static_cast<QT>(q);
+    grad[i] -= q * header->scale;
+  }
+}
+
+template <typename QT>
+void Dequantize(const uint8_t* payload, const CompressedGradHeader& header,
+                float* out) {
+  PADDLE_ENFORCE_EQ(header.num_values, header.numel,
+                    "The quantized gradient should have all the values.");
+  auto* values = reinterpret_cast<const QT*>(payload);
+  for (int64_t i = 0; i < header.numel; ++i) {
+    out[i] = values[i] * header.scale;
+  }
+}
+
+}  // namespace
+
+GradCompressType StringToGradCompressType(const std::string& type) {
+  if (type == "none" || type.empty()) {
+    return GradCompressType::kNone;
+  } else if (type == "topk") {
+    return GradCompressType::kTopK;
+  } else if (type == "int8") {
+    return GradCompressType::kInt8;
+  } else if (type == "int16") {
+    return GradCompressType::kInt16;
+  }
+  PADDLE_THROW(
+      "Unknown gradient compress type %s, should be none, topk, int8 or "
+      "int16.",
+      type);
+}
+
+GradientCompressor::GradientCompressor(GradCompressType type,
+                                       double topk_ratio, int64_t min_numel)
+    : type_(type), topk_ratio_(topk_ratio), min_numel_(min_numel) {
+  if (type_ == GradCompressType::kTopK) {
+    PADDLE_ENFORCE(topk_ratio_ > 0 && topk_ratio_ <= 1,
+                   "The top-k ratio should be in (0, 1], but got %f.",
+                   topk_ratio_);
+  }
+}
+
+framework::Tensor* GradientCompressor::GetResidual(
+    const std::string& name, const framework::DDim& dims) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& residual = residuals_[name];
+  if (residual == nullptr ||
+      residual->numel() != framework::product(dims)) {
+    residual.reset(new framework::Tensor());
+    auto* data = residual->mutable_data<float>(dims, platform::CPUPlace());
+    memset(data, 0, residual->numel() * sizeof(float));
+  }
+  return residual.get();
+}
+
+bool GradientCompressor::Compress(const std::string& name,
+                                  const framework::Tensor& grad,
+                                  framework::LoDTensor* out) {
+  if (type_ == GradCompressType::kNone || !grad.IsInitialized() ||
+      grad.type() != framework::proto::VarType::FP32 ||
+      !platform::is_cpu_place(grad.place()) || grad.numel() < min_numel_ ||
+      grad.dims().size() > framework::DDim::kMaxRank) {
+    return false;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  // Only one thread sends a gradient at a time, so its residual is not
+  // locked.
+  int64_t numel = grad.numel();
+  float* acc = GetResidual(name, grad.dims())->data<float>();
+  const float* grad_data = grad.data<float>();
+  for (int64_t i = 0; i < numel; ++i) {
+    acc[i] += grad_data[i];
+  }
+
+  CompressedGradHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kCompressedGradMagic;
+  header.type = static_cast<int32_t>(type_);
+  header.rank = grad.dims().size();
+  header.numel = numel;
+  for (int i = 0; i < header.rank; ++i) {
+    header.dims[i] = grad.dims()[i];
+  }
+  switch (type_) {
+    case GradCompressType::kTopK:
+      CompressTopK(topk_ratio_, acc, &header, out);
+      break;
+    case GradCompressType::kInt8:
+      Quantize<int8_t>(acc, &header, out);
+      break;
+    case GradCompressType::kInt16:
+      Quantize<int16_t>(acc, &header, out);
+      break;
+    default:
+      PADDLE_THROW("Unknown gradient compress type %d",
+                   static_cast<int>(type_));
+  }
+
+  auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  std::lock_guard<std::mutex> lock(mutex_);
+  stat_.num_vars += 1;
+  stat_.raw_bytes += numel * sizeof(float);
+  stat_.compressed_bytes += out->numel();
+  stat_.time_us += time_us;
+  return true;
+}
+
+GradientCompressor::Stat GradientCompressor::TakeStat() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stat stat = stat_;
+  stat_ = Stat();
+  return stat;
+}
+
+bool IsCompressedGradient(const framework::Variable& var) {
+  if (!var.IsType<framework::LoDTensor>()) {
+    return false;
+  }
+  auto& tensor = var.Get<framework::LoDTensor>();
+  if (!tensor.IsInitialized() ||
+      tensor.type() != framework::proto::VarType::UINT8 ||
+      !platform::is_cpu_place(tensor.place()) ||
+      tensor.numel() < static_cast<int64_t>(sizeof(CompressedGradHeader))) {
+    return false;
+  }
+  uint32_t magic;
+  memcpy(&magic, tensor.data<uint8_t>(), sizeof(magic));
+  return magic == kCompressedGradMagic;
+}
+
+void DecompressGradient(framework::Variable* var) {
+  PADDLE_ENFORCE(IsCompressedGradient(*var),
+                 "The variable is not a compressed gradient.");
+  auto* tensor = var->GetMutable<framework::LoDTensor>();
+  const uint8_t* data = tensor->data<uint8_t>();
+  CompressedGradHeader header;
+  memcpy(&header, data, sizeof(header));
+  const uint8_t* payload = data + sizeof(header);
+
+  PADDLE_ENFORCE(header.rank >= 0 && header.rank <= framework::DDim::kMaxRank,
+                 "Invalid rank %d of the compressed gradient.", header.rank);
+  auto dims = framework::make_ddim(
+      std::vector<int64_t>(header.dims, header.dims + header.rank));
+  PADDLE_ENFORCE_EQ(framework::product(dims), header.numel,
+                    "The numel of the compressed gradient mismatches dims.");
+  auto type = static_cast<GradCompressType>(header.type);
+  PADDLE_ENFORCE_EQ(
+      tensor->numel(),
+      static_cast<int64_t>(sizeof(header)) +
+          PayloadBytes(type, header.num_values),
+      "The size of the compressed gradient mismatches its header.");
+
+  framework::LoDTensor dense;
+  auto* out = dense.mutable_data<float>(dims, platform::CPUPlace());
+  switch (type) {
+    case GradCompressType::kTopK: {
+      memset(out, 0, header.numel * sizeof(float));
+      auto* indices = reinterpret_cast<const uint32_t*>(payload);
+      auto* values =
+          reinterpret_cast<const float*>(indices + header.num_values);
+      for (int64_t i = 0; i < header.num_values; ++i) {
+        PADDLE_ENFORCE_LT(static_cast<int64_t>(indices[i]), header.numel,
+                          "The index of the top-k gradient is out of range.");
+        out[indices[i]] = values[i];
+      }
+      break;
+    }
+    case GradCompressType::kInt8:
+      Dequantize<int8_t>(payload, header, out);
+      break;
+    case GradCompressType::kInt16:
+      Dequantize<int16_t>(payload, header, out);
+      break;
+    default:
+      PADDLE_THROW("Unknown gradient compress type %d", header.type);
+  }
+  *tensor = dense;
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
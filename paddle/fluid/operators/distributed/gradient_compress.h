@@ -0,0 +1,99 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/variable.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+enum class GradCompressType {
+  kNone = 0,
+  // Send the k = ratio * numel elements of the largest magnitude only.
+  kTopK = 1,
+  // Linear quantization with a scale of max(abs(grad)) per tensor.
+  kInt8 = 2,
+  kInt16 = 3,
+};
+
+// "none", "topk", "int8" or "int16".
+GradCompressType StringToGradCompressType(const std::string& type);
+
+/*
+ * GradientCompressor compresses the dense FP32 gradients sent by the trainer.
+ *
+ * The compressed gradient is a 1-D UINT8 LoDTensor which carries its type,
+ * dims and payload, so it goes through the RPC as a normal LoDTensor and the
+ * receiver decompresses it by DecompressGradient without any configuration.
+ *
+ * What is dropped by the compression of a gradient is kept as its residual
+ * and added to the next gradient of the same name before compressing it,
+ * so all the updates reach the parameter server sooner or later.
+ */
+class GradientCompressor {
+ public:
+  struct Stat {
+    int64_t num_vars = 0;
+    int64_t raw_bytes = 0;
+    int64_t compressed_bytes = 0;
+    int64_t time_us = 0;
+  };
+
+  GradientCompressor(GradCompressType type, double topk_ratio,
+                     int64_t min_numel);
+
+  /*
+   * @brief Compress the gradient named name into out, return false and leave
+   * out untouched if the gradient is not supported or too small to compress.
+   * The gradients of different names can be compressed in parallel.
+   */
+  bool Compress(const std::string& name, const framework::Tensor& grad,
+                framework::LoDTensor* out);
+
+  // Return the statistics since the last call and reset them.
+  Stat TakeStat();
+
+  GradCompressType type() const { return type_; }
+
+ private:
+  framework::Tensor* GetResidual(const std::string& name,
+                                 const framework::DDim& dims);
+
+  const GradCompressType type_;
+  const double topk_ratio_;
+  const int64_t min_numel_;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<framework::Tensor>>
+      residuals_;
+  Stat stat_;
+};
+
+bool IsCompressedGradient(const framework::Variable& var);
+
+// Replace the compressed gradient in var by the dense FP32 one.
+void DecompressGradient(framework::Variable* var);
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
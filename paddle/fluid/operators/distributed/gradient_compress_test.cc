@@ -0,0 +1,176 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/gradient_compress.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+using LoDTensor = framework::LoDTensor;
+
+static void FillGrad(const std::vector<float>& values,
+                     const framework::DDim& dims, LoDTensor* tensor) {
+  auto* data = tensor->mutable_data<float>(dims, platform::CPUPlace());
+  std::copy(values.begin(), values.end(), data);
+}
+
+static std::vector<float> SendAndRecv(GradientCompressor* compressor,
+                                      const std::vector<float>& grad,
+                                      const framework::DDim& dims) {
+  LoDTensor grad_tensor;
+  FillGrad(grad, dims, &grad_tensor);
+  framework::Variable var;
+  auto* compressed = var.GetMutable<LoDTensor>();
+  if (!compressor->Compress("w@GRAD", grad_tensor, compressed)) {
+    return grad;
+  }
+  EXPECT_TRUE(IsCompressedGradient(var));
+  DecompressGradient(&var);
+  EXPECT_FALSE(IsCompressedGradient(var));
+  auto& out = var.Get<LoDTensor>();
+  EXPECT_EQ(out.dims(), dims);
+  return std::vector<float>(out.data<float>(),
+                            out.data<float>() + out.numel());
+}
+
+TEST(GradientCompress, TopK) {
+  GradientCompressor compressor(GradCompressType::kTopK, 0.25, 1);
+  auto dims = framework::make_ddim({2, 4});
+  std::vector<float> grad = {0.1, -4, 0.2, 0.3, 3, -0.1, 0.2, 0};
+
+  auto out = SendAndRecv(&compressor, grad, dims);
+  std::vector<float> expect = {0, -4, 0, 0, 3, 0, 0, 0};
+  EXPECT_EQ(out, expect);
+  auto stat = compressor.TakeStat();
+  EXPECT_EQ(stat.num_vars, 1);
+  EXPECT_EQ(stat.raw_bytes, 8 * static_cast<int64_t>(sizeof(float)));
+  EXPECT_EQ(compressor.TakeStat().num_vars, 0);
+
+  // The dropped values are accumulated until they are sent.
+  std::vector<float> zeros(8, 0);
+  out = SendAndRecv(&compressor, {0, 0, 0.2, 0.3, 0, 0, 0, 0}, dims);
+  expect = {0, 0, 0.4, 0.6, 0, 0, 0, 0};
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_NEAR(out[i], expect[i], 1e-6);
+  }
+  out = SendAndRecv(&compressor, zeros, dims);
+  EXPECT_NEAR(out[6], 0.2, 1e-6);
+  EXPECT_EQ(std::count(out.begin(), out.end(), 0.0f), 6);
+}
+
+TEST(GradientCompress, Quantize) {
+  auto dims = framework::make_ddim({16, 64});
+  std::vector<float> grad(1024);
+  for (size_t i = 0; i < grad.size(); ++i) {
+    grad[i] = std::sin(static_cast<float>(i)) * 0.01f;
+  }
+  for (auto type : {GradCompressType::kInt8, GradCompressType::kInt16}) {
+    GradientCompressor compressor(type, 0, 1);
+    float max_error =
+        type == GradCompressType::kInt8 ? 0.01 / 254 : 0.01 / 65534;
+    auto out = SendAndRecv(&compressor, grad, dims);
+    for (size_t i = 0; i < grad.size(); ++i) {
+      EXPECT_NEAR(out[i], grad[i], max_error * 1.01);
+    }
+    auto stat = compressor.TakeStat();
+    EXPECT_LT(stat.compressed_bytes, stat.raw_bytes);
+
+    std::vector<float> zeros(grad.size(), 0);
+    out = SendAndRecv(&compressor, zeros, dims);
+    for (size_t i = 0; i < grad.size(); ++i) {
+      EXPECT_LE(std::fabs(out[i]), max_error * 1.01);
+    }
+  }
+}
+
+TEST(GradientCompress, NotCompressed) {
+  GradientCompressor compressor(GradCompressType::kInt8, 0, 16);
+  LoDTensor small;
+  FillGrad(std::vector<float>(8, 1), framework::make_ddim({8}), &small);
+  LoDTensor out;
+  EXPECT_FALSE(compressor.Compress("small", small, &out));
+
+  LoDTensor ints;
+  ints.mutable_data<int64_t>(framework::make_ddim({32}), platform::CPUPlace());
+  EXPECT_FALSE(compressor.Compress("ints", ints, &out));
+
+  framework::Variable var;
+  auto* bytes = var.GetMutable<LoDTensor>()->mutable_data<uint8_t>(
+      framework::make_ddim({256}), platform::CPUPlace());
+  memset(bytes, 0, 256);
+  EXPECT_FALSE(IsCompressedGradient(var));
+
+  EXPECT_THROW(StringToGradCompressType("int4"), platform::EnforceNotMet);
+}
+
+// Train a linear regression by SGD with the gradients passing through the
+// compression, the loss should converge as fast as without compression.
+static float TrainLinearRegression(GradientCompressor* compressor) {
+  const int kDim = 256, kSamples = 512, kSteps = 300;
+  const float kLearningRate = 0.2;
+  std::mt19937 rng(0);
+  std::normal_distribution<float> dist(0, 1);
+  std::vector<float> target(kDim), x(kSamples * kDim), y(kSamples);
+  for (auto& v : target) v = dist(rng);
+  for (auto& v : x) v = dist(rng);
+  for (int i = 0; i < kSamples; ++i) {
+    y[i] = 0;
+    for (int j = 0; j < kDim; ++j) y[i] += x[i * kDim + j] * target[j];
+  }
+
+  auto dims = framework::make_ddim({kDim});
+  std::vector<float> w(kDim, 0), grad(kDim), residual(kSamples);
+  float loss = 0;
+  for (int step = 0; step < kSteps; ++step) {
+    loss = 0;
+    for (int i = 0; i < kSamples; ++i) {
+      residual[i] = -y[i];
+      for (int j = 0; j < kDim; ++j) residual[i] += x[i * kDim + j] * w[j];
+      loss += residual[i] * residual[i] / (2 * kSamples);
+    }
+    for (int j = 0; j < kDim; ++j) {
+      grad[j] = 0;
+      for (int i = 0; i < kSamples; ++i) {
+        grad[j] += x[i * kDim + j] * residual[i] / kSamples;
+      }
+    }
+    auto sent = SendAndRecv(compressor, grad, dims);
+    for (int j = 0; j < kDim; ++j) w[j] -= kLearningRate * sent[j];
+  }
+  return loss;
+}
+
+TEST(GradientCompress, ConvergenceParity) {
+  GradientCompressor none(GradCompressType::kNone, 0, 1);
+  float base_loss = TrainLinearRegression(&none);
+  for (auto type : {GradCompressType::kTopK, GradCompressType::kInt8,
+                    GradCompressType::kInt16}) {
+    GradientCompressor compressor(type, 0.1, 1);
+    float loss = TrainLinearRegression(&compressor);
+    LOG(INFO) << "compress type " << static_cast<int>(type) << " loss " << loss
+              << " base loss " << base_loss;
+    EXPECT_LT(loss, base_loss * 2 + 1e-4);
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -34,6 +34,25 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
+// Serializes the meta fields of request, if any, followed by the tag and the
+// length of the varlength field_number, directly into one slice. The data of
+// the field is sent in slices of its own.
+static ::grpc::Slice EncodeHeaderSlice(const VarMsg* request, int field_number,
+                                       size_t length) {
+  char prefix[16];
+  ProtoEncodeHelper e(prefix, sizeof(prefix));
+  e.WriteVarlengthBeginning(field_number, length);
+
+  size_t header_size = request == nullptr ? 0 : request->ByteSize();
+  ::grpc::Slice slice(header_size + e.size());
+  uint8_t* p = const_cast<uint8_t*>(slice.begin());
+  if (request != nullptr) {
+    p = request->SerializeWithCachedSizesToArray(p);
+  }
+  memcpy(p, e.data(), e.size());
+  return slice;
+}
+
 void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                            const platform::DeviceContext& ctx,
                            ::grpc::ByteBuffer* msg, const std::string& out_name,
@@ -77,44 +96,33 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                  typeid(var->Type()).name());
   }
 
-  std::string header;
-  request.AppendToString(&header);
-  auto buffer = std::unique_ptr<char[]>(new char[1024]);
-  void* buf = buffer.get();
-  ProtoEncodeHelper e(static_cast<char*>(buf), 1024);
-  e.WriteRawBytes(std::string(header.data(), header.size()));
-// NCCLID is copied directly to the message, return bytebuffer
-// with only one slice if serializing NCCLID.
 #ifdef PADDLE_WITH_CUDA
+  // NCCLID is small, copy it to the message.
   if (var->IsType<ncclUniqueId>()) {
-    e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber,
-                              NCCL_UNIQUE_ID_BYTES);
     const ncclUniqueId& uid = var->Get<ncclUniqueId>();
-    e.WriteRawBytes(std::string(uid.internal, NCCL_UNIQUE_ID_BYTES));
-
-    // for serialize NCCL_ID
-    ::grpc::Slice slices(e.size());
-    memcpy(const_cast<uint8_t*>(slices.begin()), e.data(), e.size());
-    ::grpc::ByteBuffer tmp(&slices, 1);
+    ::grpc::Slice slices[2];
+    slices[0] = EncodeHeaderSlice(&request, VarMsg::kSerializedFieldNumber,
+                                  NCCL_UNIQUE_ID_BYTES);
+    slices[1] = ::grpc::Slice(uid.internal, NCCL_UNIQUE_ID_BYTES);
+    ::grpc::ByteBuffer tmp(&slices[0], 2);
     msg->Swap(&tmp);
     return;
   }
 #endif
   PADDLE_ENFORCE_NOT_NULL(payload);
 
-  e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber,
-                            payload->memory_size());
   if (payload->memory_size() >= std::numeric_limits<int>::max()) {
     LOG(FATAL) << "FATAL error: varname:" << name
                << ", vlen:" << payload->memory_size()
                << " >= std::numeric_limits<int>::max():"
                << std::numeric_limits<int>::max() << ", so exit!";
   }
-  // steal reference of tensor data
+  // The slices of the tensor data and the rows reference the memory of the
+  // variable, which is kept alive until grpc has sent them.
   ::grpc::Slice slices[4];  // metadata, tensor, rows meta, rows
   int num_slices = 2;       // only SelectedRows have rows buffer
-  slices[0] = ::grpc::Slice(e.size());
-  memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
+  slices[0] = EncodeHeaderSlice(&request, VarMsg::kSerializedFieldNumber,
+                                payload->memory_size());
   slices[1] = ::grpc::Slice(
       grpc_slice_new_with_user_data(payload->ptr(), payload->memory_size(),
                                     SerializeDestroyCallback, payload),
@@ -122,22 +130,25 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
 
   if (var->IsType<framework::SelectedRows>()) {
     auto* slr = var->GetMutable<framework::SelectedRows>();
-    ProtoEncodeHelper e2(static_cast<char*>(buf), 128);
-
     PADDLE_ENFORCE(VectorElemName(slr->rows()) == typeid(int64_t).name());
-    size_t rows_memory_size = slr->rows().size() * sizeof(int64_t);
-
-    e2.WriteVarlengthBeginning(VarMsg::kRowsFieldNumber, rows_memory_size);
-    slices[2] = ::grpc::Slice(e2.size());
-    memcpy(const_cast<uint8_t*>(slices[2].begin()), e2.data(), e2.size());
-
+    // With CUDA, Vector is copy on write, so the rows are shared with the
+    // SelectedRows until it changes them. They are read by the const data(),
+    // since the mutable one detaches the shared copy.
+    auto* rows = new framework::Vector<int64_t>(slr->rows());
+    const int64_t* rows_data =
+        static_cast<const framework::Vector<int64_t>&>(*rows).data();
+    size_t rows_memory_size = rows->size() * sizeof(int64_t);
+
+    slices[2] = EncodeHeaderSlice(nullptr, VarMsg::kRowsFieldNumber,
+                                  rows_memory_size);
+    // grpc only reads the memory of the slice.
     slices[3] = ::grpc::Slice(
         grpc_slice_new_with_user_data(
-            const_cast<void*>(
-                reinterpret_cast<const void*>(slr->rows().data())),
-            rows_memory_size, [](void* backing) {},
-            const_cast<char*>(
-                reinterpret_cast<const char*>(slr->rows().data()))),
+            const_cast<int64_t*>(rows_data), rows_memory_size,
+            [](void* backing) {
+              delete reinterpret_cast<framework::Vector<int64_t>*>(backing);
+            },
+            rows),
         ::grpc::Slice::STEAL_REF);
     num_slices = 4;
   }
@@ -0,0 +1,174 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Throughput of sending a large dense variable with the grpc serde, in
+// process and to an async parameter server over loopback. The default size
+// keeps it fast enough for CI, e.g. run it with --var_size_mb=128 to see the
+// cost of the copies of a large parameter.
+
+#include <stdlib.h>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/operators/distributed/async_sparse_param_update_recorder.h"
+#include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/distributed/grpc/grpc_serde.h"
+#include "paddle/fluid/operators/distributed/grpc/grpc_variable_response.h"
+#include "paddle/fluid/operators/distributed/request_handler_impl.h"
+#include "paddle/fluid/string/printf.h"
+
+DEFINE_int32(var_size_mb, 16, "The size of the variable sent.");
+DEFINE_int32(send_times, 10, "How many times the variable is sent.");
+
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+namespace distributed = paddle::operators::distributed;
+
+USE_OP(scale);
+
+static int64_t VarNumel() {
+  return static_cast<int64_t>(FLAGS_var_size_mb) * 1024 * 1024 / sizeof(float);
+}
+
+static void InitGrad(framework::Scope* scope, const std::string& name) {
+  auto* tensor = scope->Var(name)->GetMutable<framework::LoDTensor>();
+  float* data = tensor->mutable_data<float>(
+      framework::make_ddim({VarNumel()}), platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>(i % 128);
+  }
+}
+
+static void ReportThroughput(const std::string& name,
+                             std::chrono::steady_clock::time_point start) {
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  double mb = static_cast<double>(FLAGS_var_size_mb) * FLAGS_send_times;
+  LOG(INFO) << name << ": sent " << FLAGS_send_times << " x "
+            << FLAGS_var_size_mb << " MB in " << seconds << " s, "
+            << mb / seconds << " MB/s";
+}
+
+TEST(GrpcSerdeBenchmark, InProcess) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  framework::Scope scope;
+  InitGrad(&scope, "w@GRAD");
+  auto* var = scope.FindVar("w@GRAD");
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_send_times; ++i) {
+    ::grpc::ByteBuffer msg;
+    distributed::SerializeToByteBuffer("w@GRAD", var, ctx, &msg);
+    // Received into the local scope of the request, as an async pserver does.
+    distributed::GRPCVariableResponse resp(&scope, &ctx, true);
+    ASSERT_EQ(resp.Parse(msg), 0);
+    auto& recv = resp.GetVar()->Get<framework::LoDTensor>();
+    ASSERT_EQ(recv.numel(), VarNumel());
+    EXPECT_EQ(recv.data<float>()[VarNumel() - 1],
+              static_cast<float>((VarNumel() - 1) % 128));
+  }
+  ReportThroughput("in process", start);
+}
+
+std::unique_ptr<distributed::RPCServer> g_rpc_service;
+std::unique_ptr<distributed::RequestHandler> g_req_handler;
+
+// An async pserver whose optimize block copies the received gradient to a
+// persistable variable.
+static void StartServer() {
+  framework::ProgramDesc program;
+  framework::Scope scope;
+  platform::CPUPlace place;
+  framework::Executor exe(place);
+  platform::CPUDeviceContext ctx(place);
+
+  auto* root_block = program.MutableBlock(0);
+  root_block->Var("w@GRAD")->SetType(framework::proto::VarType::LOD_TENSOR);
+  auto* out_desc = root_block->Var("w_out");
+  out_desc->SetType(framework::proto::VarType::LOD_TENSOR);
+  out_desc->SetPersistable(true);
+  auto* block = program.AppendBlock(*root_block);
+  auto* op = block->AppendOp();
+  op->SetType("scale");
+  op->SetInput("X", {"w@GRAD"});
+  op->SetOutput("Out", {"w_out"});
+  op->SetAttr("scale", 1.0f);
+  scope.Var("w_out")->GetMutable<framework::LoDTensor>();
+
+  auto prepared = exe.Prepare(program, std::vector<int>{block->ID()});
+  std::unordered_map<std::string,
+                     std::shared_ptr<framework::ExecutorPrepareContext>>
+      grad_to_prepared;
+  grad_to_prepared["w@GRAD"] = prepared[0];
+  distributed::AsyncSparseParamUpdateRecorder::Init(1, {});
+
+  g_req_handler->SetProgram(&program);
+  g_req_handler->SetGradToPreparedCtx(&grad_to_prepared);
+  g_req_handler->SetDevCtx(&ctx);
+  g_req_handler->SetScope(&scope);
+  g_req_handler->SetExecutor(&exe);
+
+  g_rpc_service->RegisterRPC(distributed::kRequestSend, g_req_handler.get());
+  g_req_handler->SetRPCServer(g_rpc_service.get());
+  g_rpc_service->StartServer();
+}
+
+TEST(GrpcSerdeBenchmark, Loopback) {
+  setenv("http_proxy", "", 1);
+  setenv("https_proxy", "", 1);
+  g_req_handler.reset(new distributed::RequestSendHandler(false));
+  g_rpc_service.reset(new RPCSERVER_T("127.0.0.1:0", 1));
+  distributed::RPCClient* client =
+      distributed::RPCClient::GetInstance<RPCCLIENT_T>(0);
+
+  std::thread server_thread(StartServer);
+  g_rpc_service->WaitServerReady();
+  std::string ep = paddle::string::Sprintf("127.0.0.1:%d",
+                                           g_rpc_service->GetSelectedPort());
+
+  framework::Scope scope;
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  InitGrad(&scope, "w@GRAD");
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_send_times; ++i) {
+    client->AsyncSendVar(ep, ctx, scope, "w@GRAD");
+    client->Wait();
+  }
+  ReportThroughput("loopback", start);
+
+  auto& out =
+      g_req_handler->scope()->FindVar("w_out")->Get<framework::LoDTensor>();
+  ASSERT_EQ(out.numel(), VarNumel());
+  EXPECT_EQ(out.data<float>()[VarNumel() - 1],
+            static_cast<float>((VarNumel() - 1) % 128));
+
+  g_rpc_service->ShutDown();
+  server_thread.join();
+  g_rpc_service.reset(nullptr);
+  g_req_handler.reset(nullptr);
+}
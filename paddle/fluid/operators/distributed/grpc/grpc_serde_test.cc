@@ -222,3 +222,57 @@ TEST(SelectedRows, Run) {
   RunSerdeTestSelectedRows(gpu);
 #endif
 }
+
+TEST(ZeroCopy, Run) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+
+  framework::Variable var;
+  auto* slr = var.GetMutable<framework::SelectedRows>();
+  slr->set_height(100);
+  auto* value = slr->mutable_value();
+  float* value_data =
+      value->mutable_data<float>(framework::make_ddim({3, 16}), place);
+  for (int i = 0; i < value->numel(); ++i) value_data[i] = i;
+  *slr->mutable_rows() = framework::Vector<int64_t>({7, 8, 9});
+
+  ::grpc::ByteBuffer msg;
+  operators::distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg);
+  std::vector<::grpc::Slice> slices;
+  (void)msg.Dump(&slices);
+  ASSERT_EQ(slices.size(), 4UL);
+  // The tensor data is sent from the memory of the variable.
+  EXPECT_EQ(reinterpret_cast<const float*>(slices[1].begin()), value_data);
+  EXPECT_EQ(slices[1].size(), value->memory_size());
+  EXPECT_EQ(slices[3].size(), 3 * sizeof(int64_t));
+#ifdef PADDLE_WITH_CUDA
+  // The rows are sent from the copy on write memory shared with the variable.
+  EXPECT_EQ(reinterpret_cast<const int64_t*>(slices[3].begin()),
+            slr->rows().data());
+#endif
+
+  // The sent tensor and rows stay valid after the variable is changed.
+  *slr->mutable_rows() = framework::Vector<int64_t>({1});
+  value->clear();
+  EXPECT_EQ(reinterpret_cast<const float*>(slices[1].begin())[47], 47);
+  const int64_t* rows = reinterpret_cast<const int64_t*>(slices[3].begin());
+  EXPECT_EQ(rows[0], 7);
+  EXPECT_EQ(rows[2], 9);
+
+  // A variable in the local scope of a request is read into a reused buffer.
+  framework::Scope scope;
+  void* recv_data = nullptr;
+  {
+    operators::distributed::GRPCVariableResponse resp(&scope, &ctx, true);
+    EXPECT_EQ(resp.Parse(msg), 0);
+    auto& slr2 = resp.GetVar()->Get<framework::SelectedRows>();
+    EXPECT_EQ(slr2.value().data<float>()[5], 5);
+    EXPECT_EQ(slr2.rows()[1], 8);
+    recv_data = slr2.value().Holder()->ptr();
+  }
+  operators::distributed::GRPCVariableResponse resp(&scope, &ctx, true);
+  EXPECT_EQ(resp.Parse(msg), 0);
+  auto& slr3 = resp.GetVar()->Get<framework::SelectedRows>();
+  EXPECT_EQ(slr3.value().Holder()->ptr(), recv_data);
+  EXPECT_EQ(slr3.value().data<float>()[47], 47);
+}
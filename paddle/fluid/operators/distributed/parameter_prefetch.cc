@@ -31,6 +31,7 @@
 #include "paddle/fluid/operators/distributed/rpc_client.h"
 #include "paddle/fluid/operators/distributed/variable_response.h"
 #include "paddle/fluid/operators/distributed_ops/send_recv_util.h"
+#include "paddle/fluid/operators/math/gather_rows.h"
 
 namespace paddle {
 namespace operators {
@@ -82,16 +83,15 @@ static void SplitIdsIntoMultipleVarsBySection(
 
 typedef std::vector<std::pair<std::string, std::string>> TableAndEndpoints;
 
+// The received rows are kept in local_scope, and recved_rows points to them.
 void prefetch_core(
     const std::vector<int64_t>& ids, const TableAndEndpoints& tables,
     const std::vector<int64_t>& height_sections,
-    const framework::ExecutionContext& context, const framework::Scope& scope,
-    std::unordered_map<int64_t, std::vector<float>>* recved_vec_map) {
+    const framework::ExecutionContext& context, framework::Scope* local_scope,
+    std::unordered_map<int64_t, const float*>* recved_rows) {
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto& actual_ctx = *pool.Get(context.GetPlace());
 
-  std::unique_ptr<framework::Scope> local_scope = scope.NewTmpScope();
-
   std::vector<std::string> in_var_names;
   std::vector<std::string> out_var_names;
   for (size_t i = 0; i < tables.size(); ++i) {
@@ -101,7 +101,7 @@ void prefetch_core(
 
   auto splited_ids = SplitIds(ids, height_sections);
   SplitIdsIntoMultipleVarsBySection(in_var_names, height_sections, splited_ids,
-                                    local_scope.get());
+                                    local_scope);
 
   // create output var in local scope
   for (auto& name : out_var_names) {
@@ -114,11 +114,11 @@ void prefetch_core(
 
   std::vector<distributed::VarHandlePtr> rets;
   for (size_t i = 0; i < in_var_names.size(); i++) {
-    if (NeedSend(*local_scope.get(), in_var_names[i])) {
+    if (NeedSend(*local_scope, in_var_names[i])) {
       VLOG(3) << "sending " << in_var_names[i] << " to " << tables[i].second
               << " to get " << out_var_names[i] << " back";
       rets.push_back(rpc_client->AsyncPrefetchVar(
-          tables[i].second, actual_ctx, *local_scope.get(), in_var_names[i],
+          tables[i].second, actual_ctx, *local_scope, in_var_names[i],
           out_var_names[i], tables[i].first));
     } else {
       VLOG(3) << "don't send no-initialied variable: " << out_var_names[i];
@@ -149,9 +149,7 @@ void prefetch_core(
       for (int64_t i = 0; i < dims[0]; ++i) {
         auto id = ids_in_this_section[i];
         auto origin_id = id + abs_sections[section_idx];
-        std::vector<float> vecs(row_numel);
-        std::copy_n(out_var_data + i * row_numel, row_numel, vecs.begin());
-        (*recved_vec_map)[origin_id] = vecs;
+        (*recved_rows)[origin_id] = out_var_data + i * row_numel;
       }
     } else {
       VLOG(3) << "ids in this section is empty";
@@ -219,9 +217,10 @@ void prefetchs(const std::vector<std::string>& id_var_names,
     tables.push_back(std::make_pair(table_names[i], endpoints[i]));
   }
 
-  std::unordered_map<int64_t, std::vector<float>> recved_vec_map;
-  prefetch_core(ids_union, tables, height_sections, context, scope,
-                &recved_vec_map);
+  std::unique_ptr<framework::Scope> local_scope = scope.NewTmpScope();
+  std::unordered_map<int64_t, const float*> recved_rows;
+  prefetch_core(ids_union, tables, height_sections, context, local_scope.get(),
+                &recved_rows);
 
   auto padding_idx = distributed::kNoPadding;
 
@@ -240,16 +239,19 @@ void prefetchs(const std::vector<std::string>& id_var_names,
 
     auto* out_d = out_t->mutable_data<float>(place);
 
-    for (int idx = 0; idx < ids.size(); idx++) {
+    // Resolve the rows of all the ids first, then gather them in one pass.
+    std::vector<const float*> rows(ids.size(), nullptr);
+    for (size_t idx = 0; idx < ids.size(); idx++) {
       const auto& id = ids[idx];
-
-      if (padding_idx != distributed::kNoPadding && id == padding_idx) {
-        memset(out_d + idx * vec_dim_1, 0, sizeof(float) * vec_dim_1);
-      } else {
-        std::copy_n(recved_vec_map[id].begin(), vec_dim_1,
-                    out_d + idx * vec_dim_1);
+      if (padding_idx == distributed::kNoPadding || id != padding_idx) {
+        auto it = recved_rows.find(id);
+        PADDLE_ENFORCE(it != recved_rows.end(),
+                       "id %ld is not received from the pserver", id);
+        rows[idx] = it->second;
       }
     }
+    math::GatherRows(rows.data(), static_cast<int64_t>(rows.size()),
+                     vec_dim_1, out_d);
   }
 
   if (backfill) {
@@ -257,8 +259,8 @@ void prefetchs(const std::vector<std::string>& id_var_names,
 
     auto* reconstruct_d = reconstruct_var->data<float>();
     for (auto& id : ids_union) {
-      std::copy(recved_vec_map[id].begin(), recved_vec_map[id].end(),
-                reconstruct_d + id * vec_dim_1);
+      const float* row = recved_rows[id];
+      std::copy(row, row + vec_dim_1, reconstruct_d + id * vec_dim_1);
     }
   }
 }
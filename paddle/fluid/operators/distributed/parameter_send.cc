@@ -25,6 +25,7 @@
 #include "paddle/fluid/framework/tensor.h"
 
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/distributed/gradient_compress.h"
 #include "paddle/fluid/operators/distributed/rpc_client.h"
 #include "paddle/fluid/operators/distributed/variable_response.h"
 #include "paddle/fluid/operators/distributed_ops/send_recv_util.h"
@@ -40,7 +41,8 @@ using DDim = framework::DDim;
 
 template <typename T>
 void ParameterSend<T>::operator()(const RpcContext &rpc_ctx,
-                                  const framework::Scope &scope, bool sync) {
+                                  const framework::Scope &scope, bool sync,
+                                  GradientCompressor *compressor) {
   std::unique_ptr<framework::Scope> local_scope = scope.NewTmpScope();
 
   platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
@@ -77,6 +79,21 @@ void ParameterSend<T>::operator()(const RpcContext &rpc_ctx,
         row_offset += outs_dims[i][0];
       }
     }
+    if (compressor != nullptr) {
+      for (auto &name : rpc_ctx.splited_var_names) {
+        auto *var = local_scope->FindVar(name);
+        if (var == nullptr || !var->IsInitialized()) {
+          continue;
+        }
+        framework::LoDTensor compressed;
+        if (compressor->Compress(name, var->Get<framework::LoDTensor>(),
+                                 &compressed)) {
+          // shadow the gradient in scope by the compressed one
+          *local_scope->Var(name)->GetMutable<framework::LoDTensor>() =
+              compressed;
+        }
+      }
+    }
   } else if (send_var->IsType<framework::SelectedRows>()) {
     auto &send_slr = send_var->Get<framework::SelectedRows>();
     auto abs_sections = ToAbsoluteSection(rpc_ctx.height_sections);
@@ -24,10 +24,13 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
+class GradientCompressor;
+
 template <typename T>
 struct ParameterSend {
+  // The dense gradient is compressed before sending if compressor is given.
   void operator()(const RpcContext &rpc_ctx, const framework::Scope &scope,
-                  bool sync);
+                  bool sync, GradientCompressor *compressor = nullptr);
 };
 
 };  // namespace distributed
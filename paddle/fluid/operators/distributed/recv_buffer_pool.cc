@@ -0,0 +1,76 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/recv_buffer_pool.h"
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/platform/place.h"
+
+DEFINE_int32(rpc_recv_buffer_pool_size, 4,
+             "The max number of the buffers kept to receive a variable "
+             "into, 0 to allocate a new buffer for every request.");
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+RecvBufferPool& RecvBufferPool::Instance() {
+  // Never destroyed, the buffers may be released after the allocators are.
+  static RecvBufferPool* pool = new RecvBufferPool();
+  return *pool;
+}
+
+std::shared_ptr<memory::Allocation> RecvBufferPool::Acquire(
+    const std::string& varname, size_t size) {
+  platform::CPUPlace cpu;
+  if (FLAGS_rpc_recv_buffer_pool_size <= 0) {
+    return memory::AllocShared(cpu, size);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& buffers = buffers_[varname];
+  for (auto& buffer : buffers) {
+    if (buffer.use_count() != 1) continue;
+    if (buffer->size() < size) {
+      // The variable grew, e.g. a SelectedRows with more rows.
+      buffer = memory::AllocShared(cpu, size);
+    }
+    return buffer;
+  }
+
+  auto buffer = memory::AllocShared(cpu, size);
+  if (buffers.size() < static_cast<size_t>(FLAGS_rpc_recv_buffer_pool_size)) {
+    buffers.push_back(buffer);
+  } else {
+    VLOG(4) << "all the " << buffers.size() << " receive buffers of "
+            << varname << " are in use";
+  }
+  return buffer;
+}
+
+size_t RecvBufferPool::NumBuffers(const std::string& varname) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = buffers_.find(varname);
+  return it == buffers_.end() ? 0 : it->second.size();
+}
+
+void RecvBufferPool::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffers_.clear();
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,63 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/memory/malloc.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+/*
+ * RecvBufferPool keeps the CPU buffers that the parameter server receives
+ * variables into, so a large gradient sent again and again is read into the
+ * same memory instead of a fresh allocation for every request.
+ *
+ * A buffer is handed out again only when the pool holds its last reference,
+ * i.e. the tensor of the previous request and everything sharing its memory
+ * are gone, so a buffer is never written while it is still being read.
+ */
+class RecvBufferPool {
+ public:
+  static RecvBufferPool& Instance();
+
+  // Returns a CPU buffer of at least size bytes to receive varname into.
+  std::shared_ptr<memory::Allocation> Acquire(const std::string& varname,
+                                              size_t size);
+
+  // Number of the buffers kept for varname.
+  size_t NumBuffers(const std::string& varname);
+
+  void Clear();
+
+ private:
+  RecvBufferPool() = default;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string,
+                     std::vector<std::shared_ptr<memory::Allocation>>>
+      buffers_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,80 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/recv_buffer_pool.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+DECLARE_int32(rpc_recv_buffer_pool_size);
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+TEST(RecvBufferPool, ReuseReleasedBuffer) {
+  auto& pool = RecvBufferPool::Instance();
+  pool.Clear();
+
+  void* ptr = nullptr;
+  {
+    auto buffer = pool.Acquire("w@GRAD", 1024);
+    ASSERT_GE(buffer->size(), 1024UL);
+    ptr = buffer->ptr();
+  }
+  // Released by the previous request, so the same memory is read into.
+  auto buffer = pool.Acquire("w@GRAD", 512);
+  EXPECT_EQ(buffer->ptr(), ptr);
+  EXPECT_EQ(pool.NumBuffers("w@GRAD"), 1UL);
+
+  // Still in use, a second buffer is kept.
+  auto other = pool.Acquire("w@GRAD", 512);
+  EXPECT_NE(other->ptr(), buffer->ptr());
+  EXPECT_EQ(pool.NumBuffers("w@GRAD"), 2UL);
+  EXPECT_EQ(pool.NumBuffers("b@GRAD"), 0UL);
+  pool.Clear();
+}
+
+TEST(RecvBufferPool, GrowAndLimit) {
+  auto& pool = RecvBufferPool::Instance();
+  pool.Clear();
+
+  pool.Acquire("w@GRAD", 256);
+  auto grown = pool.Acquire("w@GRAD", 4096);
+  EXPECT_GE(grown->size(), 4096UL);
+  EXPECT_EQ(pool.NumBuffers("w@GRAD"), 1UL);
+
+  int pool_size = FLAGS_rpc_recv_buffer_pool_size;
+  FLAGS_rpc_recv_buffer_pool_size = 2;
+  std::vector<std::shared_ptr<memory::Allocation>> in_use{grown};
+  for (int i = 0; i < 4; ++i) {
+    in_use.push_back(pool.Acquire("w@GRAD", 4096));
+  }
+  EXPECT_EQ(pool.NumBuffers("w@GRAD"), 2UL);
+
+  FLAGS_rpc_recv_buffer_pool_size = 0;
+  in_use.clear();
+  pool.Acquire("b@GRAD", 64);
+  EXPECT_EQ(pool.NumBuffers("b@GRAD"), 0UL);
+
+  FLAGS_rpc_recv_buffer_pool_size = pool_size;
+  pool.Clear();
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
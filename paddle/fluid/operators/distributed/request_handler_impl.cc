@@ -23,6 +23,7 @@
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/variable_helper.h"
 #include "paddle/fluid/operators/distributed/async_sparse_param_update_recorder.h"
+#include "paddle/fluid/operators/distributed/gradient_compress.h"
 #include "paddle/fluid/operators/distributed/rpc_server.h"
 #include "paddle/fluid/string/piece.h"
 #include "paddle/fluid/string/printf.h"
@@ -60,6 +61,9 @@ bool RequestSendHandler::Handle(const std::string& varname,
             "async mode should not recv BATCH_BARRIER_MESSAGE or "
             "COMPLETE_MESSAGE");
       }
+      if (invar != nullptr && IsCompressedGradient(*invar)) {
+        DecompressGradient(invar);
+      }
       if (AsyncSparseParamUpdateRecorder::GetInstance()->HasGrad(varname)) {
         auto& grad_slr =
             scope->FindVar(varname)->Get<framework::SelectedRows>();
@@ -77,6 +81,9 @@ bool RequestSendHandler::Handle(const std::string& varname,
         LOG(FATAL) << "sync: Can not find server side var: " << varname;
         return false;
       }
+      if (IsCompressedGradient(*invar)) {
+        DecompressGradient(invar);
+      }
     }
   }
   return true;
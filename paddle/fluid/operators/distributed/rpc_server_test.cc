@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include <stdlib.h>
 #include <unistd.h>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT
@@ -24,7 +25,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
 
+#include "paddle/fluid/operators/distributed/async_sparse_param_update_recorder.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/distributed/gradient_compress.h"
 #include "paddle/fluid/operators/distributed/request_handler_impl.h"
 #include "paddle/fluid/operators/distributed/rpc_client.h"
 #include "paddle/fluid/operators/distributed/rpc_server.h"
@@ -34,6 +37,7 @@ namespace platform = paddle::platform;
 namespace distributed = paddle::operators::distributed;
 
 USE_NO_KERNEL_OP(lookup_sparse_table);
+USE_OP(scale);
 
 std::unique_ptr<distributed::RPCServer> g_rpc_service;
 std::unique_ptr<distributed::RequestHandler> g_req_handler;
@@ -188,3 +192,98 @@ TEST(COMPLETE, CPU) {
   g_rpc_service.reset(nullptr);
   g_req_handler.reset(nullptr);
 }
+
+// The optimize block of the async pserver, which copies the received
+// gradient to a persistable variable to check it.
+void StartAsyncSendServer(const std::string& rpc_name) {
+  framework::ProgramDesc program;
+  framework::Scope scope;
+  platform::CPUPlace place;
+  framework::Executor exe(place);
+  platform::CPUDeviceContext ctx(place);
+
+  auto* root_block = program.MutableBlock(0);
+  root_block->Var("w@GRAD")->SetType(framework::proto::VarType::LOD_TENSOR);
+  auto* out_desc = root_block->Var("w_out");
+  out_desc->SetType(framework::proto::VarType::LOD_TENSOR);
+  out_desc->SetPersistable(true);
+  auto* block = program.AppendBlock(*root_block);
+  auto* op = block->AppendOp();
+  op->SetType("scale");
+  op->SetInput("X", {"w@GRAD"});
+  op->SetOutput("Out", {"w_out"});
+  op->SetAttr("scale", 1.0f);
+  scope.Var("w_out")->GetMutable<framework::LoDTensor>();
+
+  auto prepared = exe.Prepare(program, std::vector<int>{block->ID()});
+  std::unordered_map<std::string,
+                     std::shared_ptr<framework::ExecutorPrepareContext>>
+      grad_to_prepared;
+  grad_to_prepared["w@GRAD"] = prepared[0];
+  distributed::AsyncSparseParamUpdateRecorder::Init(1, {});
+
+  g_req_handler->SetProgram(&program);
+  g_req_handler->SetGradToPreparedCtx(&grad_to_prepared);
+  g_req_handler->SetDevCtx(&ctx);
+  g_req_handler->SetScope(&scope);
+  g_req_handler->SetExecutor(&exe);
+
+  g_rpc_service->RegisterRPC(rpc_name, g_req_handler.get());
+  g_req_handler->SetRPCServer(g_rpc_service.get());
+
+  std::thread server_thread(
+      std::bind(&distributed::RPCServer::StartServer, g_rpc_service.get()));
+
+  server_thread.join();
+}
+
+TEST(COMPRESSED_SEND, CPU) {
+  setenv("http_proxy", "", 1);
+  setenv("https_proxy", "", 1);
+  g_req_handler.reset(new distributed::RequestSendHandler(false));
+  g_rpc_service.reset(new RPCSERVER_T("127.0.0.1:0", 1));
+  distributed::RPCClient* client =
+      distributed::RPCClient::GetInstance<RPCCLIENT_T>(0);
+
+  std::thread server_thread(StartAsyncSendServer, distributed::kRequestSend);
+  g_rpc_service->WaitServerReady();
+  int port = g_rpc_service->GetSelectedPort();
+  std::string ep = paddle::string::Sprintf("127.0.0.1:%d", port);
+
+  framework::Scope scope;
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+  framework::LoDTensor grad;
+  auto* grad_data =
+      grad.mutable_data<float>(framework::make_ddim({10, 8}), place);
+  for (int i = 0; i < grad.numel(); ++i) {
+    grad_data[i] = static_cast<float>(i % 10) - 4.5f;
+  }
+  distributed::GradientCompressor compressor(
+      distributed::GradCompressType::kTopK, 0.1, 1);
+  auto* send_tensor = scope.Var("w@GRAD")->GetMutable<framework::LoDTensor>();
+  ASSERT_TRUE(compressor.Compress("w@GRAD", grad, send_tensor));
+  EXPECT_LT(send_tensor->memory_size(), grad.memory_size());
+
+  client->AsyncSendVar(ep, ctx, scope, "w@GRAD");
+  client->Wait();
+
+  // The 8 elements of the largest magnitude are received.
+  auto& out =
+      g_req_handler->scope()->FindVar("w_out")->Get<framework::LoDTensor>();
+  ASSERT_EQ(out.dims(), grad.dims());
+  int num_sent = 0;
+  for (int i = 0; i < out.numel(); ++i) {
+    if (out.data<float>()[i] != 0) {
+      EXPECT_EQ(out.data<float>()[i], grad_data[i]);
+      EXPECT_EQ(std::fabs(grad_data[i]), 4.5f);
+      ++num_sent;
+    }
+  }
+  EXPECT_EQ(num_sent, 8);
+
+  g_rpc_service->ShutDown();
+  server_thread.join();
+  g_rpc_service.reset(nullptr);
+  g_req_handler.reset(nullptr);
+}
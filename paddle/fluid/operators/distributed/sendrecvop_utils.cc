@@ -57,14 +57,14 @@ static TensorPayload GetCommunicationAllocationFromTensor(
 TensorPayload GetTensorPayload(framework::Variable* var,
                                const platform::DeviceContext& ctx,
                                VarMsg* request) {
-  auto tensor = var->Get<framework::LoDTensor>();
+  auto& tensor = var->Get<framework::LoDTensor>();
   // FIXME(wuyi): data types in send_recv.proto is copied from
   // framework.proto
   request->set_data_type(static_cast<VarMsg::Type>(tensor.type()));
   for (auto& dim : framework::vectorize(tensor.dims())) {
     request->add_dims(dim);
   }
-  const framework::LoD lod = tensor.lod();
+  const framework::LoD& lod = tensor.lod();
   if (lod.size() > 0) {
     request->set_lod_level(lod.size());
     for (auto& each : lod) {
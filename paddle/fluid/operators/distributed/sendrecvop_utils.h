@@ -78,6 +78,8 @@ inline framework::proto::VarType::Type ToVarType(
       return framework::proto::VarType::INT64;  // NOLINT
     case sendrecv::VariableMessage::BOOL:
       return framework::proto::VarType::BOOL;  // NOLINT
+    case sendrecv::VariableMessage::UINT8:
+      return framework::proto::VarType::UINT8;  // NOLINT
     default:
       PADDLE_THROW("Not support type %d", type);
   }
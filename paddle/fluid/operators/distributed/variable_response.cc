@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/operators/distributed/variable_response.h"
 #include <vector>
+#include "paddle/fluid/operators/distributed/recv_buffer_pool.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
 
 DEFINE_string(rpc_server_profile_path, "./profile_ps",
@@ -23,6 +24,20 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
+void VariableResponse::PrepareRecvBuffer(const platform::DeviceContext& ctx,
+                                         framework::Tensor* tensor,
+                                         int64_t length) {
+  // A variable in the server scope is read into its own memory again and
+  // again. One in the local scope of a request is new, so take the buffer of
+  // an earlier request instead of allocating a new one.
+  if (!create_scope_ || !platform::is_cpu_place(ctx.GetPlace()) ||
+      tensor->IsInitialized() || length <= 0) {
+    return;
+  }
+  tensor->ResetHolder(
+      RecvBufferPool::Instance().Acquire(meta_.varname(), length));
+}
+
 bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
                                const platform::DeviceContext& dev_ctx,
                                platform::Place place, void* dest,
@@ -76,7 +91,7 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
     if (total_written + size_to_write > length) {
       size_to_write = length - total_written;
     }
-    // TODO(gongwb): can we avoid copy?
+    // The only copy of the payload: from the rpc buffers to the tensor.
     platform::CPUPlace cpu;
     // This log is useful to see how long a internal block size is of rpc.
     VLOG(7) << "copy " << size_to_write << " data to CPUPlace";
@@ -113,6 +128,7 @@ bool VariableResponse::CopyLodTensorData(
   }
   tensor->set_lod(lod);
 
+  PrepareRecvBuffer(ctx, tensor, length);
   void* tensor_data =
       tensor->mutable_data(ctx.GetPlace(), ToVarType(meta_.data_type()));
 
@@ -144,6 +160,7 @@ bool VariableResponse::CopySelectRowsTensorData(
       static_cast<size_t>(tensor->numel()),
       length / framework::SizeOfType(paddle::operators::distributed::ToVarType(
                    meta_.data_type())));
+  PrepareRecvBuffer(ctx, tensor, length);
   void* tensor_data = tensor->mutable_data(
       ctx.GetPlace(),
       paddle::operators::distributed::ToVarType(meta_.data_type()));
@@ -99,6 +99,11 @@ class VariableResponse {
   int GetTrainerId() { return static_cast<int>(meta_.trainer_id()); }
 
  protected:
+  // Give the tensor to receive into a reusable buffer of at least length
+  // bytes, see RecvBufferPool.
+  void PrepareRecvBuffer(const platform::DeviceContext& dev_ctx,
+                         framework::Tensor* tensor, int64_t length);
+
   bool ReadRaw(::google::protobuf::io::CodedInputStream* input,
                const platform::DeviceContext& dev_ctx, platform::Place place,
                void* dest, int64_t size);
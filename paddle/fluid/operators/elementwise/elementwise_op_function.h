@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/parallel_for.h"
 #include "paddle/fluid/platform/transform.h"
 
 #ifdef __NVCC__
@@ -351,22 +352,28 @@ template <typename T, typename DX_OP, typename DY_OP>
 static void ElemwiseGradBroadcast1CPU(const T *x, const T *y, const T *out,
                                       const T *dout, int h, int w, DX_OP dx_op,
                                       DY_OP dy_op, T *dx, T *dy) {
-  for (int i = 0; i < h; ++i) {
-    for (int j = 0; j < w; ++j) {
-      int x_offset = i * w + j;
-      if (dx != nullptr) {
-        dx[x_offset] = dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-      }
-      if (dy != nullptr) {
-        T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-        if (i == 0) {
-          dy[j] = tmp;
-        } else {
-          dy[j] += tmp;
+  // Split the columns, so each dy[j] is reduced by one thread in the same
+  // order as the serial loop.
+  platform::ParallelFor(
+      0, w, platform::ParallelForGrainSize(h), [&](int64_t begin, int64_t end) {
+        for (int i = 0; i < h; ++i) {
+          for (int j = begin; j < end; ++j) {
+            int x_offset = i * w + j;
+            if (dx != nullptr) {
+              dx[x_offset] =
+                  dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
+            }
+            if (dy != nullptr) {
+              T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
+              if (i == 0) {
+                dy[j] = tmp;
+              } else {
+                dy[j] += tmp;
+              }
+            }
+          }
         }
-      }
-    }
-  }
+      });
 }
 
 #ifdef __NVCC__
@@ -476,25 +483,29 @@ template <typename T, typename DX_OP, typename DY_OP>
 static void ElemwiseGradBroadcast2CPU(const T *x, const T *y, const T *out,
                                       const T *dout, int pre, int n, int post,
                                       DX_OP dx_op, DY_OP dy_op, T *dx, T *dy) {
-  for (int i = 0; i < pre; ++i) {
-    for (int j = 0; j < n; ++j) {
-      for (int k = 0; k < post; ++k) {
-        int x_offset = i * n * post + j * post + k;
-        if (dx != nullptr) {
-          dx[x_offset] =
-              dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-        }
-        if (dy != nullptr) {
-          T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-          if (i == 0 && k == 0) {
-            dy[j] = tmp;
-          } else {
-            dy[j] += tmp;
+  const int64_t grain_size =
+      platform::ParallelForGrainSize(static_cast<int64_t>(pre) * post);
+  platform::ParallelFor(0, n, grain_size, [&](int64_t begin, int64_t end) {
+    for (int i = 0; i < pre; ++i) {
+      for (int j = begin; j < end; ++j) {
+        for (int k = 0; k < post; ++k) {
+          int x_offset = i * n * post + j * post + k;
+          if (dx != nullptr) {
+            dx[x_offset] =
+                dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
+          }
+          if (dy != nullptr) {
+            T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
+            if (i == 0 && k == 0) {
+              dy[j] = tmp;
+            } else {
+              dy[j] += tmp;
+            }
           }
         }
       }
     }
-  }
+  });
 }
 
 #ifdef __NVCC__
@@ -137,6 +137,11 @@ class FCOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<bool>("use_mkldnn",
                   "(bool, default false) Only used in mkldnn kernel")
         .SetDefault(false);
+    AddAttr<bool>("use_packed_weight",
+                  "(bool, default false) Whether to run with the weight packed "
+                  "by MKL, which should be constant. Only used in CPU kernel, "
+                  "it is set by gemm_weight_pack_pass.")
+        .SetDefault(false);
     AddAttr<bool>(framework::kAllKernelsMustComputeRuntimeShape,
                   "Skip calling InferShape() function in the runtime.")
         .SetDefault(true);
@@ -18,6 +18,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/fc.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
 
 namespace paddle {
 namespace operators {
@@ -75,12 +76,20 @@ class FCOpKernel : public framework::OpKernel<T> {
 
     const T* input_data = input->data<T>();
     const T* w_data = w->data<T>();
+    const T* bias_data = bias ? bias->data<T>() : NULL;
     T* output_data = output->mutable_data<T>(ctx.GetPlace());
 
+    if (platform::is_cpu_place(ctx.GetPlace()) &&
+        ctx.Attr<bool>("use_packed_weight") &&
+        math::MatMulWithPackedWeight<T>(*w, M, input_data, output_data)) {
+      math::FCAddBias<T>(M, w_dims[1], output_data, bias_data, with_relu);
+      return;
+    }
+
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     math::FCFunctor<DeviceContext, T> fc;
     fc(dev_ctx, M, w_dims[1], w_dims[0], input_data, w_data, output_data,
-       bias ? bias->data<T>() : NULL, with_relu);
+       bias_data, with_relu);
   }
 };
 
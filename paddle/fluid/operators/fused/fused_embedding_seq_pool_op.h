@@ -79,7 +79,7 @@ void prepare_csr_data(const std::vector<uint64_t> &offset,
 template <typename T>
 struct EmbeddingVSumFunctor {
   void operator()(const framework::ExecutionContext &context,
-                  const LoDTensor *table_t, const LoDTensor *ids_t,
+                  const Tensor *table_t, const LoDTensor *ids_t,
                   LoDTensor *output_t) {
     auto *table = table_t->data<T>();
     int64_t table_height = table_t->dims()[0];
@@ -116,17 +116,63 @@ inline int FusedEmbeddingSeqPoolLastDim(const framework::DDim &table_dims,
   return last_dim;
 }
 
+// Replace the ids with the indexes of their rows in the SelectedRows table,
+// and the padding ids with kNoPadding.
+inline void RemapIdsToRowIndexes(const SelectedRows &table,
+                                 const LoDTensor &ids_t, int64_t padding_idx,
+                                 LoDTensor *indexes_t) {
+  const int64_t *ids = ids_t.data<int64_t>();
+  int64_t ids_numel = ids_t.numel();
+  int64_t *indexes =
+      indexes_t->mutable_data<int64_t>(ids_t.dims(), platform::CPUPlace());
+  indexes_t->set_lod(ids_t.lod());
+  table.BatchIndex(ids, ids_numel, indexes);
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    if (padding_idx != kNoPadding && ids[i] == padding_idx) {
+      indexes[i] = kNoPadding;
+    } else {
+      PADDLE_ENFORCE_GE(indexes[i], 0, "the input key %ld should be exists.",
+                        ids[i]);
+    }
+  }
+}
+
 template <typename T>
 class FusedEmbeddingSeqPoolKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext &context) const override {
     const LoDTensor *ids_t = context.Input<LoDTensor>("Ids");  // int tensor
     LoDTensor *output_t = context.Output<LoDTensor>("Out");    // float tensor
-    const LoDTensor *table_var = context.Input<LoDTensor>("W");
+    auto *table_var = context.InputVar("W");
     const std::string &combiner_type = context.Attr<std::string>("combiner");
+#if defined(PADDLE_WITH_MKLML) && !defined(_WIN32) && !defined(__APPLE__) && \
+    !defined(__OSX__)
+    int64_t padding_idx = context.Attr<int64_t>("padding_idx");
+#else
+    // EmbeddingVSumFunctor does not skip the padding ids.
+    int64_t padding_idx = kNoPadding;
+#endif
+
+    const Tensor *table_t = nullptr;
+    LoDTensor indexes_t;
+    if (table_var->IsType<LoDTensor>()) {
+      table_t = &table_var->Get<LoDTensor>();
+    } else if (table_var->IsType<SelectedRows>()) {
+      // Resolve all the ids in the table at once, then pool the rows of the
+      // value by their indexes, the padding ids are skipped as kNoPadding.
+      const auto &table = table_var->Get<SelectedRows>();
+      table_t = &table.value();
+      RemapIdsToRowIndexes(table, *ids_t, padding_idx, &indexes_t);
+      ids_t = &indexes_t;
+      padding_idx = kNoPadding;
+    } else {
+      PADDLE_THROW(
+          "The parameter W of a FusedEmbeddingSeqPool "
+          "must be either LoDTensor or SelectedRows");
+    }
 
     int64_t last_dim =
-        FusedEmbeddingSeqPoolLastDim(table_var->dims(), ids_t->dims());
+        FusedEmbeddingSeqPoolLastDim(table_t->dims(), ids_t->dims());
     const auto &ids_lod = ids_t->lod();
     // in run time, the LoD of ids must be 1
     PADDLE_ENFORCE_EQ(ids_lod.size(), 1UL,
@@ -139,11 +185,10 @@ class FusedEmbeddingSeqPoolKernel : public framework::OpKernel<T> {
     if (combiner_type == "sum") {
 #if defined(PADDLE_WITH_MKLML) && !defined(_WIN32) && !defined(__APPLE__) && \
     !defined(__OSX__)
-      int64_t padding_idx = context.Attr<int64_t>("padding_idx");
       auto output = output_t->mutable_data<T>(context.GetPlace());
-      int64_t table_height = table_var->dims()[0];
-      int64_t table_width = table_var->dims()[1];
-      auto weights = table_var->data<T>();
+      int64_t table_height = table_t->dims()[0];
+      int64_t table_width = table_t->dims()[1];
+      auto weights = table_t->data<T>();
 
       const std::vector<uint64_t> offset = ids_lod[0];
       auto len = ids_t->numel();
@@ -174,7 +219,7 @@ class FusedEmbeddingSeqPoolKernel : public framework::OpKernel<T> {
 
 #else
       EmbeddingVSumFunctor<T> functor;
-      functor(context, table_var, ids_t, output_t);
+      functor(context, table_t, ids_t, output_t);
 #endif
     }
   }
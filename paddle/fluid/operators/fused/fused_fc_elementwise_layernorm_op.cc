@@ -12,7 +12,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <string>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/fc.h"
 
 namespace paddle {
 namespace operators {
@@ -175,6 +178,77 @@ add_out <= elementwise_add(fc_out, Y)
   }
 };
 
+template <typename T>
+class FusedFCElementwiseLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *x = ctx.Input<framework::Tensor>("X");
+    auto *w = ctx.Input<framework::Tensor>("W");
+    auto *out = ctx.Output<framework::Tensor>("Out");
+
+    auto w_dims = w->dims();
+    int N = w_dims[1];
+    int K = w_dims[0];
+    int M = framework::product(x->dims()) / K;
+
+    auto *y = ctx.Input<framework::Tensor>("Y");
+    auto *bias_0 = ctx.Input<framework::Tensor>("Bias0");
+    auto *bias_1 = ctx.Input<framework::Tensor>("Bias1");
+    auto *scale = ctx.Input<framework::Tensor>("Scale");
+
+    const T *y_data = y->data<T>();
+    const T *bias_0_data = bias_0 ? bias_0->data<T>() : nullptr;
+    const T *bias_1_data = bias_1 ? bias_1->data<T>() : nullptr;
+    const T *scale_data = scale ? scale->data<T>() : nullptr;
+    T *out_data = out->mutable_data<T>(ctx.GetPlace());
+
+    // The JIT LayerNorm kernel is not in-place safe, so the fc and residual
+    // results are kept in a temporary tensor, which is normalized into out.
+    framework::Tensor fc_out;
+    T *fc_out_data = fc_out.mutable_data<T>({M, N}, ctx.GetPlace());
+
+    bool with_relu =
+        (ctx.Attr<std::string>("activation_type") == "relu") ? true : false;
+    auto &dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+    math::FCFunctor<platform::CPUDeviceContext, T> fc;
+    fc(dev_ctx, M, N, K, x->data<T>(), w->data<T>(), fc_out_data, bias_0_data,
+       with_relu);
+
+    // Normalize the rows of [left, right] after adding the residual.
+    auto matrix_dim = framework::flatten_to_2d(
+        y->dims(), ctx.Attr<int>("begin_norm_axis"));
+    int left = static_cast<int>(matrix_dim[0]);
+    int right = static_cast<int>(matrix_dim[1]);
+
+    auto add =
+        jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+            right);
+    for (int i = 0; i < left; ++i) {
+      add(y_data + i * right, fc_out_data + i * right, fc_out_data + i * right,
+          right);
+    }
+
+    auto *mean = ctx.Output<framework::Tensor>("Mean");
+    auto *variance = ctx.Output<framework::Tensor>("Variance");
+    framework::Tensor mean_tmp, variance_tmp;
+    if (mean == nullptr) {
+      mean = &mean_tmp;
+      mean->Resize({left});
+    }
+    if (variance == nullptr) {
+      variance = &variance_tmp;
+      variance->Resize({left});
+    }
+
+    auto layer_norm =
+        jit::KernelFuncs<jit::LayerNormTuple<T>, platform::CPUPlace>::Cache()
+            .At(right);
+    layer_norm(fc_out_data, out_data, mean->mutable_data<T>(ctx.GetPlace()),
+               variance->mutable_data<T>(ctx.GetPlace()), scale_data,
+               bias_1_data, left, ctx.Attr<float>("epsilon"), right);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -183,3 +257,6 @@ REGISTER_OPERATOR(fused_fc_elementwise_layernorm,
                   ops::FusedFCElementwiseLayerNormOp,
                   ops::FusedFCElementwiseLayerNormOpMaker,
                   paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(fused_fc_elementwise_layernorm,
+                       ops::FusedFCElementwiseLayerNormCPUKernel<float>,
+                       ops::FusedFCElementwiseLayerNormCPUKernel<double>);
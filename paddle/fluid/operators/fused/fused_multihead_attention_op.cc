@@ -0,0 +1,274 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/fc.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedMultiHeadAttentionOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext *ctx) const override {
+    for (auto &name : {"X", "WQ", "BiasQ", "WK", "BiasK", "WV", "BiasV",
+                       "WOut", "BiasOut"}) {
+      PADDLE_ENFORCE_EQ(ctx->HasInput(name), true,
+                        "Input(%s) of fused_multihead_attention should not be "
+                        "null.",
+                        name);
+    }
+    PADDLE_ENFORCE_EQ(
+        ctx->HasOutput("Out"), true,
+        "Output(Out) of fused_multihead_attention should not be null.");
+
+    auto x_dims = ctx->GetInputDim("X");
+    PADDLE_ENFORCE_EQ(x_dims.size(), 3,
+                      "Input(X) should be a 3-D tensor of [batch, seq, hidden].");
+
+    auto w_dims = ctx->GetInputDim("WQ");
+    PADDLE_ENFORCE_EQ(w_dims.size(), 2, "Input(WQ) should be a 2-D tensor.");
+    PADDLE_ENFORCE_EQ(ctx->GetInputDim("WK"), w_dims,
+                      "Input(WK) should be of the same shape as Input(WQ).");
+    PADDLE_ENFORCE_EQ(ctx->GetInputDim("WV"), w_dims,
+                      "Input(WV) should be of the same shape as Input(WQ).");
+    if (ctx->IsRuntime() || (x_dims[2] > 0 && w_dims[0] > 0)) {
+      PADDLE_ENFORCE_EQ(x_dims[2], w_dims[0],
+                        "The hidden size of Input(X) and the height of "
+                        "Input(WQ) should be equal.");
+    }
+    for (auto &name : {"BiasQ", "BiasK", "BiasV"}) {
+      PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim(name)),
+                        w_dims[1], "The size of Input(%s) should be %d.",
+                        name, w_dims[1]);
+    }
+
+    int head_number = ctx->Attrs().Get<int>("head_number");
+    PADDLE_ENFORCE_GT(head_number, 0, "'head_number' should be positive.");
+    PADDLE_ENFORCE_EQ(w_dims[1] % head_number, 0,
+                      "The width of Input(WQ) should be divisible by "
+                      "'head_number'.");
+
+    auto w_out_dims = ctx->GetInputDim("WOut");
+    PADDLE_ENFORCE_EQ(w_out_dims.size(), 2,
+                      "Input(WOut) should be a 2-D tensor.");
+    PADDLE_ENFORCE_EQ(w_out_dims[0], w_dims[1],
+                      "The height of Input(WOut) and the width of Input(WQ) "
+                      "should be equal.");
+    PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("BiasOut")),
+                      w_out_dims[1], "The size of Input(BiasOut) should be %d.",
+                      w_out_dims[1]);
+
+    if (ctx->HasInput("BiasQK")) {
+      PADDLE_ENFORCE_EQ(ctx->GetInputDim("BiasQK").size(), 4,
+                        "Input(BiasQK) should be a 4-D tensor.");
+    }
+
+    ctx->SetOutputDim("Out", {x_dims[0], x_dims[1], w_out_dims[1]});
+    ctx->ShareLoD("X", "Out");
+  }
+};
+
+class FusedMultiHeadAttentionOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X",
+             "(Tensor), The input tensor of shape [batch, seq_len, hidden].");
+    AddInput("WQ",
+             "(Tensor), The weight of the projection of query, a 2-D tensor "
+             "of shape [hidden, size].");
+    AddInput("BiasQ",
+             "(Tensor), The bias of the projection of query, of shape [size].");
+    AddInput("WK",
+             "(Tensor), The weight of the projection of key, of the same "
+             "shape as WQ.");
+    AddInput("BiasK",
+             "(Tensor), The bias of the projection of key, of shape [size].");
+    AddInput("WV",
+             "(Tensor), The weight of the projection of value, of the same "
+             "shape as WQ.");
+    AddInput("BiasV",
+             "(Tensor), The bias of the projection of value, of shape [size].");
+    AddInput("BiasQK",
+             "(Tensor, optional), The bias added to the attention scores, a "
+             "4-D tensor of shape [batch or 1, head_number or 1, seq_len or "
+             "1, seq_len].")
+        .AsDispensable();
+    AddInput("WOut",
+             "(Tensor), The weight of the output projection, a 2-D tensor of "
+             "shape [size, out_size].");
+    AddInput("BiasOut",
+             "(Tensor), The bias of the output projection, of shape "
+             "[out_size].");
+    AddOutput("Out",
+              "(Tensor), The output tensor of shape [batch, seq_len, "
+              "out_size].");
+    AddAttr<int>("head_number", "The number of heads, which divides size.")
+        .SetDefault(1);
+    AddAttr<float>("alpha", "The scale of the attention scores.")
+        .SetDefault(1.0f);
+    AddComment(R"DOC(
+q, k, v <= fc(X, WQ, BiasQ), fc(X, WK, BiasK), fc(X, WV, BiasV), each of which
+           is split into head_number heads of shape [batch, head, seq, size / head]
+attn <= softmax(alpha * q * k^T + BiasQK) * v, with the heads combined
+Out <= fc(attn, WOut, BiasOut)
+)DOC");
+  }
+};
+
+template <typename T>
+class FusedMultiHeadAttentionKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *x = ctx.Input<framework::Tensor>("X");
+    auto *bias_qk = ctx.Input<framework::Tensor>("BiasQK");
+    auto *w_out = ctx.Input<framework::Tensor>("WOut");
+    auto *bias_out = ctx.Input<framework::Tensor>("BiasOut");
+    auto *out = ctx.Output<framework::Tensor>("Out");
+    auto place = ctx.GetPlace();
+    auto &dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+
+    auto x_dims = x->dims();
+    int batch = x_dims[0];
+    int seq_len = x_dims[1];
+    int hidden = x_dims[2];
+    int size = ctx.Input<framework::Tensor>("WQ")->dims()[1];
+    int head_number = ctx.Attr<int>("head_number");
+    int head_size = size / head_number;
+    int M = batch * seq_len;
+    // The number of the attention matrices of all the heads.
+    int batch_head = batch * head_number;
+
+    // q, k and v of [3, batch, seq_len, head_number, head_size].
+    framework::Tensor qkv;
+    qkv.Resize({3, batch, seq_len, head_number, head_size});
+    T *qkv_data = qkv.mutable_data<T>(place);
+    math::FCFunctor<platform::CPUDeviceContext, T> fc;
+    const char *weights[] = {"WQ", "WK", "WV"};
+    const char *biases[] = {"BiasQ", "BiasK", "BiasV"};
+    for (int i = 0; i < 3; ++i) {
+      fc(dev_ctx, M, size, hidden, x->data<T>(),
+         ctx.Input<framework::Tensor>(weights[i])->data<T>(),
+         qkv_data + i * M * size,
+         ctx.Input<framework::Tensor>(biases[i])->data<T>());
+    }
+
+    // Split the heads to [3, batch, head_number, seq_len, head_size].
+    framework::Tensor heads;
+    heads.Resize({3, batch, head_number, seq_len, head_size});
+    heads.mutable_data<T>(place);
+    math::Transpose<platform::CPUDeviceContext, T, 5> trans5;
+    trans5(dev_ctx, qkv, &heads, {0, 1, 3, 2, 4});
+    const T *q_data = heads.data<T>();
+    const T *k_data = q_data + M * size;
+    const T *v_data = k_data + M * size;
+
+    // scores = alpha * q * k^T of [batch, head_number, seq_len, seq_len].
+    framework::Tensor scores;
+    scores.Resize({batch, head_number, seq_len, seq_len});
+    T *scores_data = scores.mutable_data<T>(place);
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(dev_ctx);
+    int64_t head_stride = static_cast<int64_t>(seq_len) * head_size;
+    blas.BatchedGEMM(CblasNoTrans, CblasTrans, seq_len, seq_len, head_size,
+                     static_cast<T>(ctx.Attr<float>("alpha")), q_data, k_data,
+                     static_cast<T>(0), scores_data, batch_head, head_stride,
+                     head_stride);
+
+    if (bias_qk) {
+      AddBiasQK(*bias_qk, batch, head_number, seq_len, scores_data);
+    }
+    auto softmax =
+        jit::KernelFuncs<jit::SoftmaxTuple<T>, platform::CPUPlace>::Cache().At(
+            seq_len);
+    softmax(scores_data, scores_data, seq_len, batch_head * seq_len, 1);
+
+    // context = scores * v of [batch, head_number, seq_len, head_size].
+    framework::Tensor context;
+    context.Resize({batch, head_number, seq_len, head_size});
+    T *context_data = context.mutable_data<T>(place);
+    blas.BatchedGEMM(CblasNoTrans, CblasNoTrans, seq_len, head_size, seq_len,
+                     static_cast<T>(1), scores_data, v_data, static_cast<T>(0),
+                     context_data, batch_head,
+                     static_cast<int64_t>(seq_len) * seq_len, head_stride);
+
+    // Combine the heads to [batch, seq_len, size], and project it.
+    framework::Tensor combined;
+    combined.Resize({batch, seq_len, head_number, head_size});
+    combined.mutable_data<T>(place);
+    math::Transpose<platform::CPUDeviceContext, T, 4> trans4;
+    trans4(dev_ctx, context, &combined, {0, 2, 1, 3});
+
+    int out_size = w_out->dims()[1];
+    out->Resize({batch, seq_len, out_size});
+    fc(dev_ctx, M, out_size, size, combined.data<T>(), w_out->data<T>(),
+       out->mutable_data<T>(place), bias_out->data<T>());
+  }
+
+ private:
+  // Adds bias_qk of [batch or 1, head_number or 1, seq_len or 1, seq_len] to
+  // the scores of [batch, head_number, seq_len, seq_len].
+  void AddBiasQK(const framework::Tensor &bias_qk, int batch, int head_number,
+                 int seq_len, T *scores) const {
+    auto dims = bias_qk.dims();
+    PADDLE_ENFORCE_EQ(dims.size(), 4, "Input(BiasQK) should be a 4-D tensor.");
+    PADDLE_ENFORCE(dims[0] == batch || dims[0] == 1,
+                   "The dim 0 of Input(BiasQK) should be %d or 1.", batch);
+    PADDLE_ENFORCE(dims[1] == head_number || dims[1] == 1,
+                   "The dim 1 of Input(BiasQK) should be %d or 1.",
+                   head_number);
+    PADDLE_ENFORCE(dims[2] == seq_len || dims[2] == 1,
+                   "The dim 2 of Input(BiasQK) should be %d or 1.", seq_len);
+    PADDLE_ENFORCE_EQ(dims[3], seq_len,
+                      "The dim 3 of Input(BiasQK) should be %d.", seq_len);
+    int bias_batch = dims[0];
+    int bias_heads = dims[1];
+    int bias_rows = dims[2];
+    const T *bias_data = bias_qk.data<T>();
+
+    auto add =
+        jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+            seq_len);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < batch * head_number; ++i) {
+      int b = bias_batch == 1 ? 0 : i / head_number;
+      int h = bias_heads == 1 ? 0 : i % head_number;
+      const T *bias = bias_data + (b * bias_heads + h) * bias_rows * seq_len;
+      T *dst = scores + static_cast<int64_t>(i) * seq_len * seq_len;
+      for (int r = 0; r < seq_len; ++r) {
+        const T *bias_row = bias_rows == 1 ? bias : bias + r * seq_len;
+        add(bias_row, dst + r * seq_len, dst + r * seq_len, seq_len);
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_multihead_attention, ops::FusedMultiHeadAttentionOp,
+                  ops::FusedMultiHeadAttentionOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(fused_multihead_attention,
+                       ops::FusedMultiHeadAttentionKernel<float>,
+                       ops::FusedMultiHeadAttentionKernel<double>);
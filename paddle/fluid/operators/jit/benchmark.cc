@@ -12,9 +12,11 @@
  * See the License for the specific language governing permissions and
  * limitations under the License. */
 
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 #include "gflags/gflags.h"
 #include "glog/logging.h"
@@ -29,6 +31,7 @@ DEFINE_int32(burning, 10, "Burning times.");
 DEFINE_int32(repeat, 3000, "Repeat times.");
 DEFINE_int32(max_size, 1000, "The Max size would be tested.");
 DEFINE_string(filter, "", "The Benchmark name would be run.");
+DEFINE_int32(threads, 8, "The threads number of the FirstCall benchmark.");
 
 class BenchJITKernel {
  public:
@@ -476,6 +479,47 @@ void BenchKernelVBroadcast() {
   }
 }
 
+// Benchmark the latency of the first calls of KernelFuncs in several threads.
+// The jitcodes of every attr are generated once and shared by all threads.
+template <typename PlaceType>
+void BenchFirstCallMultiThreads() {
+  auto first_call = [](double* elapsed) {
+    auto start = paddle::platform::PosixInNsec() * 1e-3;
+    for (int d : TestSizes()) {
+      const jit::lstm_attr_t lstm_attr(d, jit::kVSigmoid, jit::kVTanh,
+                                       jit::kVTanh, false);
+      jit::KernelFuncs<jit::LSTMCtHtTuple<float>, PlaceType>::Cache().At(
+          lstm_attr);
+      const jit::gru_attr_t gru_attr(d, jit::kVSigmoid, jit::kVTanh);
+      jit::KernelFuncs<jit::GRUH1Tuple<float>, PlaceType>::Cache().At(
+          gru_attr);
+      const jit::seq_pool_attr_t seq_pool_attr(d, jit::SeqPoolType::kSum);
+      jit::KernelFuncs<jit::SeqPoolTuple<float>, PlaceType>::Cache().At(
+          seq_pool_attr);
+    }
+    auto end = paddle::platform::PosixInNsec() * 1e-3;
+    *elapsed = end - start;
+  };
+
+  std::vector<double> elapsed(FLAGS_threads, 0.0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < FLAGS_threads; ++i) {
+    threads.emplace_back(first_call, &elapsed[i]);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  double sum = 0.0, max = 0.0;
+  for (auto e : elapsed) {
+    sum += e;
+    max = std::max(max, e);
+  }
+  LOG(INFO) << "First call of " << 3 * FLAGS_max_size << " attrs in "
+            << FLAGS_threads << " threads: average takes "
+            << sum / FLAGS_threads << " us, max takes " << max << " us";
+}
+
 #define BenchKernelVMul BenchKernelXYZN
 #define BenchKernelVAdd BenchKernelXYZN
 #define BenchKernelVAddRelu BenchKernelXYZN
@@ -509,6 +553,11 @@ using CPUPlace = paddle::platform::CPUPlace;
     BenchKernel##name<jit::name##Tuple<float>, CPUPlace>(); \
   }
 
+// Should go first, before the jitcodes are generated by other benchmarks.
+BENCH_JITKERNEL(FirstCall, FP32, CPU) {
+  BenchFirstCallMultiThreads<CPUPlace>();
+}
+
 // xyzn
 BENCH_FP32_CPU(VMul);
 BENCH_FP32_CPU(VAdd);
@@ -558,6 +607,7 @@ BENCH_FP32_CPU(VBroadcast);
 //     --repeat: the repeat times
 //     --max_size: the max size would be tested
 //     --filter: the bench name would be run
+//     --threads: the threads number of the FirstCall benchmark
 int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
   google::InitGoogleLogging(argv[0]);
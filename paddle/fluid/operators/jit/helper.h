@@ -15,6 +15,7 @@
 #pragma once
 
 #include <iostream>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <utility>  // for std::move
@@ -38,8 +39,16 @@ GetJitCode(const typename KernelTuple::attr_type& attr) {
   using Attr = typename KernelTuple::attr_type;
   int64_t key = JitCodeKey<Attr>(attr);
   auto& codes = JitCodePool<KernelTuple::kernel_type>::Instance();
-  if (codes.Has(key)) {
-    return codes.AllKernels().at(key).get();
+  auto* res = codes.Get(key);
+  if (res) {
+    return res;
+  }
+
+  std::lock_guard<std::mutex> guard(codes.GenMutex());
+  // The code may be generated by other threads when waiting for the lock
+  res = codes.Get(key);
+  if (res) {
+    return res;
   }
 
   // creator is not related with attr, so can use KernelKey as key
@@ -54,9 +63,7 @@ GetJitCode(const typename KernelTuple::attr_type& attr) {
       if (i && i->CanBeUsed(attr)) {
         auto p = i->CreateJitCode(attr);
         if (p) {
-          auto res = p.get();
-          codes.Insert(key, std::move(p));
-          return res;
+          return codes.Insert(key, std::move(p));
         }
       }
     }
@@ -175,6 +182,9 @@ typename KernelTuple::func_type GetDefaultBestFunc(
   return funcs[0];
 }
 
+// The thread local cache of the function pointers in front of the kernel
+// pools and the process-wide JitCodePool, so that the lookups of one attr
+// would not take any lock after the first time.
 template <typename KernelTuple, typename PlaceType>
 class KernelFuncs {
  public:
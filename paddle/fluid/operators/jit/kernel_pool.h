@@ -15,10 +15,12 @@
 #pragma once
 
 #include <memory>  // for unique_ptr
+#include <mutex>   // NOLINT
 #include <string>
 #include <unordered_map>
 #include <utility>  // for move
 #include <vector>
+#include "paddle/fluid/framework/rw_lock.h"
 #include "paddle/fluid/operators/jit/gen_base.h"
 #include "paddle/fluid/operators/jit/kernel_base.h"
 #include "paddle/fluid/operators/jit/kernel_key.h"
@@ -28,6 +30,10 @@ namespace paddle {
 namespace operators {
 namespace jit {
 
+// The generated codes are shared by all threads of the process, so that every
+// code of one (kernel type, attr) key is generated only once. The pool is
+// read-mostly: the lookups take a read lock and each thread only looks up a
+// key once since KernelFuncs caches the function pointers per thread.
 template <KernelType KT>
 class JitCodePool {
   typedef std::unique_ptr<GenBase> GenBasePtr;
@@ -36,20 +42,37 @@ class JitCodePool {
  public:
   JitCodePool() = default;
   static JitCodePool& Instance() {
-    static thread_local JitCodePool<KT> g_jit_codes;
+    static JitCodePool<KT> g_jit_codes;
     return g_jit_codes;
   }
 
+  // Not thread-safe, only used in unit tests.
   const JitCodeMap& AllKernels() { return codes_; }
 
-  bool Has(int64_t key) const { return codes_.find(key) != codes_.end(); }
+  bool Has(int64_t key) const { return Get(key) != nullptr; }
 
-  void Insert(int64_t key, GenBasePtr value) {
-    codes_.emplace(key, std::move(value));
+  // Returns nullptr if the key does not exist.
+  const GenBase* Get(int64_t key) const {
+    framework::AutoRDLock guard(&rw_lock_);
+    auto iter = codes_.find(key);
+    return iter != codes_.end() ? iter->second.get() : nullptr;
   }
 
+  // Returns the code of the key, which is the inserted one if the key did
+  // not exist.
+  const GenBase* Insert(int64_t key, GenBasePtr value) {
+    framework::AutoWRLock guard(&rw_lock_);
+    return codes_.emplace(key, std::move(value)).first->second.get();
+  }
+
+  // Held when generating codes, so that the same code would not be generated
+  // by several threads at the same time.
+  std::mutex& GenMutex() { return gen_mtx_; }
+
  private:
   JitCodeMap codes_;
+  mutable framework::RWLock rw_lock_;
+  std::mutex gen_mtx_;
   DISABLE_COPY_AND_ASSIGN(JitCodePool);
 };
 
@@ -59,6 +59,13 @@ class LoadCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
                   "If true, file_path is in memory, and LoDTensors will be "
                   "loaded directly from memory")
         .SetDefault(false);
+    AddAttr<bool>("use_mmap",
+                  "(boolean, default false)"
+                  "If true, the file will be mapped into memory, and the "
+                  "LoDTensors on CPU will point to the mapping without copy "
+                  "if their data are aligned, which is the case when the "
+                  "file is saved by save_combine with align_payload.")
+        .SetDefault(false);
     AddComment(R"DOC(
 LoadCombine Operator.
 
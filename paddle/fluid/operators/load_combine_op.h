@@ -15,11 +15,13 @@ limitations under the License. */
 #pragma once
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/mapped_file.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/device_context.h"
 
@@ -33,12 +35,16 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     auto filename = ctx.Attr<std::string>("file_path");
     auto load_as_fp16 = ctx.Attr<bool>("load_as_fp16");
     auto model_from_memory = ctx.Attr<bool>("model_from_memory");
+    auto use_mmap = ctx.Attr<bool>("use_mmap");
     auto &out_var_names = ctx.Outputs("Out");
 
     PADDLE_ENFORCE_GT(
         static_cast<int>(out_var_names.size()), 0,
         "The number of output variables should be greater than 0.");
-    if (!model_from_memory) {
+    if (use_mmap && !model_from_memory && platform::is_cpu_place(place)) {
+      LoadParamsFromMappedFile(ctx, place, filename, load_as_fp16,
+                               out_var_names);
+    } else if (!model_from_memory) {
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE(static_cast<bool>(fin),
                      "OP(LoadCombine) fail to open file %s, please check "
@@ -78,25 +84,8 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
       // Get data from fin to tensor
       DeserializeFromStream(*buffer, tensor, dev_ctx);
 
-      auto in_dtype = tensor->type();
-      auto out_dtype =
-          load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
-
-      if (in_dtype != out_dtype) {
-        // convert to float16 tensor
-        auto in_kernel_type = framework::OpKernelType(in_dtype, place);
-        auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor fp16_tensor;
-        // copy LoD info to the new tensor
-        fp16_tensor.set_lod(tensor->lod());
-        framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
-                                 &fp16_tensor);
-
-        // reset output tensor
-        out_vars[i]->Clear();
-        tensor = out_vars[i]->GetMutable<framework::LoDTensor>();
-        tensor->set_lod(fp16_tensor.lod());
-        tensor->ShareDataWith(fp16_tensor);
+      if (load_as_fp16) {
+        CastToFP16(place, out_vars[i]);
       }
     }
     buffer->peek();
@@ -104,6 +93,55 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                    "You are not allowed to load partial data via "
                    "load_combine_op, use load_op instead.");
   }
+
+  // The CPU tensors point to the mapped file directly if their payloads are
+  // aligned, so that processes loading the same file share the pages.
+  void LoadParamsFromMappedFile(
+      const framework::ExecutionContext &context, const platform::Place &place,
+      const std::string &filename, bool load_as_fp16,
+      const std::vector<std::string> &out_var_names) const {
+    auto file = std::make_shared<framework::MappedFile>(filename);
+    auto out_vars = context.MultiOutputVar("Out");
+
+    size_t offset = 0;
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      PADDLE_ENFORCE(out_vars[i] != nullptr,
+                     "Output variable %s cannot be found", out_var_names[i]);
+
+      auto *tensor = out_vars[i]->GetMutable<framework::LoDTensor>();
+      framework::DeserializeFromMappedFile(file, &offset, tensor);
+
+      if (load_as_fp16) {
+        CastToFP16(place, out_vars[i]);
+      }
+    }
+    PADDLE_ENFORCE_EQ(offset, file->size(),
+                      "You are not allowed to load partial data via "
+                      "load_combine_op, use load_op instead.");
+  }
+
+  void CastToFP16(const platform::Place &place,
+                  framework::Variable *out_var) const {
+    auto *tensor = out_var->GetMutable<framework::LoDTensor>();
+    auto in_dtype = tensor->type();
+    auto out_dtype = framework::proto::VarType::FP16;
+    if (in_dtype == out_dtype) return;
+
+    // convert to float16 tensor
+    auto in_kernel_type = framework::OpKernelType(in_dtype, place);
+    auto out_kernel_type = framework::OpKernelType(out_dtype, place);
+    framework::LoDTensor fp16_tensor;
+    // copy LoD info to the new tensor
+    fp16_tensor.set_lod(tensor->lod());
+    framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
+                             &fp16_tensor);
+
+    // reset output tensor
+    out_var->Clear();
+    tensor = out_var->GetMutable<framework::LoDTensor>();
+    tensor->set_lod(fp16_tensor.lod());
+    tensor->ShareDataWith(fp16_tensor);
+  }
 };
 
 }  // namespace operators
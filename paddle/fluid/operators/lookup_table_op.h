@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/gather_rows.h"
 
 #ifdef PADDLE_WITH_DISTRIBUTE
 #include "paddle/fluid/operators/distributed/parameter_prefetch.h"
@@ -108,18 +109,19 @@ class LookupTableKernel : public framework::OpKernel<T> {
         const auto *table = table_t.value().data<T>();
         auto *output = output_t->mutable_data<T>(context.GetPlace());
 
-        auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
+        // Resolve all the ids first, then gather the rows in one pass.
+        std::vector<int64_t> indexes(ids_numel);
+        table_t.BatchIndex(ids, ids_numel, indexes.data());
         for (int64_t i = 0; i < ids_numel; ++i) {
           if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-            memset(output + i * row_width, 0, row_width * sizeof(T));
+            indexes[i] = -1;
           } else {
             PADDLE_ENFORCE_GE(ids[i], 0);
-            auto id_index = table_t.Index(ids[i]);
-            PADDLE_ENFORCE_GE(id_index, 0, "the input key should be exists.");
-            blas.VCOPY(row_width, table + id_index * row_width,
-                       output + i * row_width);
+            PADDLE_ENFORCE_GE(indexes[i], 0,
+                              "the input key %ld should be exists.", ids[i]);
           }
         }
+        math::GatherRows(table, indexes.data(), ids_numel, row_width, output);
       }
     }
   }
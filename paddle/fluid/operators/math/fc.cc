@@ -20,6 +20,32 @@ namespace paddle {
 namespace operators {
 namespace math {
 
+template <typename T>
+void FCAddBias(const int M, const int N, T* Y, const T* B, bool relu) {
+  if (B == NULL) {
+    return;
+  }
+  if (relu) {
+    auto compute =
+        jit::KernelFuncs<jit::VAddReluTuple<T>, platform::CPUPlace>::Cache().At(
+            N);
+    for (int i = 0; i < M; i++) {
+      T* dst = Y + i * N;
+      compute(B, dst, dst, N);
+    }
+  } else {
+    auto compute =
+        jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(N);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < M; i++) {
+      T* dst = Y + i * N;
+      compute(B, dst, dst, N);
+    }
+  }
+}
+
 template <typename T>
 class FCFunctor<platform::CPUDeviceContext, T> {
  public:
@@ -28,32 +54,14 @@ class FCFunctor<platform::CPUDeviceContext, T> {
                   const T* B = nullptr, bool relu = false) {
     auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
     blas.MatMul(M, N, K, X, W, Y);
-    if (B == NULL) {
-      return;
-    }
-    if (relu) {
-      auto compute =
-          jit::KernelFuncs<jit::VAddReluTuple<T>, platform::CPUPlace>::Cache()
-              .At(N);
-      for (int i = 0; i < M; i++) {
-        T* dst = Y + i * N;
-        compute(B, dst, dst, N);
-      }
-    } else {
-      auto compute =
-          jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
-              N);
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
-#endif
-      for (int i = 0; i < M; i++) {
-        T* dst = Y + i * N;
-        compute(B, dst, dst, N);
-      }
-    }
+    FCAddBias<T>(M, N, Y, B, relu);
   }
 };
 
+template void FCAddBias<float>(const int M, const int N, float* Y,
+                               const float* B, bool relu);
+template void FCAddBias<double>(const int M, const int N, double* Y,
+                                const double* B, bool relu);
 template class FCFunctor<platform::CPUDeviceContext, float>;
 template class FCFunctor<platform::CPUDeviceContext, double>;
 
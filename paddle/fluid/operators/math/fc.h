@@ -29,6 +29,13 @@ class FCFunctor {
                   const T* B = nullptr, bool relu = false);
 };
 
+// Adds B to each of the M rows of Y on CPU, then applies relu if relu is
+// true. It is the bias part of FCFunctor, for Y which already holds X * W,
+// e.g. which is computed with the packed weight.
+template <typename T>
+void FCAddBias(const int M, const int N, T* Y, const T* B = nullptr,
+               bool relu = false);
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
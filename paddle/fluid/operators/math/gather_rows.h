@@ -0,0 +1,100 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>  // for int64_t
+#include <cstring>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// How many rows ahead of the copied row are prefetched.
+constexpr int64_t kGatherRowsPrefetchDistance = 8;
+// Gather with multiple threads only when there are enough elements to copy.
+constexpr int64_t kGatherRowsParallelNumel = 64 * 1024;
+
+namespace detail {
+
+inline void PrefetchRead(const void* addr) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(addr, 0, 1);
+#else
+  static_cast<void>(addr);
+#endif
+}
+
+template <typename T, typename RowFunc>
+void GatherRowsImpl(RowFunc row, int64_t n, int64_t width, T* dst) {
+  const size_t row_bytes = width * sizeof(T);
+  const int64_t lines_per_row = (row_bytes + 63) / 64;
+#ifdef PADDLE_WITH_MKLML
+  const bool parallel = n * width >= kGatherRowsParallelNumel;
+#pragma omp parallel for schedule(static) if (parallel)
+#endif
+  for (int64_t i = 0; i < n; ++i) {
+    // The rows are scattered in the table, so the hardware prefetcher can
+    // not predict them, fetch the upcoming row while copying this one.
+    if (i + kGatherRowsPrefetchDistance < n) {
+      const char* next = reinterpret_cast<const char*>(
+          row(i + kGatherRowsPrefetchDistance));
+      if (next != nullptr) {
+        for (int64_t l = 0; l < lines_per_row; ++l) {
+          PrefetchRead(next + l * 64);
+        }
+      }
+    }
+    const T* src = row(i);
+    if (src == nullptr) {
+      std::memset(dst + i * width, 0, row_bytes);
+    } else {
+      std::memcpy(dst + i * width, src, row_bytes);
+    }
+  }
+}
+
+}  // namespace detail
+
+/*
+ * @brief Copy the rows of table into dst, the ith row of dst is the
+ * indexes[i]th row of table, or zeros if indexes[i] is negative.
+ *
+ * Both table and dst are row-major with width elements per row, and dst
+ * should hold n rows.
+ */
+template <typename T>
+void GatherRows(const T* table, const int64_t* indexes, int64_t n,
+                int64_t width, T* dst) {
+  detail::GatherRowsImpl<T>(
+      [=](int64_t i) -> const T* {
+        return indexes[i] < 0 ? nullptr : table + indexes[i] * width;
+      },
+      n, width, dst);
+}
+
+/*
+ * @brief Copy the n rows into dst, the row is filled with zeros if its
+ * pointer is nullptr.
+ */
+template <typename T>
+void GatherRows(const T* const* rows, int64_t n, int64_t width, T* dst) {
+  detail::GatherRowsImpl<T>([=](int64_t i) { return rows[i]; }, n, width,
+                            dst);
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
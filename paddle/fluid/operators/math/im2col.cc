@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/im2col.h"
 #include <vector>
 #include "paddle/fluid/operators/math/im2col_cfo_cpu.h"
+#include "paddle/fluid/platform/parallel_for.h"
 
 namespace paddle {
 namespace operators {
@@ -36,6 +37,23 @@ class Im2ColFunctor<paddle::operators::math::ColFormat::kCFO,
     PADDLE_ENFORCE(im.dims().size() == 3);
     PADDLE_ENFORCE(col->dims().size() == 5);
 
+    // The input channels are unfolded to disjoint blocks of col, so the
+    // slices of them run in parallel.
+    const int64_t channel_cost = col->numel() / col->dims()[0];
+    platform::ParallelFor(
+        0, im.dims()[0], platform::ParallelForGrainSize(channel_cost),
+        [&](int64_t begin, int64_t end) {
+          const framework::Tensor im_slice = im.Slice(begin, end);
+          framework::Tensor col_slice = col->Slice(begin, end);
+          Im2ColSlice(im_slice, dilation, stride, padding, &col_slice);
+        });
+  }
+
+ private:
+  void Im2ColSlice(const framework::Tensor& im,
+                   const std::vector<int>& dilation,
+                   const std::vector<int>& stride,
+                   const std::vector<int>& padding, framework::Tensor* col) {
     if (stride[0] == 1 && stride[1] == 1 && dilation[0] == 1 &&
         dilation[1] == 1) {
       if (padding[0] == 0 && padding[1] == 0) {
@@ -0,0 +1,174 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/math/packed_gemm.h"
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+namespace {
+
+#ifdef PADDLE_WITH_MKLML
+template <typename T>
+class PackedWeight {
+ public:
+  PackedWeight(const T* weight, int K, int N) : K_(K), N_(N) {
+    auto blas = GetCPUBlas();
+    data_ = blas.GEMM_ALLOC(CblasBMatrix, 1 /*height of C*/, N, K);
+    PADDLE_ENFORCE_NOT_NULL(data_, "Failed to allocate the packed weight.");
+    blas.GEMM_PACK(CblasBMatrix, CblasNoTrans, 1 /*height of C*/, N, K, T(1.0),
+                   weight, N, data_);
+  }
+
+  ~PackedWeight() { GetCPUBlas().GEMM_FREE(data_); }
+
+  void MatMul(int M, const T* X, T* Y) const {
+    GetCPUBlas().GEMM_COMPUTE(CblasNoTrans, CblasPacked, M, N_, K_, X, K_,
+                              data_, N_, T(0.0), Y, N_);
+  }
+
+  int K() const { return K_; }
+  int N() const { return N_; }
+
+ private:
+  static BlasT<platform::CPUDeviceContext, T> GetCPUBlas() {
+    auto* dev_ctx = static_cast<platform::CPUDeviceContext*>(
+        platform::DeviceContextPool::Instance().Get(platform::CPUPlace()));
+    return GetBlas<platform::CPUDeviceContext, T>(*dev_ctx);
+  }
+
+  T* data_{nullptr};
+  int K_;
+  int N_;
+
+  DISABLE_COPY_AND_ASSIGN(PackedWeight);
+};
+
+template <typename T>
+class PackedWeightCache {
+ public:
+  static PackedWeightCache& Instance() {
+    static PackedWeightCache cache;
+    return cache;
+  }
+
+  std::shared_ptr<const PackedWeight<T>> Get(const framework::Tensor& weight) {
+    if (weight.dims().size() != 2 || !platform::is_cpu_place(weight.place())) {
+      return nullptr;
+    }
+    const T* data = weight.data<T>();
+    int K = static_cast<int>(weight.dims()[0]);
+    int N = static_cast<int>(weight.dims()[1]);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(data);
+    // The address may be reused by another weight after the cached one is
+    // freed, the holder tells them apart.
+    if (it != entries_.end() &&
+        it->second.holder.lock() == weight.Holder() &&
+        it->second.packed->K() == K && it->second.packed->N() == N) {
+      return it->second.packed;
+    }
+
+    for (auto iter = entries_.begin(); iter != entries_.end();) {
+      if (iter->second.holder.expired()) {
+        iter = entries_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    Entry& entry = entries_[data];
+    entry.holder = weight.Holder();
+    entry.packed = std::make_shared<PackedWeight<T>>(data, K, N);
+    VLOG(3) << "Pack the weight " << data << " of [" << K << ", " << N << "]";
+    return entry.packed;
+  }
+
+ private:
+  PackedWeightCache() = default;
+
+  struct Entry {
+    std::weak_ptr<memory::Allocation> holder;
+    std::shared_ptr<const PackedWeight<T>> packed;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<const T*, Entry> entries_;
+
+  DISABLE_COPY_AND_ASSIGN(PackedWeightCache);
+};
+
+template <typename T>
+bool PackWeightImpl(const framework::Tensor& weight) {
+  return PackedWeightCache<T>::Instance().Get(weight) != nullptr;
+}
+
+template <typename T>
+bool MatMulWithPackedWeightImpl(const framework::Tensor& weight, int M,
+                                const T* X, T* Y) {
+  auto packed = PackedWeightCache<T>::Instance().Get(weight);
+  if (packed == nullptr) {
+    return false;
+  }
+  if (M > 0) {
+    packed->MatMul(M, X, Y);
+  }
+  return true;
+}
+#else
+template <typename T>
+bool PackWeightImpl(const framework::Tensor& weight) {
+  return false;
+}
+
+template <typename T>
+bool MatMulWithPackedWeightImpl(const framework::Tensor& weight, int M,
+                                const T* X, T* Y) {
+  return false;
+}
+#endif
+
+}  // namespace
+
+template <>
+bool PackWeight<float>(const framework::Tensor& weight) {
+  return PackWeightImpl<float>(weight);
+}
+
+template <>
+bool PackWeight<double>(const framework::Tensor& weight) {
+  return PackWeightImpl<double>(weight);
+}
+
+template <>
+bool MatMulWithPackedWeight<float>(const framework::Tensor& weight, int M,
+                                   const float* X, float* Y) {
+  return MatMulWithPackedWeightImpl<float>(weight, M, X, Y);
+}
+
+template <>
+bool MatMulWithPackedWeight<double>(const framework::Tensor& weight, int M,
+                                    const double* X, double* Y) {
+  return MatMulWithPackedWeightImpl<double>(weight, M, X, Y);
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,67 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "paddle/fluid/framework/tensor.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * The constant weights of FC and mul are packed by MKL's GEMM_PACK once,
+ * and the packed buffers are cached by the weight tensors, so all the ops
+ * and predictors sharing a weight share its packed buffer. A packed buffer
+ * is released after its weight is freed, when another weight is packed.
+ *
+ * The packing is supported for the float and double weights of 2-D in CPU
+ * with MKLML only, otherwise the functions return false and do nothing.
+ */
+
+/*
+ * @brief Pack the weight of shape [K, N] into the cache if it is not
+ * packed yet.
+ */
+template <typename T>
+inline bool PackWeight(const framework::Tensor& weight) {
+  return false;
+}
+
+/*
+ * @brief Y = X * weight, where X is [M, K] and Y is [M, N], with the packed
+ * weight, which is packed at the first call if PackWeight is not called.
+ * The weight must not be changed after it is packed.
+ */
+template <typename T>
+inline bool MatMulWithPackedWeight(const framework::Tensor& weight, int M,
+                                   const T* X, T* Y) {
+  return false;
+}
+
+template <>
+bool PackWeight<float>(const framework::Tensor& weight);
+template <>
+bool PackWeight<double>(const framework::Tensor& weight);
+
+template <>
+bool MatMulWithPackedWeight<float>(const framework::Tensor& weight, int M,
+                                   const float* X, float* Y);
+template <>
+bool MatMulWithPackedWeight<double>(const framework::Tensor& weight, int M,
+                                    const double* X, double* Y);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,76 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/math/packed_gemm.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+void TestPackedMatMul(int M, int K, int N) {
+  platform::CPUPlace place;
+  framework::Tensor weight;
+  T* w = weight.mutable_data<T>(framework::make_ddim({K, N}), place);
+  for (int i = 0; i < K * N; ++i) {
+    w[i] = static_cast<T>((i % 7) - 3) / 4;
+  }
+  std::vector<T> x(M * K);
+  for (int i = 0; i < M * K; ++i) {
+    x[i] = static_cast<T>((i % 5) - 2) / 3;
+  }
+  std::vector<T> y(M * N, 0);
+
+#ifdef PADDLE_WITH_MKLML
+  ASSERT_TRUE(PackWeight<T>(weight));
+  // The batch size can be different from call to call.
+  for (int m : {M, 1}) {
+    ASSERT_TRUE(MatMulWithPackedWeight<T>(weight, m, x.data(), y.data()));
+    for (int i = 0; i < m; ++i) {
+      for (int j = 0; j < N; ++j) {
+        T expect = 0;
+        for (int k = 0; k < K; ++k) {
+          expect += x[i * K + k] * w[k * N + j];
+        }
+        EXPECT_NEAR(y[i * N + j], expect, 1e-4 * (std::fabs(expect) + 1));
+      }
+    }
+  }
+#else
+  ASSERT_FALSE(PackWeight<T>(weight));
+  ASSERT_FALSE(MatMulWithPackedWeight<T>(weight, M, x.data(), y.data()));
+#endif
+}
+
+TEST(PackedGemm, Float) { TestPackedMatMul<float>(7, 64, 33); }
+
+TEST(PackedGemm, Double) { TestPackedMatMul<double>(3, 17, 128); }
+
+TEST(PackedGemm, NotSupported) {
+  framework::Tensor weight;
+  weight.mutable_data<float>(framework::make_ddim({2, 3, 4}),
+                             platform::CPUPlace());
+  EXPECT_FALSE(PackWeight<float>(weight));
+  framework::Tensor int_weight;
+  int_weight.mutable_data<int>(framework::make_ddim({3, 4}),
+                               platform::CPUPlace());
+  EXPECT_FALSE(PackWeight<int>(int_weight));
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
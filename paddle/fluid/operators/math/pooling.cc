@@ -14,6 +14,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/pooling.h"
 #include <algorithm>
 #include <vector>
+#include "paddle/fluid/platform/parallel_for.h"
 
 namespace paddle {
 namespace operators {
@@ -51,10 +52,19 @@ class Pool2dFunctor<platform::CPUDeviceContext, PoolProcess, T> {
     const T* input_data = input.data<T>();
     T* output_data = output->mutable_data<T>(context.GetPlace());
 
-    int hstart, hend;
-    int wstart, wend;
-    for (int i = 0; i < batch_size; i++) {
-      for (int c = 0; c < output_channels; ++c) {
+    // The planes of all the samples and channels are pooled independently.
+    const int64_t num_planes = static_cast<int64_t>(batch_size) *
+                               output_channels;
+    const int64_t grain_size = platform::ParallelForGrainSize(
+        static_cast<int64_t>(output_stride) * ksize_height * ksize_width);
+    platform::ParallelFor(0, num_planes, grain_size, [&](int64_t begin,
+                                                         int64_t end) {
+      PoolProcess process = pool_process;
+      int hstart, hend;
+      int wstart, wend;
+      for (int64_t plane = begin; plane < end; ++plane) {
+        const T* input_plane = input_data + plane * input_stride;
+        T* output_plane = output_data + plane * output_stride;
         for (int ph = 0; ph < output_height; ++ph) {
           if (adaptive) {
             hstart = AdaptStartIndex(ph, input_height, output_height);
@@ -74,23 +84,21 @@ class Pool2dFunctor<platform::CPUDeviceContext, PoolProcess, T> {
               wstart = std::max(wstart, 0);
             }
 
-            T ele = pool_process.initial();
+            T ele = process.initial();
             for (int h = hstart; h < hend; ++h) {
               for (int w = wstart; w < wend; ++w) {
-                pool_process.compute(input_data[h * input_width + w], &ele);
+                process.compute(input_plane[h * input_width + w], &ele);
               }
             }
             int pool_size = (exclusive || adaptive)
                                 ? (hend - hstart) * (wend - wstart)
                                 : ksize_height * ksize_width;
-            pool_process.finalize(static_cast<T>(pool_size), &ele);
-            output_data[ph * output_width + pw] = ele;
+            process.finalize(static_cast<T>(pool_size), &ele);
+            output_plane[ph * output_width + pw] = ele;
           }
         }
-        input_data += input_stride;
-        output_data += output_stride;
       }
-    }
+    });
   }
 };
 
@@ -128,10 +136,20 @@ class Pool2dGradFunctor<platform::CPUDeviceContext, PoolProcess, T> {
     const T* output_grad_data = output_grad.data<T>();
     T* input_grad_data = input_grad->mutable_data<T>(context.GetPlace());
 
-    int hstart, hend;
-    int wstart, wend;
-    for (int i = 0; i < batch_size; i++) {
-      for (int c = 0; c < output_channels; ++c) {
+    const int64_t num_planes = static_cast<int64_t>(batch_size) *
+                               output_channels;
+    const int64_t grain_size = platform::ParallelForGrainSize(
+        static_cast<int64_t>(output_stride) * ksize_height * ksize_width);
+    platform::ParallelFor(0, num_planes, grain_size, [&](int64_t begin,
+                                                         int64_t end) {
+      PoolProcess process = pool_grad_process;
+      int hstart, hend;
+      int wstart, wend;
+      for (int64_t plane = begin; plane < end; ++plane) {
+        const T* input_plane = input_data + plane * input_stride;
+        const T* output_plane = output_data + plane * output_stride;
+        const T* output_grad_plane = output_grad_data + plane * output_stride;
+        T* input_grad_plane = input_grad_data + plane * input_stride;
         for (int ph = 0; ph < output_height; ++ph) {
           if (adaptive) {
             hstart = AdaptStartIndex(ph, input_height, output_height);
@@ -156,22 +174,17 @@ class Pool2dGradFunctor<platform::CPUDeviceContext, PoolProcess, T> {
             float scale = 1.0 / pool_size;
             for (int h = hstart; h < hend; ++h) {
               for (int w = wstart; w < wend; ++w) {
-                pool_grad_process.compute(
-                    input_data[h * input_width + w],
-                    output_data[ph * output_width + pw],
-                    output_grad_data[ph * output_width + pw],
-                    static_cast<T>(scale),
-                    input_grad_data + h * input_width + w);
+                process.compute(input_plane[h * input_width + w],
+                                output_plane[ph * output_width + pw],
+                                output_grad_plane[ph * output_width + pw],
+                                static_cast<T>(scale),
+                                input_grad_plane + h * input_width + w);
               }
             }
           }
         }
-        input_data += input_stride;
-        output_data += output_stride;
-        input_grad_data += input_stride;
-        output_grad_data += output_stride;
       }
-    }
+    });
   }
 };
 
@@ -73,7 +73,8 @@ class BatchNormMKLDNNHandler : public platform::MKLDNNHandler {
     // BatchNorm PD has to be passed to Grad op that
     // may be executed by diffrent thread, hence
     // for that one we use key that does not contain TID
-    const std::string key_batch_norm_fwd_pd = key_common_ + "@bn_fwd_pd";
+    const platform::BlobKey key_batch_norm_fwd_pd =
+        platform::AppendBlobKey(key_common_, "@bn_fwd_pd");
     batch_norm_pd_ = std::static_pointer_cast<batch_norm_fwd::primitive_desc>(
         dev_ctx_.GetBlob(key_batch_norm_fwd_pd));
 
@@ -97,9 +98,10 @@ class BatchNormMKLDNNHandler : public platform::MKLDNNHandler {
       std::shared_ptr<memory> scaleshift_memory,
       std::shared_ptr<memory> dst_memory, std::shared_ptr<memory> mean_memory,
       std::shared_ptr<memory> variance_memory, bool is_test) {
-    auto prim_key = key_ + "@batch_norm_p";
+    const platform::BlobKey prim_key =
+        platform::AppendBlobKey(key_, "@batch_norm_p");
     auto batch_norm_p =
-        std::static_pointer_cast<batch_norm_fwd>(dev_ctx_.GetBlob(prim_key));
+        std::static_pointer_cast<batch_norm_fwd>(GetLocalBlob(prim_key));
 
     if (batch_norm_p == nullptr) {
       if (is_test) {
@@ -114,7 +116,7 @@ class BatchNormMKLDNNHandler : public platform::MKLDNNHandler {
             *mean_memory, *variance_memory);
       }
 
-      dev_ctx_.SetBlob(prim_key, batch_norm_p);
+      SetLocalBlob(prim_key, batch_norm_p);
     }
 
     return batch_norm_p;
@@ -165,6 +165,11 @@ class MulOpMaker : public framework::OpProtoAndCheckerMaker {
         "(bool, default false) Force quantize kernel output FP32, only "
         "used in quantized MKL-DNN.")
         .SetDefault(false);
+    AddAttr<bool>("use_packed_weight",
+                  "(bool, default false) Whether to run with $Y$ packed by "
+                  "MKL, which should be constant. Only used in CPU kernel, it "
+                  "is set by gemm_weight_pack_pass.")
+        .SetDefault(false);
     AddComment(R"DOC(
 Mul Operator.
 
@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
 
 namespace paddle {
 namespace operators {
@@ -50,9 +51,15 @@ class MulKernel : public framework::OpKernel<T> {
       z->Resize({x_matrix.dims()[0], y_matrix.dims()[1]});
     }
 
-    auto blas = math::GetBlas<DeviceContext, T>(context);
-
-    blas.MatMul(x_matrix, y_matrix, z);
+    bool packed = platform::is_cpu_place(context.GetPlace()) &&
+                  context.Attr<bool>("use_packed_weight") &&
+                  math::MatMulWithPackedWeight<T>(
+                      y_matrix, x_matrix.dims()[0], x_matrix.data<T>(),
+                      z->data<T>());
+    if (!packed) {
+      auto blas = math::GetBlas<DeviceContext, T>(context);
+      blas.MatMul(x_matrix, y_matrix, z);
+    }
     if (z_dim.size() != 2) {
       z->Resize(z_dim);
     }
@@ -0,0 +1,164 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/fused_sparse_adam_op.h"
+
+namespace paddle {
+namespace operators {
+
+void FusedSparseAdamOp::InferShape(framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInputs("Param"),
+                 "Inputs(Param) of FusedSparseAdamOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInputs("Grad"),
+                 "Inputs(Grad) of FusedSparseAdamOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInputs("Moment1"),
+                 "Inputs(Moment1) of FusedSparseAdamOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInputs("Moment2"),
+                 "Inputs(Moment2) of FusedSparseAdamOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasInputs("LearningRate"),
+      "Inputs(LearningRate) of FusedSparseAdamOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInputs("Beta1Pow"),
+                 "Inputs(Beta1Pow) of FusedSparseAdamOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInputs("Beta2Pow"),
+                 "Inputs(Beta2Pow) of FusedSparseAdamOp should not be null.");
+
+  PADDLE_ENFORCE(ctx->HasOutputs("ParamOut"),
+                 "Outputs(ParamOut) of FusedSparseAdamOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasOutputs("Moment1Out"),
+      "Outputs(Moment1Out) of FusedSparseAdamOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasOutputs("Moment2Out"),
+      "Outputs(Moment2Out) of FusedSparseAdamOp should not be null.");
+
+  auto param_dims = ctx->GetInputsDim("Param");
+  size_t param_num = param_dims.size();
+  PADDLE_ENFORCE_EQ(ctx->Inputs("Grad").size(), param_num,
+                    "The number of Grad and Param should be equal.");
+  for (auto type : ctx->GetInputsVarType("Grad")) {
+    PADDLE_ENFORCE_EQ(type, framework::proto::VarType::SELECTED_ROWS,
+                      "Grad of FusedSparseAdamOp should be SelectedRows.");
+  }
+
+  auto mom1_dims = ctx->GetInputsDim("Moment1");
+  auto mom2_dims = ctx->GetInputsDim("Moment2");
+  auto lr_dims = ctx->GetInputsDim("LearningRate");
+  auto beta1_pow_dims = ctx->GetInputsDim("Beta1Pow");
+  auto beta2_pow_dims = ctx->GetInputsDim("Beta2Pow");
+  PADDLE_ENFORCE_EQ(mom1_dims.size(), param_num);
+  PADDLE_ENFORCE_EQ(mom2_dims.size(), param_num);
+  PADDLE_ENFORCE_EQ(lr_dims.size(), param_num);
+  PADDLE_ENFORCE_EQ(beta1_pow_dims.size(), param_num);
+  PADDLE_ENFORCE_EQ(beta2_pow_dims.size(), param_num);
+  for (size_t i = 0; i < param_num; ++i) {
+    PADDLE_ENFORCE_NE(framework::product(lr_dims[i]), 0,
+                      "Maybe the Input variable LearningRate has not "
+                      "been initialized. You may need to confirm "
+                      "if you put exe.run(startup_program) "
+                      "after optimizer.minimize function.");
+    PADDLE_ENFORCE_EQ(framework::product(lr_dims[i]), 1,
+                      "Learning rate should have 1 dimension");
+    PADDLE_ENFORCE_EQ(framework::product(beta1_pow_dims[i]), 1,
+                      "Beta1 power accumulator should have 1 dimension");
+    PADDLE_ENFORCE_EQ(framework::product(beta2_pow_dims[i]), 1,
+                      "Beta2 power accumulator should have 1 dimension");
+    PADDLE_ENFORCE_EQ(
+        param_dims[i], mom1_dims[i],
+        "Param and Moment1 input of FusedSparseAdamOp should have same "
+        "dimension");
+    PADDLE_ENFORCE_EQ(
+        param_dims[i], mom2_dims[i],
+        "Param and Moment2 input of FusedSparseAdamOp should have same "
+        "dimension");
+  }
+
+  ctx->SetOutputsDim("ParamOut", param_dims);
+  ctx->SetOutputsDim("Moment1Out", param_dims);
+  ctx->SetOutputsDim("Moment2Out", param_dims);
+}
+
+framework::OpKernelType FusedSparseAdamOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  auto input_data_type =
+      ctx.MultiInput<framework::LoDTensor>("Param").front()->type();
+  return framework::OpKernelType(input_data_type, ctx.GetPlace());
+}
+
+class FusedSparseAdamOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(vector<Tensor>) Input parameters").AsDuplicable();
+    AddInput("Grad", "(vector<SelectedRows>) Input gradients").AsDuplicable();
+    AddInput("LearningRate", "(vector<Tensor>) Learning rates")
+        .AsDuplicable();
+    AddInput("Moment1", "(vector<Tensor>) Input first moments").AsDuplicable();
+    AddInput("Moment2", "(vector<Tensor>) Input second moments")
+        .AsDuplicable();
+    AddInput("Beta1Pow", "(vector<Tensor>) Input beta1 power accumulators")
+        .AsDuplicable();
+    AddInput("Beta2Pow", "(vector<Tensor>) Input beta2 power accumulators")
+        .AsDuplicable();
+
+    AddOutput("ParamOut", "(vector<Tensor>) Output parameters").AsDuplicable();
+    AddOutput("Moment1Out", "(vector<Tensor>) Output first moments")
+        .AsDuplicable();
+    AddOutput("Moment2Out", "(vector<Tensor>) Output second moments")
+        .AsDuplicable();
+
+    AddAttr<float>("beta1",
+                   "(float, default 0.9) "
+                   "Exponential decay rate for the "
+                   "first moment estimates.")
+        .SetDefault(0.9f);
+    AddAttr<float>("beta2",
+                   "(float, default 0.999) "
+                   "exponential decay rate for the "
+                   "second moment estimates.")
+        .SetDefault(0.999f);
+    AddAttr<float>("epsilon",
+                   "(float, default 1.0e-8) "
+                   "Constant for numerical stability")
+        .SetDefault(1.0e-8f);
+    AddAttr<bool>(
+        "lazy_mode",
+        "(bool, default false) "
+        "only update the parameter that has gradient in sparse update")
+        .SetDefault(false);
+
+    AddComment(R"DOC(
+Fused Sparse Adam Optimizer.
+
+Updates the parameters with SelectedRows gradients by Adam in one operator,
+it is inserted by fuse_sparse_adam_op_pass in place of the adam operators of
+the sparse parameters, e.g. the embedding tables.
+
+The duplicated rows of every gradient are merged by a hash map, and then the
+rows of all the parameters are updated by FLAGS_inner_op_parallelism threads.
+The update of every parameter is the same as adam.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(fused_sparse_adam, ops::FusedSparseAdamOp,
+                             ops::FusedSparseAdamOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fused_sparse_adam,
+    ops::FusedSparseAdamOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FusedSparseAdamOpKernel<paddle::platform::CPUDeviceContext, double>);
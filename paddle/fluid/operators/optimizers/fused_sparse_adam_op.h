@@ -0,0 +1,135 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <math.h>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/optimizers/fused_sparse_optimizer.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedSparseAdamOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override;
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override;
+};
+
+// Updates a group of parameters with SelectedRows gradients by Adam in one
+// kernel. The duplicated rows of every gradient are merged by HashMergeGrad,
+// then the rows of all the parameters are cut into segments which are
+// updated by FLAGS_inner_op_parallelism threads.
+template <typename DeviceContext, typename T>
+class FusedSparseAdamOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    using framework::LoDTensor;
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "fused_sparse_adam only supports CPUPlace.");
+
+    bool lazy_mode = ctx.Attr<bool>("lazy_mode");
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+
+    auto params = ctx.MultiInput<LoDTensor>("Param");
+    auto mom1s = ctx.MultiInput<LoDTensor>("Moment1");
+    auto mom2s = ctx.MultiInput<LoDTensor>("Moment2");
+    auto lrs = ctx.MultiInput<LoDTensor>("LearningRate");
+    auto beta1_pows = ctx.MultiInput<LoDTensor>("Beta1Pow");
+    auto beta2_pows = ctx.MultiInput<LoDTensor>("Beta2Pow");
+    auto param_outs = ctx.MultiOutput<LoDTensor>("ParamOut");
+    auto mom1_outs = ctx.MultiOutput<LoDTensor>("Moment1Out");
+    auto mom2_outs = ctx.MultiOutput<LoDTensor>("Moment2Out");
+
+    size_t param_num = params.size();
+    std::vector<const framework::SelectedRows*> grads;
+    std::vector<size_t> param_ids = GetSparseGrads(ctx, params, &grads);
+
+    int thread_num = FLAGS_inner_op_parallelism;
+    std::vector<HashMergedGrad<T>> merged_grads(param_num);
+    RunTasksInParallel(param_ids.size(), thread_num, [&](size_t task) {
+      size_t i = param_ids[task];
+      HashMergeGrad<T>(*grads[i], params[i]->dims()[0], !lazy_mode,
+                       &merged_grads[i]);
+    });
+
+    // Only the merged rows are updated in lazy mode, otherwise all the rows
+    // of the parameters are updated.
+    std::vector<SparseUpdateSegment> segments;
+    for (auto i : param_ids) {
+      int64_t row_num = lazy_mode
+                            ? static_cast<int64_t>(merged_grads[i].rows_.size())
+                            : params[i]->dims()[0];
+      AppendSparseUpdateSegments(i, row_num, merged_grads[i].row_numel_,
+                                 &segments);
+    }
+    VLOG(3) << "fused_sparse_adam updates " << param_ids.size()
+            << " params in " << segments.size()
+            << " segments, lazy_mode=" << lazy_mode;
+
+    // lr is the same for all the rows of a parameter.
+    std::vector<T> lr_t(param_num);
+    for (auto i : param_ids) {
+      T beta1_pow = *beta1_pows[i]->data<T>();
+      T beta2_pow = *beta2_pows[i]->data<T>();
+      lr_t[i] = *lrs[i]->data<T>() * (sqrt(1 - beta2_pow) / (1 - beta1_pow));
+      param_outs[i]->mutable_data<T>(ctx.GetPlace());
+      mom1_outs[i]->mutable_data<T>(ctx.GetPlace());
+      mom2_outs[i]->mutable_data<T>(ctx.GetPlace());
+    }
+
+    RunTasksInParallel(segments.size(), thread_num, [&](size_t task) {
+      const SparseUpdateSegment& seg = segments[task];
+      size_t i = seg.param_idx;
+      const HashMergedGrad<T>& grad = merged_grads[i];
+      int64_t row_numel = grad.row_numel_;
+      const T* param = params[i]->data<T>();
+      const T* mom1 = mom1s[i]->data<T>();
+      const T* mom2 = mom2s[i]->data<T>();
+      T* param_out = param_outs[i]->data<T>();
+      T* mom1_out = mom1_outs[i]->data<T>();
+      T* mom2_out = mom2_outs[i]->data<T>();
+      T lr = lr_t[i];
+
+      for (int64_t r = seg.begin; r < seg.end; ++r) {
+        int64_t param_row = r;
+        const T* g = nullptr;
+        if (lazy_mode) {
+          param_row = grad.rows_[r];
+          g = grad.value_ + r * row_numel;
+        } else if (grad.param_row_index_[r] >= 0) {
+          g = grad.value_ + grad.param_row_index_[r] * row_numel;
+        }
+        int64_t offset = param_row * row_numel;
+        for (int64_t k = 0; k < row_numel; ++k) {
+          T gk = g == nullptr ? static_cast<T>(0) : g[k];
+          T m1 = beta1 * mom1[offset + k] + (1 - beta1) * gk;
+          T m2 = beta2 * mom2[offset + k] + (1 - beta2) * gk * gk;
+          mom1_out[offset + k] = m1;
+          mom2_out[offset + k] = m2;
+          param_out[offset + k] =
+              param[offset + k] - lr * (m1 / (sqrt(m2) + epsilon));
+        }
+      }
+    });
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
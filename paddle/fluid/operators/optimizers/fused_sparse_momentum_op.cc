@@ -0,0 +1,123 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/fused_sparse_momentum_op.h"
+
+namespace paddle {
+namespace operators {
+
+void FusedSparseMomentumOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInputs("Param"),
+                 "Inputs(Param) of FusedSparseMomentumOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInputs("Grad"),
+                 "Inputs(Grad) of FusedSparseMomentumOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasInputs("Velocity"),
+      "Inputs(Velocity) of FusedSparseMomentumOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasInputs("LearningRate"),
+      "Inputs(LearningRate) of FusedSparseMomentumOp should not be null.");
+
+  PADDLE_ENFORCE(
+      ctx->HasOutputs("ParamOut"),
+      "Outputs(ParamOut) of FusedSparseMomentumOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasOutputs("VelocityOut"),
+      "Outputs(VelocityOut) of FusedSparseMomentumOp should not be null.");
+
+  auto param_dims = ctx->GetInputsDim("Param");
+  size_t param_num = param_dims.size();
+  PADDLE_ENFORCE_EQ(ctx->Inputs("Grad").size(), param_num,
+                    "The number of Grad and Param should be equal.");
+  for (auto type : ctx->GetInputsVarType("Grad")) {
+    PADDLE_ENFORCE_EQ(type, framework::proto::VarType::SELECTED_ROWS,
+                      "Grad of FusedSparseMomentumOp should be SelectedRows.");
+  }
+
+  auto velocity_dims = ctx->GetInputsDim("Velocity");
+  auto lr_dims = ctx->GetInputsDim("LearningRate");
+  PADDLE_ENFORCE_EQ(velocity_dims.size(), param_num);
+  PADDLE_ENFORCE_EQ(lr_dims.size(), param_num);
+  for (size_t i = 0; i < param_num; ++i) {
+    PADDLE_ENFORCE_NE(framework::product(lr_dims[i]), 0,
+                      "Maybe the Input variable LearningRate has not "
+                      "been initialized. You may need to confirm "
+                      "if you put exe.run(startup_program) "
+                      "after optimizer.minimize function.");
+    PADDLE_ENFORCE_EQ(framework::product(lr_dims[i]), 1,
+                      "Learning_rate should be a scalar");
+    PADDLE_ENFORCE_EQ(
+        param_dims[i], velocity_dims[i],
+        "Param and Velocity of FusedSparseMomentumOp should have the same "
+        "dimension.");
+  }
+
+  ctx->SetOutputsDim("ParamOut", param_dims);
+  ctx->SetOutputsDim("VelocityOut", param_dims);
+}
+
+framework::OpKernelType FusedSparseMomentumOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  auto input_data_type =
+      ctx.MultiInput<framework::LoDTensor>("Param").front()->type();
+  return framework::OpKernelType(input_data_type, ctx.GetPlace());
+}
+
+class FusedSparseMomentumOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(vector<Tensor>) Input parameters").AsDuplicable();
+    AddInput("Grad", "(vector<SelectedRows>) Input gradients").AsDuplicable();
+    AddInput("Velocity", "(vector<Tensor>) Input velocities").AsDuplicable();
+    AddInput("LearningRate", "(vector<Tensor>) Learning rates")
+        .AsDuplicable();
+
+    AddOutput("ParamOut", "(vector<Tensor>) Output parameters").AsDuplicable();
+    AddOutput("VelocityOut", "(vector<Tensor>) Output velocities")
+        .AsDuplicable();
+
+    AddAttr<float>("mu", "(float) Momentum coefficient");
+    AddAttr<bool>("use_nesterov",
+                  "(bool, default false) "
+                  "Use Nesterov Momentum")
+        .SetDefault(false);
+
+    AddComment(R"DOC(
+Fused Sparse Momentum Optimizer.
+
+Updates the parameters with SelectedRows gradients by Momentum in one
+operator, it is inserted by fuse_sparse_momentum_op_pass in place of the
+momentum operators of the sparse parameters, e.g. the embedding tables.
+
+The duplicated rows of every gradient are merged by a hash map, and then the
+rows of all the parameters are updated by FLAGS_inner_op_parallelism threads.
+The update of every parameter is the same as momentum.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(fused_sparse_momentum, ops::FusedSparseMomentumOp,
+                             ops::FusedSparseMomentumOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fused_sparse_momentum,
+    ops::FusedSparseMomentumOpKernel<paddle::platform::CPUDeviceContext,
+                                     float>,
+    ops::FusedSparseMomentumOpKernel<paddle::platform::CPUDeviceContext,
+                                     double>);
@@ -0,0 +1,107 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/optimizers/fused_sparse_optimizer.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedSparseMomentumOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override;
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override;
+};
+
+// Updates a group of parameters with SelectedRows gradients by Momentum in
+// one kernel. As momentum does, the velocity of every row decays even if the
+// row has no gradient, so all the rows of the parameters are updated. They
+// are cut into segments which are updated by FLAGS_inner_op_parallelism
+// threads.
+template <typename DeviceContext, typename T>
+class FusedSparseMomentumOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    using framework::LoDTensor;
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "fused_sparse_momentum only supports CPUPlace.");
+
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    bool use_nesterov = ctx.Attr<bool>("use_nesterov");
+
+    auto params = ctx.MultiInput<LoDTensor>("Param");
+    auto velocities = ctx.MultiInput<LoDTensor>("Velocity");
+    auto lrs = ctx.MultiInput<LoDTensor>("LearningRate");
+    auto param_outs = ctx.MultiOutput<LoDTensor>("ParamOut");
+    auto velocity_outs = ctx.MultiOutput<LoDTensor>("VelocityOut");
+
+    size_t param_num = params.size();
+    std::vector<const framework::SelectedRows*> grads;
+    std::vector<size_t> param_ids = GetSparseGrads(ctx, params, &grads);
+
+    int thread_num = FLAGS_inner_op_parallelism;
+    std::vector<HashMergedGrad<T>> merged_grads(param_num);
+    RunTasksInParallel(param_ids.size(), thread_num, [&](size_t task) {
+      size_t i = param_ids[task];
+      HashMergeGrad<T>(*grads[i], params[i]->dims()[0], true,
+                       &merged_grads[i]);
+    });
+
+    std::vector<SparseUpdateSegment> segments;
+    for (auto i : param_ids) {
+      AppendSparseUpdateSegments(i, params[i]->dims()[0],
+                                 merged_grads[i].row_numel_, &segments);
+      param_outs[i]->mutable_data<T>(ctx.GetPlace());
+      velocity_outs[i]->mutable_data<T>(ctx.GetPlace());
+    }
+    VLOG(3) << "fused_sparse_momentum updates " << param_ids.size()
+            << " params in " << segments.size()
+            << " segments, use_nesterov=" << use_nesterov;
+
+    RunTasksInParallel(segments.size(), thread_num, [&](size_t task) {
+      const SparseUpdateSegment& seg = segments[task];
+      size_t i = seg.param_idx;
+      const HashMergedGrad<T>& grad = merged_grads[i];
+      int64_t row_numel = grad.row_numel_;
+      const T* param = params[i]->data<T>();
+      const T* velocity = velocities[i]->data<T>();
+      T* param_out = param_outs[i]->data<T>();
+      T* velocity_out = velocity_outs[i]->data<T>();
+      T lr = *lrs[i]->data<T>();
+
+      for (int64_t r = seg.begin; r < seg.end; ++r) {
+        const T* g = grad.param_row_index_[r] >= 0
+                         ? grad.value_ + grad.param_row_index_[r] * row_numel
+                         : nullptr;
+        int64_t offset = r * row_numel;
+        for (int64_t k = 0; k < row_numel; ++k) {
+          T gk = g == nullptr ? static_cast<T>(0) : g[k];
+          T v = velocity[offset + k] * mu + gk;
+          velocity_out[offset + k] = v;
+          param_out[offset + k] = use_nesterov
+                                      ? param[offset + k] - (gk + v * mu) * lr
+                                      : param[offset + k] - v * lr;
+        }
+      }
+    });
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,183 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <future>  // NOLINT
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/threadpool.h"
+
+// The helpers shared by the fused optimizers of SelectedRows gradients, e.g.
+// fused_sparse_adam, fused_sparse_momentum and fused_sparse_sgd.
+
+namespace paddle {
+namespace operators {
+
+// The gradient of one parameter whose duplicated rows are merged.
+template <typename T>
+struct HashMergedGrad {
+  std::vector<int64_t> rows_;
+  // Points to the value of the gradient if it has no duplicated rows,
+  // otherwise to merged_value_.
+  const T* value_;
+  std::vector<T> merged_value_;
+  int64_t row_numel_;
+  // The index in rows_ of every row of the parameter, -1 if the row has no
+  // gradient. Only built when all the rows of the parameter are updated.
+  std::vector<int64_t> param_row_index_;
+};
+
+// Merges the duplicated rows of grad by a hash map in the order they first
+// appear, which avoids sorting the rows as scatter::MergeAdd does.
+template <typename T>
+void HashMergeGrad(const framework::SelectedRows& grad, int64_t param_height,
+                   bool build_param_row_index, HashMergedGrad<T>* merged) {
+  const auto& rows = grad.rows();
+  const T* value = grad.value().data<T>();
+  size_t row_num = rows.size();
+  merged->row_numel_ = grad.value().numel() / row_num;
+
+  std::unordered_map<int64_t, int64_t> row_to_index;
+  row_to_index.reserve(row_num);
+  std::vector<int64_t> index(row_num);
+  merged->rows_.clear();
+  merged->rows_.reserve(row_num);
+  for (size_t i = 0; i < row_num; ++i) {
+    auto iter = row_to_index.emplace(
+        rows[i], static_cast<int64_t>(merged->rows_.size()));
+    if (iter.second) {
+      merged->rows_.push_back(rows[i]);
+    }
+    index[i] = iter.first->second;
+  }
+
+  int64_t row_numel = merged->row_numel_;
+  if (merged->rows_.size() == row_num) {
+    merged->value_ = value;
+    merged->merged_value_.clear();
+  } else {
+    merged->merged_value_.assign(merged->rows_.size() * row_numel, 0);
+    T* out = merged->merged_value_.data();
+    for (size_t i = 0; i < row_num; ++i) {
+      T* dst = out + index[i] * row_numel;
+      const T* src = value + i * row_numel;
+      for (int64_t k = 0; k < row_numel; ++k) {
+        dst[k] += src[k];
+      }
+    }
+    merged->value_ = out;
+  }
+
+  if (build_param_row_index) {
+    merged->param_row_index_.assign(param_height, -1);
+    for (size_t i = 0; i < merged->rows_.size(); ++i) {
+      merged->param_row_index_[merged->rows_[i]] = i;
+    }
+  }
+}
+
+// Runs fn(0), ..., fn(task_num - 1) on thread_num threads of framework::Async,
+// every thread takes the next task when it finishes one.
+template <typename Callback>
+void RunTasksInParallel(size_t task_num, int thread_num, Callback fn) {
+#ifndef _WIN32
+  if (thread_num > 1 && task_num > 1) {
+    std::atomic<size_t> next_task(0);
+    std::vector<std::future<void>> fs;
+    for (int i = 0; i < thread_num && static_cast<size_t>(i) < task_num; ++i) {
+      fs.push_back(framework::Async([&next_task, task_num, &fn] {
+        for (size_t task = next_task++; task < task_num; task = next_task++) {
+          fn(task);
+        }
+      }));
+    }
+    for (auto& f : fs) {
+      f.wait();
+    }
+    return;
+  }
+#endif
+  for (size_t task = 0; task < task_num; ++task) {
+    fn(task);
+  }
+}
+
+// Gets the SelectedRows gradients of the "Grad" inputs, and returns the
+// indexes of the parameters whose gradients are not empty. The parameters
+// with empty gradients are skipped as the unfused optimizers do.
+inline std::vector<size_t> GetSparseGrads(
+    const framework::ExecutionContext& ctx,
+    const std::vector<const framework::LoDTensor*>& params,
+    std::vector<const framework::SelectedRows*>* grads) {
+  auto grad_vars = ctx.MultiInputVar("Grad");
+  size_t param_num = params.size();
+  PADDLE_ENFORCE_EQ(grad_vars.size(), param_num);
+
+  std::vector<size_t> param_ids;
+  grads->assign(param_num, nullptr);
+  for (size_t i = 0; i < param_num; ++i) {
+    PADDLE_ENFORCE(grad_vars[i]->IsType<framework::SelectedRows>(),
+                   "The Var(%s)'s type should be SelectedRows, "
+                   "but the received is %s",
+                   ctx.Inputs("Grad")[i],
+                   framework::ToTypeName(grad_vars[i]->Type()));
+    auto* grad = &grad_vars[i]->Get<framework::SelectedRows>();
+    (*grads)[i] = grad;
+    if (grad->rows().size() == 0) {
+      VLOG(3) << "grad row size of " << ctx.Inputs("Param")[i] << " is 0";
+      continue;
+    }
+    int64_t height = params[i]->dims()[0];
+    for (auto row : grad->rows()) {
+      PADDLE_ENFORCE(row >= 0 && row < height,
+                     "The row %d of Grad(%s) is out of range [0, %d).", row,
+                     ctx.Inputs("Grad")[i], height);
+    }
+    PADDLE_ENFORCE_EQ(grad->value().numel() / grad->rows().size() * height,
+                      params[i]->numel(),
+                      "The row numel of Grad(%s) does not match Param(%s).",
+                      ctx.Inputs("Grad")[i], ctx.Inputs("Param")[i]);
+    param_ids.push_back(i);
+  }
+  return param_ids;
+}
+
+// A range of rows of one parameter, which is updated by one task.
+struct SparseUpdateSegment {
+  // The number of elements updated by one task.
+  static constexpr int64_t kSegmentNumel = 1 << 16;
+
+  size_t param_idx;
+  int64_t begin;
+  int64_t end;
+};
+
+// Cuts the rows [0, row_num) of the param_idx-th parameter into segments.
+inline void AppendSparseUpdateSegments(
+    size_t param_idx, int64_t row_num, int64_t row_numel,
+    std::vector<SparseUpdateSegment>* segments) {
+  int64_t rows_per_segment =
+      std::max<int64_t>(SparseUpdateSegment::kSegmentNumel / row_numel, 1);
+  for (int64_t begin = 0; begin < row_num; begin += rows_per_segment) {
+    segments->push_back(
+        {param_idx, begin, std::min(begin + rows_per_segment, row_num)});
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,369 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>  // NOLINT
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/place.h"
+
+USE_OP(adam);
+USE_OP(momentum);
+USE_OP(sgd);
+USE_OP(fused_sparse_adam);
+USE_OP(fused_sparse_momentum);
+USE_OP(fused_sparse_sgd);
+
+DEFINE_int32(fused_sparse_adam_benchmark_tables, 32,
+             "The number of embedding tables in the benchmark.");
+DEFINE_int32(fused_sparse_adam_benchmark_height, 100000,
+             "The height of every embedding table in the benchmark.");
+DEFINE_int32(fused_sparse_adam_benchmark_rows, 4096,
+             "The rows of the gradient of every table in the benchmark.");
+DEFINE_int32(fused_sparse_adam_benchmark_repeat, 10,
+             "The times the benchmark runs the optimizers.");
+
+namespace paddle {
+namespace operators {
+
+namespace f = paddle::framework;
+
+static void RandomTensor(f::LoDTensor* tensor, const f::DDim& dims, float min,
+                         float max, std::mt19937* engine) {
+  std::uniform_real_distribution<float> dist(min, max);
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = dist(*engine);
+  }
+}
+
+static void FillScalar(f::LoDTensor* tensor, float value) {
+  tensor->Resize({1});
+  *tensor->mutable_data<float>(platform::CPUPlace()) = value;
+}
+
+// Creates the tables in scope, the vars of the optimizer of table i are named
+// "<name>_i", and the param and moments are created with the prefix
+// "unfused_" and "fused_" by the same values. mom1 is the velocity of
+// momentum.
+static void CreateTables(f::Scope* scope, int table_num, int64_t height,
+                         int64_t width, int64_t grad_rows) {
+  std::mt19937 engine(table_num);
+  std::uniform_int_distribution<int64_t> row_dist(0, height - 1);
+  for (int i = 0; i < table_num; ++i) {
+    auto id = std::to_string(i);
+    f::LoDTensor param, mom1, mom2;
+    RandomTensor(&param, {height, width}, -1.0f, 1.0f, &engine);
+    RandomTensor(&mom1, {height, width}, -0.1f, 0.1f, &engine);
+    RandomTensor(&mom2, {height, width}, 0.0f, 0.1f, &engine);
+    for (auto prefix : {"unfused_", "fused_"}) {
+      f::TensorCopySync(param, platform::CPUPlace(),
+                        scope->Var(prefix + ("param_" + id))
+                            ->GetMutable<f::LoDTensor>());
+      f::TensorCopySync(mom1, platform::CPUPlace(),
+                        scope->Var(prefix + ("mom1_" + id))
+                            ->GetMutable<f::LoDTensor>());
+      f::TensorCopySync(mom2, platform::CPUPlace(),
+                        scope->Var(prefix + ("mom2_" + id))
+                            ->GetMutable<f::LoDTensor>());
+    }
+
+    // The rows are unsorted and have duplicated ones.
+    auto* grad = scope->Var("grad_" + id)->GetMutable<f::SelectedRows>();
+    grad->set_height(height);
+    std::vector<int64_t> rows(grad_rows);
+    for (auto& row : rows) {
+      row = row_dist(engine);
+    }
+    grad->set_rows(rows);
+    RandomTensor(grad->mutable_value(), {grad_rows, width}, -1.0f, 1.0f,
+                 &engine);
+
+    FillScalar(scope->Var("lr_" + id)->GetMutable<f::LoDTensor>(), 0.001f);
+    FillScalar(scope->Var("beta1_pow_" + id)->GetMutable<f::LoDTensor>(),
+               0.9f * 0.9f);
+    FillScalar(scope->Var("beta2_pow_" + id)->GetMutable<f::LoDTensor>(),
+               0.999f * 0.999f);
+  }
+}
+
+static f::AttributeMap AdamAttrs(bool lazy_mode) {
+  f::AttributeMap attrs;
+  attrs["beta1"] = 0.9f;
+  attrs["beta2"] = 0.999f;
+  attrs["epsilon"] = 1.0e-8f;
+  attrs["lazy_mode"] = lazy_mode;
+  return attrs;
+}
+
+static std::vector<std::unique_ptr<f::OperatorBase>> CreateAdamOps(
+    int table_num, bool lazy_mode) {
+  std::vector<std::unique_ptr<f::OperatorBase>> ops;
+  for (int i = 0; i < table_num; ++i) {
+    auto id = std::to_string(i);
+    ops.emplace_back(f::OpRegistry::CreateOp(
+        "adam",
+        {{"Param", {"unfused_param_" + id}},
+         {"Grad", {"grad_" + id}},
+         {"Moment1", {"unfused_mom1_" + id}},
+         {"Moment2", {"unfused_mom2_" + id}},
+         {"LearningRate", {"lr_" + id}},
+         {"Beta1Pow", {"beta1_pow_" + id}},
+         {"Beta2Pow", {"beta2_pow_" + id}}},
+        {{"ParamOut", {"unfused_param_" + id}},
+         {"Moment1Out", {"unfused_mom1_" + id}},
+         {"Moment2Out", {"unfused_mom2_" + id}}},
+        AdamAttrs(lazy_mode)));
+  }
+  return ops;
+}
+
+static std::unique_ptr<f::OperatorBase> CreateFusedOp(int table_num,
+                                                      bool lazy_mode) {
+  std::vector<std::string> params, grads, mom1s, mom2s, lrs, beta1_pows,
+      beta2_pows;
+  for (int i = 0; i < table_num; ++i) {
+    auto id = std::to_string(i);
+    params.push_back("fused_param_" + id);
+    grads.push_back("grad_" + id);
+    mom1s.push_back("fused_mom1_" + id);
+    mom2s.push_back("fused_mom2_" + id);
+    lrs.push_back("lr_" + id);
+    beta1_pows.push_back("beta1_pow_" + id);
+    beta2_pows.push_back("beta2_pow_" + id);
+  }
+  return f::OpRegistry::CreateOp(
+      "fused_sparse_adam",
+      {{"Param", params},
+       {"Grad", grads},
+       {"Moment1", mom1s},
+       {"Moment2", mom2s},
+       {"LearningRate", lrs},
+       {"Beta1Pow", beta1_pows},
+       {"Beta2Pow", beta2_pows}},
+      {{"ParamOut", params}, {"Moment1Out", mom1s}, {"Moment2Out", mom2s}},
+      AdamAttrs(lazy_mode));
+}
+
+static void ExpectTablesNear(const f::Scope& scope, int table_num) {
+  for (int i = 0; i < table_num; ++i) {
+    auto id = std::to_string(i);
+    for (auto name : {"param_", "mom1_", "mom2_"}) {
+      auto& expected =
+          scope.FindVar("unfused_" + (name + id))->Get<f::LoDTensor>();
+      auto& actual = scope.FindVar("fused_" + (name + id))->Get<f::LoDTensor>();
+      ASSERT_EQ(expected.dims(), actual.dims());
+      const float* expected_data = expected.data<float>();
+      const float* actual_data = actual.data<float>();
+      for (int64_t j = 0; j < expected.numel(); ++j) {
+        ASSERT_NEAR(expected_data[j], actual_data[j], 1e-5)
+            << name << id << "[" << j << "]";
+      }
+    }
+  }
+}
+
+static std::vector<std::unique_ptr<f::OperatorBase>> CreateMomentumOps(
+    int table_num, const f::AttributeMap& attrs) {
+  std::vector<std::unique_ptr<f::OperatorBase>> ops;
+  for (int i = 0; i < table_num; ++i) {
+    auto id = std::to_string(i);
+    ops.emplace_back(f::OpRegistry::CreateOp(
+        "momentum",
+        {{"Param", {"unfused_param_" + id}},
+         {"Grad", {"grad_" + id}},
+         {"Velocity", {"unfused_mom1_" + id}},
+         {"LearningRate", {"lr_" + id}}},
+        {{"ParamOut", {"unfused_param_" + id}},
+         {"VelocityOut", {"unfused_mom1_" + id}}},
+        attrs));
+  }
+  return ops;
+}
+
+static std::unique_ptr<f::OperatorBase> CreateFusedMomentumOp(
+    int table_num, const f::AttributeMap& attrs) {
+  std::vector<std::string> params, grads, velocities, lrs;
+  for (int i = 0; i < table_num; ++i) {
+    auto id = std::to_string(i);
+    params.push_back("fused_param_" + id);
+    grads.push_back("grad_" + id);
+    velocities.push_back("fused_mom1_" + id);
+    lrs.push_back("lr_" + id);
+  }
+  return f::OpRegistry::CreateOp(
+      "fused_sparse_momentum",
+      {{"Param", params},
+       {"Grad", grads},
+       {"Velocity", velocities},
+       {"LearningRate", lrs}},
+      {{"ParamOut", params}, {"VelocityOut", velocities}}, attrs);
+}
+
+static std::vector<std::unique_ptr<f::OperatorBase>> CreateSGDOps(
+    int table_num) {
+  std::vector<std::unique_ptr<f::OperatorBase>> ops;
+  for (int i = 0; i < table_num; ++i) {
+    auto id = std::to_string(i);
+    ops.emplace_back(f::OpRegistry::CreateOp(
+        "sgd",
+        {{"Param", {"unfused_param_" + id}},
+         {"Grad", {"grad_" + id}},
+         {"LearningRate", {"lr_" + id}}},
+        {{"ParamOut", {"unfused_param_" + id}}}, f::AttributeMap()));
+  }
+  return ops;
+}
+
+static std::unique_ptr<f::OperatorBase> CreateFusedSGDOp(int table_num) {
+  std::vector<std::string> params, grads, lrs;
+  for (int i = 0; i < table_num; ++i) {
+    auto id = std::to_string(i);
+    params.push_back("fused_param_" + id);
+    grads.push_back("grad_" + id);
+    lrs.push_back("lr_" + id);
+  }
+  return f::OpRegistry::CreateOp(
+      "fused_sparse_sgd",
+      {{"Param", params}, {"Grad", grads}, {"LearningRate", lrs}},
+      {{"ParamOut", params}}, f::AttributeMap());
+}
+
+// Runs the unfused ops and the fused op of 5 tables for 2 steps with
+// thread_num threads, and compares the tables updated by them.
+static void TestFusedSparseOptimizer(
+    const std::function<std::vector<std::unique_ptr<f::OperatorBase>>(int)>&
+        create_ops,
+    const std::function<std::unique_ptr<f::OperatorBase>(int)>&
+        create_fused_op,
+    int thread_num) {
+  int old_parallelism = FLAGS_inner_op_parallelism;
+  FLAGS_inner_op_parallelism = thread_num;
+  const int table_num = 5;
+  f::Scope scope;
+  platform::CPUPlace place;
+  CreateTables(&scope, table_num, 1000, 7, 300);
+  // An empty gradient is skipped.
+  auto* empty_grad = scope.FindVar("grad_3")->GetMutable<f::SelectedRows>();
+  empty_grad->mutable_rows()->clear();
+
+  auto ops = create_ops(table_num);
+  auto fused_op = create_fused_op(table_num);
+  for (int step = 0; step < 2; ++step) {
+    for (auto& op : ops) {
+      op->Run(scope, place);
+    }
+    fused_op->Run(scope, place);
+  }
+  ExpectTablesNear(scope, table_num);
+  FLAGS_inner_op_parallelism = old_parallelism;
+}
+
+static void TestFusedSparseAdam(bool lazy_mode, int thread_num) {
+  TestFusedSparseOptimizer(
+      [=](int table_num) { return CreateAdamOps(table_num, lazy_mode); },
+      [=](int table_num) { return CreateFusedOp(table_num, lazy_mode); },
+      thread_num);
+}
+
+TEST(FusedSparseAdam, NotLazyMode) {
+  TestFusedSparseAdam(false, 0);
+  TestFusedSparseAdam(false, 4);
+}
+
+TEST(FusedSparseAdam, LazyMode) {
+  TestFusedSparseAdam(true, 0);
+  TestFusedSparseAdam(true, 4);
+}
+
+TEST(FusedSparseMomentum, Nesterov) {
+  for (bool use_nesterov : {false, true}) {
+    f::AttributeMap attrs;
+    attrs["mu"] = 0.9f;
+    attrs["use_nesterov"] = use_nesterov;
+    for (int thread_num : {0, 4}) {
+      TestFusedSparseOptimizer(
+          [&](int table_num) { return CreateMomentumOps(table_num, attrs); },
+          [&](int table_num) {
+            return CreateFusedMomentumOp(table_num, attrs);
+          },
+          thread_num);
+    }
+  }
+}
+
+TEST(FusedSparseSGD, Basic) {
+  for (int thread_num : {0, 4}) {
+    TestFusedSparseOptimizer(CreateSGDOps, CreateFusedSGDOp, thread_num);
+  }
+}
+
+// Updates dozens of embedding tables by an adam op per table and by one
+// fused_sparse_adam op.
+TEST(FusedSparseAdam, Benchmark) {
+  const int table_num = FLAGS_fused_sparse_adam_benchmark_tables;
+  f::Scope scope;
+  platform::CPUPlace place;
+  CreateTables(&scope, table_num, FLAGS_fused_sparse_adam_benchmark_height, 16,
+               FLAGS_fused_sparse_adam_benchmark_rows);
+
+  int old_parallelism = FLAGS_inner_op_parallelism;
+  for (int thread_num : {0, 8}) {
+    FLAGS_inner_op_parallelism = thread_num;
+    for (bool lazy_mode : {true, false}) {
+      auto adam_ops = CreateAdamOps(table_num, lazy_mode);
+      auto fused_op = CreateFusedOp(table_num, lazy_mode);
+
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < FLAGS_fused_sparse_adam_benchmark_repeat; ++i) {
+        for (auto& op : adam_ops) {
+          op->Run(scope, place);
+        }
+      }
+      double adam_ms = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+      start = std::chrono::steady_clock::now();
+      for (int i = 0; i < FLAGS_fused_sparse_adam_benchmark_repeat; ++i) {
+        fused_op->Run(scope, place);
+      }
+      double fused_ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+
+      ExpectTablesNear(scope, table_num);
+      LOG(INFO) << table_num << " tables, lazy_mode=" << lazy_mode
+                << ", inner_op_parallelism=" << thread_num << ": adam "
+                << adam_ms / FLAGS_fused_sparse_adam_benchmark_repeat
+                << " ms/step, fused_sparse_adam "
+                << fused_ms / FLAGS_fused_sparse_adam_benchmark_repeat
+                << " ms/step";
+    }
+  }
+  FLAGS_inner_op_parallelism = old_parallelism;
+}
+
+}  // namespace operators
+}  // namespace paddle
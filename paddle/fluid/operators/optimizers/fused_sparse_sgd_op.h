@@ -0,0 +1,96 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/optimizers/fused_sparse_optimizer.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedSparseSGDOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override;
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override;
+};
+
+// Updates a group of parameters with SelectedRows gradients by SGD in one
+// kernel. The parameters are updated in place as sgd does. The duplicated
+// rows of every gradient are merged by HashMergeGrad first, so that the
+// merged rows can be cut into segments which are updated by
+// FLAGS_inner_op_parallelism threads without writing the same row.
+template <typename DeviceContext, typename T>
+class FusedSparseSGDOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    using framework::LoDTensor;
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "fused_sparse_sgd only supports CPUPlace.");
+
+    auto params = ctx.MultiInput<LoDTensor>("Param");
+    auto lrs = ctx.MultiInput<LoDTensor>("LearningRate");
+    auto param_outs = ctx.MultiOutput<LoDTensor>("ParamOut");
+
+    size_t param_num = params.size();
+    PADDLE_ENFORCE_EQ(param_outs.size(), param_num);
+    std::vector<const framework::SelectedRows*> grads;
+    std::vector<size_t> param_ids = GetSparseGrads(ctx, params, &grads);
+    for (auto i : param_ids) {
+      PADDLE_ENFORCE_EQ(params[i], param_outs[i],
+                        "The Param(%s) should be updated in place.",
+                        ctx.Inputs("Param")[i]);
+    }
+
+    int thread_num = FLAGS_inner_op_parallelism;
+    std::vector<HashMergedGrad<T>> merged_grads(param_num);
+    RunTasksInParallel(param_ids.size(), thread_num, [&](size_t task) {
+      size_t i = param_ids[task];
+      HashMergeGrad<T>(*grads[i], params[i]->dims()[0], false,
+                       &merged_grads[i]);
+    });
+
+    std::vector<SparseUpdateSegment> segments;
+    for (auto i : param_ids) {
+      AppendSparseUpdateSegments(
+          i, static_cast<int64_t>(merged_grads[i].rows_.size()),
+          merged_grads[i].row_numel_, &segments);
+    }
+    VLOG(3) << "fused_sparse_sgd updates " << param_ids.size()
+            << " params in " << segments.size() << " segments";
+
+    RunTasksInParallel(segments.size(), thread_num, [&](size_t task) {
+      const SparseUpdateSegment& seg = segments[task];
+      size_t i = seg.param_idx;
+      const HashMergedGrad<T>& grad = merged_grads[i];
+      int64_t row_numel = grad.row_numel_;
+      T* param_out = param_outs[i]->data<T>();
+      T lr = *lrs[i]->data<T>();
+
+      for (int64_t r = seg.begin; r < seg.end; ++r) {
+        const T* g = grad.value_ + r * row_numel;
+        T* p = param_out + grad.rows_[r] * row_numel;
+        for (int64_t k = 0; k < row_numel; ++k) {
+          p[k] -= lr * g[k];
+        }
+      }
+    });
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
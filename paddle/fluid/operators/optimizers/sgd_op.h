@@ -114,14 +114,14 @@ class SGDOpKernel : public framework::OpKernel<T> {
 
       const auto *lr = learning_rate->data<T>();
       const auto *grad_data = grad.value().data<T>();
-      auto *out_data = param_out->mutable_value()->data<T>();
       for (size_t i = 0; i < grad.rows().size(); i++) {
         int64_t id_index = param_out->AutoGrownIndex(grad.rows()[i], false);
         PADDLE_ENFORCE_GE(id_index, static_cast<int64_t>(0),
                           "id should be in the table");
+        // The row may be in the grown chunks of the table.
+        auto *out_data = param_out->MutableRowData<T>(id_index);
         for (int64_t j = 0; j < grad_row_width; j++) {
-          out_data[id_index * grad_row_width + j] -=
-              lr[0] * grad_data[i * grad_row_width + j];
+          out_data[j] -= lr[0] * grad_data[i * grad_row_width + j];
         }
       }
     } else {
@@ -72,9 +72,12 @@ class BlockingQueue {
     receive_cv_.wait(lock, [&] { return !queue_.empty() || closed_; });
     if (!queue_.empty()) {
       PADDLE_ENFORCE_NOT_NULL(elem);
-      *elem = queue_.front();
       if (LIKELY(!speed_test_mode_)) {
+        // The element is moved out, e.g. the LoD of the tensors is not copied.
+        *elem = std::move(queue_.front());
         queue_.pop_front();
+      } else {
+        *elem = queue_.front();
       }
       send_cv_.notify_one();
       return true;
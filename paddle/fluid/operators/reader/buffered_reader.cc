@@ -13,15 +13,81 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/reader/buffered_reader.h"
+#include <string.h>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/memory/malloc.h"
 
 #include "paddle/fluid/platform/profiler.h"
 namespace paddle {
 namespace operators {
 namespace reader {
+
+// The batches in cpu_buffer_, the one used by the executor and the one
+// being released by it, plus one more to not wait for the release.
+static size_t CPUMemoryPoolSize(size_t buffer_size) { return buffer_size + 3; }
+
+// The memory blocks of the batches on CPUPlace, at most max_block_num blocks
+// for every slot. A block is handed out by Acquire, and returned by the
+// deleter of its holder once the consumer releases the last tensor sharing
+// it, so the blocks in the free lists are never referenced by others.
+class CPUMemoryPool : public std::enable_shared_from_this<CPUMemoryPool> {
+ public:
+  CPUMemoryPool(const platform::Place &place, size_t max_block_num)
+      : place_(place), max_block_num_(max_block_num) {}
+
+  // Returns the holder of a block of at least size bytes for the slot, or
+  // nullptr if all the blocks of the slot are still in use, e.g. the batches
+  // are kept by the user.
+  std::shared_ptr<memory::Allocation> Acquire(size_t slot, size_t size) {
+    memory::AllocationPtr block;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (free_blocks_.size() <= slot) {
+        free_blocks_.resize(slot + 1);
+        block_nums_.resize(slot + 1, 0);
+      }
+      auto &free_blocks = free_blocks_[slot];
+      if (!free_blocks.empty()) {
+        block = std::move(free_blocks.back());
+        free_blocks.pop_back();
+      } else if (block_nums_[slot] < max_block_num_) {
+        ++block_nums_[slot];
+      } else {
+        return nullptr;
+      }
+    }
+    if (block == nullptr || block->size() < size) {
+      block = memory::Alloc(place_, size);
+    }
+    std::weak_ptr<CPUMemoryPool> weak_pool = shared_from_this();
+    return std::shared_ptr<memory::Allocation>(
+        block.release(), [weak_pool, slot](memory::Allocation *allocation) {
+          memory::AllocationPtr block(allocation);
+          auto pool = weak_pool.lock();
+          if (pool) {
+            pool->Release(slot, std::move(block));
+          }
+        });
+  }
+
+ private:
+  void Release(size_t slot, memory::AllocationPtr block) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    free_blocks_[slot].emplace_back(std::move(block));
+  }
+
+  platform::Place place_;
+  const size_t max_block_num_;
+  std::mutex mutex_;
+  std::vector<std::vector<memory::AllocationPtr>> free_blocks_;
+  // The number of blocks of every slot, including the ones in use.
+  std::vector<size_t> block_nums_;
+};
+
 BufferedReader::~BufferedReader() {
   VLOG(1) << "~BufferedReader";
   reader_->Shutdown();
@@ -46,7 +112,9 @@ BufferedReader::BufferedReader(
     : framework::DecoratedReader(reader),
       thread_pool_(1),
       place_(place),
-      buffer_size_(buffer_size) {
+      buffer_size_(buffer_size),
+      cpu_memory_pool_(std::make_shared<CPUMemoryPool>(
+          place, CPUMemoryPoolSize(buffer_size))) {
   VLOG(1) << "BufferedReader";
 #ifdef PADDLE_WITH_CUDA
   if (platform::is_gpu_place(place_)) {
@@ -83,6 +151,10 @@ void BufferedReader::ReadAsync(size_t i) {
       return -1UL;
     }
 
+    if (platform::is_cpu_place(place_)) {
+      CopyToCPUMemoryPool(&cpu);
+    }
+
 #ifdef PADDLE_WITH_CUDA
     // NOTE(liangdun): using async copy instead of TensorCopySync
     // TensorCopySync would block other stream, because TensorCopySync
@@ -150,6 +222,28 @@ void BufferedReader::ReadAsync(size_t i) {
   }));
 }
 
+void BufferedReader::CopyToCPUMemoryPool(TensorVec *batch) {
+  platform::RecordEvent record_event("BufferedReader:CopyToCPUMemoryPool");
+  for (size_t j = 0; j < batch->size(); ++j) {
+    auto &tensor = (*batch)[j];
+    if (!platform::is_cpu_place(tensor.place()) || tensor.numel() == 0) {
+      continue;
+    }
+    size_t size = tensor.numel() * framework::SizeOfType(tensor.type());
+    auto holder = cpu_memory_pool_->Acquire(j, size);
+    if (holder == nullptr) {
+      VLOG(3) << "BufferedReader: the cpu memory pool of slot " << j
+              << " is used up";
+      continue;
+    }
+    memcpy(holder->ptr(), tensor.data<void>(), size);
+    // The dims, type, layout and LoD of tensor are kept, and it drops its
+    // memory in this thread.
+    tensor.clear();
+    tensor.ResetHolder(std::move(holder));
+  }
+}
+
 void BufferedReader::ShutdownImpl() {
   VLOG(1) << "ShutdownImpl";
   reader_->Shutdown();
@@ -28,6 +28,8 @@ namespace paddle {
 namespace operators {
 namespace reader {
 
+class CPUMemoryPool;
+
 class BufferedReader : public framework::DecoratedReader {
   using TensorVec = std::vector<framework::LoDTensor>;
   using VecFuture = std::future<TensorVec>;
@@ -43,6 +45,8 @@ class BufferedReader : public framework::DecoratedReader {
 
   void ReadAsync(size_t i);
 
+  void CopyToCPUMemoryPool(TensorVec* batch);
+
  protected:
   void ShutdownImpl() override;
   void StartImpl() override;
@@ -62,6 +66,11 @@ class BufferedReader : public framework::DecoratedReader {
   // buffers and prevent alloc every time.
   std::vector<TensorVec> cpu_buffer_;
   std::vector<TensorVec> gpu_buffer_;
+  // On CPUPlace, the batches are copied into the memory of this pool by the
+  // reading thread. The memory is returned to the pool when the consumer
+  // releases the batch, so the executor never allocates or releases the
+  // memory of the batches.
+  std::shared_ptr<CPUMemoryPool> cpu_memory_pool_;
   size_t prev_pos_{-1UL};
 #ifdef PADDLE_WITH_CUDA
   cudaStream_t stream_;
@@ -0,0 +1,115 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/buffered_reader.h"
+#include <memory>
+#include <set>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// Reads batch_num batches, the i-th of which has a tensor of [4, 3] filled
+// by i and with the LoD {0, 1, 4}. All the batches are kept, so their memory
+// is not reused by others.
+class StubBatchReader : public framework::ReaderBase {
+ public:
+  explicit StubBatchReader(int batch_num) : batch_num_(batch_num) {}
+
+  void ReadNextImpl(std::vector<framework::LoDTensor> *out) override {
+    out->clear();
+    if (static_cast<int>(batches_.size()) >= batch_num_) {
+      return;
+    }
+    int i = batches_.size();
+    framework::LoDTensor tensor;
+    tensor.Resize({4, 3});
+    float *data = tensor.mutable_data<float>(platform::CPUPlace());
+    for (int64_t k = 0; k < tensor.numel(); ++k) {
+      data[k] = i;
+    }
+    tensor.set_lod({{0, 1, 4}});
+    batches_.push_back(tensor);
+    out->push_back(tensor);
+  }
+
+  std::set<const void *> SourcePtrs() const {
+    std::set<const void *> ptrs;
+    for (auto &t : batches_) ptrs.insert(t.data<void>());
+    return ptrs;
+  }
+
+ private:
+  int batch_num_;
+  std::vector<framework::LoDTensor> batches_;
+};
+
+static void ExpectBatch(const std::vector<framework::LoDTensor> &batch,
+                        int i) {
+  ASSERT_EQ(batch.size(), 1UL);
+  auto &tensor = batch[0];
+  ASSERT_EQ(tensor.dims(), framework::make_ddim({4, 3}));
+  ASSERT_EQ(tensor.lod(), framework::LoD({{0, 1, 4}}));
+  const float *data = tensor.data<float>();
+  for (int64_t k = 0; k < tensor.numel(); ++k) {
+    ASSERT_EQ(data[k], i);
+  }
+}
+
+TEST(BufferedReader, ReuseCPUTensors) {
+  const int batch_num = 20;
+  auto stub = std::make_shared<StubBatchReader>(batch_num);
+  auto reader = framework::MakeDecoratedReader<BufferedReader>(
+      stub, platform::CPUPlace(), 2);
+
+  std::set<const void *> ptrs;
+  for (int i = 0; i < batch_num; ++i) {
+    std::vector<framework::LoDTensor> batch;
+    reader->ReadNext(&batch);
+    ExpectBatch(batch, i);
+    ptrs.insert(batch[0].data<void>());
+  }
+  std::vector<framework::LoDTensor> batch;
+  reader->ReadNext(&batch);
+  EXPECT_TRUE(batch.empty());
+
+  // The batches are copied into at most 5 memory blocks, which are returned
+  // to the pool when the batches are released.
+  EXPECT_LE(ptrs.size(), 5UL);
+  for (auto ptr : stub->SourcePtrs()) {
+    EXPECT_EQ(ptrs.count(ptr), 0UL);
+  }
+}
+
+TEST(BufferedReader, KeepCPUTensors) {
+  const int batch_num = 20;
+  auto stub = std::make_shared<StubBatchReader>(batch_num);
+  auto reader = framework::MakeDecoratedReader<BufferedReader>(
+      stub, platform::CPUPlace(), 2);
+
+  // The batches kept by the user are never overwritten.
+  std::vector<std::vector<framework::LoDTensor>> batches(batch_num);
+  for (int i = 0; i < batch_num; ++i) {
+    reader->ReadNext(&batches[i]);
+  }
+  for (int i = 0; i < batch_num; ++i) {
+    ExpectBatch(batches[i], i);
+  }
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -52,6 +52,12 @@ class LoDTensorBlockingQueue {
     return lod_tensor_vec;
   }
 
+  // Pops the tensors into *lod_tensor_vec, which are moved out of the queue.
+  // Returns false if the queue is closed and empty.
+  bool Pop(std::vector<framework::LoDTensor>* lod_tensor_vec) {
+    return queue_.Receive(lod_tensor_vec);
+  }
+
   inline size_t Cap() const { return queue_.Cap(); }
 
   inline size_t Size() const { return queue_.Size(); }
@@ -26,9 +26,7 @@ PyReader::PyReader(const std::shared_ptr<LoDTensorBlockingQueue>& queue)
 }
 
 void PyReader::ReadNext(std::vector<framework::LoDTensor>* out) {
-  bool success;
-  *out = queue_->Pop(&success);
-  if (!success) out->clear();
+  if (!queue_->Pop(out)) out->clear();
 }
 
 PyReader::~PyReader() { queue_->Close(); }
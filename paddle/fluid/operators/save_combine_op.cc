@@ -65,6 +65,12 @@ to a file on disk.
                   "type and then saved. Otherwise, the tensor will be "
                   "directly saved without data type conversion.")
         .SetDefault(false);
+    AddAttr<bool>("align_payload",
+                  "(boolean, default false)"
+                  "If true, the data of each tensor will be aligned in the "
+                  "file, so that load_combine with use_mmap can load the "
+                  "tensors without copy.")
+        .SetDefault(false);
     AddAttr<std::string>(
         "file_path",
         "(string)"
@@ -344,3 +344,51 @@ TEST(SaveLoadTestWithCombineOp, CPU) {
     }
   }
 }
+
+// Save the tensors with aligned payloads, and load them from the mapped file.
+TEST(SaveLoadCombineOp, CPU_mmap) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  int* expect1 = CreateForSaveCombineOp<int, int>(10, 10, lod1, "test_var1",
+                                                  place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 2, 5, 10};
+  int numel2 = 200;
+  paddle::framework::LoD expect_lod2;
+  int* expect2 = CreateForSaveCombineOp<int, int>(10, 20, lod2, "test_var2",
+                                                  place, &scope, &expect_lod2);
+
+  paddle::framework::AttributeMap save_attrs;
+  save_attrs.insert({"file_path", std::string("check_tensor_mmap.ls")});
+  save_attrs.insert({"align_payload", true});
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, save_attrs);
+  save_combine_op->Run(scope, place);
+
+  auto target1 = GeneratePlaceholderBeforeLoad("out_var1", &scope);
+  auto target2 = GeneratePlaceholderBeforeLoad("out_var2", &scope);
+
+  paddle::framework::AttributeMap load_attrs;
+  load_attrs.insert({"file_path", std::string("check_tensor_mmap.ls")});
+  load_attrs.insert({"use_mmap", true});
+  auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"out_var1", "out_var2"}}}, load_attrs);
+  load_combine_op->Run(scope, place);
+
+  paddle::framework::LoD actual_lod1, actual_lod2;
+  int* actual1 = GetValuesAfterLoadCombineOp<int>(target1, scope, &actual_lod1);
+  int* actual2 = GetValuesAfterLoadCombineOp<int>(target2, scope, &actual_lod2);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(actual1) %
+                paddle::framework::kTensorPayloadAlignment,
+            0UL);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(actual2) %
+                paddle::framework::kTensorPayloadAlignment,
+            0UL);
+
+  CheckValues<int, int>(expect1, actual1, expect_lod1, actual_lod1, numel1);
+  CheckValues<int, int>(expect2, actual2, expect_lod2, actual_lod2, numel2);
+}
@@ -27,7 +27,12 @@ limitations under the License. */
 namespace paddle {
 namespace platform {
 
+// Like the thread number of OpenMP, the setting is per thread, so the
+// predictors running in different threads do not overwrite each other.
+static thread_local int num_threads_in_use = 1;
+
 void SetNumThreads(int num_threads) {
+  num_threads_in_use = num_threads > 1 ? num_threads : 1;
 #ifdef PADDLE_USE_OPENBLAS
 // windows has no support for openblas multi-thread
 // please refer to: https://github.com/PaddlePaddle/Paddle/issues/7234
@@ -47,5 +52,7 @@ void SetNumThreads(int num_threads) {
 #endif
 }
 
+int GetNumThreads() { return num_threads_in_use; }
+
 }  // namespace platform
 }  // namespace paddle
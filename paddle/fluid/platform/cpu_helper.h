@@ -22,5 +22,9 @@ namespace platform {
 //! Set the number of threads in use.
 void SetNumThreads(int num_threads);
 
+//! Get the number of threads set by SetNumThreads in the calling thread,
+//! which is 1 if it is never called.
+int GetNumThreads();
+
 }  // namespace platform
 }  // namespace paddle
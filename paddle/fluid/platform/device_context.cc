@@ -10,6 +10,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -330,140 +331,201 @@ Place CUDAPinnedDeviceContext::GetPlace() const { return place_; }
 #endif
 
 #ifdef PADDLE_WITH_MKLDNN
+KeyBlob* ShapeBlob::Find(BlobKey shape) {
+  auto it = index_.find(shape);
+  if (it == index_.end()) return nullptr;
+  blobs_.splice(blobs_.begin(), blobs_, it->second);
+  return &it->second->second;
+}
+
+KeyBlob* ShapeBlob::Get(BlobKey shape, size_t capacity) {
+  auto* pBlob = Find(shape);
+  if (pBlob != nullptr) return pBlob;
+  while (capacity > 0 && index_.size() >= capacity) {
+    VLOG(2) << "remove all blobs of the least recently used shape: "
+            << blobs_.back().first;
+    index_.erase(blobs_.back().first);
+    blobs_.pop_back();
+  }
+  blobs_.emplace_front(shape, KeyBlob());
+  index_[shape] = blobs_.begin();
+  return &blobs_.front().second;
+}
+
+namespace {
+std::atomic<uint64_t> mkldnn_device_context_num{0};
+}  // namespace
+
 MKLDNNDeviceContext::MKLDNNDeviceContext(CPUPlace place)
     : CPUDeviceContext(place), engine_(mkldnn::engine::cpu, 0), p_blobmap_() {
   p_blobmap_.reset(new BlobMap());
   p_mutex_.reset(new std::mutex());
+  id_ = mkldnn_device_context_num++;
+  p_thread_blobmaps_.reset(new std::vector<std::weak_ptr<ThreadBlobMap>>());
 }
 
+struct ThreadBlobMap {
+  std::mutex mutex;
+  BlobMap blobmap;
+};
+
 namespace {
 // Current mkldnn session id.
 thread_local size_t cur_mkldnn_session_id = kMKLDNNSessionID_Default;
-// Current data input shape string.
+// Current data input shape string and its key.
 // - For fixed-shape, it's a null string in default.
 // - For dynamic-shape, it's user specific.
 thread_local std::string cur_input_shape_str = "";
+thread_local BlobKey cur_input_shape_key = HashBlobKey("");
 // the cache capacity of different input shapes for MKLDNN.
 // Default 1 means fixed input shape, not dynamic shape.
 thread_local int cur_input_shape_cache_capacity = 1;
+
+// The blob maps of the contexts in the current thread, keyed by the id of
+// the context.
+thread_local std::unordered_map<uint64_t, std::shared_ptr<ThreadBlobMap>>
+    thread_blobmaps;
+
+// In cache clearing mode, cur_input_shape_cache_capacity defines max pblob
+// capacity.
+size_t GetShapeBlobCapacity(size_t sid) {
+  return sid == kMKLDNNSessionID_CacheClearing
+             ? static_cast<size_t>(std::max(cur_input_shape_cache_capacity, 0))
+             : 0;
+}
 }  // namespace
 
 void set_cur_mkldnn_session_id(size_t sid) { cur_mkldnn_session_id = sid; }
 size_t get_cur_mkldnn_session_id(void) { return cur_mkldnn_session_id; }
 void set_cur_input_shape_str(std::string input_shape_str) {
   cur_input_shape_str = input_shape_str;
+  cur_input_shape_key = HashBlobKey(input_shape_str);
 }
 void set_cur_input_shape_cache_capacity(int input_shape_cache_capacity) {
   cur_input_shape_cache_capacity = input_shape_cache_capacity;
 }
 
-void MKLDNNDeviceContext::ResetBlobMap() const { p_blobmap_->clear(); }
+void MKLDNNDeviceContext::ResetBlobMap() const {
+  std::lock_guard<std::mutex> lock(*p_mutex_);
+  p_blobmap_->clear();
+  for (auto& weak_blobmap : *p_thread_blobmaps_) {
+    auto thread_blobmap = weak_blobmap.lock();
+    if (thread_blobmap) {
+      std::lock_guard<std::mutex> thread_lock(thread_blobmap->mutex);
+      thread_blobmap->blobmap.clear();
+    }
+  }
+}
 
 size_t MKLDNNDeviceContext::GetShapeBlobSize() const {
-  std::lock_guard<std::mutex> lock(*p_mutex_);
-  BlobMap* pMap = p_blobmap_.get();
+  {
+    std::lock_guard<std::mutex> lock(*p_mutex_);
+    BlobMap* pMap = p_blobmap_.get();
+    auto map_it = pMap->find(cur_mkldnn_session_id);
+    if (map_it != pMap->end()) {
+      return map_it->second.size();
+    }
+  }
+  auto* thread_blobmap = GetThreadBlobMap();
+  std::lock_guard<std::mutex> lock(thread_blobmap->mutex);
+  BlobMap* pMap = &thread_blobmap->blobmap;
   auto map_it = pMap->find(cur_mkldnn_session_id);
   if (map_it == pMap->end()) {
     LOG(FATAL) << "MKLDNNDeviceContext don't find cur_mkldnn_session_id : "
                << cur_mkldnn_session_id;
   }
-  return map_it->second->size();
+  return map_it->second.size();
 }
 
-void MKLDNNDeviceContext::SetBlob(const std::string& name,
+void MKLDNNDeviceContext::SetBlob(BlobKey key,
                                   std::shared_ptr<void> data) const {
-  BlobMap* pMap = p_blobmap_.get();
-  std::shared_ptr<ShapeBlob> sBlob = nullptr;
-  std::shared_ptr<KeyBlob> pBlob = nullptr;
-
-  int sid = platform::get_cur_mkldnn_session_id();
+  size_t sid = platform::get_cur_mkldnn_session_id();
 
   std::lock_guard<std::mutex> lock(*p_mutex_);
 
-  // Find ShapeBlob for current mkldnn session id.
-  auto map_it = pMap->find(sid);
-
-  if (map_it == pMap->end()) {
-    // 1st time to set blob in current thread
-    sBlob = std::shared_ptr<ShapeBlob>(new ShapeBlob());
-    (*pMap)[sid] = sBlob;
-    VLOG(2) << "SetBlob: sid=" << sid << ", add new sid\n";
-  } else {
-    sBlob = map_it->second;
-  }
-
-  // Find KeyBlob for current input shape
-  auto key_it = sBlob->find(cur_input_shape_str);
-
-  if (key_it == sBlob->end()) {
-    // In cache clearing mode, cur_input_shape_cache_capacity defines
-    // max pblob capacity
-    if ((static_cast<size_t>(sid) == kMKLDNNSessionID_CacheClearing) &&
-        sBlob->size() &&
-        (sBlob->size() >=
-         static_cast<size_t>(cur_input_shape_cache_capacity))) {
-      VLOG(2) << "sid=" << sid
-              << ", remove all blobs of shape: " << sBlob->begin()->first;
-      sBlob->erase(sBlob->begin()->first);
-    }
-    pBlob = std::shared_ptr<KeyBlob>(new KeyBlob());
-    (*sBlob)[cur_input_shape_str] = pBlob;
-  } else {
-    pBlob = key_it->second;
-  }
-
-  // Find Blob via name
-  auto blob_it = pBlob->find(name);
-  if (blob_it == pBlob->end()) {
-    (*pBlob)[name] = data;
-  } else {
-    blob_it->second = data;  // set data to existing blob
-  }
-  VLOG(2) << "SetBlob: sid=" << sid << ", add blob=" << name << "\n";
+  // Find or create the KeyBlob of the current input shape in the ShapeBlob
+  // of the current mkldnn session id.
+  auto* pBlob = (*p_blobmap_)[sid].Get(cur_input_shape_key,
+                                       GetShapeBlobCapacity(sid));
+  (*pBlob)[key] = std::move(data);
+  VLOG(2) << "SetBlob: sid=" << sid << ", add blob=" << key << "\n";
   // lock will be automatically released when out of scope
-  return;
 }
 
-std::shared_ptr<void> MKLDNNDeviceContext::GetBlob(
-    const std::string& name) const {
-  BlobMap* pMap = p_blobmap_.get();
-  std::shared_ptr<ShapeBlob> sBlob = nullptr;
-  std::shared_ptr<KeyBlob> pBlob = nullptr;
-
-  int sid = platform::get_cur_mkldnn_session_id();
+std::shared_ptr<void> MKLDNNDeviceContext::GetBlob(BlobKey key) const {
+  size_t sid = platform::get_cur_mkldnn_session_id();
 
   std::lock_guard<std::mutex> lock(*p_mutex_);
 
   // Find ShapeBlob for current mkldnn session id firstly
-  auto map_it = pMap->find(sid);
-  if (map_it == pMap->end()) {
+  auto map_it = p_blobmap_->find(sid);
+  if (map_it == p_blobmap_->end()) {
     VLOG(2) << "GetBlob: sid=" << sid << ", miss sid\n";
     return nullptr;
   }
-  sBlob = map_it->second;
 
   // Find KeyBlob for current input shape secondly
-  auto sBlob_it = sBlob->find(cur_input_shape_str);
-  if (sBlob_it == sBlob->end()) {
+  auto* pBlob = map_it->second.Find(cur_input_shape_key);
+  if (pBlob == nullptr) {
     VLOG(2) << "GetBlob: sid=" << cur_input_shape_str
             << ", miss input_shape_str\n";
     return nullptr;
   }
-  pBlob = sBlob_it->second;
-
-  // Find Blob via name
-  auto key_it = pBlob->find(name);
 
+  // Find Blob via key
+  auto key_it = pBlob->find(key);
   if (key_it == pBlob->end()) {
-    VLOG(2) << "GetBlob sid=" << sid << ", miss blob=" << name << "\n";
+    VLOG(2) << "GetBlob sid=" << sid << ", miss blob=" << key << "\n";
     return nullptr;
   }
 
-  VLOG(2) << "GetBlob sid=" << sid << ", get blob=" << name << "\n";
+  VLOG(2) << "GetBlob sid=" << sid << ", get blob=" << key << "\n";
   // lock will be automatically released when out of scope
   return key_it->second;
 }
 
+ThreadBlobMap* MKLDNNDeviceContext::GetThreadBlobMap() const {
+  auto& thread_blobmap = thread_blobmaps[id_];
+  if (thread_blobmap == nullptr) {
+    thread_blobmap = std::make_shared<ThreadBlobMap>();
+    // Register the blob map so that ResetBlobMap can clear it, and drop the
+    // ones of the exited threads.
+    std::lock_guard<std::mutex> lock(*p_mutex_);
+    auto& registry = *p_thread_blobmaps_;
+    registry.erase(
+        std::remove_if(registry.begin(), registry.end(),
+                       [](const std::weak_ptr<ThreadBlobMap>& weak_blobmap) {
+                         return weak_blobmap.expired();
+                       }),
+        registry.end());
+    registry.emplace_back(thread_blobmap);
+  }
+  return thread_blobmap.get();
+}
+
+void MKLDNNDeviceContext::SetThreadBlob(BlobKey key,
+                                        std::shared_ptr<void> data) const {
+  size_t sid = platform::get_cur_mkldnn_session_id();
+  auto* thread_blobmap = GetThreadBlobMap();
+  std::lock_guard<std::mutex> lock(thread_blobmap->mutex);
+  auto* pBlob = thread_blobmap->blobmap[sid].Get(cur_input_shape_key,
+                                                 GetShapeBlobCapacity(sid));
+  (*pBlob)[key] = std::move(data);
+}
+
+std::shared_ptr<void> MKLDNNDeviceContext::GetThreadBlob(BlobKey key) const {
+  size_t sid = platform::get_cur_mkldnn_session_id();
+  auto* thread_blobmap = GetThreadBlobMap();
+  std::lock_guard<std::mutex> lock(thread_blobmap->mutex);
+  BlobMap* pMap = &thread_blobmap->blobmap;
+  auto map_it = pMap->find(sid);
+  if (map_it == pMap->end()) return nullptr;
+  auto* pBlob = map_it->second.Find(cur_input_shape_key);
+  if (pBlob == nullptr) return nullptr;
+  auto key_it = pBlob->find(key);
+  return key_it == pBlob->end() ? nullptr : key_it->second;
+}
+
 #endif
 
 }  // namespace platform
@@ -10,7 +10,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #pragma once
 
+#include <atomic>
 #include <future>  // NOLINT
+#include <list>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
@@ -274,15 +276,65 @@ struct DefaultDeviceContextType<platform::CUDAPinnedPlace> {
 #endif
 
 #ifdef PADDLE_WITH_MKLDNN
+// The key of a cached MKLDNN blob, the FNV-1a hash of its name. The hash of a
+// name is a prefix of the hashes of the longer names, i.e. the key of
+// name + suffix is AppendBlobKey(HashBlobKey(name), suffix), so the keys of
+// the blobs of one primitive are appended to one precomputed key instead of
+// building the strings.
+using BlobKey = uint64_t;
+
+constexpr BlobKey kBlobKeySeed = 14695981039346656037ULL;
+
+inline BlobKey AppendBlobKey(BlobKey key, const char* data, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    key ^= static_cast<uint8_t>(data[i]);
+    key *= 1099511628211ULL;
+  }
+  return key;
+}
+
+inline BlobKey AppendBlobKey(BlobKey key, const std::string& str) {
+  return AppendBlobKey(key, str.data(), str.size());
+}
+
+template <size_t N>
+inline BlobKey AppendBlobKey(BlobKey key, const char (&str)[N]) {
+  return AppendBlobKey(key, str, N - 1);
+}
+
+inline BlobKey HashBlobKey(const std::string& name) {
+  return AppendBlobKey(kBlobKeySeed, name);
+}
+
 // Following three maps are used to cache MKLDNN primitives.
 // There relations are:
-// - BlobMap = Map<cur_thread_id, ShapeBlob>
-// - ShapeBlob = Map<cur_input_shape_str, KeyBlob>
-// - KeyBlob  = Map<blob_name, blob>
+// - BlobMap = Map<cur_mkldnn_session_id, ShapeBlob>
+// - ShapeBlob = LRU Map<cur_input_shape_key, KeyBlob>
+// - KeyBlob  = Map<blob_key, blob>
 // Where:
-using KeyBlob = std::unordered_map<std::string, std::shared_ptr<void>>;
-using ShapeBlob = std::unordered_map<std::string, std::shared_ptr<KeyBlob>>;
-using BlobMap = std::unordered_map<int, std::shared_ptr<ShapeBlob>>;
+using KeyBlob = std::unordered_map<BlobKey, std::shared_ptr<void>>;
+
+class ShapeBlob {
+ public:
+  // Find the KeyBlob of shape and mark it as the most recently used one.
+  // Return nullptr if not found
+  KeyBlob* Find(BlobKey shape);
+
+  // Find or create the KeyBlob of shape. When a KeyBlob is created and
+  // capacity is not 0, the least recently used ones are removed to keep at
+  // most capacity shapes.
+  KeyBlob* Get(BlobKey shape, size_t capacity);
+
+  size_t size() const { return index_.size(); }
+
+ private:
+  // From the most recently used shape to the least recently used one.
+  std::list<std::pair<BlobKey, KeyBlob>> blobs_;
+  std::unordered_map<BlobKey, std::list<std::pair<BlobKey, KeyBlob>>::iterator>
+      index_;
+};
+
+using BlobMap = std::unordered_map<size_t, ShapeBlob>;
 
 // default mkldnn session id
 constexpr size_t kMKLDNNSessionID_Default = 0;
@@ -294,6 +346,9 @@ size_t get_cur_mkldnn_session_id(void);
 void set_cur_input_shape_str(std::string input_shape_str);
 void set_cur_input_shape_cache_capacity(int input_shape_cache_capacity);
 
+// The blob map of a MKLDNNDeviceContext in one thread.
+struct ThreadBlobMap;
+
 class MKLDNNDeviceContext : public CPUDeviceContext {
  public:
   explicit MKLDNNDeviceContext(CPUPlace place);
@@ -301,22 +356,44 @@ class MKLDNNDeviceContext : public CPUDeviceContext {
   /* \brief  Get the active engine */
   const mkldnn::engine& GetEngine() const { return engine_; }
 
-  // Remove all entries from the blob map
+  // Remove all entries from the blob map, and the thread blob maps of all
+  // the threads.
   void ResetBlobMap() const;
 
   // Get the ShapeBlob size in cur_mkldnn_session_id.
   size_t GetShapeBlobSize() const;
 
   // Set data to blob (i.e. name/data pair). Create blob if not existing
-  void SetBlob(const std::string& name, std::shared_ptr<void> data) const;
+  void SetBlob(const std::string& name, std::shared_ptr<void> data) const {
+    SetBlob(HashBlobKey(name), std::move(data));
+  }
+  void SetBlob(BlobKey key, std::shared_ptr<void> data) const;
 
   // Find a saved blob. Return nullptr if not found
-  std::shared_ptr<void> GetBlob(const std::string& name) const;
+  std::shared_ptr<void> GetBlob(const std::string& name) const {
+    return GetBlob(HashBlobKey(name));
+  }
+  std::shared_ptr<void> GetBlob(BlobKey key) const;
+
+  // The same as SetBlob and GetBlob, but the blobs are kept in a blob map of
+  // the current thread, whose lock is only contended by ResetBlobMap. They
+  // are used for the primitives and memories that are only used by one
+  // thread.
+  void SetThreadBlob(BlobKey key, std::shared_ptr<void> data) const;
+  std::shared_ptr<void> GetThreadBlob(BlobKey key) const;
 
  private:
+  ThreadBlobMap* GetThreadBlobMap() const;
+
   mkldnn::engine engine_;
   std::shared_ptr<BlobMap> p_blobmap_;
   std::shared_ptr<std::mutex> p_mutex_;
+  // Identifies the blob maps of this context in the threads.
+  uint64_t id_;
+  // The blob maps of this context in the threads, guarded by p_mutex_. A
+  // blob map is owned by its thread, so it is released when the thread exits.
+  std::shared_ptr<std::vector<std::weak_ptr<ThreadBlobMap>>>
+      p_thread_blobmaps_;
 };
 #endif
 
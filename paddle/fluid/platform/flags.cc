@@ -301,17 +301,50 @@ DEFINE_double(memory_fraction_of_eager_deletion, 1.0,
  * Allocator related FLAG
  * Name: FLAGS_allocator_strategy
  * Since Version: 1.2
- * Value Range: string, {naive_best_fit, auto_groth}, default=naive_best_fit
+ * Value Range: string, {naive_best_fit, auto_groth, thread_local},
+ *              default=naive_best_fit
  * Example:
  * Note: Allocator policy for selecting Paddle Paddle.
  *       The allocator strategy is under development and the non-legacy
  *       allocator is not yet stable.
+ *       thread_local is the same as auto_growth on GPU, and serves the small
+ *       CPU allocations from per-thread caches in front of an auto-growth
+ *       chunk pool.
  */
 DEFINE_string(allocator_strategy, "naive_best_fit",
               "The allocation strategy. naive_best_fit means the original best "
               "fit allocator of Fluid. "
               "auto_growth means the experimental auto-growth allocator. "
-              "Enum in [naive_best_fit, auto_growth].");
+              "thread_local means the auto-growth allocator with per-thread "
+              "caches of small CPU allocations. "
+              "Enum in [naive_best_fit, auto_growth, thread_local].");
+
+/**
+ * Allocator related FLAG
+ * Name: FLAGS_cpu_thread_cache_max_size
+ * Since Version: 1.6
+ * Value Range: uint64, default=1048576 (Byte)
+ * Example: FLAGS_cpu_thread_cache_max_size=262144, CPU allocations larger
+ *          than 256KB would not be cached by threads.
+ * Note: Only valid when FLAGS_allocator_strategy=thread_local.
+ */
+DEFINE_uint64(cpu_thread_cache_max_size, 1ul << 20,
+              "The max size in bytes of the CPU allocations cached by each "
+              "thread when FLAGS_allocator_strategy=thread_local.");
+
+/**
+ * Allocator related FLAG
+ * Name: FLAGS_cpu_thread_cache_capacity_in_mb
+ * Since Version: 1.6
+ * Value Range: uint64, default=64 (MB)
+ * Example:
+ * Note: The max bytes of freed CPU memory cached by each thread when
+ *       FLAGS_allocator_strategy=thread_local. The memory freed beyond the
+ *       capacity is returned to the shared chunk pool.
+ */
+DEFINE_uint64(cpu_thread_cache_capacity_in_mb, 64ul,
+              "The capacity of the CPU allocation cache of each thread in MB "
+              "when FLAGS_allocator_strategy=thread_local.");
 
 /**
  * Memory related FLAG
@@ -451,3 +484,40 @@ DEFINE_double(local_exe_sub_scope_limit, 256.0,  // MBytes
               "each CUDAPlace. If you don't need to limit the memory, "
               "you should set FLAGS_local_exe_sub_scope_limit=-1. "
               "The default value is 256 MBytes.");
+
+/**
+ * Profiler related FLAG
+ * Name: FLAGS_enable_latency_monitor
+ * Since Version: 1.6
+ * Value Range: bool, default=false
+ * Example: FLAGS_enable_latency_monitor=true, collect the latency
+ *          histograms of all operators while running.
+ * Note: The latency monitor is cheap enough to be always on in serving
+ *       processes, and its statistics can be exported at any time.
+ */
+DEFINE_bool(enable_latency_monitor, false,
+            "Whether to collect the latency histograms of the operators.");
+
+/**
+ * Profiler related FLAG
+ * Name: FLAGS_latency_monitor_ring_size
+ * Since Version: 1.6
+ * Value Range: uint64, default=16384
+ * Example:
+ * Note: The number of events buffered by each thread for the latency
+ *       monitor, which is rounded up to a power of two. Events are dropped
+ *       when the buffer is full before the aggregator drains it.
+ */
+DEFINE_uint64(latency_monitor_ring_size, 16384,
+              "The event ring size of each thread for the latency monitor.");
+
+/**
+ * Profiler related FLAG
+ * Name: FLAGS_latency_monitor_interval_ms
+ * Since Version: 1.6
+ * Value Range: int32, default=100 (ms)
+ * Example:
+ * Note: The interval that the latency monitor aggregates the events.
+ */
+DEFINE_int32(latency_monitor_interval_ms, 100,
+             "The aggregation interval of the latency monitor in ms.");
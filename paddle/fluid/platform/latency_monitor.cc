@@ -0,0 +1,278 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/latency_monitor.h"
+#include <algorithm>
+#include <utility>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+DECLARE_bool(enable_latency_monitor);
+DECLARE_uint64(latency_monitor_ring_size);
+DECLARE_int32(latency_monitor_interval_ms);
+
+namespace paddle {
+namespace platform {
+
+constexpr size_t LatencyHistogram::kSubBucketBits;
+constexpr size_t LatencyHistogram::kSubBucketNum;
+constexpr size_t LatencyHistogram::kBucketNum;
+
+size_t LatencyHistogram::BucketIndex(uint64_t ns) {
+  if (ns < kSubBucketNum) return static_cast<size_t>(ns);
+  size_t shift = kSubBucketBits;
+  while (shift < 63 && (ns >> (shift + 1)) != 0) ++shift;
+  // ns is in [2^shift, 2^(shift+1)), which is split into kSubBucketNum buckets
+  size_t sub = static_cast<size_t>(ns >> (shift - kSubBucketBits)) &
+               (kSubBucketNum - 1);
+  return (shift - kSubBucketBits + 1) * kSubBucketNum + sub;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(size_t idx) {
+  if (idx < kSubBucketNum) return idx;
+  size_t shift = idx / kSubBucketNum + kSubBucketBits - 1;
+  uint64_t sub = idx % kSubBucketNum;
+  return (static_cast<uint64_t>(1) << shift) +
+         (sub << (shift - kSubBucketBits));
+}
+
+void LatencyHistogram::Add(uint64_t ns) {
+  if (buckets_.empty()) buckets_.resize(kBucketNum, 0);
+  ++buckets_[BucketIndex(ns)];
+  ++count_;
+  total_ns_ += ns;
+  min_ns_ = std::min(min_ns_, ns);
+  max_ns_ = std::max(max_ns_, ns);
+}
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+  if (count_ == 0) return 0;
+  q = std::min(std::max(q, 0.0), 1.0);
+  // The rank of the percentile, which is 1-based.
+  uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(q * static_cast<double>(count_) + 0.5));
+  if (rank >= count_) return max_ns_;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketNum; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // Use the middle of the bucket, and keep it in [min, max].
+      uint64_t lower = BucketLowerBound(i);
+      uint64_t upper =
+          i + 1 < kBucketNum ? BucketLowerBound(i + 1) : max_ns_ + 1;
+      uint64_t mid = lower + (upper - lower) / 2;
+      return std::min(std::max(mid, min_ns_), max_ns_);
+    }
+  }
+  return max_ns_;
+}
+
+// A single-producer single-consumer ring of events. The owner thread pushes
+// the events, and the aggregator, which holds aggregate_mutex_, drains them.
+struct LatencyMonitor::EventRing {
+  struct Entry {
+    uint32_t event_id_;
+    uint64_t start_ns_;
+    uint64_t end_ns_;
+  };
+
+  explicit EventRing(size_t capacity)
+      : entries_(capacity), mask_(capacity - 1) {}
+
+  bool Push(uint32_t event_id, uint64_t start_ns, uint64_t end_ns) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == entries_.size()) {
+      return false;
+    }
+    auto &entry = entries_[head & mask_];
+    entry.event_id_ = event_id;
+    entry.start_ns_ = start_ns;
+    entry.end_ns_ = end_ns;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename Callback>
+  void Drain(Callback &&callback) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    for (; tail != head; ++tail) {
+      callback(entries_[tail & mask_]);
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_relaxed);
+  }
+
+  std::vector<Entry> entries_;
+  size_t mask_;
+  // head_ and tail_ are written by different threads, put them in different
+  // cache lines to avoid false sharing.
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+LatencyMonitor &LatencyMonitor::Instance() {
+  static LatencyMonitor monitor;
+  return monitor;
+}
+
+bool LatencyMonitor::IsEnabled() { return FLAGS_enable_latency_monitor; }
+
+void LatencyMonitor::Enable() { FLAGS_enable_latency_monitor = true; }
+
+void LatencyMonitor::Disable() { FLAGS_enable_latency_monitor = false; }
+
+LatencyMonitor::~LatencyMonitor() {
+  {
+    std::lock_guard<std::mutex> guard(thread_mutex_);
+    stop_ = true;
+  }
+  thread_cv_.notify_all();
+  if (aggregate_thread_) {
+    aggregate_thread_->join();
+  }
+}
+
+uint32_t LatencyMonitor::InternEvent(const std::string &name) {
+  // Most threads record a small and fixed set of events, cache the ids in
+  // the thread to avoid the global mutex.
+  static thread_local std::unordered_map<std::string, uint32_t> cache;
+  auto it = cache.find(name);
+  if (it != cache.end()) return it->second;
+
+  uint32_t id;
+  {
+    std::lock_guard<std::mutex> guard(names_mutex_);
+    auto iter = name_to_id_.find(name);
+    if (iter == name_to_id_.end()) {
+      id = static_cast<uint32_t>(names_.size());
+      names_.emplace_back(name);
+      name_to_id_.emplace(name, id);
+    } else {
+      id = iter->second;
+    }
+  }
+  cache.emplace(name, id);
+  return id;
+}
+
+LatencyMonitor::EventRing *LatencyMonitor::GetThreadRing() {
+  static thread_local std::shared_ptr<EventRing> ring;
+  if (ring) return ring.get();
+
+  size_t capacity = 1;
+  while (capacity < FLAGS_latency_monitor_ring_size) capacity <<= 1;
+  ring = std::make_shared<EventRing>(capacity);
+  {
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+    rings_.emplace_back(ring);
+  }
+  {
+    std::lock_guard<std::mutex> guard(thread_mutex_);
+    if (!aggregate_thread_ && !stop_) {
+      aggregate_thread_.reset(
+          new std::thread([this] { AggregateLoop(); }));  // NOLINT
+    }
+  }
+  return ring.get();
+}
+
+void LatencyMonitor::Record(uint32_t event_id, uint64_t start_ns,
+                            uint64_t end_ns) {
+  if (!GetThreadRing()->Push(event_id, start_ns, end_ns)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void LatencyMonitor::DrainRings() {
+  std::vector<std::shared_ptr<EventRing>> rings;
+  {
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+    rings.reserve(rings_.size());
+    for (auto it = rings_.begin(); it != rings_.end();) {
+      // The owner thread has exited and all its events have been drained.
+      if (it->use_count() == 1 && (*it)->Empty()) {
+        it = rings_.erase(it);
+      } else {
+        rings.emplace_back(*it);
+        ++it;
+      }
+    }
+  }
+
+  for (auto &ring : rings) {
+    ring->Drain([this](const EventRing::Entry &entry) {
+      if (entry.event_id_ >= histograms_.size()) {
+        histograms_.resize(entry.event_id_ + 1);
+      }
+      uint64_t elapsed =
+          entry.end_ns_ > entry.start_ns_ ? entry.end_ns_ - entry.start_ns_ : 0;
+      histograms_[entry.event_id_].Add(elapsed);
+    });
+  }
+}
+
+void LatencyMonitor::AggregateLoop() {
+  std::unique_lock<std::mutex> lock(thread_mutex_);
+  while (!stop_) {
+    thread_cv_.wait_for(
+        lock, std::chrono::milliseconds(
+                  std::max(FLAGS_latency_monitor_interval_ms, 1)));
+    if (stop_) break;
+    lock.unlock();
+    {
+      std::lock_guard<std::mutex> guard(aggregate_mutex_);
+      DrainRings();
+    }
+    lock.lock();
+  }
+}
+
+std::vector<EventLatencyStats> LatencyMonitor::Snapshot(bool reset) {
+  std::vector<EventLatencyStats> stats;
+  {
+    std::lock_guard<std::mutex> guard(aggregate_mutex_);
+    DrainRings();
+    std::lock_guard<std::mutex> names_guard(names_mutex_);
+    for (size_t id = 0; id < histograms_.size(); ++id) {
+      auto &histogram = histograms_[id];
+      if (histogram.count() == 0) continue;
+      stats.emplace_back(EventLatencyStats{
+          names_[id], histogram.count(), histogram.total_ns() / 1000000.0,
+          histogram.min_ns() / 1000000.0, histogram.max_ns() / 1000000.0,
+          histogram.Percentile(0.5) / 1000000.0,
+          histogram.Percentile(0.99) / 1000000.0});
+    }
+    if (reset) histograms_.clear();
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const EventLatencyStats &a, const EventLatencyStats &b) {
+              return a.total_ms_ > b.total_ms_;
+            });
+  return stats;
+}
+
+void LatencyMonitor::Reset() {
+  std::lock_guard<std::mutex> guard(aggregate_mutex_);
+  DrainRings();
+  histograms_.clear();
+  dropped_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace platform
+}  // namespace paddle
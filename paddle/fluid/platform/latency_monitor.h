@@ -0,0 +1,160 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace platform {
+
+// Monotonic timestamp in nanoseconds. std::chrono::steady_clock is served by
+// clock_gettime(CLOCK_MONOTONIC) through vDSO on Linux, which does not enter
+// the kernel.
+inline uint64_t MonotonicNsec() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/*
+ * @brief A histogram of latencies in nanoseconds with log-linear buckets.
+ *
+ * Each power of two range is split into kSubBucketNum buckets, so that the
+ * relative error of the percentiles is less than 1 / kSubBucketNum.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBucketBits = 3;
+  static constexpr size_t kSubBucketNum = 1UL << kSubBucketBits;
+  static constexpr size_t kBucketNum =
+      (64 - kSubBucketBits + 1) * kSubBucketNum;
+
+  static size_t BucketIndex(uint64_t ns);
+  static uint64_t BucketLowerBound(size_t idx);
+
+  void Add(uint64_t ns);
+
+  // Returns the q-th (0 <= q <= 1) percentile in nanoseconds.
+  uint64_t Percentile(double q) const;
+
+  uint64_t count() const { return count_; }
+  uint64_t total_ns() const { return total_ns_; }
+  uint64_t min_ns() const { return count_ == 0 ? 0 : min_ns_; }
+  uint64_t max_ns() const { return max_ns_; }
+
+ private:
+  std::vector<uint64_t> buckets_;  // allocated on the first Add
+  uint64_t count_{0};
+  uint64_t total_ns_{0};
+  uint64_t min_ns_{UINT64_MAX};
+  uint64_t max_ns_{0};
+};
+
+struct EventLatencyStats {
+  std::string name_;
+  uint64_t calls_;
+  double total_ms_;
+  double min_ms_;
+  double max_ms_;
+  double p50_ms_;
+  double p99_ms_;
+};
+
+/*
+ * @brief An always-on, low-overhead event latency collector.
+ *
+ * Unlike the profiler, which keeps every event of every thread until
+ * DisableProfiler, the monitor records an interned event id and two
+ * monotonic timestamps into a fixed-size per-thread ring buffer. The rings
+ * are single-producer single-consumer, so recording never takes a lock. A
+ * background thread drains the rings every FLAGS_latency_monitor_interval_ms
+ * and aggregates the events into per-event LatencyHistograms. Events are
+ * dropped, and counted, when the ring of a thread is full.
+ *
+ * The monitor is switched by FLAGS_enable_latency_monitor, and RecordEvent
+ * records into it whenever it is enabled.
+ */
+class LatencyMonitor {
+ public:
+  static LatencyMonitor &Instance();
+
+  static bool IsEnabled();
+  void Enable();
+  void Disable();
+
+  // Returns the id of the event name, which is stable during the lifetime of
+  // the process.
+  uint32_t InternEvent(const std::string &name);
+
+  // Records an event of the current thread, which never blocks.
+  void Record(uint32_t event_id, uint64_t start_ns, uint64_t end_ns);
+
+  // Drains all the rings and returns the statistics of every event that has
+  // been recorded since the last reset, sorted by the total time. The
+  // statistics are cleared after the snapshot if reset is true.
+  std::vector<EventLatencyStats> Snapshot(bool reset = false);
+
+  void Reset();
+
+  // The number of events dropped because of full rings.
+  uint64_t DroppedEventNum() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  ~LatencyMonitor();
+
+ private:
+  struct EventRing;
+
+  LatencyMonitor() = default;
+
+  EventRing *GetThreadRing();
+  // Should be called with aggregate_mutex_ held.
+  void DrainRings();
+  void AggregateLoop();
+
+  std::mutex names_mutex_;
+  std::unordered_map<std::string, uint32_t> name_to_id_;
+  std::vector<std::string> names_;
+
+  std::mutex rings_mutex_;
+  std::list<std::shared_ptr<EventRing>> rings_;
+
+  std::mutex aggregate_mutex_;
+  std::vector<LatencyHistogram> histograms_;  // indexed by event id
+
+  std::atomic<uint64_t> dropped_{0};
+
+  std::mutex thread_mutex_;
+  std::condition_variable thread_cv_;
+  std::unique_ptr<std::thread> aggregate_thread_;
+  bool stop_{false};
+
+  DISABLE_COPY_AND_ASSIGN(LatencyMonitor);
+};
+
+}  // namespace platform
+}  // namespace paddle
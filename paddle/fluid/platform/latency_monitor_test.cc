@@ -0,0 +1,99 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/latency_monitor.h"
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(LatencyHistogram, Bucket) {
+  using H = LatencyHistogram;
+  size_t prev_idx = 0;
+  for (uint64_t ns = 1; ns < (1UL << 40); ns = ns * 3 / 2 + 1) {
+    size_t idx = H::BucketIndex(ns);
+    ASSERT_LT(idx, H::kBucketNum);
+    ASSERT_GE(idx, prev_idx);
+    ASSERT_LE(H::BucketLowerBound(idx), ns);
+    ASSERT_GT(H::BucketLowerBound(idx + 1), ns);
+    prev_idx = idx;
+  }
+  ASSERT_EQ(H::BucketIndex(UINT64_MAX), H::kBucketNum - 1);
+}
+
+TEST(LatencyHistogram, Percentile) {
+  LatencyHistogram histogram;
+  ASSERT_EQ(histogram.Percentile(0.5), 0UL);
+  for (uint64_t ns = 1; ns <= 10000; ++ns) {
+    histogram.Add(ns * 1000);
+  }
+  ASSERT_EQ(histogram.count(), 10000UL);
+  ASSERT_EQ(histogram.min_ns(), 1000UL);
+  ASSERT_EQ(histogram.max_ns(), 10000000UL);
+  // The relative error is less than 1 / kSubBucketNum
+  double p50 = histogram.Percentile(0.5);
+  double p99 = histogram.Percentile(0.99);
+  ASSERT_NEAR(p50, 5000000.0, 5000000.0 / LatencyHistogram::kSubBucketNum);
+  ASSERT_NEAR(p99, 9900000.0, 9900000.0 / LatencyHistogram::kSubBucketNum);
+  ASSERT_EQ(histogram.Percentile(1.0), histogram.max_ns());
+}
+
+TEST(LatencyMonitor, Snapshot) {
+  auto &monitor = LatencyMonitor::Instance();
+  monitor.Enable();
+  monitor.Reset();
+
+  uint32_t fast_id = monitor.InternEvent("fast_op");
+  uint32_t slow_id = monitor.InternEvent("slow_op");
+  ASSERT_NE(fast_id, slow_id);
+  ASSERT_EQ(monitor.InternEvent("fast_op"), fast_id);
+
+  const size_t thread_num = 4;
+  const size_t event_num = 1000;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&] {
+      ASSERT_EQ(monitor.InternEvent("slow_op"), slow_id);
+      for (size_t j = 0; j < event_num; ++j) {
+        monitor.Record(fast_id, 0, 1000);
+        monitor.Record(slow_id, 0, 1000000);
+      }
+    });
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+
+  auto stats = monitor.Snapshot();
+  ASSERT_EQ(stats.size(), 2UL);
+  // Sorted by the total time
+  ASSERT_EQ(stats[0].name_, "slow_op");
+  ASSERT_EQ(stats[1].name_, "fast_op");
+  ASSERT_EQ(monitor.DroppedEventNum(), 0UL);
+  ASSERT_EQ(stats[0].calls_, thread_num * event_num);
+  ASSERT_EQ(stats[1].calls_, thread_num * event_num);
+  ASSERT_DOUBLE_EQ(stats[0].p50_ms_, 1.0);
+  ASSERT_DOUBLE_EQ(stats[0].p99_ms_, 1.0);
+  ASSERT_DOUBLE_EQ(stats[1].max_ms_, 0.001);
+
+  monitor.Reset();
+  ASSERT_TRUE(monitor.Snapshot().empty());
+  monitor.Disable();
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,186 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <chrono>  // NOLINT
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/device_context.h"
+
+DEFINE_int32(mkldnn_blob_cache_benchmark_threads, 4,
+             "The number of threads running the benchmark.");
+DEFINE_int32(mkldnn_blob_cache_benchmark_runs, 2000,
+             "The times every thread runs the ops in the benchmark.");
+
+namespace paddle {
+namespace platform {
+
+static std::shared_ptr<void> MakeBlob(int value) {
+  return std::make_shared<int>(value);
+}
+
+static int BlobValue(const std::shared_ptr<void>& blob) {
+  return blob == nullptr ? -1 : *std::static_pointer_cast<int>(blob);
+}
+
+TEST(MKLDNNBlobCache, AppendBlobKey) {
+  std::string name = "conv2d-3-224-224";
+  EXPECT_EQ(AppendBlobKey(HashBlobKey(name), "@conv_pd"),
+            HashBlobKey(name + "@conv_pd"));
+  EXPECT_EQ(AppendBlobKey(AppendBlobKey(HashBlobKey(name), std::string("@p")),
+                          "reorder_p"),
+            HashBlobKey(name + "@preorder_p"));
+  EXPECT_NE(HashBlobKey(name), HashBlobKey(name + "-BWD"));
+}
+
+TEST(MKLDNNBlobCache, ShapeLRU) {
+  MKLDNNDeviceContext ctx(CPUPlace{});
+  set_cur_mkldnn_session_id(kMKLDNNSessionID_CacheClearing);
+  set_cur_input_shape_cache_capacity(2);
+
+  set_cur_input_shape_str("1-");
+  ctx.SetBlob("a", MakeBlob(1));
+  set_cur_input_shape_str("2-");
+  ctx.SetBlob("a", MakeBlob(2));
+  // Shape 1 is used after shape 2, so shape 2 is evicted by shape 3.
+  set_cur_input_shape_str("1-");
+  EXPECT_EQ(BlobValue(ctx.GetBlob("a")), 1);
+  set_cur_input_shape_str("3-");
+  ctx.SetBlob("a", MakeBlob(3));
+  EXPECT_EQ(ctx.GetShapeBlobSize(), 2UL);
+
+  set_cur_input_shape_str("1-");
+  EXPECT_EQ(BlobValue(ctx.GetBlob("a")), 1);
+  set_cur_input_shape_str("2-");
+  EXPECT_EQ(ctx.GetBlob("a"), nullptr);
+  set_cur_input_shape_str("3-");
+  EXPECT_EQ(BlobValue(ctx.GetBlob(HashBlobKey("a"))), 3);
+
+  set_cur_mkldnn_session_id(kMKLDNNSessionID_Default);
+  set_cur_input_shape_cache_capacity(0);
+  set_cur_input_shape_str("");
+}
+
+TEST(MKLDNNBlobCache, ThreadBlob) {
+  MKLDNNDeviceContext ctx(CPUPlace{});
+  BlobKey key = HashBlobKey("conv2d@conv_p");
+  ctx.SetThreadBlob(key, MakeBlob(1));
+  ctx.SetBlob(key, MakeBlob(2));
+  EXPECT_EQ(BlobValue(ctx.GetThreadBlob(key)), 1);
+
+  std::thread other([&] {
+    EXPECT_EQ(ctx.GetThreadBlob(key), nullptr);
+    EXPECT_EQ(BlobValue(ctx.GetBlob(key)), 2);
+    ctx.SetThreadBlob(key, MakeBlob(3));
+    EXPECT_EQ(BlobValue(ctx.GetThreadBlob(key)), 3);
+  });
+  other.join();
+  EXPECT_EQ(BlobValue(ctx.GetThreadBlob(key)), 1);
+
+  // The blobs of another context are not shared.
+  MKLDNNDeviceContext other_ctx(CPUPlace{});
+  EXPECT_EQ(other_ctx.GetThreadBlob(key), nullptr);
+
+  ctx.ResetBlobMap();
+  EXPECT_EQ(ctx.GetThreadBlob(key), nullptr);
+  EXPECT_EQ(ctx.GetBlob(key), nullptr);
+}
+
+// Runs 50 ops of an NLP model, whose inputs have random sequence lengths, in
+// several threads. Every op gets its primitive from the cache, and creates
+// it when missing, by the string keys of the handlers before, and by the
+// keys appended to the precomputed keys of the ops with the thread blobs.
+TEST(MKLDNNBlobCache, Benchmark) {
+  const int op_num = 50;
+  const int max_seq_len = 128;
+  MKLDNNDeviceContext ctx(CPUPlace{});
+  std::vector<std::string> op_names;
+  std::vector<BlobKey> op_keys;
+  for (int i = 0; i < op_num; ++i) {
+    op_names.push_back("fc-" + std::to_string(i) + "-768-768-fc_" +
+                       std::to_string(i) + ".tmp_1");
+    op_keys.push_back(HashBlobKey(op_names.back()));
+  }
+
+  auto run_string_keys = [&](std::mt19937* rng) {
+    std::string tid = std::to_string(
+        std::hash<std::thread::id>()(std::this_thread::get_id()));
+    int seq_len = (*rng)() % max_seq_len + 1;
+    for (int i = 0; i < op_num; ++i) {
+      std::string key = std::to_string(seq_len) + "-768-" + op_names[i] +
+                        "-t:" + tid + "@forward_p";
+      if (ctx.GetBlob(key) == nullptr) ctx.SetBlob(key, MakeBlob(i));
+    }
+  };
+  auto run_blob_keys = [&](std::mt19937* rng) {
+    int seq_len = (*rng)() % max_seq_len + 1;
+    for (int i = 0; i < op_num; ++i) {
+      BlobKey key = AppendBlobKey(
+          AppendBlobKey(op_keys[i], std::to_string(seq_len)), "@forward_p");
+      if (ctx.GetThreadBlob(key) == nullptr) {
+        ctx.SetThreadBlob(key, MakeBlob(i));
+      }
+    }
+  };
+
+  const int thread_num = FLAGS_mkldnn_blob_cache_benchmark_threads;
+  const int runs = FLAGS_mkldnn_blob_cache_benchmark_runs;
+  for (bool blob_keys : {false, true}) {
+    ctx.ResetBlobMap();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_num; ++t) {
+      threads.emplace_back([&, t] {
+        std::mt19937 rng(t);
+        for (int i = 0; i < runs; ++i) {
+          blob_keys ? run_blob_keys(&rng) : run_string_keys(&rng);
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    double us = std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    LOG(INFO) << thread_num << " threads, " << op_num
+              << " ops, blob_keys=" << blob_keys << ": " << us / runs
+              << " us/run";
+  }
+
+  // With the shape LRU the cache keeps the primitives of at most capacity
+  // sequence lengths.
+  const int capacity = 10;
+  set_cur_mkldnn_session_id(kMKLDNNSessionID_CacheClearing);
+  set_cur_input_shape_cache_capacity(capacity);
+  std::mt19937 rng(0);
+  for (int i = 0; i < runs; ++i) {
+    int seq_len = rng() % max_seq_len + 1;
+    set_cur_input_shape_str(std::to_string(seq_len) + "-");
+    for (int j = 0; j < op_num; ++j) {
+      BlobKey key = AppendBlobKey(op_keys[j], "@forward_p");
+      if (ctx.GetBlob(key) == nullptr) ctx.SetBlob(key, MakeBlob(j));
+    }
+  }
+  EXPECT_EQ(ctx.GetShapeBlobSize(), static_cast<size_t>(capacity));
+  set_cur_mkldnn_session_id(kMKLDNNSessionID_Default);
+  set_cur_input_shape_cache_capacity(0);
+  set_cur_input_shape_str("");
+}
+
+}  // namespace platform
+}  // namespace paddle
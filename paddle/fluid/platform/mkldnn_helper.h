@@ -15,6 +15,7 @@ limitations under the License. */
 
 #include <mkldnn.h>
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -211,5 +212,33 @@ inline std::string CreateKey(ArgTypes&&... args) {
   return key;
 }
 
+template <typename T>
+inline void AppendKey(BlobKey* key, const T& num) {
+  *key = AppendBlobKey(*key, std::to_string(num));
+}
+
+inline void AppendKey(BlobKey* key, const std::string& str) {
+  *key = AppendBlobKey(*key, str);
+}
+
+inline void AppendKey(BlobKey* key, const char* str) {
+  *key = AppendBlobKey(*key, str, std::strlen(str));
+}
+
+inline void AppendKey(BlobKey* key, const std::vector<int>& dims) {
+  for (size_t i = 0; i < dims.size(); i++) {
+    AppendKey(key, dims[i]);
+  }
+}
+
+// The same as HashBlobKey(CreateKey(args...)), without building the string.
+template <typename... ArgTypes>
+inline BlobKey CreateBlobKey(ArgTypes&&... args) {
+  BlobKey key = kBlobKeySeed;
+  using expand_type = int[];
+  expand_type{0, (AppendKey(&key, std::forward<ArgTypes>(args)), 0)...};
+  return key;
+}
+
 }  // namespace platform
 }  // namespace paddle
@@ -35,42 +35,43 @@ class MKLDNNHandlerT {
  public:
   MKLDNNHandlerT(const MKLDNNDeviceContext& dev_ctx, mkldnn::engine engine,
                  platform::Place cpu_place, const std::string& base_key)
+      : MKLDNNHandlerT(dev_ctx, engine, cpu_place, HashBlobKey(base_key)) {}
+
+  // base_key is created by CreateBlobKey, which builds no string.
+  MKLDNNHandlerT(const MKLDNNDeviceContext& dev_ctx, mkldnn::engine engine,
+                 platform::Place cpu_place, BlobKey base_key)
       : dev_ctx_(dev_ctx),
         engine_(engine),
         place_(cpu_place),
         key_common_(base_key),
+        key_(key_common_),
+        thread_blobs_(platform::get_cur_mkldnn_session_id() ==
+                      platform::kMKLDNNSessionID_Default),
         fwd_pd_(nullptr),
-        bwd_pd_(nullptr) {
-    if (platform::get_cur_mkldnn_session_id() !=
-        platform::kMKLDNNSessionID_Default) {
-      key_ = key_common_;
-    } else {
-      key_ = key_common_ + "-t:" + ThreadIDasStr();
-    }
-  }
+        bwd_pd_(nullptr) {}
 
   template <typename... Args>
   std::shared_ptr<TForward> AcquireForwardPrimitive(Args&&... args) {
-    const std::string key_p = key_ + "@forward_p";
+    const BlobKey key_p = AppendBlobKey(key_, "@forward_p");
     auto forward_p =
-        std::static_pointer_cast<TForward>(dev_ctx_.GetBlob(key_p));
+        std::static_pointer_cast<TForward>(this->GetLocalBlob(key_p));
     if (forward_p == nullptr) {
       forward_p =
           std::make_shared<TForward>(*fwd_pd_, std::forward<Args>(args)...);
-      dev_ctx_.SetBlob(key_p, forward_p);
+      this->SetLocalBlob(key_p, forward_p);
     }
     return forward_p;
   }
 
   template <typename... Args>
   std::shared_ptr<TBackward> AcquireBackwardPrimitive(Args&&... args) {
-    const std::string key_p = key_ + "@backward_p";
+    const BlobKey key_p = AppendBlobKey(key_, "@backward_p");
     auto backward_p =
-        std::static_pointer_cast<TBackward>(dev_ctx_.GetBlob(key_p));
+        std::static_pointer_cast<TBackward>(this->GetLocalBlob(key_p));
     if (backward_p == nullptr) {
       backward_p =
           std::make_shared<TBackward>(*bwd_pd_, std::forward<Args>(args)...);
-      dev_ctx_.SetBlob(key_p, backward_p);
+      this->SetLocalBlob(key_p, backward_p);
     }
     return backward_p;
   }
@@ -120,7 +121,7 @@ class MKLDNNHandlerT {
     // Forward PD has to be passed to Grad op that
     // may be executed by diffrent thread, hence
     // for that one we use key that does not contain TID
-    const std::string key_pd = key_common_ + "@forward_pd";
+    const BlobKey key_pd = AppendBlobKey(key_common_, "@forward_pd");
     fwd_pd_ = std::static_pointer_cast<typename TForward::primitive_desc>(
         dev_ctx_.GetBlob(key_pd));
     if (fwd_pd_ == nullptr) {
@@ -140,41 +141,58 @@ class MKLDNNHandlerT {
 
   template <typename... Args>
   void AcquireBackwardPrimitiveDescriptor(Args&&... args) {
-    const std::string key_fwd_pd = key_common_ + "@forward_pd";
+    const BlobKey key_fwd_pd = AppendBlobKey(key_common_, "@forward_pd");
     fwd_pd_ = std::static_pointer_cast<typename TForward::primitive_desc>(
         dev_ctx_.GetBlob(key_fwd_pd));
     PADDLE_ENFORCE_NOT_NULL(fwd_pd_);
-    const std::string key_pd = key_ + "@backward_pd";
+    const BlobKey key_pd = AppendBlobKey(key_, "@backward_pd");
     bwd_pd_ = std::static_pointer_cast<typename TBackward::primitive_desc>(
-        dev_ctx_.GetBlob(key_pd));
+        this->GetLocalBlob(key_pd));
     if (bwd_pd_ == nullptr) {
       auto bwd_desc = typename TBackward::desc(std::forward<Args>(args)...);
       bwd_pd_ = std::make_shared<typename TBackward::primitive_desc>(
           bwd_desc, engine_, *fwd_pd_);
-      dev_ctx_.SetBlob(key_pd, bwd_pd_);
+      this->SetLocalBlob(key_pd, bwd_pd_);
     }
   }
 
   std::shared_ptr<mkldnn::memory> AcquireMemoryFromPrimitive(
       mkldnn::memory::primitive_desc mdp, void* ptr,
       const std::string& suffix) {
-    auto local_key = key_ + suffix;
+    const BlobKey local_key = AppendBlobKey(key_, suffix);
     auto mem_p =
-        std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
+        std::static_pointer_cast<mkldnn::memory>(this->GetLocalBlob(local_key));
     if (mem_p == nullptr) {
       mem_p = std::make_shared<mkldnn::memory>(mdp, ptr);
-      dev_ctx_.SetBlob(local_key, mem_p);
+      this->SetLocalBlob(local_key, mem_p);
     } else {
       mem_p->set_data_handle(ptr);
     }
     return mem_p;
   }
 
+  // The blobs of key_ are only used by the current thread in the default
+  // session, they are kept in the thread blob map instead of adding the thread
+  // id to their keys. The blobs of key_common_ may be used by the grad ops in
+  // the other threads, so they are always kept in the shared blob map.
+  std::shared_ptr<void> GetLocalBlob(BlobKey key) const {
+    return thread_blobs_ ? dev_ctx_.GetThreadBlob(key) : dev_ctx_.GetBlob(key);
+  }
+
+  void SetLocalBlob(BlobKey key, std::shared_ptr<void> data) const {
+    if (thread_blobs_) {
+      dev_ctx_.SetThreadBlob(key, std::move(data));
+    } else {
+      dev_ctx_.SetBlob(key, std::move(data));
+    }
+  }
+
   const MKLDNNDeviceContext& dev_ctx_;
   mkldnn::engine engine_;
   platform::Place place_;
-  std::string key_;
-  std::string key_common_;
+  BlobKey key_common_;
+  BlobKey key_;
+  bool thread_blobs_;
   std::shared_ptr<typename TForward::primitive_desc> fwd_pd_;
   std::shared_ptr<typename TBackward::primitive_desc> bwd_pd_;
 };
@@ -184,14 +202,12 @@ class MKLDNNHandler {
  public:
   MKLDNNHandler(const MKLDNNDeviceContext& dev_ctx, mkldnn::engine engine,
                 const std::string& base_key)
-      : dev_ctx_(dev_ctx), engine_(engine), key_common_(base_key) {
-    if (platform::get_cur_mkldnn_session_id() !=
-        platform::kMKLDNNSessionID_Default) {
-      key_ = key_common_;
-    } else {
-      key_ = key_common_ + "-t:" + ThreadIDasStr();
-    }
-  }
+      : dev_ctx_(dev_ctx),
+        engine_(engine),
+        key_common_(HashBlobKey(base_key)),
+        key_(key_common_),
+        thread_blobs_(platform::get_cur_mkldnn_session_id() ==
+                      platform::kMKLDNNSessionID_Default) {}
 
   std::shared_ptr<mkldnn::memory> AcquireSrcMemory(
       const mkldnn::memory::desc& md, void* ptr) {
@@ -216,12 +232,12 @@ class MKLDNNHandler {
   std::shared_ptr<mkldnn::memory> AcquireMemoryFromPrimitive(
       mkldnn::memory::primitive_desc mdp, void* ptr,
       const std::string& suffix) {
-    auto local_key = key_ + suffix;
+    const BlobKey local_key = AppendBlobKey(key_, suffix);
     auto mem_p =
-        std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
+        std::static_pointer_cast<mkldnn::memory>(this->GetLocalBlob(local_key));
     if (mem_p == nullptr) {
       mem_p = std::make_shared<mkldnn::memory>(mdp, ptr);
-      dev_ctx_.SetBlob(local_key, mem_p);
+      this->SetLocalBlob(local_key, mem_p);
     } else {
       mem_p->set_data_handle(ptr);
     }
@@ -234,20 +250,21 @@ class MKLDNNHandler {
       const mkldnn::memory::desc& md, void* ptr, const std::string& suffix,
       user_function custom_func = {}) {
     /*Generate key*/
-    auto local_key = key_ + suffix;
+    const BlobKey local_key = AppendBlobKey(key_, suffix);
     auto mem_p =
-        std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
+        std::static_pointer_cast<mkldnn::memory>(this->GetLocalBlob(local_key));
     if (mem_p == nullptr) {
       // Call custom reorder/preprocessing func if available
       if (custom_func) {
         auto reordered_data = custom_func(reinterpret_cast<const float*>(ptr));
-        dev_ctx_.SetBlob(local_key + "-custom_reorder", reordered_data);
+        this->SetLocalBlob(AppendBlobKey(local_key, "-custom_reorder"),
+                           reordered_data);
         ptr = reinterpret_cast<void*>(reordered_data.get());
       }
 
       mem_p = std::make_shared<mkldnn::memory>(
           mkldnn::memory::primitive_desc{md, engine_}, ptr);
-      dev_ctx_.SetBlob(local_key, mem_p);
+      this->SetLocalBlob(local_key, mem_p);
     } else {
       mem_p->set_data_handle(ptr);
     }
@@ -258,15 +275,15 @@ class MKLDNNHandler {
       const std::vector<int>& dims, const mkldnn::memory::data_type dtype,
       const MKLDNNMemoryFormat& fmt, void* ptr, const std::string& suffix) {
     /*Generate key*/
-    auto local_key = key_ + suffix;
+    const BlobKey local_key = AppendBlobKey(key_, suffix);
     auto mem_p =
-        std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
+        std::static_pointer_cast<mkldnn::memory>(this->GetLocalBlob(local_key));
     if (mem_p == nullptr) {
       auto md = mkldnn::memory::desc(dims, dtype, fmt);
 
       mem_p = std::make_shared<mkldnn::memory>(
           mkldnn::memory::primitive_desc{md, engine_}, ptr);
-      dev_ctx_.SetBlob(local_key, mem_p);
+      this->SetLocalBlob(local_key, mem_p);
     } else {
       mem_p->set_data_handle(ptr);
     }
@@ -278,18 +295,18 @@ class MKLDNNHandler {
       const std::shared_ptr<mkldnn::memory>& target_memory_p,
       const std::string& suffix,
       std::vector<mkldnn::primitive>& pipeline) {  // NOLINT
-    auto local_key = key_ + suffix;
-    auto key_reorder_p = key_ + suffix + "reorder_p";
+    const BlobKey local_key = AppendBlobKey(key_, suffix);
+    const BlobKey key_reorder_p = AppendBlobKey(local_key, "reorder_p");
 
     auto stored_reorder_p = std::static_pointer_cast<mkldnn::reorder>(
-        dev_ctx_.GetBlob(key_reorder_p));
+        this->GetLocalBlob(key_reorder_p));
 
     if (stored_reorder_p) {
       pipeline.push_back(*stored_reorder_p);
     } else {
       auto reorder_p =
           std::make_shared<mkldnn::reorder>(*user_memory_p, *target_memory_p);
-      dev_ctx_.SetBlob(key_reorder_p, reorder_p);
+      this->SetLocalBlob(key_reorder_p, reorder_p);
       pipeline.push_back(*reorder_p);
     }
 
@@ -305,11 +322,11 @@ class MKLDNNHandler {
       bool is_persistent = false, bool is_INT8 = false,
       std::vector<float> scale_data = {1.0f}, int mask = 0) {
     // create reorder primitive if the input format is not the preferred one
-    auto local_key = key_ + suffix;
-    auto key_reorder_p = key_ + suffix + "reorder_p";
+    const BlobKey local_key = AppendBlobKey(key_, suffix);
+    const BlobKey key_reorder_p = AppendBlobKey(local_key, "reorder_p");
 
     auto target_memory_p =
-        std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
+        std::static_pointer_cast<mkldnn::memory>(this->GetLocalBlob(local_key));
     if (target_memory_p == nullptr) {
       target_memory_p = user_memory_p;
       std::shared_ptr<mkldnn::primitive> reorder_p;
@@ -329,14 +346,14 @@ class MKLDNNHandler {
           reorder_p = std::make_shared<mkldnn::reorder>(*user_memory_p,
                                                         *target_memory_p);
         }
-        dev_ctx_.SetBlob(key_reorder_p, reorder_p);
+        this->SetLocalBlob(key_reorder_p, reorder_p);
         pipeline.push_back(*reorder_p);
       }
-      dev_ctx_.SetBlob(local_key, target_memory_p);
+      this->SetLocalBlob(local_key, target_memory_p);
     } else if (!is_persistent) {
       // Make reorder if needed
       auto reorder_p = std::static_pointer_cast<mkldnn::reorder>(
-          dev_ctx_.GetBlob(key_reorder_p));
+          this->GetLocalBlob(key_reorder_p));
       if (reorder_p != nullptr) {
         pipeline.push_back(*reorder_p);
       }
@@ -345,10 +362,27 @@ class MKLDNNHandler {
   }
 
  protected:
+  // The blobs of key_ are only used by the current thread in the default
+  // session, they are kept in the thread blob map instead of adding the thread
+  // id to their keys. The blobs of key_common_ may be used by the grad ops in
+  // the other threads, so they are always kept in the shared blob map.
+  std::shared_ptr<void> GetLocalBlob(BlobKey key) const {
+    return thread_blobs_ ? dev_ctx_.GetThreadBlob(key) : dev_ctx_.GetBlob(key);
+  }
+
+  void SetLocalBlob(BlobKey key, std::shared_ptr<void> data) const {
+    if (thread_blobs_) {
+      dev_ctx_.SetThreadBlob(key, std::move(data));
+    } else {
+      dev_ctx_.SetBlob(key, std::move(data));
+    }
+  }
+
   const MKLDNNDeviceContext& dev_ctx_;
   mkldnn::engine engine_;
-  std::string key_;
-  std::string key_common_;
+  BlobKey key_common_;
+  BlobKey key_;
+  bool thread_blobs_;
 };
 
 class SumMKLDNNHandler : public MKLDNNHandler {
@@ -360,10 +394,10 @@ class SumMKLDNNHandler : public MKLDNNHandler {
   std::shared_ptr<mkldnn::sum::primitive_desc> AcquireSumPrimitiveDescriptor(
       const std::vector<std::shared_ptr<mkldnn::memory>>& src_mems,
       const std::vector<float>& scales, const mkldnn::memory::desc& dst_md) {
-    const std::string key_sum_pd = key_ + "@sum_pd";
+    const BlobKey key_sum_pd = AppendBlobKey(key_, "@sum_pd");
 
     sum_pd_ = std::static_pointer_cast<mkldnn::sum::primitive_desc>(
-        dev_ctx_.GetBlob(key_sum_pd));
+        this->GetLocalBlob(key_sum_pd));
     if (sum_pd_ == nullptr) {
       // Get vector of inputs primitive descriptors
       std::vector<mkldnn::memory::primitive_desc> src_pds;
@@ -372,7 +406,7 @@ class SumMKLDNNHandler : public MKLDNNHandler {
       }
 
       sum_pd_.reset(new mkldnn::sum::primitive_desc(dst_md, scales, src_pds));
-      dev_ctx_.SetBlob(key_sum_pd, sum_pd_);
+      this->SetLocalBlob(key_sum_pd, sum_pd_);
     }
 
     return sum_pd_;
@@ -391,12 +425,12 @@ class SumMKLDNNHandler : public MKLDNNHandler {
   std::shared_ptr<mkldnn::sum> AcquireSum(
       std::shared_ptr<mkldnn::memory> dst_memory,
       std::vector<mkldnn::primitive::at>* inputs) {
-    auto prim_key = key_ + "@sum_p";
+    const BlobKey prim_key = AppendBlobKey(key_, "@sum_p");
     auto sum_p =
-        std::static_pointer_cast<mkldnn::sum>(dev_ctx_.GetBlob(prim_key));
+        std::static_pointer_cast<mkldnn::sum>(this->GetLocalBlob(prim_key));
     if (sum_p == nullptr) {
       sum_p = std::make_shared<mkldnn::sum>(*(sum_pd_), *inputs, *(dst_memory));
-      dev_ctx_.SetBlob(prim_key, sum_p);
+      this->SetLocalBlob(prim_key, sum_p);
     }
     return sum_p;
   }
@@ -420,8 +454,8 @@ class ActivationMKLDNNHandler
       : platform::MKLDNNHandlerT<T, mkldnn::eltwise_forward,
                                  mkldnn::eltwise_backward>(
             dev_ctx, dev_ctx.GetEngine(), cpu_place,
-            platform::CreateKey(dims, algorithm, fmt, alpha, beta,
-                                unique_name)) {
+            platform::CreateBlobKey(dims, algorithm, fmt, alpha, beta,
+                                    unique_name)) {
     auto md = mkldnn::memory::desc(dims, platform::MKLDNNGetDataType<T>(), fmt);
 
     this->AcquireForwardPrimitiveDescriptor(
@@ -441,8 +475,8 @@ class ActivationMKLDNNHandler
       : platform::MKLDNNHandlerT<T, mkldnn::eltwise_forward,
                                  mkldnn::eltwise_backward>(
             dev_ctx, dev_ctx.GetEngine(), cpu_place,
-            platform::CreateKey(dims, algorithm, fmt, alpha, beta,
-                                unique_name)) {
+            platform::CreateBlobKey(dims, algorithm, fmt, alpha, beta,
+                                    unique_name)) {
     auto diff_dst_md = platform::MKLDNNMemDesc(
         dims, platform::MKLDNNGetDataType<T>(), diff_fmt);
     auto src_md =
@@ -473,7 +507,8 @@ class LRNMKLDNNHandler
 
       : platform::MKLDNNHandlerT<T, mkldnn::lrn_forward, mkldnn::lrn_backward>(
             dev_ctx, dev_ctx.GetEngine(), cpu_place,
-            platform::CreateKey(dims, n, alpha, beta, k, fmt, unique_name)) {
+            platform::CreateBlobKey(dims, n, alpha, beta, k, fmt,
+                                    unique_name)) {
     auto src_md =
         mkldnn::memory::desc(dims, platform::MKLDNNGetDataType<T>(), fmt);
     this->AcquireForwardPrimitiveDescriptor(
@@ -491,7 +526,8 @@ class LRNMKLDNNHandler
 
       : platform::MKLDNNHandlerT<T, mkldnn::lrn_forward, mkldnn::lrn_backward>(
             dev_ctx, dev_ctx.GetEngine(), cpu_place,
-            platform::CreateKey(dims, n, alpha, beta, k, fmt, unique_name)) {
+            platform::CreateBlobKey(dims, n, alpha, beta, k, fmt,
+                                    unique_name)) {
     auto src_md =
         mkldnn::memory::desc(dims, platform::MKLDNNGetDataType<T>(), fmt);
     auto diff_md =
@@ -533,8 +569,8 @@ class PoolingMKLDNNHandler : public MKLDNNHandlerT<T, mkldnn::pooling_forward,
       : platform::MKLDNNHandlerT<T, mkldnn::pooling_forward,
                                  mkldnn::pooling_backward>(
             dev_ctx, dev_ctx.GetEngine(), cpu_place,
-            platform::CreateKey(src_dims, pooling_type, ksize, strides,
-                                paddings, dt, fmt, unique_name)) {
+            platform::CreateBlobKey(src_dims, pooling_type, ksize, strides,
+                                    paddings, dt, fmt, unique_name)) {
     auto src_md = mkldnn::memory::desc(src_dims, dt, fmt);
     /* create memory descriptor for pooling without specified format
      * ('any') which lets a primitive (pooling in this case) choose
@@ -571,8 +607,9 @@ class PoolingMKLDNNHandler : public MKLDNNHandlerT<T, mkldnn::pooling_forward,
       : platform::MKLDNNHandlerT<T, mkldnn::pooling_forward,
                                  mkldnn::pooling_backward>(
             dev_ctx, dev_ctx.GetEngine(), cpu_place,
-            platform::CreateKey(diff_src_dims, pooling_type, ksize, strides,
-                                paddings, dt, fmt, unique_name)) {
+            platform::CreateBlobKey(diff_src_dims, pooling_type, ksize,
+                                    strides, paddings, dt, fmt,
+                                    unique_name)) {
     auto diff_dst_md = mkldnn::memory::desc(
         diff_dst_dims, platform::MKLDNNGetDataType<T>(), diff_dst_fmt);
     auto diff_src_md =
@@ -592,7 +629,7 @@ class PoolingMKLDNNHandler : public MKLDNNHandlerT<T, mkldnn::pooling_forward,
     // Pooling PD has to be passed to Grad op that
     // may be executed by diffrent thread, hence
     // for that one we use key that does not contain TID
-    auto local_key = this->key_common_ + "@workspace";
+    const BlobKey local_key = AppendBlobKey(this->key_common_, "@workspace");
     auto mem_p = std::static_pointer_cast<mkldnn::memory>(
         this->dev_ctx_.GetBlob(local_key));
     if (mem_p == nullptr) {
@@ -643,9 +680,9 @@ class TransposeMKLDNNHandler : public MKLDNNHandler {
 
   std::shared_ptr<mkldnn::memory> AcquireSrcMemory(
       const MKLDNNMemoryFormat& fmt, void* ptr) {
-    auto local_key = key_ + "@user_src_mem_p";
+    const BlobKey local_key = AppendBlobKey(key_, "@user_src_mem_p");
     auto mem_p =
-        std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
+        std::static_pointer_cast<mkldnn::memory>(this->GetLocalBlob(local_key));
     if (mem_p == nullptr) {
       // Make memory descriptor using input format, unless it
       // cannot be trusted (nchw) then make up memory fmt manually
@@ -658,7 +695,7 @@ class TransposeMKLDNNHandler : public MKLDNNHandler {
                         : Axis2MemoryDesc(dims_, logical_axis_);
       mem_p = std::make_shared<mkldnn::memory>(
           mkldnn::memory::primitive_desc{src_md, engine_}, ptr);
-      dev_ctx_.SetBlob(local_key, mem_p);
+      this->SetLocalBlob(local_key, mem_p);
     } else {
       mem_p->set_data_handle(ptr);
     }
@@ -667,9 +704,9 @@ class TransposeMKLDNNHandler : public MKLDNNHandler {
 
   std::shared_ptr<mkldnn::memory> AcquireDstMemory(framework::Tensor* output,
                                                    platform::Place place) {
-    auto local_key = key_ + "@user_dst_mem_p";
+    const BlobKey local_key = AppendBlobKey(key_, "@user_dst_mem_p");
     auto mem_p =
-        std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
+        std::static_pointer_cast<mkldnn::memory>(this->GetLocalBlob(local_key));
     if (mem_p == nullptr) {
       auto dst_mdp = mkldnn::memory::primitive_desc{
           Axis2MemoryDesc(dims_, axis_), engine_};
@@ -677,7 +714,7 @@ class TransposeMKLDNNHandler : public MKLDNNHandler {
       auto dst_data = output->mutable_data<float>(place, dst_mdp.get_size());
 
       mem_p = std::make_shared<mkldnn::memory>(dst_mdp, dst_data);
-      dev_ctx_.SetBlob(local_key, mem_p);
+      this->SetLocalBlob(local_key, mem_p);
     } else {
       auto dst_data = output->mutable_data<float>(place);
       mem_p->set_data_handle(dst_data);
@@ -688,13 +725,13 @@ class TransposeMKLDNNHandler : public MKLDNNHandler {
   std::shared_ptr<mkldnn::reorder> AcquireTranspose(
       std::shared_ptr<mkldnn::memory> dst_memory_p,
       std::shared_ptr<mkldnn::memory> src_memory_p) {
-    auto prim_key = key_ + "@transpose_p";
+    const BlobKey prim_key = AppendBlobKey(key_, "@transpose_p");
     auto transpose_p =
-        std::static_pointer_cast<mkldnn::reorder>(dev_ctx_.GetBlob(prim_key));
+        std::static_pointer_cast<mkldnn::reorder>(this->GetLocalBlob(prim_key));
     if (transpose_p == nullptr) {
       transpose_p =
           std::make_shared<mkldnn::reorder>(*(src_memory_p), *(dst_memory_p));
-      dev_ctx_.SetBlob(prim_key, transpose_p);
+      this->SetLocalBlob(prim_key, transpose_p);
     }
     return transpose_p;
   }
@@ -755,9 +792,9 @@ class ReorderMKLDNNHandler : public MKLDNNHandler {
   std::shared_ptr<mkldnn::memory> AcquireDstMemory(
       framework::Tensor* output, const MKLDNNMemoryFormat& fmt,
       platform::Place place) {
-    auto local_key = key_ + "@user_dst_mem_p";
+    const BlobKey local_key = AppendBlobKey(key_, "@user_dst_mem_p");
     auto mem_p =
-        std::static_pointer_cast<mkldnn::memory>(dev_ctx_.GetBlob(local_key));
+        std::static_pointer_cast<mkldnn::memory>(this->GetLocalBlob(local_key));
     if (mem_p == nullptr) {
       auto dst_md = platform::MKLDNNMemDesc(dims_, dtype_, fmt);
       auto dst_mdp = mkldnn::memory::primitive_desc{dst_md, engine_};
@@ -765,7 +802,7 @@ class ReorderMKLDNNHandler : public MKLDNNHandler {
       auto dst_data = output->mutable_data(place, vtype_);
 
       mem_p = std::make_shared<mkldnn::memory>(dst_mdp, dst_data);
-      dev_ctx_.SetBlob(local_key, mem_p);
+      this->SetLocalBlob(local_key, mem_p);
     } else {
       auto dst_data = output->mutable_data(place, vtype_);
       mem_p->set_data_handle(dst_data);
@@ -776,13 +813,13 @@ class ReorderMKLDNNHandler : public MKLDNNHandler {
   std::shared_ptr<mkldnn::reorder> AcquireReorder(
       std::shared_ptr<mkldnn::memory> dst_memory_p,
       std::shared_ptr<mkldnn::memory> src_memory_p) {
-    auto prim_key = key_ + "@reorder_p";
+    const BlobKey prim_key = AppendBlobKey(key_, "@reorder_p");
     auto reorder_p =
-        std::static_pointer_cast<mkldnn::reorder>(dev_ctx_.GetBlob(prim_key));
+        std::static_pointer_cast<mkldnn::reorder>(this->GetLocalBlob(prim_key));
     if (reorder_p == nullptr) {
       reorder_p =
           std::make_shared<mkldnn::reorder>(*(src_memory_p), *(dst_memory_p));
-      dev_ctx_.SetBlob(prim_key, reorder_p);
+      this->SetLocalBlob(prim_key, reorder_p);
     }
     return reorder_p;
   }
@@ -828,7 +865,7 @@ class ConvMKLDNNTemplateHandler : public MKLDNNHandler {
         conv_bwd_data_pd_(conv_bwd_data_pd) {
     // If we are in Grad operatgor then update a key with BWD suffix to
     // distinguish from FWD memory primitives
-    key_ += "-BWD";
+    key_ = AppendBlobKey(key_, "-BWD");
   }
 
   size_t GetDstMemorySize() const {
@@ -1010,7 +1047,7 @@ class ConvMKLDNNTemplateHandler : public MKLDNNHandler {
     // Conv PD has to be passed to Grad op that
     // may be exxecuted by diffrent thread, hence
     // for that one we use key that does not contain TID
-    const std::string key_conv_pd = key_common_ + "@conv_pd";
+    const BlobKey key_conv_pd = AppendBlobKey(key_common_, "@conv_pd");
 
     conv_pd_ = std::static_pointer_cast<typename forward_t::primitive_desc>(
         dev_ctx_.GetBlob(key_conv_pd));
@@ -1054,14 +1091,14 @@ class ConvMKLDNNTemplateHandler : public MKLDNNHandler {
       std::shared_ptr<mkldnn::memory> src_memory_p,
       std::shared_ptr<mkldnn::memory> weights_memory_p,
       std::shared_ptr<mkldnn::memory> dst_memory_p) {
-    auto prim_key = key_ + "@conv_p";
+    const BlobKey prim_key = AppendBlobKey(key_, "@conv_p");
     auto conv_p =
-        std::static_pointer_cast<forward_t>(dev_ctx_.GetBlob(prim_key));
+        std::static_pointer_cast<forward_t>(this->GetLocalBlob(prim_key));
     if (conv_p == nullptr) {
       conv_p = std::make_shared<forward_t>(*conv_pd_, *src_memory_p,
                                            *weights_memory_p, *dst_memory_p);
 
-      dev_ctx_.SetBlob(prim_key, conv_p);
+      this->SetLocalBlob(prim_key, conv_p);
     }
     return conv_p;
   }
@@ -1071,15 +1108,15 @@ class ConvMKLDNNTemplateHandler : public MKLDNNHandler {
       std::shared_ptr<mkldnn::memory> weights_memory_p,
       std::shared_ptr<mkldnn::memory> bias_memory_p,
       std::shared_ptr<mkldnn::memory> dst_memory_p) {
-    auto prim_key = key_ + "@conv_p";
+    const BlobKey prim_key = AppendBlobKey(key_, "@conv_p");
     auto conv_p =
-        std::static_pointer_cast<forward_t>(dev_ctx_.GetBlob(prim_key));
+        std::static_pointer_cast<forward_t>(this->GetLocalBlob(prim_key));
     if (conv_p == nullptr) {
       conv_p = std::make_shared<forward_t>(*conv_pd_, *src_memory_p,
                                            *weights_memory_p, *bias_memory_p,
                                            *dst_memory_p);
 
-      dev_ctx_.SetBlob(prim_key, conv_p);
+      this->SetLocalBlob(prim_key, conv_p);
     }
     return conv_p;
   }
@@ -1088,15 +1125,15 @@ class ConvMKLDNNTemplateHandler : public MKLDNNHandler {
       std::shared_ptr<mkldnn::memory> src_memory_p,
       std::shared_ptr<mkldnn::memory> diff_dst_memory_p,
       std::shared_ptr<mkldnn::memory> diff_weights_memory_p) {
-    auto prim_key = key_ + "@conv_bwd_weights_p";
+    const BlobKey prim_key = AppendBlobKey(key_, "@conv_bwd_weights_p");
     auto conv_bwd_weights_p = std::static_pointer_cast<backward_weights_t>(
-        dev_ctx_.GetBlob(prim_key));
+        this->GetLocalBlob(prim_key));
     if (conv_bwd_weights_p == nullptr) {
       // create backward conv primitive for weights
       conv_bwd_weights_p = std::make_shared<backward_weights_t>(
           *conv_bwd_weights_pd_, *src_memory_p, *diff_dst_memory_p,
           *diff_weights_memory_p);
-      dev_ctx_.SetBlob(prim_key, conv_bwd_weights_p);
+      this->SetLocalBlob(prim_key, conv_bwd_weights_p);
     }
     return conv_bwd_weights_p;
   }
@@ -1105,14 +1142,14 @@ class ConvMKLDNNTemplateHandler : public MKLDNNHandler {
       std::shared_ptr<mkldnn::memory> diff_dst_memory_p,
       std::shared_ptr<mkldnn::memory> weights_memory_p,
       std::shared_ptr<mkldnn::memory> diff_src_memory_p) {
-    auto prim_key = key_ + "@conv_bwd_data_p";
+    const BlobKey prim_key = AppendBlobKey(key_, "@conv_bwd_data_p");
     auto conv_bwd_data_p =
-        std::static_pointer_cast<backward_data_t>(dev_ctx_.GetBlob(prim_key));
+        std::static_pointer_cast<backward_data_t>(this->GetLocalBlob(prim_key));
     if (conv_bwd_data_p == nullptr) {
       conv_bwd_data_p = std::make_shared<backward_data_t>(
           *conv_bwd_data_pd_, *diff_dst_memory_p, *weights_memory_p,
           *diff_src_memory_p);
-      dev_ctx_.SetBlob(prim_key, conv_bwd_data_p);
+      this->SetLocalBlob(prim_key, conv_bwd_data_p);
     }
     return conv_bwd_data_p;
   }
@@ -0,0 +1,93 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include "paddle/fluid/platform/cpu_helper.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace paddle {
+namespace platform {
+
+// The minimal work of a chunk, roughly in the number of simple arithmetic
+// operations, below which forking a thread costs more than it saves.
+constexpr int64_t kParallelForMinWork = 32 * 1024;
+
+/*
+ * @brief The grain size of ParallelFor for the iterations which each cost
+ * about cost_per_iter simple operations.
+ */
+inline int64_t ParallelForGrainSize(int64_t cost_per_iter) {
+  return std::max<int64_t>(
+      1, kParallelForMinWork / std::max<int64_t>(1, cost_per_iter));
+}
+
+/*
+ * @brief Call f(chunk_begin, chunk_end) on the disjoint chunks of
+ * [begin, end) with the threads set by SetNumThreads in the calling thread.
+ *
+ * Each chunk has at least grain_size iterations, so the range runs in the
+ * calling thread if it is shorter than two grains. It also runs serially if
+ * it is already in a parallel region, e.g. nested in another ParallelFor or
+ * called from a thread of MKL, to not oversubscribe the cores. f must not
+ * depend on how the range is chunked. The first exception thrown by f is
+ * rethrown after all the chunks are done.
+ */
+template <typename Function>
+void ParallelFor(int64_t begin, int64_t end, int64_t grain_size,
+                 const Function& f) {
+  if (begin >= end) {
+    return;
+  }
+#ifdef _OPENMP
+  grain_size = std::max<int64_t>(1, grain_size);
+  int64_t num_chunks = std::min<int64_t>(
+      GetNumThreads(), (end - begin + grain_size - 1) / grain_size);
+  if (num_chunks > 1 && !omp_in_parallel()) {
+    std::exception_ptr error;
+#pragma omp parallel num_threads(static_cast<int>(num_chunks))
+    {
+      int64_t num_threads = omp_get_num_threads();
+      int64_t tid = omp_get_thread_num();
+      int64_t chunk_size = (end - begin + num_threads - 1) / num_threads;
+      int64_t chunk_begin = begin + tid * chunk_size;
+      int64_t chunk_end = std::min(end, chunk_begin + chunk_size);
+      if (chunk_begin < chunk_end) {
+        try {
+          f(chunk_begin, chunk_end);
+        } catch (...) {
+#pragma omp critical(paddle_parallel_for_error)
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return;
+  }
+#endif
+  f(begin, end);
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,76 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/parallel_for.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(ParallelFor, CoverRange) {
+  SetNumThreads(4);
+  for (int64_t n : {0, 1, 7, 1000}) {
+    std::vector<int> visits(n, 0);
+    std::atomic<int64_t> num_chunks(0);
+    ParallelFor(0, n, 3, [&](int64_t begin, int64_t end) {
+      EXPECT_LT(begin, end);
+      ++num_chunks;
+      for (int64_t i = begin; i < end; ++i) {
+        ++visits[i];
+      }
+    });
+    for (int64_t i = 0; i < n; ++i) {
+      EXPECT_EQ(visits[i], 1);
+    }
+    EXPECT_LE(num_chunks.load(), 4);
+  }
+  SetNumThreads(1);
+}
+
+TEST(ParallelFor, Nested) {
+  SetNumThreads(4);
+  std::vector<int64_t> sums(64, 0);
+  ParallelFor(0, 64, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      ParallelFor(0, 100, 1, [&](int64_t b, int64_t e) {
+        // The nested loop runs in one chunk.
+        EXPECT_EQ(b, 0);
+        EXPECT_EQ(e, 100);
+        sums[i] += e - b;
+      });
+    }
+  });
+  for (auto sum : sums) {
+    EXPECT_EQ(sum, 100);
+  }
+  SetNumThreads(1);
+}
+
+TEST(ParallelFor, Exception) {
+  SetNumThreads(4);
+  EXPECT_THROW(ParallelFor(0, 100, 1,
+                           [](int64_t begin, int64_t end) {
+                             if (begin <= 50 && 50 < end) {
+                               throw std::runtime_error("error");
+                             }
+                           }),
+               std::runtime_error);
+  SetNumThreads(1);
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/platform/profiler.h"
 #include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <limits>
 #include <map>
@@ -29,6 +30,7 @@ limitations under the License. */
 #include "glog/logging.h"
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/platform/device_tracer.h"
+#include "paddle/fluid/platform/latency_monitor.h"
 #include "paddle/fluid/platform/port.h"
 #include "paddle/fluid/string/printf.h"
 
@@ -62,6 +64,9 @@ static std::mutex g_all_mem_event_lists_mutex;
 static thread_local int32_t g_mem_thread_id;
 static uint32_t g_mem_next_thread_id = 0;
 
+static std::atomic<uint64_t> g_infer_shape_cache_hits{0};
+static std::atomic<uint64_t> g_infer_shape_cache_misses{0};
+
 inline uint64_t GetTimeInNsec() {
   using clock = std::conditional<std::chrono::high_resolution_clock::is_steady,
                                  std::chrono::high_resolution_clock,
@@ -137,11 +142,17 @@ void PopEvent(const std::string &name) {
 }
 
 RecordEvent::RecordEvent(const std::string &name)
-    : is_enabled_(false), start_ns_(PosixInNsec()) {
+    : is_enabled_(false), start_ns_(0), is_monitored_(false) {
+  if (LatencyMonitor::IsEnabled()) {
+    is_monitored_ = true;
+    monitor_event_id_ = LatencyMonitor::Instance().InternEvent(name);
+    monitor_start_ns_ = MonotonicNsec();
+  }
   if (g_state == ProfilerState::kDisabled) return;
   // lock is not needed, the code below is thread-safe
 
   is_enabled_ = true;
+  start_ns_ = PosixInNsec();
   name_ = name;
   Event *e = PushEvent(name_);
   // Maybe need the same push/pop behavior.
@@ -149,6 +160,10 @@ RecordEvent::RecordEvent(const std::string &name)
 }
 
 RecordEvent::~RecordEvent() {
+  if (is_monitored_) {
+    LatencyMonitor::Instance().Record(monitor_event_id_, monitor_start_ns_,
+                                      MonotonicNsec());
+  }
   if (g_state == ProfilerState::kDisabled || !is_enabled_) return;
   // lock is not needed, the code below is thread-safe
   DeviceTracer *tracer = GetDeviceTracer();
@@ -284,6 +299,8 @@ void ResetProfiler() {
        it != g_all_mem_event_lists.end(); ++it) {
     (*it)->Clear();
   }
+  g_infer_shape_cache_hits = 0;
+  g_infer_shape_cache_misses = 0;
 }
 
 std::vector<std::vector<Event>> GetAllEvents() {
@@ -609,6 +626,32 @@ void ParseMemEvents(const std::vector<std::vector<MemEvent>> &events) {
   PrintMemProfiler(annotation_report, 55, 18);
 }
 
+void RecordInferShapeCacheAccess(bool hit) {
+  if (g_state == ProfilerState::kDisabled) return;
+  if (hit) {
+    g_infer_shape_cache_hits.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    g_infer_shape_cache_misses.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void GetInferShapeCacheStats(uint64_t *hits, uint64_t *misses) {
+  *hits = g_infer_shape_cache_hits.load();
+  *misses = g_infer_shape_cache_misses.load();
+}
+
+// Print the hit rate of the runtime InferShape cache, nothing is printed if
+// no operator enables the cache.
+static void PrintInferShapeCacheStats() {
+  uint64_t hits, misses;
+  GetInferShapeCacheStats(&hits, &misses);
+  if (hits + misses == 0) return;
+  std::cout << "\nInferShape Cache: " << hits << " hits, " << misses
+            << " misses, hit rate "
+            << string::Sprintf("%.2f%%", 100.0 * hits / (hits + misses))
+            << std::endl;
+}
+
 void DisableProfiler(EventSortingKey sorted_key,
                      const std::string &profile_path) {
   SynchronizeAllDevice();
@@ -629,6 +672,7 @@ void DisableProfiler(EventSortingKey sorted_key,
   std::vector<std::vector<Event>> all_events = GetAllEvents();
   ParseEvents(all_events, true, sorted_key);
   ParseEvents(all_events, false, sorted_key);
+  PrintInferShapeCacheStats();
   if (VLOG_IS_ON(5)) {
     std::vector<std::vector<MemEvent>> all_mem_events = GetMemEvents();
     ParseMemEvents(all_mem_events);
@@ -640,6 +684,9 @@ void DisableProfiler(EventSortingKey sorted_key,
 }
 
 bool IsProfileEnabled() { return g_state != ProfilerState::kDisabled; }
+bool IsEventRecordEnabled() {
+  return IsProfileEnabled() || LatencyMonitor::IsEnabled();
+}
 bool ShouldSendProfileState() { return should_send_profile_state; }
 
 void SetProfileListener() {
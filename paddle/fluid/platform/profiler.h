@@ -85,6 +85,10 @@ struct RecordEvent {
 
   bool is_enabled_;
   uint64_t start_ns_;
+  // Whether the event is recorded by the LatencyMonitor.
+  bool is_monitored_;
+  uint32_t monitor_event_id_;
+  uint64_t monitor_start_ns_;
   // Event name
   std::string name_;
   // Need to distinguish name by op type, block_id, program_id and perhaps
@@ -175,6 +179,15 @@ const int kEnableProfiler = 1;
 const int kDisableProfiler = 2;
 // Test if the profiler is currently enabled.
 bool IsProfileEnabled();
+// Test if either the profiler or the latency monitor is enabled, which means
+// RecordEvent should be created.
+bool IsEventRecordEnabled();
+// Count a hit or a miss of the runtime InferShape cache of the operators while
+// the profiler is enabled, the hit rate is printed by DisableProfiler.
+void RecordInferShapeCacheAccess(bool hit);
+// Get the hits and misses of the runtime InferShape cache since the profiler
+// was last reset.
+void GetInferShapeCacheStats(uint64_t* hits, uint64_t* misses);
 // Whether the trainer should send profiling state to PS.
 bool ShouldSendProfileState();
 // Mark current process as PS by assigning a lister id.
@@ -41,7 +41,24 @@ void BindCommunicator(py::module* m) {
       }))
       .def("stop", &Communicator::Stop)
       .def("start", &Communicator::Start)
-      .def("is_running", &Communicator::IsRunning);
+      .def("is_running", &Communicator::IsRunning)
+      .def("send_stats", [](Communicator& self) {
+        py::dict stats;
+        for (auto& iter : self.GetSendStats()) {
+          auto& stat = iter.second;
+          py::dict counters;
+          counters["queue_size"] = stat.queue_size;
+          counters["max_queue_size"] = stat.max_queue_size;
+          counters["send_num"] = stat.send_num;
+          counters["merged_grad_num"] = stat.merged_grad_num;
+          counters["total_wait_us"] = stat.total_wait_us;
+          counters["max_wait_us"] = stat.max_wait_us;
+          counters["total_send_us"] = stat.total_send_us;
+          counters["max_send_us"] = stat.max_send_us;
+          stats[py::str(iter.first)] = counters;
+        }
+        return stats;
+      });
 }
 
 }  // namespace pybind
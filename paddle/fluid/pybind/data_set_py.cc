@@ -273,6 +273,16 @@ void BindDataset(py::module *m) {
                     const std::vector<platform::Place> &, size_t, bool>())
       .def("_start", &IterableDatasetWrapper::Start)
       .def("_next", &IterableDatasetWrapper::Next);
+
+  m->def("convert_multi_slot_text_to_binary",
+         &framework::ConvertMultiSlotTextToBinary, py::arg("src_filename"),
+         py::arg("dst_filename"), py::arg("slot_types"),
+         py::arg("block_ins_num") = 1024, py::arg("pipe_command") = "cat",
+         py::call_guard<py::gil_scoped_release>());
+  m->def("split_multi_slot_binary_files",
+         &framework::SplitMultiSlotBinaryFiles, py::arg("filelist"),
+         py::arg("block_num_per_part"),
+         py::call_guard<py::gil_scoped_release>());
 }
 
 }  // namespace pybind
@@ -34,21 +34,27 @@ using paddle::PaddleDType;
 using paddle::PaddleBuf;
 using paddle::PaddleTensor;
 using paddle::PaddlePlace;
+using paddle::PaddleOpLatency;
 using paddle::PaddlePredictor;
 using paddle::NativeConfig;
 using paddle::NativePaddlePredictor;
 using paddle::AnalysisPredictor;
+using paddle::BatchingConfig;
+using paddle::BatchingPredictor;
+using paddle::PaddleBatchingStats;
 
 namespace {
 void BindPaddleDType(py::module *m);
 void BindPaddleBuf(py::module *m);
 void BindPaddleTensor(py::module *m);
 void BindPaddlePlace(py::module *m);
+void BindPaddleOpLatency(py::module *m);
 void BindPaddlePredictor(py::module *m);
 void BindNativeConfig(py::module *m);
 void BindNativePredictor(py::module *m);
 void BindAnalysisConfig(py::module *m);
 void BindAnalysisPredictor(py::module *m);
+void BindBatchingPredictor(py::module *m);
 
 #ifdef PADDLE_WITH_MKLDNN
 void BindMkldnnQuantizerConfig(py::module *m);
@@ -135,11 +141,13 @@ void BindInferenceApi(py::module *m) {
   BindPaddleBuf(m);
   BindPaddleTensor(m);
   BindPaddlePlace(m);
+  BindPaddleOpLatency(m);
   BindPaddlePredictor(m);
   BindNativeConfig(m);
   BindNativePredictor(m);
   BindAnalysisConfig(m);
   BindAnalysisPredictor(m);
+  BindBatchingPredictor(m);
 #ifdef PADDLE_WITH_MKLDNN
   BindMkldnnQuantizerConfig(m);
 #endif
@@ -247,6 +255,18 @@ void BindPaddlePlace(py::module *m) {
       .value("GPU", PaddlePlace::kGPU);
 }
 
+void BindPaddleOpLatency(py::module *m) {
+  py::class_<PaddleOpLatency>(*m, "PaddleOpLatency")
+      .def(py::init<>())
+      .def_readwrite("name", &PaddleOpLatency::name)
+      .def_readwrite("calls", &PaddleOpLatency::calls)
+      .def_readwrite("total_ms", &PaddleOpLatency::total_ms)
+      .def_readwrite("min_ms", &PaddleOpLatency::min_ms)
+      .def_readwrite("max_ms", &PaddleOpLatency::max_ms)
+      .def_readwrite("p50_ms", &PaddleOpLatency::p50_ms)
+      .def_readwrite("p99_ms", &PaddleOpLatency::p99_ms);
+}
+
 void BindPaddlePredictor(py::module *m) {
   auto paddle_predictor = py::class_<PaddlePredictor>(*m, "PaddlePredictor");
   paddle_predictor
@@ -259,6 +279,8 @@ void BindPaddlePredictor(py::module *m) {
       .def("get_input_tensor", &PaddlePredictor::GetInputTensor)
       .def("get_output_tensor", &PaddlePredictor::GetOutputTensor)
       .def("zero_copy_run", &PaddlePredictor::ZeroCopyRun)
+      .def("get_op_latency_snapshot", &PaddlePredictor::GetOpLatencySnapshot,
+           py::arg("reset") = true)
       .def("clone", &PaddlePredictor::Clone);
 
   auto config = py::class_<PaddlePredictor::Config>(paddle_predictor, "Config");
@@ -337,7 +359,19 @@ void BindAnalysisConfig(py::module *m) {
            py::arg("x") = true)
       .def("ir_optim", &AnalysisConfig::ir_optim)
       .def("enable_memory_optim", &AnalysisConfig::EnableMemoryOptim)
+      .def("enable_memory_arena", &AnalysisConfig::EnableMemoryArena,
+           py::arg("x") = true)
+      .def("memory_arena_enabled", &AnalysisConfig::memory_arena_enabled)
+      .def("enable_optim_program_cache",
+           &AnalysisConfig::EnableOptimProgramCache, py::arg("x") = true)
+      .def("optim_program_cache_enabled",
+           &AnalysisConfig::optim_program_cache_enabled)
       .def("enable_profile", &AnalysisConfig::EnableProfile)
+      .def("switch_params_use_mmap", &AnalysisConfig::SwitchParamsUseMmap,
+           py::arg("x") = true)
+      .def("params_use_mmap", &AnalysisConfig::params_use_mmap)
+      .def("enable_latency_monitor", &AnalysisConfig::EnableLatencyMonitor)
+      .def("latency_monitor_enabled", &AnalysisConfig::latency_monitor_enabled)
       .def("set_optim_cache_dir", &AnalysisConfig::SetOptimCacheDir)
       .def("switch_use_feed_fetch_ops", &AnalysisConfig::SwitchUseFeedFetchOps,
            py::arg("x") = true)
@@ -369,6 +403,8 @@ void BindAnalysisConfig(py::module *m) {
            &AnalysisConfig::SetCpuMathLibraryNumThreads)
       .def("cpu_math_library_num_threads",
            &AnalysisConfig::cpu_math_library_num_threads)
+      .def("set_inter_op_num_threads", &AnalysisConfig::SetInterOpNumThreads)
+      .def("inter_op_num_threads", &AnalysisConfig::inter_op_num_threads)
       .def("to_native_config", &AnalysisConfig::ToNativeConfig)
       .def("enable_quantizer", &AnalysisConfig::EnableMkldnnQuantizer)
 #ifdef PADDLE_WITH_MKLDNN
@@ -418,11 +454,53 @@ void BindAnalysisPredictor(py::module *m) {
       .def("get_input_tensor", &AnalysisPredictor::GetInputTensor)
       .def("get_output_tensor", &AnalysisPredictor::GetOutputTensor)
       .def("zero_copy_run", &AnalysisPredictor::ZeroCopyRun)
+      .def("get_op_latency_snapshot", &AnalysisPredictor::GetOpLatencySnapshot,
+           py::arg("reset") = true)
       .def("clone", &AnalysisPredictor::Clone)
       .def("scope", &AnalysisPredictor::scope,
            py::return_value_policy::reference)
       .def("SaveOptimModel", &AnalysisPredictor::SaveOptimModel,
-           py::arg("dir"));
+           py::arg("dir"), py::arg("align_params") = false);
+}
+
+void BindBatchingPredictor(py::module *m) {
+  py::class_<BatchingConfig>(*m, "BatchingConfig")
+      .def(py::init<>())
+      .def_readwrite("max_batch_size", &BatchingConfig::max_batch_size)
+      .def_readwrite("max_wait_us", &BatchingConfig::max_wait_us)
+      .def_readwrite("num_workers", &BatchingConfig::num_workers);
+
+  py::class_<PaddleBatchingStats>(*m, "PaddleBatchingStats")
+      .def(py::init<>())
+      .def_readwrite("requests", &PaddleBatchingStats::requests)
+      .def_readwrite("failed_requests", &PaddleBatchingStats::failed_requests)
+      .def_readwrite("batches", &PaddleBatchingStats::batches)
+      .def_readwrite("avg_batch_size", &PaddleBatchingStats::avg_batch_size)
+      .def_readwrite("avg_batch_fill", &PaddleBatchingStats::avg_batch_fill)
+      .def_readwrite("avg_requests_per_batch",
+                     &PaddleBatchingStats::avg_requests_per_batch)
+      .def_readwrite("avg_queue_ms", &PaddleBatchingStats::avg_queue_ms)
+      .def_readwrite("avg_latency_ms", &PaddleBatchingStats::avg_latency_ms)
+      .def_readwrite("p50_latency_ms", &PaddleBatchingStats::p50_latency_ms)
+      .def_readwrite("p99_latency_ms", &PaddleBatchingStats::p99_latency_ms)
+      .def_readwrite("max_latency_ms", &PaddleBatchingStats::max_latency_ms);
+
+  py::class_<BatchingPredictor>(*m, "BatchingPredictor")
+      .def(py::init<const AnalysisConfig &, const BatchingConfig &>())
+      // Release the GIL so that the requests of Python threads can be
+      // batched together.
+      .def("run",
+           [](BatchingPredictor &self,
+              const std::vector<PaddleTensor> &inputs) {
+             std::vector<PaddleTensor> outputs;
+             {
+               py::gil_scoped_release release;
+               self.Run(inputs, &outputs);
+             }
+             return outputs;
+           })
+      .def("get_stats", &BatchingPredictor::GetStats,
+           py::arg("reset") = false);
 }
 }  // namespace
 }  // namespace pybind
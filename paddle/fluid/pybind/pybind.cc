@@ -1289,7 +1289,21 @@ All parameter, weight, gradient are variables in Paddle.
                     [](const ExecutionStrategy &self) { return self.dry_run_; },
                     [](ExecutionStrategy &self, bool dry_run) {
                       self.dry_run_ = dry_run;
-                    });
+                    })
+      .def_property(
+          "use_work_stealing_thread_pool",
+          [](const ExecutionStrategy &self) {
+            return self.use_work_stealing_thread_pool_;
+          },
+          [](ExecutionStrategy &self, bool use_work_stealing_thread_pool) {
+            self.use_work_stealing_thread_pool_ = use_work_stealing_thread_pool;
+          },
+          R"DOC(The type is BOOL, use_work_stealing_thread_pool indicates
+                whether to run the operators with a work-stealing thread pool,
+                which has lower scheduling overhead than the default thread
+                pool when the graph has many small operators. It only works
+                with the experimental executor. Default False.
+              )DOC");
 
   exec_strategy.def_property(
       "use_experimental_executor",
@@ -1670,6 +1684,10 @@ All parameter, weight, gradient are variables in Paddle.
           "cache_runtime_context",
           [](const BuildStrategy &self) { return self.cache_runtime_context_; },
           [](BuildStrategy &self, bool b) { self.cache_runtime_context_ = b; })
+      .def_property(
+          "cache_infer_shape",
+          [](const BuildStrategy &self) { return self.cache_infer_shape_; },
+          [](BuildStrategy &self, bool b) { self.cache_infer_shape_ = b; })
       .def_property(
           "mkldnn_enabled_op_types",
           [](const BuildStrategy &self) {
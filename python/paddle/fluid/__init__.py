@@ -156,11 +156,15 @@ def __bootstrap__():
         'eager_delete_scope', 'initial_cpu_memory_in_mb', 'init_allocated_mem',
         'paddle_num_threads', 'dist_threadpool_size', 'eager_delete_tensor_gb',
         'fast_eager_deletion_mode', 'memory_fraction_of_eager_deletion',
-        'allocator_strategy', 'reader_queue_speed_test_mode',
+        'allocator_strategy', 'cpu_thread_cache_max_size',
+        'cpu_thread_cache_capacity_in_mb', 'reader_queue_speed_test_mode',
         'print_sub_graph_dir', 'pe_profile_fname', 'inner_op_parallelism',
         'enable_parallel_graph', 'fuse_parameter_groups_size',
         'multiple_of_cupti_buffer_size', 'fuse_parameter_memory_size',
-        'tracer_profile_fname', 'dygraph_debug'
+        'tracer_profile_fname', 'dygraph_debug', 'enable_latency_monitor',
+        'latency_monitor_ring_size', 'latency_monitor_interval_ms',
+        'dataset_global_shuffle_inflight_mb', 'data_feed_readahead_block_num',
+        'data_feed_readahead_block_size'
     ]
     if 'Darwin' not in sysstr:
         read_env_flags.append('use_pinned_memory')
@@ -184,6 +188,7 @@ def __bootstrap__():
         read_env_flags.append('rpc_get_thread_num')
         read_env_flags.append('rpc_prefetch_thread_num')
         read_env_flags.append('rpc_disable_reuse_port')
+        read_env_flags.append('rpc_recv_buffer_pool_size')
 
         # env for communicator
         read_env_flags.append('communicator_independent_recv_thread')
@@ -192,8 +197,11 @@ def __bootstrap__():
         read_env_flags.append('communicator_thread_pool_size')
         read_env_flags.append('communicator_max_merge_var_num')
         read_env_flags.append('communicator_fake_rpc')
-        read_env_flags.append('communicator_send_wait_times')
+        read_env_flags.append('communicator_send_wait_ms')
         read_env_flags.append('communicator_merge_sparse_grad')
+        read_env_flags.append('communicator_grad_compress_type')
+        read_env_flags.append('communicator_grad_compress_topk_ratio')
+        read_env_flags.append('communicator_grad_compress_min_numel')
         if core.is_compiled_with_brpc():
             read_env_flags.append('max_body_size')
             #set brpc max body size
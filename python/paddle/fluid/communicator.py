@@ -104,3 +104,27 @@ class Communicator(object):
                 comm.is_running()
         """
         self.communicator_.is_running()
+
+    def send_stats(self):
+        """
+        Get the counters of sending each gradient, which are the current
+        queue size, the max queue size at a merge, the number of sends,
+        the number of merged gradients, and the total and max time in
+        microseconds that gradients wait in the queue and that merging and
+        sending take.
+
+        Returns:
+            dict: gradient name -> dict of the counters
+
+        Examples:
+            .. code-block:: python
+
+                import paddle.fluid as fluid
+
+                prog = fluid.Program()
+                comm = fluid.communicator.Communicator(prog)
+                comm.start()
+                print(comm.send_stats())
+                comm.stop()
+        """
+        return self.communicator_.send_stats()
@@ -393,7 +393,9 @@ class InMemoryDataset(DatasetBase):
 
     def set_fleet_send_sleep_seconds(self, fleet_send_sleep_seconds=0):
         """
-        Set fleet send sleep time, default is 0
+        Set fleet send sleep time, default is 0. It is ignored now, the
+        data sent but not yet received in global shuffle is bounded by
+        FLAGS_dataset_global_shuffle_inflight_mb instead.
 
         Args:
             fleet_send_sleep_seconds(int): fleet send sleep time
@@ -657,6 +659,26 @@ class InMemoryDataset(DatasetBase):
         return local_data_size[0]
 
 
+class CompactInMemoryDataset(InMemoryDataset):
+    """
+    CompactInMemoryDataset, it is the same as InMemoryDataset except that
+    the loaded instances are packed into large contiguous blocks, which
+    takes much less memory, and shuffling only moves the handles of them.
+    It does not support merge_by_lineid and slots_shuffle.
+    This class should be created by DatasetFactory
+
+    Example:
+        dataset = paddle.fluid.DatasetFactory().create_dataset(
+            "CompactInMemoryDataset")
+    """
+
+    def __init__(self):
+        """ Init. """
+        super(CompactInMemoryDataset, self).__init__()
+        self.dataset = core.Dataset("MultiSlotCompactDataset")
+        self.proto_desc.name = "MultiSlotCompactInMemoryDataFeed"
+
+
 class QueueDataset(DatasetBase):
     """
     QueueDataset, it will process data streamly.
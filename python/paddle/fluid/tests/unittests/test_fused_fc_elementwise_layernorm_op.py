@@ -17,15 +17,12 @@ from __future__ import print_function
 import unittest
 import numpy as np
 from op_test import OpTest
-from paddle.fluid import core
 from test_fc_op import fc_refer, MatrixGenerate
 from test_layer_norm_op import _reference_layer_norm_naive
 
 np.random.random(123)
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "Paddle core is not compiled with CUDA")
 class TestFusedFCElementwiseLayerNormOp(OpTest):
     def config(self):
         self.matrix = MatrixGenerate(1, 10, 15, 3, 3, 2)
@@ -67,8 +64,7 @@ class TestFusedFCElementwiseLayerNormOp(OpTest):
         self.outputs = {"Out": out, "Mean": mean, "Variance": variance}
 
     def test_check_output(self):
-        place = core.CUDAPlace(0)
-        self.check_output_with_place(place, atol=2e-3)
+        self.check_output(atol=2e-3)
 
 
 class TestFusedFCElementwiseLayerNormOp2(TestFusedFCElementwiseLayerNormOp):
@@ -78,5 +74,13 @@ class TestFusedFCElementwiseLayerNormOp2(TestFusedFCElementwiseLayerNormOp):
         self.begin_norm_axis = 1
 
 
+class TestFusedFCElementwiseLayerNormOp3(TestFusedFCElementwiseLayerNormOp):
+    def config(self):
+        # The normalized size is larger than 8 but not a multiple of 8.
+        self.matrix = MatrixGenerate(3, 4, 21, 2, 2, 1)
+        self.y_shape = [3, 21]
+        self.begin_norm_axis = 1
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,112 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def multihead_attention_refer(x, weights, biases, bias_qk, w_out, bias_out,
+                              head_number, alpha):
+    batch, seq_len, _ = x.shape
+    size = weights[0].shape[1]
+    head_size = size // head_number
+
+    def split_heads(w, b):
+        out = np.dot(x, w) + b
+        out = out.reshape(batch, seq_len, head_number, head_size)
+        return out.transpose(0, 2, 1, 3)
+
+    q, k, v = [split_heads(w, b) for w, b in zip(weights, biases)]
+    scores = alpha * np.matmul(q, k.transpose(0, 1, 3, 2)) + bias_qk
+    scores = np.exp(scores - np.max(scores, axis=-1, keepdims=True))
+    scores = scores / np.sum(scores, axis=-1, keepdims=True)
+    context = np.matmul(scores, v).transpose(0, 2, 1, 3)
+    context = context.reshape(batch, seq_len, size)
+    return np.dot(context, w_out) + bias_out
+
+
+class TestFusedMultiHeadAttentionOp(OpTest):
+    def config(self):
+        self.batch = 2
+        self.seq_len = 8
+        self.hidden = 16
+        self.head_number = 4
+        self.out_size = 16
+        self.bias_qk_shape = [self.batch, self.head_number, self.seq_len,
+                              self.seq_len]
+
+    def setUp(self):
+        self.op_type = "fused_multihead_attention"
+        self.config()
+        alpha = 0.125
+
+        def random(*shape):
+            return np.random.uniform(-0.5, 0.5, shape).astype("float32")
+
+        x = random(self.batch, self.seq_len, self.hidden)
+        weights = [random(self.hidden, self.hidden) for _ in range(3)]
+        biases = [random(self.hidden) for _ in range(3)]
+        bias_qk = random(*self.bias_qk_shape)
+        w_out = random(self.hidden, self.out_size)
+        bias_out = random(self.out_size)
+        out = multihead_attention_refer(x, weights, biases, bias_qk, w_out,
+                                        bias_out, self.head_number, alpha)
+
+        self.inputs = {
+            "X": x,
+            "WQ": weights[0],
+            "BiasQ": biases[0],
+            "WK": weights[1],
+            "BiasK": biases[1],
+            "WV": weights[2],
+            "BiasV": biases[2],
+            "BiasQK": bias_qk,
+            "WOut": w_out,
+            "BiasOut": bias_out
+        }
+        self.attrs = {"head_number": self.head_number, "alpha": alpha}
+        self.outputs = {"Out": out.astype("float32")}
+
+    def test_check_output(self):
+        self.check_output(atol=1e-4)
+
+
+class TestFusedMultiHeadAttentionOpBroadcastBias(
+        TestFusedMultiHeadAttentionOp):
+    def config(self):
+        self.batch = 3
+        self.seq_len = 5
+        self.hidden = 12
+        self.head_number = 3
+        self.out_size = 7
+        # The padding mask of keys shared by the heads and queries.
+        self.bias_qk_shape = [self.batch, 1, 1, self.seq_len]
+
+
+class TestFusedMultiHeadAttentionOpSharedBias(TestFusedMultiHeadAttentionOp):
+    def config(self):
+        self.batch = 3
+        self.seq_len = 5
+        self.hidden = 12
+        self.head_number = 3
+        self.out_size = 7
+        # The bias shared by the samples of the batch.
+        self.bias_qk_shape = [1, self.head_number, self.seq_len, self.seq_len]
+
+
+if __name__ == '__main__':
+    unittest.main()